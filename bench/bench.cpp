@@ -0,0 +1,63 @@
+#include "bench.h"
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+// ===================== Results =====================
+void BenchReporter::report(const std::string &suite, const std::string &name, const BenchMetrics &metrics)
+{
+    switch (format_)
+    {
+    case Format::Text:
+    {
+        std::ostringstream label;
+        label << suite << "/" << name;
+        std::cout << std::left << std::setw(40) << label.str() << std::right;
+        for (const auto &[key, value] : metrics)
+            std::cout << "  " << key << "=" << value;
+        std::cout << "\n";
+        break;
+    }
+    case Format::Csv:
+    {
+        // Start a new header whenever the set of columns changes
+        std::vector<std::string> header;
+        for (const auto &metric : metrics)
+            header.push_back(metric.first);
+
+        if (header != csvHeader_)
+        {
+            csvHeader_ = header;
+            std::cout << "suite,name";
+            for (const auto &key : header)
+                std::cout << "," << key;
+            std::cout << "\n";
+        }
+
+        std::cout << suite << "," << name;
+        for (const auto &metric : metrics)
+            std::cout << "," << metric.second;
+        std::cout << "\n";
+        break;
+    }
+    case Format::Json:
+        std::cout << "{\"suite\":\"" << suite << "\",\"name\":\"" << name << "\"";
+        for (const auto &[key, value] : metrics)
+            std::cout << ",\"" << key << "\":" << value;
+        std::cout << "}\n";
+        break;
+    }
+
+    std::cout.flush();
+}
+
+// ===================== Utility Functions =====================
+void fillNoise(std::vector<float> &buffer, float amplitude, uint32_t seed)
+{
+    uint32_t state = seed ? seed : 1;
+    for (float &sample : buffer)
+    {
+        state = state * 1664525u + 1013904223u;
+        sample = amplitude * (static_cast<float>(state >> 8) * (2.0f / 16777216.0f) - 1.0f);
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ===================== Results =====================
+
+using BenchMetrics = std::vector<std::pair<std::string, double>>;
+
+// Prints benchmark records as aligned text, CSV or JSON Lines
+class BenchReporter {
+public:
+    enum class Format { Text, Csv, Json };
+
+    explicit BenchReporter(Format format) : format_(format) {}
+
+    void report(const std::string& suite, const std::string& name, const BenchMetrics& metrics);
+
+private:
+    Format format_;
+    std::vector<std::string> csvHeader_;
+};
+
+// ===================== Context =====================
+
+struct BenchContext
+{
+    BenchReporter* reporter;
+    double minSeconds = 0.1;   // minimum measured time per case
+    double sampleRate = 48000; // used for realtime factors
+    std::string filter;        // only run suites containing this string
+    mutable int failures = 0;  // correctness checks that failed
+
+    bool enabled(const std::string& suite) const {
+        return filter.empty() || suite.find(filter) != std::string::npos;
+    }
+};
+
+// ===================== Timing =====================
+
+// Calls body() repeatedly until at least minSeconds have elapsed, after a
+// short warm-up. Returns seconds per call.
+template <typename Body>
+double timePerCall(Body&& body, double minSeconds)
+{
+    using Clock = std::chrono::steady_clock;
+
+    for (int i = 0; i < 3; i++)
+        body();
+
+    uint64_t iterations = 1;
+    while (true)
+    {
+        auto start = Clock::now();
+        for (uint64_t i = 0; i < iterations; i++)
+            body();
+        double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+        if (elapsed >= minSeconds)
+            return elapsed / iterations;
+
+        // Aim a little past the target so the next pass usually finishes
+        double scale = elapsed > 0.0 ? 1.2 * minSeconds / elapsed : 10.0;
+        iterations = static_cast<uint64_t>(iterations * std::min(std::max(scale, 2.0), 100.0));
+    }
+}
+
+// Fills buffer with deterministic noise in [-amplitude, amplitude]
+void fillNoise(std::vector<float>& buffer, float amplitude = 0.5f, uint32_t seed = 1);
+
+// ===================== Suites =====================
+
+void benchEngine(const BenchContext& ctx);
+void benchParallel(const BenchContext& ctx);
+void benchEffects(const BenchContext& ctx);
+void benchFused(const BenchContext& ctx);
+void benchSimd(const BenchContext& ctx);
+void benchFastmath(const BenchContext& ctx);
+void benchBridge(const BenchContext& ctx);
+void benchIdle(const BenchContext& ctx);
+void benchDenormal(const BenchContext& ctx);
+void benchAmpModel(const BenchContext& ctx);
+void benchRecorder(const BenchContext& ctx);
+void benchEvents(const BenchContext& ctx);
+void benchAnalysis(const BenchContext& ctx);
+void benchConversion(const BenchContext& ctx);
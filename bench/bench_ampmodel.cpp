@@ -0,0 +1,187 @@
+#include "bench.h"
+#include "Effects/ampmodel.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+namespace
+{
+    // Random weights at the scale training starts from, so the gates neither
+    // saturate nor die out
+    AmpModel randomModel(AmpModel::Cell cell, int layers, int hiddenSize, uint32_t seed)
+    {
+        AmpModel model;
+        model.cell = cell;
+        model.layers = layers;
+        model.hiddenSize = hiddenSize;
+        model.weights.resize(AmpModel::weightCount(cell, layers, hiddenSize));
+        fillNoise(model.weights, 1.0f / std::sqrt(static_cast<float>(hiddenSize + 1)), seed);
+        return model;
+    }
+
+    // Straight from the file layout with libm, for checking the effect against
+    std::vector<float> referenceRun(const AmpModel &model, const std::vector<float> &input)
+    {
+        const size_t H = static_cast<size_t>(model.hiddenSize);
+        const bool lstm = model.cell == AmpModel::Cell::Lstm;
+        const size_t rows = (lstm ? 4 : 3) * H;
+        auto sigmoid = [](double x)
+        { return 1.0 / (1.0 + std::exp(-x)); };
+
+        struct State
+        {
+            std::vector<double> h, c;
+        };
+        std::vector<State> states(model.layers);
+        std::vector<const float *> layerWeights(model.layers);
+
+        const float *w = model.weights.data();
+        for (int l = 0; l < model.layers; l++)
+        {
+            const size_t inputs = l == 0 ? 1 : H;
+            layerWeights[l] = w;
+            w += rows * (inputs + H) + rows * (lstm ? 1 : 2);
+            states[l].h.assign(w, w + H);
+            w += H;
+            if (lstm)
+            {
+                states[l].c.assign(w, w + H);
+                w += H;
+            }
+        }
+        const float *head = w;
+
+        std::vector<float> output(input.size());
+        for (size_t n = 0; n < input.size(); n++)
+        {
+            std::vector<double> x = {input[n]};
+            for (int l = 0; l < model.layers; l++)
+            {
+                const size_t columns = x.size() + H;
+                const float *W = layerWeights[l];
+                const float *bias = W + rows * columns;
+                std::vector<double> gx(rows), gh(rows);
+                for (size_t r = 0; r < rows; r++)
+                {
+                    gx[r] = bias[r];
+                    gh[r] = lstm ? 0.0 : bias[rows + r];
+                    for (size_t j = 0; j < x.size(); j++)
+                        gx[r] += W[r * columns + j] * x[j];
+                    for (size_t j = 0; j < H; j++)
+                        gh[r] += W[r * columns + x.size() + j] * states[l].h[j];
+                }
+
+                State &s = states[l];
+                for (size_t k = 0; k < H; k++)
+                {
+                    if (lstm)
+                    {
+                        double i = sigmoid(gx[k] + gh[k]), f = sigmoid(gx[H + k] + gh[H + k]);
+                        double g = std::tanh(gx[2 * H + k] + gh[2 * H + k]), o = sigmoid(gx[3 * H + k] + gh[3 * H + k]);
+                        s.c[k] = f * s.c[k] + i * g;
+                        s.h[k] = o * std::tanh(s.c[k]);
+                    }
+                    else
+                    {
+                        double r = sigmoid(gx[k] + gh[k]), z = sigmoid(gx[H + k] + gh[H + k]);
+                        double c = std::tanh(gx[2 * H + k] + r * gh[2 * H + k]);
+                        s.h[k] = (1.0 - z) * c + z * s.h[k];
+                    }
+                }
+                x = s.h;
+            }
+
+            double y = head[H];
+            for (size_t k = 0; k < H; k++)
+                y += head[k] * x[k];
+            output[n] = static_cast<float>(y);
+        }
+        return output;
+    }
+
+    double timeModel(const BenchContext &ctx, AmpModelEffect &effect, const std::vector<float> &source)
+    {
+        const unsigned long frames = static_cast<unsigned long>(source.size());
+        ProcessSpec spec;
+        spec.sampleRate = ctx.sampleRate;
+        spec.maxFrames = frames;
+        effect.prepare(spec);
+
+        std::vector<float> block(frames);
+        return timePerCall([&]
+                           {
+                               std::copy(source.begin(), source.end(), block.begin());
+                               effect.process(block.data(), frames, 0); },
+                           ctx.minSeconds);
+    }
+}
+
+// ===================== Amp Models =====================
+
+// Real-time factor of one mono instance for each model size, which is also
+// how many instances a core could run. Every size is checked against a
+// double-precision reference.
+void benchAmpModel(const BenchContext &ctx)
+{
+    struct Size
+    {
+        AmpModel::Cell cell;
+        int layers;
+        int hidden;
+    };
+    const Size sizes[] = {
+        {AmpModel::Cell::Lstm, 1, 8},
+        {AmpModel::Cell::Lstm, 1, 12},
+        {AmpModel::Cell::Lstm, 1, 16},
+        {AmpModel::Cell::Lstm, 1, 24},
+        {AmpModel::Cell::Lstm, 1, 28},
+        {AmpModel::Cell::Lstm, 1, 32},
+        {AmpModel::Cell::Lstm, 1, 40},
+        {AmpModel::Cell::Lstm, 2, 16},
+        {AmpModel::Cell::Lstm, 2, 24},
+        {AmpModel::Cell::Gru, 1, 16},
+        {AmpModel::Cell::Gru, 1, 32},
+        {AmpModel::Cell::Gru, 2, 16},
+    };
+
+    const unsigned long frames = 256;
+    std::vector<float> source(frames);
+    fillNoise(source, 0.5f);
+
+    // A second of guitar-level noise through every size
+    std::vector<float> checkInput(static_cast<size_t>(ctx.sampleRate));
+    fillNoise(checkInput, 0.5f, 7);
+
+    for (const Size &size : sizes)
+    {
+        AmpModel model = randomModel(size.cell, size.layers, size.hidden, static_cast<uint32_t>(size.hidden * 10 + size.layers));
+        std::string name = std::string(size.cell == AmpModel::Cell::Lstm ? "lstm_" : "gru_") +
+                           std::to_string(size.layers) + "x" + std::to_string(size.hidden);
+
+        std::vector<float> expected = referenceRun(model, checkInput);
+        AmpModelEffect effect(model);
+        ProcessSpec spec;
+        spec.sampleRate = ctx.sampleRate;
+        spec.maxFrames = static_cast<unsigned long>(checkInput.size());
+        effect.prepare(spec);
+        std::vector<float> actual = checkInput;
+        effect.process(actual.data(), static_cast<unsigned long>(actual.size()), 0);
+
+        float maxError = 0.0f;
+        for (size_t i = 0; i < actual.size(); i++)
+            maxError = std::max(maxError, std::abs(actual[i] - expected[i]));
+        if (!(maxError <= 1e-4f))
+        {
+            ctx.failures++;
+            std::cerr << "[Error] Amp model " << name << " differs from the reference by " << maxError << "\n";
+        }
+
+        double seconds = timeModel(ctx, effect, source);
+        ctx.reporter->report("ampmodel", name,
+                             {{"weights", static_cast<double>(model.weights.size())},
+                              {"max_error", maxError},
+                              {"ns_per_sample", seconds * 1e9 / frames},
+                              {"realtime_factor", (frames / ctx.sampleRate) / seconds}});
+    }
+}
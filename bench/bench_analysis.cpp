@@ -0,0 +1,160 @@
+#include "bench.h"
+#include "analyzer.h"
+#include "audioengine.h"
+#include "Effects/distortion.h"
+#include "Effects/gain.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace
+{
+    // A plucked-string stand-in: eight harmonics falling off as 1/k, over a
+    // little noise so the window is never perfectly periodic
+    void fillTone(float *out, size_t count, double frequency, double sampleRate, uint64_t start, uint32_t seed)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            double t = (start + i) / sampleRate;
+            double x = 0.0;
+            for (int k = 1; k <= 8; k++)
+                x += std::sin(2.0 * 3.14159265358979 * k * frequency * t + 0.7 * k) / k;
+            seed = seed * 1664525u + 1013904223u;
+            out[i] = static_cast<float>(0.2 * x) + 0.002f * (static_cast<float>(seed >> 8) / 8388608.0f - 1.0f);
+        }
+    }
+
+    float centsBetween(float frequency, double reference)
+    {
+        return static_cast<float>(1200.0 * std::log2(frequency / reference));
+    }
+
+    // Frames from switching the tone fed through the tap to the first
+    // reading within 5 cents of the new note; 0 if it never settles
+    uint64_t switchFrames(Analyzer &analyzer, double from, double to, double sampleRate)
+    {
+        const size_t frames = 64;
+        std::vector<float> block(frames);
+        TapEffect &tap = *analyzer.tap();
+        uint64_t frame = 0;
+
+        // A second of the old note, then the new one
+        const uint64_t change = static_cast<uint64_t>(sampleRate);
+        for (; frame < change + static_cast<uint64_t>(sampleRate / 2); frame += frames)
+        {
+            double frequency = frame < change ? from : to;
+            if (frequency > 0.0)
+                fillTone(block.data(), frames, frequency, sampleRate, frame, static_cast<uint32_t>(frame + 1));
+            else
+                std::fill(block.begin(), block.end(), 0.0f);
+            tap.process(block.data(), frames, 0);
+            analyzer.poll();
+
+            Analyzer::Reading reading = analyzer.reading();
+            if (frame >= change && reading.pitched && std::abs(centsBetween(reading.frequency, to)) < 5.0f)
+                return frame + frames - change;
+        }
+        return 0;
+    }
+}
+
+// ===================== Analysis =====================
+
+// Tuner accuracy across the guitar's range, how long a new note takes to
+// show up in the readings, and what the tap costs the audio thread
+void benchAnalysis(const BenchContext &ctx)
+{
+    struct Target
+    {
+        const char *name;
+        double frequency;
+    };
+    const Target targets[] = {{"B1", 61.735}, {"E2", 82.407}, {"A2", 110.0}, {"D3", 146.832},
+                              {"G3", 195.998}, {"B3", 246.942}, {"E4", 329.628}, {"E5", 659.255}};
+
+    PitchDetector detector;
+    detector.prepare(ctx.sampleRate);
+    std::vector<float> window(detector.windowFrames());
+
+    for (const Target &target : targets)
+    {
+        // Several windows, each starting at another phase of the tone
+        float worst = 0.0f;
+        bool named = true;
+        for (uint32_t w = 0; w < 16; w++)
+        {
+            fillTone(window.data(), window.size(), target.frequency, ctx.sampleRate, w * 997, w + 1);
+            float frequency = 0.0f, clarity = 0.0f;
+            if (!detector.detect(window.data(), frequency, clarity))
+            {
+                worst = 1200.0f;
+                break;
+            }
+            worst = std::max(worst, std::abs(centsBetween(frequency, target.frequency)));
+            named = named && nearestNote(frequency).name == target.name;
+        }
+
+        Analyzer onset, change;
+        onset.tap()->prepare(ProcessSpec{ctx.sampleRate, 1, 64, false});
+        change.tap()->prepare(ProcessSpec{ctx.sampleRate, 1, 64, false});
+        double onsetMs = switchFrames(onset, 0.0, target.frequency, ctx.sampleRate) * 1000.0 / ctx.sampleRate;
+        double changeMs = switchFrames(change, target.frequency * 1.5, target.frequency, ctx.sampleRate) * 1000.0 /
+                          ctx.sampleRate;
+
+        if (worst > 1.0f || !named || onsetMs <= 0.0 || changeMs <= 0.0 || changeMs >= 50.0)
+        {
+            ctx.failures++;
+            std::cerr << "[Error] Tuner read " << target.name << " " << worst << " cents off, "
+                      << (named ? "" : "as the wrong note, ") << "settling after " << onsetMs
+                      << " ms from silence and " << changeMs << " ms from another note\n";
+        }
+
+        float frequency, clarity;
+        double detect = timePerCall([&] { detector.detect(window.data(), frequency, clarity); }, ctx.minSeconds);
+        ctx.reporter->report("analysis", std::string("pitch_") + target.name,
+                             {{"max_error_cents", worst},
+                              {"onset_ms", onsetMs},
+                              {"change_ms", changeMs},
+                              {"us_per_detect", detect * 1e6}});
+    }
+
+    // The tap against the same chain without it, with the ring drained the
+    // way the analysis thread would
+    const unsigned long frames = 256;
+    const int channels = 2;
+    std::vector<float> input(frames * channels), output(input.size());
+    fillNoise(input, 0.5f);
+
+    Analyzer analyzer;
+    double seconds[2];
+    for (int tapped = 0; tapped < 2; tapped++)
+    {
+        AudioEngine engine;
+        engine.addEffect(std::make_shared<GainEffect>(2.0f));
+        engine.addEffect(std::make_shared<DistortionEffect>());
+        if (tapped)
+        {
+            engine.addEffect(analyzer.tap());
+            engine.moveEffect(2, 0);
+        }
+        engine.prepare(ctx.sampleRate, channels, channels, frames, false);
+
+        SpscRing &ring = analyzer.tap()->samples();
+        seconds[tapped] = timePerCall(
+            [&]
+            {
+                engine.process(input.data(), output.data(), frames);
+                ring.discard(frames);
+            },
+            ctx.minSeconds);
+    }
+
+    ctx.reporter->report("analysis", "tap",
+                         {{"frames", static_cast<double>(frames)},
+                          {"plain_ns_per_block", seconds[0] * 1e9},
+                          {"tapped_ns_per_block", seconds[1] * 1e9},
+                          {"overhead", seconds[1] / seconds[0]},
+                          {"dropped_frames", static_cast<double>(analyzer.tap()->droppedFrames())}});
+}
@@ -0,0 +1,198 @@
+#include "bench.h"
+#include "devicebridge.h"
+#include "resampler.h"
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+namespace
+{
+    constexpr double kPi = 3.14159265358979323846;
+
+    // Signal-to-error ratio of a sine resampled by ratio, against the exact
+    // sine at each output frame's input time
+    double resampledSnr(double ratio, double cycles)
+    {
+        const size_t block = 256;
+        const int channels = 2;
+        Resampler resampler;
+        resampler.prepare(channels, ratio, block);
+
+        auto sine = [&](double t) { return 0.5 * std::sin(2.0 * kPi * cycles * t); };
+
+        std::vector<float> input, output(block * channels);
+        size_t inputFrames = 0, outputFrames = 0;
+        double signal = 0.0, error = 0.0;
+
+        for (int b = 0; b < 200; b++)
+        {
+            size_t needed = resampler.inputNeeded(block);
+            input.resize(needed * channels);
+            for (size_t i = 0; i < needed; i++)
+                input[i * channels] = input[i * channels + 1] = static_cast<float>(sine(static_cast<double>(inputFrames + i)));
+            inputFrames += needed;
+            resampler.process(input.data(), output.data(), block);
+
+            for (size_t i = 0; i < block; i++, outputFrames++)
+            {
+                // Skip the filter's start-up transient
+                if (outputFrames < 1024)
+                    continue;
+                double expected = sine(static_cast<double>(outputFrames) * ratio);
+                double diff = output[i * channels] - expected;
+                signal += expected * expected;
+                error += diff * diff;
+            }
+        }
+
+        return 10.0 * std::log10(signal / std::max(error, 1e-30));
+    }
+
+    // The drift estimate settles in 4-14 s on these cases; allow for jitter
+    constexpr double kMaxSettleSeconds = 20.0;
+
+    struct DriftResult
+    {
+        double measuredPpm = 0.0;
+        double latencyMs = 0.0;
+        double settleSeconds = -1.0; // first time the estimate stays within 10 ppm
+        uint64_t underruns = 0;
+        uint64_t overruns = 0;
+    };
+
+    // Plays two devices against each other on a simulated timeline: the
+    // input clock runs ppm fast, and every callback fires late by up to
+    // jitter of its period
+    DriftResult simulateDrift(double inputRate, double outputRate, double ppm,
+                              size_t inputBlock, size_t outputBlock, double jitter, double seconds)
+    {
+        const int channels = 2;
+        DeviceBridge bridge;
+        bridge.prepare(channels, inputRate, outputRate, inputBlock, outputBlock);
+
+        std::vector<float> in(inputBlock * channels), out(outputBlock * channels);
+        fillNoise(in, 0.5f, 1);
+
+        uint32_t random = 12345;
+        auto late = [&](double period)
+        {
+            random = random * 1664525u + 1013904223u;
+            return jitter * period * (random >> 8) / 16777216.0;
+        };
+
+        const double inputPeriod = inputBlock / (inputRate * (1.0 + ppm * 1e-6));
+        const double outputPeriod = outputBlock / outputRate;
+        uint64_t inputCount = 0, outputCount = 0;
+        double nextInput = late(inputPeriod), nextOutput = 0.02 + late(outputPeriod);
+
+        DriftResult result;
+        double now = 0.0;
+        while (now < seconds)
+        {
+            if (nextInput <= nextOutput)
+            {
+                now = nextInput;
+                bridge.push(in.data(), inputBlock, now);
+                nextInput = ++inputCount * inputPeriod + late(inputPeriod);
+            }
+            else
+            {
+                now = nextOutput;
+                bridge.pull(out.data(), outputBlock, now);
+                nextOutput = 0.02 + ++outputCount * outputPeriod + late(outputPeriod);
+
+                DeviceBridge::Status s = bridge.status();
+                bool settled = std::abs(s.driftPpm - ppm) < 10.0;
+                if (!settled)
+                    result.settleSeconds = -1.0;
+                else if (result.settleSeconds < 0.0)
+                    result.settleSeconds = now;
+            }
+        }
+
+        DeviceBridge::Status s = bridge.status();
+        result.measuredPpm = s.driftPpm;
+        result.latencyMs = s.latencySeconds * 1000.0;
+        result.underruns = s.underruns;
+        result.overruns = s.overruns;
+        return result;
+    }
+}
+
+// ===================== Device Bridge =====================
+
+// Resampler quality and cost, and the drift loop holding the ring level
+void benchBridge(const BenchContext &ctx)
+{
+    const std::pair<double, double> rates[] = {{44100.0, 48000.0}, {48000.0, 44100.0}, {48000.0, 48000.0}};
+
+    for (const auto &[inputRate, outputRate] : rates)
+    {
+        double ratio = inputRate / outputRate;
+        char name[64];
+        std::snprintf(name, sizeof(name), "resample_%.0f_%.0f", inputRate, outputRate);
+
+        // Tones as a share of the input rate: 1 kHz and 15 kHz at 48 kHz
+        double lowSnr = resampledSnr(ratio * 1.0002, 1000.0 / 48000.0);
+        double highSnr = resampledSnr(ratio * 1.0002, 15000.0 / 48000.0);
+        if (lowSnr < 90.0 || highSnr < 80.0)
+        {
+            ctx.failures++;
+            std::cerr << "[Error] " << name << " is too noisy\n";
+        }
+
+        const size_t block = 256;
+        const int channels = 2;
+        Resampler resampler;
+        resampler.prepare(channels, ratio, block);
+        std::vector<float> input((block * 2 + Resampler::kTaps) * channels), output(block * channels);
+        fillNoise(input, 0.5f, 2);
+
+        double seconds = timePerCall([&]
+                                     { resampler.process(input.data(), output.data(), block); },
+                                     ctx.minSeconds);
+
+        ctx.reporter->report("bridge", name,
+                             {{"snr_1k_db", lowSnr},
+                              {"snr_15k_db", highSnr},
+                              {"ns_per_frame", seconds * 1e9 / block},
+                              {"realtime_factor", (block / outputRate) / seconds}});
+    }
+
+    struct Case
+    {
+        double inputRate, outputRate, ppm;
+        size_t inputBlock, outputBlock;
+    };
+    const Case cases[] = {
+        {48000.0, 48000.0, 150.0, 256, 128},
+        {48000.0, 48000.0, -300.0, 64, 256},
+        {44100.0, 48000.0, 80.0, 128, 128},
+    };
+
+    for (const Case &c : cases)
+    {
+        DriftResult r = simulateDrift(c.inputRate, c.outputRate, c.ppm, c.inputBlock, c.outputBlock, 0.3, 120.0);
+        bool ok = r.underruns == 0 && r.overruns == 0 && std::abs(r.measuredPpm - c.ppm) < 10.0;
+        if (!ok)
+        {
+            ctx.failures++;
+            std::cerr << "[Error] Bridge lost lock at " << c.ppm << " ppm\n";
+        }
+        else if (r.settleSeconds < 0.0 || r.settleSeconds > kMaxSettleSeconds)
+        {
+            ctx.failures++;
+            std::cerr << "[Error] Bridge took " << r.settleSeconds << " s to settle at " << c.ppm << " ppm\n";
+        }
+
+        char name[64];
+        std::snprintf(name, sizeof(name), "drift_%+.0fppm_%zu_%zu", c.ppm, c.inputBlock, c.outputBlock);
+        ctx.reporter->report("bridge", name,
+                             {{"measured_ppm", r.measuredPpm},
+                              {"settle_s", r.settleSeconds},
+                              {"latency_ms", r.latencyMs},
+                              {"underruns", static_cast<double>(r.underruns)},
+                              {"overruns", static_cast<double>(r.overruns)}});
+    }
+}
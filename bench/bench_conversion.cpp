@@ -0,0 +1,272 @@
+#include "bench.h"
+#include "sampleconverter.h"
+#include "simd.h"
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <string>
+
+namespace
+{
+    using Bytes = std::vector<uint8_t>;
+
+    // Noise past full scale, with the values that must saturate mixed in
+    Bytes floatInput(size_t count, uint32_t seed)
+    {
+        std::vector<float> data(count);
+        fillNoise(data, 1.2f, seed);
+        const float specials[] = {
+            std::numeric_limits<float>::quiet_NaN(),
+            std::numeric_limits<float>::infinity(),
+            -std::numeric_limits<float>::infinity(),
+            1.0f, -1.0f, 0.99999994f, -0.0f};
+        for (size_t i = 0; i < count; i += 5)
+            data[i] = specials[(i / 5) % 7];
+
+        Bytes bytes(count * sizeof(float));
+        std::memcpy(bytes.data(), data.data(), bytes.size());
+        return bytes;
+    }
+
+    // Every bit pattern is a valid integer sample
+    Bytes integerInput(size_t bytes, uint32_t seed)
+    {
+        Bytes data(bytes);
+        for (uint8_t &b : data)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            b = static_cast<uint8_t>(seed >> 24);
+        }
+        return data;
+    }
+
+    void seedDither(uint32_t *state)
+    {
+        for (size_t i = 0; i < kDitherLanes; i++)
+            state[i] = static_cast<uint32_t>(i * 0x9e3779b9u + 1);
+    }
+
+    // One direction of one format: converts count samples and returns the
+    // output bytes, followed by the dither state when the kernel takes one
+    struct Conversion
+    {
+        SampleEncoding encoding;
+        bool toFloat;
+        std::function<Bytes(const SimdKernels &, size_t, bool dither)> run;
+    };
+
+    const std::vector<Conversion> &conversions()
+    {
+        static const std::vector<Conversion> list = {
+            {SampleEncoding::Int16, true, [](const SimdKernels &k, size_t n, bool)
+             {
+                 Bytes in = integerInput(2 * n, 1), out(4 * n);
+                 k.int16ToFloat(reinterpret_cast<const int16_t *>(in.data()), reinterpret_cast<float *>(out.data()), n);
+                 return out;
+             }},
+            {SampleEncoding::Int24, true, [](const SimdKernels &k, size_t n, bool)
+             {
+                 Bytes in = integerInput(3 * n, 2), out(4 * n);
+                 k.int24ToFloat(in.data(), reinterpret_cast<float *>(out.data()), n);
+                 return out;
+             }},
+            {SampleEncoding::Int32, true, [](const SimdKernels &k, size_t n, bool)
+             {
+                 Bytes in = integerInput(4 * n, 3), out(4 * n);
+                 k.int32ToFloat(reinterpret_cast<const int32_t *>(in.data()), reinterpret_cast<float *>(out.data()), n);
+                 return out;
+             }},
+            {SampleEncoding::Int16, false, [](const SimdKernels &k, size_t n, bool dither)
+             {
+                 Bytes in = floatInput(n, 4), out(2 * n + sizeof(uint32_t) * kDitherLanes);
+                 uint32_t state[kDitherLanes];
+                 seedDither(state);
+                 k.floatToInt16(reinterpret_cast<const float *>(in.data()), reinterpret_cast<int16_t *>(out.data()), n,
+                                dither ? state : nullptr);
+                 std::memcpy(out.data() + 2 * n, state, sizeof(state));
+                 return out;
+             }},
+            {SampleEncoding::Int24, false, [](const SimdKernels &k, size_t n, bool dither)
+             {
+                 Bytes in = floatInput(n, 5), out(3 * n + sizeof(uint32_t) * kDitherLanes);
+                 uint32_t state[kDitherLanes];
+                 seedDither(state);
+                 k.floatToInt24(reinterpret_cast<const float *>(in.data()), out.data(), n, dither ? state : nullptr);
+                 std::memcpy(out.data() + 3 * n, state, sizeof(state));
+                 return out;
+             }},
+            {SampleEncoding::Int32, false, [](const SimdKernels &k, size_t n, bool)
+             {
+                 Bytes in = floatInput(n, 6), out(4 * n);
+                 k.floatToInt32(reinterpret_cast<const float *>(in.data()), reinterpret_cast<int32_t *>(out.data()), n);
+                 return out;
+             }},
+        };
+        return list;
+    }
+
+    // Every length up to 67 plus a large block, with and without dither
+    bool matchesScalar(const SimdKernels &kernels, const Conversion &conversion)
+    {
+        const SimdKernels &reference = *scalarKernels();
+        for (bool dither : {false, true})
+        {
+            for (size_t n = 0; n <= 67; n++)
+            {
+                if (conversion.run(kernels, n, dither) != conversion.run(reference, n, dither))
+                    return false;
+            }
+            if (conversion.run(kernels, 4099, dither) != conversion.run(reference, 4099, dither))
+                return false;
+        }
+        return true;
+    }
+
+    // Integer samples survive the trip through float unchanged when nothing
+    // is added on the way back
+    bool roundTrips(const SimdKernels &k)
+    {
+        std::vector<int16_t> shorts(65536), shortsBack(65536);
+        for (size_t i = 0; i < shorts.size(); i++)
+            shorts[i] = static_cast<int16_t>(i);
+        std::vector<float> floats(shorts.size());
+        k.int16ToFloat(shorts.data(), floats.data(), shorts.size());
+        k.floatToInt16(floats.data(), shortsBack.data(), shorts.size(), nullptr);
+        if (shorts != shortsBack)
+            return false;
+
+        // Random 24-bit samples, with both extremes
+        Bytes packed = integerInput(3 * 65536, 7), packedBack(packed.size());
+        const uint8_t extremes[] = {0xff, 0xff, 0x7f, 0x00, 0x00, 0x80};
+        std::memcpy(packed.data(), extremes, sizeof(extremes));
+        k.int24ToFloat(packed.data(), floats.data(), 65536);
+        k.floatToInt24(floats.data(), packedBack.data(), 65536, nullptr);
+        return packed == packedBack;
+    }
+}
+
+// ===================== Sample Conversion =====================
+
+// The device format conversions: every variant against scalar, what each
+// format costs per sample, and whether dither stays within its bounds
+void benchConversion(const BenchContext &ctx)
+{
+    const size_t count = 2048; // a 1024-frame stereo block
+
+    std::vector<const SimdKernels *> variants = availableSimdKernels();
+    for (size_t index = 0; index < conversions().size(); index++)
+    {
+        const Conversion &conversion = conversions()[index];
+        std::string name = std::string(encodingName(conversion.encoding)) + (conversion.toFloat ? "_in" : "_out");
+
+        double scalarSeconds = 0.0;
+        for (const SimdKernels *kernels : variants)
+        {
+            bool identical = matchesScalar(*kernels, conversion);
+            if (!identical)
+            {
+                ctx.failures++;
+                std::cerr << "[Error] " << kernels->name << "/" << name << " differs from scalar\n";
+            }
+
+            // Output is dithered wherever the format allows it
+            std::vector<float> floats(count);
+            fillNoise(floats, 0.9f, 8);
+            Bytes samples = integerInput(4 * count, 9);
+            uint32_t state[kDitherLanes];
+            seedDither(state);
+
+            double seconds = timePerCall([&]
+                                         {
+                switch (index)
+                {
+                case 0: kernels->int16ToFloat(reinterpret_cast<const int16_t *>(samples.data()), floats.data(), count); break;
+                case 1: kernels->int24ToFloat(samples.data(), floats.data(), count); break;
+                case 2: kernels->int32ToFloat(reinterpret_cast<const int32_t *>(samples.data()), floats.data(), count); break;
+                case 3: kernels->floatToInt16(floats.data(), reinterpret_cast<int16_t *>(samples.data()), count, state); break;
+                case 4: kernels->floatToInt24(floats.data(), samples.data(), count, state); break;
+                default: kernels->floatToInt32(floats.data(), reinterpret_cast<int32_t *>(samples.data()), count); break;
+                } },
+                                         ctx.minSeconds);
+            if (kernels == variants.front())
+                scalarSeconds = seconds;
+
+            ctx.reporter->report("conversion", std::string(kernels->name) + "/" + name,
+                                 {{"identical", identical ? 1.0 : 0.0},
+                                  {"samples", static_cast<double>(count)},
+                                  {"ns_per_sample", seconds * 1e9 / count},
+                                  {"speedup", scalarSeconds / seconds}});
+        }
+    }
+
+    for (const SimdKernels *kernels : variants)
+    {
+        if (!roundTrips(*kernels))
+        {
+            ctx.failures++;
+            std::cerr << "[Error] " << kernels->name << " changes 16- or 24-bit samples on a round trip\n";
+        }
+    }
+
+    // Dithered silence: TPDF noise of one LSB either side rounds to -1, 0 or
+    // +1, non-zero a quarter of the time, and averages out to nothing
+    {
+        const size_t n = 1 << 18;
+        std::vector<float> silence(n, 0.0f);
+        std::vector<int16_t> out(n);
+        uint32_t state[kDitherLanes];
+        seedDither(state);
+        simd().floatToInt16(silence.data(), out.data(), n, state);
+
+        double sum = 0.0;
+        size_t nonZero = 0, outside = 0;
+        for (int16_t v : out)
+        {
+            sum += v;
+            nonZero += v != 0;
+            outside += v < -1 || v > 1;
+        }
+        double mean = sum / n, busy = static_cast<double>(nonZero) / n;
+        if (outside != 0 || std::abs(mean) > 0.01 || busy < 0.2 || busy > 0.3)
+        {
+            ctx.failures++;
+            std::cerr << "[Error] Dithered silence has " << outside << " samples past one LSB, mean " << mean
+                      << " and " << busy * 100.0 << "% non-zero\n";
+        }
+        ctx.reporter->report("conversion", "dither_silence",
+                             {{"mean_lsb", mean}, {"nonzero_fraction", busy}, {"beyond_one_lsb", static_cast<double>(outside)}});
+    }
+
+    // A whole stereo period through the converters the backends use, in and
+    // out, for each device format
+    const unsigned long frames = 256;
+    const int channels = 2;
+    for (SampleEncoding encoding : {SampleEncoding::Float32, SampleEncoding::Int32, SampleEncoding::Int24, SampleEncoding::Int16})
+    {
+        SampleConverter input, output;
+        input.prepare(encoding, channels, frames);
+        output.prepare(encoding, channels, frames);
+
+        Bytes device = integerInput(frames * input.frameBytes(), 10), deviceOut(device.size());
+        if (encoding == SampleEncoding::Float32)
+            device = floatInput(frames * channels, 11);
+
+        volatile float sink = 0.0f;
+        double seconds = timePerCall([&]
+                                     {
+            const float *in = input.read(device.data(), frames);
+            float *out = output.target(deviceOut.data());
+            std::memcpy(out, in, frames * channels * sizeof(float));
+            output.write(deviceOut.data(), frames);
+            sink += out[0]; },
+                                     ctx.minSeconds);
+
+        ctx.reporter->report("conversion", std::string("period_") + encodingName(encoding),
+                             {{"frames", static_cast<double>(frames)},
+                              {"channels", static_cast<double>(channels)},
+                              {"ns_per_period", seconds * 1e9},
+                              {"ns_per_sample", seconds * 1e9 / (frames * channels)}});
+    }
+}
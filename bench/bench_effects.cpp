@@ -0,0 +1,197 @@
+#include "bench.h"
+#include "Effects/convolution.h"
+#include "Effects/distortion.h"
+#include "Effects/gain.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace
+{
+    // The pre-block-API gain, for comparing against the per-sample adapter
+    class SampleGain : public SampleEffect {
+    public:
+        using SampleEffect::process;
+
+        float process(float inputSample) override {
+            return std::max(-1.0f, std::min(1.0f, inputSample * 1.0f));
+        }
+    };
+
+    void benchEffect(const BenchContext &ctx, const std::string &name, Effect &effect,
+                     const std::function<void()> &beforeBlock = {}, bool realtime = true)
+    {
+        const unsigned long frames = 256;
+        ProcessSpec spec;
+        spec.sampleRate = ctx.sampleRate;
+        spec.channelCount = 1;
+        spec.maxFrames = frames;
+        spec.realtime = realtime;
+        effect.prepare(spec);
+
+        // Effects work in place, so restore the input every call; otherwise
+        // repeated attenuation decays it into denormals
+        std::vector<float> source(frames);
+        std::vector<float> block(frames);
+        fillNoise(source);
+
+        double seconds = timePerCall([&]
+                                     {
+                                         if (beforeBlock)
+                                             beforeBlock();
+                                         std::copy(source.begin(), source.end(), block.begin());
+                                         effect.beginBlock(frames);
+                                         effect.process(block.data(), frames, 0); },
+                                     ctx.minSeconds);
+
+        ctx.reporter->report("effects", name,
+                             {{"frames", static_cast<double>(frames)},
+                              {"ns_per_sample", seconds * 1e9 / frames},
+                              {"realtime_factor", (frames / ctx.sampleRate) / seconds}});
+    }
+
+    // Decaying noise, like a real cabinet response
+    std::vector<float> makeImpulse(size_t length, double sampleRate)
+    {
+        std::vector<float> ir(length);
+        fillNoise(ir);
+        for (size_t i = 0; i < length; i++)
+            ir[i] *= 0.05f * static_cast<float>(std::exp(-static_cast<double>(i) / (0.1 * sampleRate)));
+        return ir;
+    }
+
+    // Offline convolution against a direct-form reference
+    double convolutionError(const BenchContext &ctx, size_t length)
+    {
+        std::vector<float> ir = makeImpulse(length, ctx.sampleRate);
+        std::vector<float> input(length + 8192);
+        fillNoise(input, 0.5f, 2);
+
+        ConvolutionEffect convolution({ir}, ctx.sampleRate);
+        ProcessSpec spec;
+        spec.sampleRate = ctx.sampleRate;
+        spec.maxFrames = 256;
+        spec.realtime = false;
+        convolution.prepare(spec);
+
+        std::vector<float> output = input;
+        for (size_t start = 0; start < output.size(); start += 256)
+            convolution.process(output.data() + start, std::min<size_t>(256, output.size() - start), 0);
+
+        double worst = 0.0;
+        for (size_t n = 0; n < input.size(); n++)
+        {
+            double want = 0.0;
+            for (size_t k = 0; k < length && k <= n; k++)
+                want += static_cast<double>(ir[k]) * input[n - k];
+            worst = std::max(worst, std::fabs(output[n] - want));
+        }
+        return worst;
+    }
+
+    // A response recorded at 44.1 kHz, played at the stream's rate, against
+    // the same response sampled at the stream's rate directly, relative to
+    // its peak. Samples of a continuous response are scaled by the sample
+    // spacing, so both versions have the same gain.
+    double resampledImpulseError(const BenchContext &ctx)
+    {
+        const double recordedRate = 44100.0;
+        auto response = [](double t, double rate)
+        {
+            // Smooth onset, so the response is band-limited at either rate
+            double envelope = std::exp(-t / 0.01) * (1.0 - std::exp(-t / 0.001));
+            return static_cast<float>(envelope * std::sin(2.0 * 3.14159265358979 * 500.0 * t) * 1000.0 / rate);
+        };
+
+        std::vector<float> recorded(static_cast<size_t>(0.1 * recordedRate));
+        for (size_t i = 0; i < recorded.size(); i++)
+            recorded[i] = response(i / recordedRate, recordedRate);
+
+        ConvolutionEffect convolution({recorded}, recordedRate);
+        ProcessSpec spec;
+        spec.sampleRate = ctx.sampleRate;
+        spec.maxFrames = 256;
+        spec.realtime = false;
+        convolution.prepare(spec);
+
+        // The effect's response to a unit impulse is the response it plays
+        std::vector<float> output(convolution.impulseLength());
+        output[0] = 1.0f;
+        for (size_t start = 0; start < output.size(); start += 256)
+            convolution.process(output.data() + start, std::min<size_t>(256, output.size() - start), 0);
+
+        double worst = 0.0, peak = 0.0;
+        for (size_t n = 0; n < output.size(); n++)
+        {
+            double want = response(n / ctx.sampleRate, ctx.sampleRate);
+            worst = std::max(worst, std::fabs(output[n] - want));
+            peak = std::max(peak, std::fabs(want));
+        }
+        return worst / peak;
+    }
+}
+
+// ===================== Effects =====================
+
+// Cost of each effect on a single channel at a typical block size
+void benchEffects(const BenchContext &ctx)
+{
+    GainEffect gain(1.0f);
+    benchEffect(ctx, "gain", gain);
+
+    // Retarget every block so the gain is always ramping
+    GainEffect ramped(1.0f);
+    bool flip = false;
+    benchEffect(ctx, "gain_ramping", ramped, [&]
+                { ramped.setGain((flip = !flip) ? 0.5f : 1.0f); });
+
+    SampleGain sampleGain;
+    benchEffect(ctx, "gain_per_sample_adapter", sampleGain);
+
+    const std::pair<const char *, DistortionEffect::Mode> modes[] = {
+        {"distortion_softclip", DistortionEffect::Mode::SoftClip},
+        {"distortion_overdrive", DistortionEffect::Mode::Overdrive},
+        {"distortion_tube", DistortionEffect::Mode::Tube},
+        {"distortion_foldback", DistortionEffect::Mode::Foldback}};
+
+    for (const auto &[name, mode] : modes)
+    {
+        // Heavy drive: should cost the same as light drive
+        DistortionEffect distortion(mode, 40.0f, 0.5f);
+        benchEffect(ctx, name, distortion);
+    }
+
+    double error = convolutionError(ctx, 12000);
+    ctx.reporter->report("effects", "convolution_accuracy", {{"taps", 12000.0}, {"max_abs_error", error}});
+    if (error > 1e-4)
+    {
+        ctx.failures++;
+        std::cerr << "[Error] Convolution differs from direct form by " << error << "\n";
+    }
+
+    double resampledError = resampledImpulseError(ctx);
+    ctx.reporter->report("effects", "convolution_resampled", {{"recorded_rate", 44100.0}, {"max_rel_error", resampledError}});
+    if (resampledError > 1e-3)
+    {
+        ctx.failures++;
+        std::cerr << "[Error] A resampled impulse response differs from one recorded at the stream rate by "
+                  << resampledError * 100.0 << "% of its peak\n";
+    }
+
+    // Callback cost should stay flat as the response grows; the tail runs on
+    // the background thread. The offline runs include the tail in line.
+    for (double seconds : {0.1, 1.0, 5.0})
+    {
+        size_t length = static_cast<size_t>(seconds * ctx.sampleRate);
+        std::string suffix = std::to_string(static_cast<int>(seconds * 1000)) + "ms";
+
+        ConvolutionEffect live({makeImpulse(length, ctx.sampleRate)}, ctx.sampleRate);
+        benchEffect(ctx, "convolution_" + suffix, live);
+
+        ConvolutionEffect offline({makeImpulse(length, ctx.sampleRate)}, ctx.sampleRate);
+        benchEffect(ctx, "convolution_" + suffix + "_offline", offline, {}, false);
+    }
+}
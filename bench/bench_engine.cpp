@@ -0,0 +1,421 @@
+#include "bench.h"
+#include "audioengine.h"
+#include "realtime.h"
+#include "Effects/convolution.h"
+#include "Effects/distortion.h"
+#include "Effects/gain.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+// ===================== Engine =====================
+
+// Full AudioEngine::process cost across buffer sizes, channel counts and chain lengths
+void benchEngine(const BenchContext &ctx)
+{
+    const unsigned long bufferSizes[] = {32, 64, 128, 256, 512, 1024, 2048, 4096};
+    const int channelCounts[] = {1, 2, 4, 8, 16, 32};
+    const int chainLengths[] = {0, 1, 2, 4, 6};
+
+    for (int chainLength : chainLengths)
+    {
+        for (int channels : channelCounts)
+        {
+            AudioEngine engine;
+            for (int i = 0; i < chainLength; i++)
+                engine.addEffect(std::make_shared<GainEffect>(1.0f));
+
+            for (unsigned long frames : bufferSizes)
+            {
+                engine.prepare(ctx.sampleRate, channels, channels, frames);
+
+                std::vector<float> input(frames * channels);
+                std::vector<float> output(input.size());
+                fillNoise(input);
+
+                double seconds = timePerCall([&]
+                                             { engine.process(input.data(), output.data(), frames); },
+                                             ctx.minSeconds);
+
+                double nsPerSample = seconds * 1e9 / (frames * channels);
+                double realtimeFactor = (frames / ctx.sampleRate) / seconds;
+
+                ctx.reporter->report("engine", "process",
+                                     {{"frames", static_cast<double>(frames)},
+                                      {"channels", static_cast<double>(channels)},
+                                      {"chain", static_cast<double>(chainLength)},
+                                      {"ns_per_sample", nsPerSample},
+                                      {"realtime_factor", realtimeFactor}});
+            }
+        }
+    }
+}
+
+// ===================== Parallel =====================
+
+// Scaling of a CPU-heavy chain on a 32-channel rig as workers are added. On
+// machines with fewer cores than workers the pool falls back to serial
+// processing, which shows up in missed_slots and fallbacks.
+void benchParallel(const BenchContext &ctx)
+{
+    const unsigned long frames = 256;
+    const int channels = 32;
+    const int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    std::vector<float> input(frames * channels);
+    std::vector<float> output(input.size());
+    fillNoise(input);
+
+    double serialSeconds = 0.0;
+    for (int workers = 0; workers <= std::max(cores - 1, 1); workers = workers ? workers * 2 : 1)
+    {
+        AudioEngine engine;
+        for (int i = 0; i < 4; i++)
+            engine.addEffect(std::make_shared<DistortionEffect>(DistortionEffect::Mode::Tube, 8.0f, 0.5f));
+        engine.prepare(ctx.sampleRate, channels, channels, frames);
+        engine.setWorkerThreads(workers);
+
+        double seconds = timePerCall([&]
+                                     { engine.process(input.data(), output.data(), frames); },
+                                     ctx.minSeconds);
+        if (workers == 0)
+            serialSeconds = seconds;
+
+        const WorkerPool *pool = engine.getWorkerPool();
+        ctx.reporter->report("parallel", "process",
+                             {{"workers", static_cast<double>(workers)},
+                              {"channels", static_cast<double>(channels)},
+                              {"ns_per_sample", seconds * 1e9 / (frames * channels)},
+                              {"speedup", serialSeconds / seconds},
+                              {"missed_slots", pool ? static_cast<double>(pool->missedSlots()) : 0.0},
+                              {"fallbacks", pool ? static_cast<double>(pool->fallbacks()) : 0.0}});
+    }
+}
+
+// ===================== Idle Bypass =====================
+
+namespace
+{
+    // Gain, tube drive (whose DC blocker rings) and a half-second decaying
+    // cabinet response: a chain with a long tail
+    void addRingingChain(AudioEngine &engine, double sampleRate)
+    {
+        std::vector<float> ir(static_cast<size_t>(sampleRate / 2));
+        fillNoise(ir, 0.5f, 3);
+        for (size_t i = 0; i < ir.size(); i++)
+            ir[i] *= static_cast<float>(std::exp(-8.0 * i / ir.size()));
+
+        engine.addEffect(std::make_shared<GainEffect>(2.0f));
+        engine.addEffect(std::make_shared<DistortionEffect>(DistortionEffect::Mode::Tube, 4.0f, 0.5f));
+        engine.addEffect(std::make_shared<ConvolutionEffect>(std::vector<std::vector<float>>{ir}, sampleRate));
+    }
+}
+
+// Checks that bypassing an idle chain never cuts off its tail, then
+// compares the cost of a silent block with and without the bypass
+void benchIdle(const BenchContext &ctx)
+{
+    const unsigned long frames = 256;
+    const int channels = 2;
+
+    // A burst, two seconds of digital silence, another burst: the bypassed
+    // output must match the processed one to within the tails' residue
+    const size_t burst = static_cast<size_t>(ctx.sampleRate / 4) / frames;
+    const size_t gap = static_cast<size_t>(ctx.sampleRate * 2) / frames;
+    std::vector<float> noise(frames * channels), silence(frames * channels, 0.0f);
+    std::vector<float> reference(frames * channels), output(frames * channels);
+
+    AudioEngine plain, idle;
+    addRingingChain(plain, ctx.sampleRate);
+    addRingingChain(idle, ctx.sampleRate);
+    plain.prepare(ctx.sampleRate, channels, channels, frames, false);
+    idle.prepare(ctx.sampleRate, channels, channels, frames, false);
+    AudioEngine::IdleOptions options;
+    options.enabled = true;
+    idle.setIdleOptions(options);
+
+    float maxError = 0.0f;
+    for (size_t block = 0; block < 2 * burst + gap; block++)
+    {
+        bool loud = block < burst || block >= burst + gap;
+        if (loud)
+            fillNoise(noise, 0.5f, static_cast<uint32_t>(block + 1));
+        const std::vector<float> &input = loud ? noise : silence;
+
+        plain.process(input.data(), reference.data(), frames);
+        idle.process(input.data(), output.data(), frames);
+        for (size_t i = 0; i < output.size(); i++)
+            maxError = std::max(maxError, std::abs(output[i] - reference[i]));
+    }
+
+    uint64_t bypassed = idle.idleBlocks();
+    if (maxError > 1e-5f || bypassed == 0)
+    {
+        ctx.failures++;
+        std::cerr << "[Error] Idle bypass changed the output (max error " << maxError << ", "
+                  << bypassed << " blocks bypassed)\n";
+    }
+
+    // Cost of a silent block once the tails have played out
+    double seconds[2];
+    for (int enabled = 0; enabled < 2; enabled++)
+    {
+        AudioEngine engine;
+        addRingingChain(engine, ctx.sampleRate);
+        engine.prepare(ctx.sampleRate, channels, channels, frames, false);
+        options.enabled = enabled != 0;
+        engine.setIdleOptions(options);
+
+        seconds[enabled] = timePerCall([&]
+                                       { engine.process(silence.data(), output.data(), frames); },
+                                       ctx.minSeconds);
+    }
+
+    ctx.reporter->report("idle", "silent_block",
+                         {{"frames", static_cast<double>(frames)},
+                          {"channels", static_cast<double>(channels)},
+                          {"max_error", maxError},
+                          {"bypassed_blocks", static_cast<double>(bypassed)},
+                          {"active_ns_per_block", seconds[0] * 1e9},
+                          {"idle_ns_per_block", seconds[1] * 1e9},
+                          {"speedup", seconds[0] / seconds[1]}});
+}
+
+// ===================== Denormals =====================
+
+// Cost of the silence after a note: the tube DC blocker decays until it
+// sits on the smallest denormal, which then runs through the cabinet. The
+// audio thread flushes denormals to zero on its first callback; this
+// compares a silent block with and without that.
+void benchDenormal(const BenchContext &ctx)
+{
+    const unsigned long frames = 256;
+    const int channels = 2;
+    const bool previous = flushesDenormals();
+
+    std::vector<float> noise(frames * channels), silence(frames * channels, 0.0f);
+    std::vector<float> output(frames * channels);
+    fillNoise(noise);
+
+    // Enough silence for the blocker state to decay from full scale into
+    // the denormal range
+    const size_t primeBlocks = static_cast<size_t>(ctx.sampleRate / 4) / frames;
+    const size_t decayBlocks = static_cast<size_t>(ctx.sampleRate * 3) / frames;
+
+    double seconds[2];
+    size_t denormals[2];
+    for (int flush = 0; flush < 2; flush++)
+    {
+        if (!setFlushDenormals(flush != 0))
+        {
+            std::cerr << "[Warning] Denormal flushing is not supported on this CPU; skipping\n";
+            return;
+        }
+
+        AudioEngine engine;
+        addRingingChain(engine, ctx.sampleRate);
+        engine.prepare(ctx.sampleRate, channels, channels, frames, false);
+        for (size_t block = 0; block < primeBlocks; block++)
+            engine.process(noise.data(), output.data(), frames);
+        for (size_t block = 0; block < decayBlocks; block++)
+            engine.process(silence.data(), output.data(), frames);
+
+        seconds[flush] = timePerCall([&]
+                                     { engine.process(silence.data(), output.data(), frames); },
+                                     ctx.minSeconds);
+
+        denormals[flush] = static_cast<size_t>(std::count_if(output.begin(), output.end(), [](float x)
+                                                             { return std::fpclassify(x) == FP_SUBNORMAL; }));
+    }
+
+    setFlushDenormals(previous);
+
+    if (denormals[1] > 0)
+    {
+        ctx.failures++;
+        std::cerr << "[Error] Denormals reached the output with flushing enabled\n";
+    }
+
+    ctx.reporter->report("denormal", "silent_tail",
+                         {{"frames", static_cast<double>(frames)},
+                          {"channels", static_cast<double>(channels)},
+                          {"denormal_samples", static_cast<double>(denormals[0])},
+                          {"plain_ns_per_sample", seconds[0] * 1e9 / (frames * channels)},
+                          {"ftz_ns_per_sample", seconds[1] * 1e9 / (frames * channels)},
+                          {"speedup", seconds[0] / seconds[1]}});
+}
+
+// ===================== Scheduled Events =====================
+
+// Checks that events land on their exact frame and that splitting blocks
+// at events leaves the output untouched, then times a block with four
+// events against one without
+void benchEvents(const BenchContext &ctx)
+{
+    const unsigned long frames = 256;
+    const int channels = 2;
+    const size_t blocks = static_cast<size_t>(ctx.sampleRate / 2) / frames;
+    std::vector<float> input(frames * channels), reference(input.size()), output(input.size());
+
+    // Gain alone, with its input low enough never to clip: bypassed frames
+    // are the input, the rest exactly twice it
+    const uint64_t bypassFrom = 1001, bypassTo = 7777;
+    AudioEngine placed;
+    auto gain = std::make_shared<GainEffect>(2.0f);
+    placed.addEffect(gain);
+    placed.prepare(ctx.sampleRate, channels, channels, frames, false);
+    ControlEvent bypass[2];
+    bypass[0].frame = bypassFrom;
+    bypass[1].frame = bypassTo;
+    for (ControlEvent &event : bypass)
+    {
+        event.effect = gain->id();
+        event.type = ControlEvent::Type::Bypass;
+    }
+    bypass[0].value = 1.0f;
+    placed.schedule(bypass, 2);
+
+    size_t misplaced = 0;
+    for (size_t block = 0; block < blocks; block++)
+    {
+        fillNoise(input, 0.25f, static_cast<uint32_t>(block + 1));
+        placed.process(input.data(), output.data(), frames);
+        for (size_t i = 0; i < output.size(); i++)
+        {
+            uint64_t frame = block * frames + i / channels;
+            float expected = frame >= bypassFrom && frame < bypassTo ? input[i] : 2.0f * input[i];
+            misplaced += output[i] != expected;
+        }
+    }
+
+    // Events that change nothing, every 37 frames, split every block
+    AudioEngine plain, split;
+    addRingingChain(plain, ctx.sampleRate);
+    addRingingChain(split, ctx.sampleRate);
+    plain.prepare(ctx.sampleRate, channels, channels, frames, false);
+    split.prepare(ctx.sampleRate, channels, channels, frames, false);
+    ControlEvent noop;
+    noop.effect = split.getEffects()[0]->id();
+    noop.value = 2.0f;
+
+    float maxError = 0.0f;
+    uint64_t nextEvent = 0;
+    for (size_t block = 0; block < blocks; block++)
+    {
+        for (; nextEvent < (block + 1) * frames; nextEvent += 37)
+        {
+            noop.frame = nextEvent;
+            split.schedule(&noop, 1);
+        }
+
+        fillNoise(input, 0.5f, static_cast<uint32_t>(block + 1));
+        plain.process(input.data(), reference.data(), frames);
+        split.process(input.data(), output.data(), frames);
+        for (size_t i = 0; i < output.size(); i++)
+            maxError = std::max(maxError, std::abs(output[i] - reference[i]));
+    }
+
+    if (misplaced > 0 || maxError > 0.0f)
+    {
+        ctx.failures++;
+        std::cerr << "[Error] Scheduled events landed on the wrong frames (" << misplaced
+                  << " samples) or changed the output (max error " << maxError << ")\n";
+    }
+
+    // An event for an effect freed before it was due must not reach the one
+    // replacing it, even if the new effect took over the old one's memory
+    {
+        AudioEngine swapped;
+        swapped.addEffect(std::make_shared<GainEffect>(2.0f));
+        swapped.prepare(ctx.sampleRate, channels, channels, frames, false);
+        ControlEvent stale;
+        stale.effect = swapped.getEffects()[0]->id();
+        stale.type = ControlEvent::Type::Bypass;
+        stale.value = 1.0f;
+        swapped.schedule(&stale, 1);
+        swapped.replaceEffect(0, std::make_shared<GainEffect>(2.0f));
+        swapped.collect();
+
+        fillNoise(input, 0.25f);
+        swapped.process(input.data(), output.data(), frames);
+        if (swapped.getEffects()[0]->isBypassed())
+        {
+            ctx.failures++;
+            std::cerr << "[Error] An event for a removed effect reached its replacement\n";
+        }
+    }
+
+    // A batch that does not fit next to the pending events waits whole, and
+    // arrives in frame order with same-frame events in the order pushed
+    {
+        EventQueue queue;
+        std::vector<ControlEvent> later(EventQueue::kCapacity - 8), batch(16);
+        for (ControlEvent &event : later)
+            event.frame = 1000;
+        for (size_t i = 0; i < batch.size(); i++)
+        {
+            batch[i].frame = 500 - i / 2 * 10;
+            batch[i].parameter = static_cast<int>(i);
+        }
+        queue.push(later.data(), later.size());
+        queue.receive();
+        queue.push(batch.data(), batch.size());
+        queue.receive();
+
+        uint64_t next = 0;
+        bool whole = queue.nextFrame(next) && next == 1000;
+        ControlEvent event;
+        while (queue.pop(1000, event))
+        {
+        }
+        queue.receive();
+
+        bool ordered = true;
+        for (size_t i = 0; i < batch.size(); i++)
+        {
+            size_t expected = (batch.size() - 2 - i / 2 * 2) + i % 2;
+            ordered = ordered && queue.pop(1000, event) && event.parameter == static_cast<int>(expected);
+        }
+
+        if (!whole || !ordered)
+        {
+            ctx.failures++;
+            std::cerr << "[Error] The event queue split a batch or took it out of frame order\n";
+        }
+    }
+
+    // Four events per block: the block runs as four shorter ones
+    double seconds[2];
+    for (int withEvents = 0; withEvents < 2; withEvents++)
+    {
+        AudioEngine engine;
+        addRingingChain(engine, ctx.sampleRate);
+        engine.prepare(ctx.sampleRate, channels, channels, frames, false);
+        noop.effect = engine.getEffects()[0]->id();
+        fillNoise(input, 0.5f);
+
+        seconds[withEvents] = timePerCall([&]
+                                          {
+                                              if (withEvents)
+                                              {
+                                                  ControlEvent events[4] = {noop, noop, noop, noop};
+                                                  for (int e = 0; e < 4; e++)
+                                                      events[e].frame = engine.streamFrame() + e * frames / 4;
+                                                  engine.schedule(events, 4);
+                                              }
+                                              engine.process(input.data(), output.data(), frames); },
+                                          ctx.minSeconds);
+    }
+
+    ctx.reporter->report("events", "split_block",
+                         {{"frames", static_cast<double>(frames)},
+                          {"channels", static_cast<double>(channels)},
+                          {"misplaced_samples", static_cast<double>(misplaced)},
+                          {"max_error", maxError},
+                          {"plain_ns_per_block", seconds[0] * 1e9},
+                          {"events_ns_per_block", seconds[1] * 1e9},
+                          {"overhead", seconds[1] / seconds[0]}});
+}
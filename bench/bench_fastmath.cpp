@@ -0,0 +1,72 @@
+#include "bench.h"
+#include "fastmath.h"
+#include <cmath>
+#include <string>
+
+namespace
+{
+    // Dense sweep of [lo, hi] comparing against libm in double precision
+    template <typename Fast, typename Exact>
+    double maxError(Fast fast, Exact exact, float lo, float hi, bool relative)
+    {
+        double worst = 0.0;
+        const int steps = 2000000;
+        for (int i = 0; i <= steps; i++)
+        {
+            float x = lo + (hi - lo) * static_cast<float>(i) / steps;
+            double want = exact(static_cast<double>(x));
+            double err = std::fabs(static_cast<double>(fast(x)) - want);
+            if (relative)
+                err /= std::fabs(want);
+            worst = std::max(worst, err);
+        }
+        return worst;
+    }
+
+    template <typename Body>
+    double nsPerSample(const BenchContext &ctx, std::vector<float> &block, Body body)
+    {
+        std::vector<float> source = block;
+        double seconds = timePerCall([&]
+                                     {
+                                         std::copy(source.begin(), source.end(), block.begin());
+                                         body(block.data(), block.size()); },
+                                     ctx.minSeconds);
+        return seconds * 1e9 / block.size();
+    }
+}
+
+// ===================== Fast Math =====================
+
+// Accuracy and speed of the waveshaping approximations against libm
+void benchFastmath(const BenchContext &ctx)
+{
+    std::vector<float> block(1024);
+    fillNoise(block, 4.0f);
+
+    auto libmTanh = [](float *x, size_t n)
+    { for (size_t i = 0; i < n; i++) x[i] = std::tanh(x[i]); };
+    auto libmAtan = [](float *x, size_t n)
+    { for (size_t i = 0; i < n; i++) x[i] = std::atan(x[i]); };
+    auto libmExp = [](float *x, size_t n)
+    { for (size_t i = 0; i < n; i++) x[i] = std::exp(x[i]); };
+
+    double tanhErr = maxError([](float x) { return fastmath::tanh(x); },
+                              [](double x) { return std::tanh(x); }, -20.0f, 20.0f, false);
+    double atanErr = maxError([](float x) { return fastmath::atan(x); },
+                              [](double x) { return std::atan(x); }, -100.0f, 100.0f, false);
+    double expErr = maxError([](float x) { return fastmath::exp(x); },
+                             [](double x) { return std::exp(x); }, -87.0f, 88.0f, true);
+
+    double fast = nsPerSample(ctx, block, fastmath::tanhBlock);
+    double libm = nsPerSample(ctx, block, libmTanh);
+    ctx.reporter->report("fastmath", "tanh", {{"max_abs_error", tanhErr}, {"ns_per_sample", fast}, {"libm_ns_per_sample", libm}, {"speedup", libm / fast}});
+
+    fast = nsPerSample(ctx, block, fastmath::atanBlock);
+    libm = nsPerSample(ctx, block, libmAtan);
+    ctx.reporter->report("fastmath", "atan", {{"max_abs_error", atanErr}, {"ns_per_sample", fast}, {"libm_ns_per_sample", libm}, {"speedup", libm / fast}});
+
+    fast = nsPerSample(ctx, block, fastmath::expBlock);
+    libm = nsPerSample(ctx, block, libmExp);
+    ctx.reporter->report("fastmath", "exp", {{"max_rel_error", expErr}, {"ns_per_sample", fast}, {"libm_ns_per_sample", libm}, {"speedup", libm / fast}});
+}
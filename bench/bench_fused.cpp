@@ -0,0 +1,127 @@
+#include "bench.h"
+#include "audioengine.h"
+#include "Effects/convolution.h"
+#include "Effects/distortion.h"
+#include "Effects/gain.h"
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace
+{
+    struct Preset
+    {
+        const char *name;
+        DistortionEffect::Mode mode;
+        bool cabinet;
+    };
+
+    // Gain -> drive (-> cab) with fresh effects, so two engines never share state
+    void buildPreset(AudioEngine &engine, const Preset &preset, double sampleRate,
+                     std::shared_ptr<GainEffect> &gain)
+    {
+        gain = std::make_shared<GainEffect>(2.0f);
+        engine.addEffect(gain);
+        engine.addEffect(std::make_shared<DistortionEffect>(preset.mode, 8.0f, 0.5f));
+
+        if (preset.cabinet)
+        {
+            // Short response: the head FIR and a few body partitions, no tail
+            std::vector<float> ir(512);
+            fillNoise(ir, 0.5f, 3);
+            for (size_t i = 0; i < ir.size(); i++)
+                ir[i] *= 0.05f * static_cast<float>(std::exp(-static_cast<double>(i) / 100.0));
+            engine.addEffect(std::make_shared<ConvolutionEffect>(std::vector<std::vector<float>>{ir}, sampleRate));
+        }
+    }
+
+    // Fused and dynamic chains must agree to the bit, including while the
+    // gain is ramping, so switching between them can never be heard
+    bool fusedMatchesDynamic(const BenchContext &ctx, const Preset &preset)
+    {
+        const unsigned long frames = 256;
+        const int channels = 2;
+
+        AudioEngine dynamic, fused;
+        std::shared_ptr<GainEffect> dynamicGain, fusedGain;
+        buildPreset(dynamic, preset, ctx.sampleRate, dynamicGain);
+        buildPreset(fused, preset, ctx.sampleRate, fusedGain);
+        dynamic.setChainFusion(false);
+        dynamic.prepare(ctx.sampleRate, channels, channels, frames, false);
+        fused.prepare(ctx.sampleRate, channels, channels, frames, false);
+
+        std::vector<float> input(frames * channels);
+        std::vector<float> a(input.size()), b(input.size());
+
+        for (int block = 0; block < 64; block++)
+        {
+            if (block % 16 == 4)
+            {
+                dynamicGain->setGain(block % 32 == 4 ? 0.5f : 3.0f);
+                fusedGain->setGain(block % 32 == 4 ? 0.5f : 3.0f);
+            }
+
+            fillNoise(input, 0.8f, static_cast<uint32_t>(block + 1));
+            dynamic.process(input.data(), a.data(), frames);
+            fused.process(input.data(), b.data(), frames);
+            if (std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) != 0)
+                return false;
+        }
+
+        return true;
+    }
+}
+
+// ===================== Fused Chains =====================
+
+// Standard presets run through the dynamic chain (one virtual call and one
+// pass over the block per effect) against their StaticChain specialization
+void benchFused(const BenchContext &ctx)
+{
+    const Preset presets[] = {
+        {"gain_softclip", DistortionEffect::Mode::SoftClip, false},
+        {"gain_overdrive", DistortionEffect::Mode::Overdrive, false},
+        {"gain_tube", DistortionEffect::Mode::Tube, false},
+        {"gain_foldback", DistortionEffect::Mode::Foldback, false},
+        {"gain_softclip_cab", DistortionEffect::Mode::SoftClip, true},
+        {"gain_tube_cab", DistortionEffect::Mode::Tube, true}};
+
+    const unsigned long frames = 256;
+    const int channels = 2;
+
+    for (const Preset &preset : presets)
+    {
+        if (!fusedMatchesDynamic(ctx, preset))
+        {
+            ctx.failures++;
+            std::cerr << "[Error] Fused " << preset.name << " chain differs from the dynamic chain\n";
+        }
+
+        std::vector<float> input(frames * channels);
+        std::vector<float> output(input.size());
+        fillNoise(input);
+
+        double seconds[2] = {};
+        for (int fuse = 0; fuse < 2; fuse++)
+        {
+            AudioEngine engine;
+            std::shared_ptr<GainEffect> gain;
+            buildPreset(engine, preset, ctx.sampleRate, gain);
+            engine.setChainFusion(fuse != 0);
+            engine.prepare(ctx.sampleRate, channels, channels, frames);
+
+            seconds[fuse] = timePerCall([&]
+                                        { engine.process(input.data(), output.data(), frames); },
+                                        ctx.minSeconds);
+        }
+
+        ctx.reporter->report("fused", preset.name,
+                             {{"frames", static_cast<double>(frames)},
+                              {"channels", static_cast<double>(channels)},
+                              {"dynamic_ns_per_sample", seconds[0] * 1e9 / (frames * channels)},
+                              {"fused_ns_per_sample", seconds[1] * 1e9 / (frames * channels)},
+                              {"speedup", seconds[0] / seconds[1]}});
+    }
+}
@@ -0,0 +1,127 @@
+#include "bench.h"
+#include "recorder.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+namespace
+{
+    // Reads a whole recorded file back; empty on error
+    std::vector<float> readBack(const std::string &path, int &channels)
+    {
+        AudioFileReader reader;
+        std::vector<float> samples;
+        if (!reader.openWav(path))
+            return samples;
+
+        channels = reader.format().channels;
+        std::vector<float> chunk(4096 * static_cast<size_t>(channels));
+        unsigned long frames;
+        while ((frames = reader.read(chunk.data(), 4096)) > 0)
+            samples.insert(samples.end(), chunk.begin(), chunk.begin() + frames * channels);
+        return samples;
+    }
+
+    struct Session
+    {
+        uint64_t pushedFrames = 0;
+        double pushSeconds = 0.0; // audio-thread time over all pushes
+        SessionRecorder::Status status;
+    };
+
+    // Pushes seconds of noise as the dry signal and its negation as the wet
+    // one, as fast as the loop runs, then stops the recorder
+    Session record(const BenchContext &ctx, const std::string &base, double seconds, double bufferSeconds)
+    {
+        const unsigned long frames = 256;
+        const int channels = 2;
+
+        SessionRecorder recorder;
+        SessionRecorder::Options options;
+        options.bufferSeconds = bufferSeconds;
+        Session session;
+        if (!recorder.start(base, ctx.sampleRate, channels, channels, options))
+            return session;
+
+        std::vector<float> dry(frames * channels), wet(dry.size());
+        const size_t blocks = static_cast<size_t>(seconds * ctx.sampleRate) / frames;
+        for (size_t b = 0; b < blocks; b++)
+        {
+            fillNoise(dry, 0.5f, static_cast<uint32_t>(b + 1));
+            for (size_t i = 0; i < dry.size(); i++)
+                wet[i] = -dry[i];
+
+            auto start = std::chrono::steady_clock::now();
+            recorder.push(dry.data(), wet.data(), frames);
+            session.pushSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            session.pushedFrames += frames;
+        }
+
+        session.status = recorder.status();
+        if (!recorder.stop())
+            session.status.writeFailed = true;
+        return session;
+    }
+
+    // Both files must cover every pushed frame, dropped ones as silence in
+    // both, so wet stays the negated dry sample for sample
+    bool checkFiles(const Session &session, const std::string &base)
+    {
+        int dryChannels = 0, wetChannels = 0;
+        std::vector<float> dry = readBack(base + "-dry.wav", dryChannels);
+        std::vector<float> wet = readBack(base + "-wet.wav", wetChannels);
+        std::remove((base + "-dry.wav").c_str());
+        std::remove((base + "-wet.wav").c_str());
+
+        if (session.status.writeFailed || dryChannels != 2 || wetChannels != 2 ||
+            dry.size() != session.pushedFrames * 2 || wet.size() != dry.size())
+            return false;
+        for (size_t i = 0; i < dry.size(); i++)
+        {
+            if (wet[i] != -dry[i])
+                return false;
+        }
+        return true;
+    }
+}
+
+// ===================== Recorder =====================
+
+// Audio-thread cost of recording a block, and whether the files stay
+// complete and in sync: once with a ring that never fills, once with one
+// far too small for the data pushed at it, which has to drop
+void benchRecorder(const BenchContext &ctx)
+{
+    const std::string base = (std::filesystem::temp_directory_path() / "amply_bench_recording").string();
+
+    struct Case
+    {
+        const char *name;
+        double seconds;
+        double bufferSeconds;
+        bool expectDrops;
+    };
+    const Case cases[] = {{"sustained", 2.0, 4.0, false}, {"overrun", 10.0, 0.1, true}};
+
+    for (const Case &c : cases)
+    {
+        Session session = record(ctx, base, c.seconds, c.bufferSeconds);
+        bool dropped = session.status.droppedBlocks > 0;
+        if (!checkFiles(session, base) || dropped != c.expectDrops)
+        {
+            ctx.failures++;
+            std::cerr << "[Error] Recording '" << c.name << "' is incomplete or out of sync ("
+                      << session.status.droppedBlocks << " block(s) dropped)\n";
+        }
+
+        const double blocks = session.pushedFrames / 256.0;
+        ctx.reporter->report("recorder", c.name,
+                             {{"seconds", c.seconds},
+                              {"buffer_mb", session.status.bufferBytes / (1024.0 * 1024.0)},
+                              {"ns_per_block", blocks > 0 ? session.pushSeconds * 1e9 / blocks : 0.0},
+                              {"dropped_blocks", static_cast<double>(session.status.droppedBlocks)},
+                              {"peak_fill", session.status.peakFill}});
+    }
+}
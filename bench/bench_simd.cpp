@@ -0,0 +1,191 @@
+#include "bench.h"
+#include "simd.h"
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <string>
+
+namespace
+{
+    // Noise with the awkward values mixed in: NaN, infinities, signed zero, denormals
+    std::vector<float> makeInput(size_t count, uint32_t seed)
+    {
+        std::vector<float> data(count);
+        fillNoise(data, 2.0f, seed);
+
+        const float specials[] = {
+            std::numeric_limits<float>::quiet_NaN(),
+            std::numeric_limits<float>::infinity(),
+            -std::numeric_limits<float>::infinity(),
+            -0.0f,
+            std::numeric_limits<float>::denorm_min(),
+            1.0f, -1.0f};
+        for (size_t i = 0; i < count; i += 7)
+            data[i] = specials[(i / 7) % 7];
+
+        return data;
+    }
+
+    bool sameBits(const std::vector<float> &a, const std::vector<float> &b)
+    {
+        return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+    }
+
+    // Runs op on a fresh copy of the inputs for every length up to 67 plus a
+    // large block, and compares the result with the scalar kernels
+    using KernelOp = std::function<std::vector<float>(const SimdKernels &, size_t)>;
+
+    bool matchesScalar(const SimdKernels &kernels, const KernelOp &op)
+    {
+        const SimdKernels &reference = *scalarKernels();
+        for (size_t n = 0; n <= 67; n++)
+        {
+            if (!sameBits(op(kernels, n), op(reference, n)))
+                return false;
+        }
+        return sameBits(op(kernels, 4099), op(reference, 4099));
+    }
+}
+
+// ===================== SIMD Kernels =====================
+
+// Verifies every compiled-in kernel variant against scalar, then times it
+void benchSimd(const BenchContext &ctx)
+{
+    std::cerr << "[Info] Selected SIMD kernels: " << simd().name << "\n";
+
+    const std::vector<std::pair<std::string, KernelOp>> ops = {
+        {"multiply", [](const SimdKernels &k, size_t n)
+         {
+             auto data = makeInput(n, 1);
+             k.multiply(data.data(), 0.7f, n);
+             return data;
+         }},
+        {"multiply_ramp", [](const SimdKernels &k, size_t n)
+         {
+             auto data = makeInput(n, 2), ramp = makeInput(n, 3);
+             k.multiplyRamp(data.data(), ramp.data(), n);
+             return data;
+         }},
+        {"clamp", [](const SimdKernels &k, size_t n)
+         {
+             auto data = makeInput(n, 4);
+             k.clamp(data.data(), -1.0f, 1.0f, n);
+             return data;
+         }},
+        {"mix", [](const SimdKernels &k, size_t n)
+         {
+             auto dst = makeInput(n, 5), src = makeInput(n, 6);
+             k.mix(dst.data(), src.data(), 0.3f, n);
+             return dst;
+         }},
+        {"dot", [](const SimdKernels &k, size_t n)
+         {
+             // Finite inputs only: a single NaN would hide any difference
+             std::vector<float> a(n), b(n);
+             fillNoise(a, 2.0f, 10);
+             fillNoise(b, 2.0f, 11);
+             return std::vector<float>{k.dot(a.data(), b.data(), n)};
+         }},
+        {"peak", [](const SimdKernels &k, size_t n)
+         {
+             // NaN but no infinities: an infinite peak would hide any difference
+             std::vector<float> data(n);
+             fillNoise(data, 2.0f, 12);
+             for (size_t i = 3; i < n; i += 11)
+                 data[i] = std::numeric_limits<float>::quiet_NaN();
+             return std::vector<float>{k.peak(data.data(), n)};
+         }},
+        {"matrix_columns", [](const SimdKernels &k, size_t n)
+         {
+             // n hidden columns after a few input ones, up to seven lines of rows
+             const size_t stride = kColumnLanes * (1 + n % 7), aCount = n % 3;
+             std::vector<float> w((aCount + n) * stride), bias(stride), a(aCount), b(n), acc(stride);
+             fillNoise(w, 2.0f, 13);
+             fillNoise(bias, 2.0f, 14);
+             fillNoise(a, 2.0f, 15);
+             fillNoise(b, 2.0f, 16);
+             k.matrixColumns(acc.data(), bias.data(), w.data(), stride, a.data(), aCount, b.data(), n);
+             return acc;
+         }},
+        {"deinterleave_stereo", [](const SimdKernels &k, size_t n)
+         {
+             auto in = makeInput(2 * n, 7);
+             std::vector<float> out(2 * n);
+             float *planes[] = {out.data(), out.data() + n};
+             k.deinterleave(in.data(), 2, planes, 2, n);
+             return out;
+         }},
+        {"interleave_stereo", [](const SimdKernels &k, size_t n)
+         {
+             auto in = makeInput(2 * n, 8);
+             std::vector<float> out(2 * n);
+             const float *planes[] = {in.data(), in.data() + n};
+             k.interleave(planes, 2, out.data(), 2, n);
+             return out;
+         }},
+        {"deinterleave_5ch", [](const SimdKernels &k, size_t n)
+         {
+             auto in = makeInput(5 * n, 9);
+             std::vector<float> out(5 * n);
+             float *planes[5];
+             for (int ch = 0; ch < 5; ch++)
+                 planes[ch] = out.data() + ch * n;
+             k.deinterleave(in.data(), 5, planes, 5, n);
+             return out;
+         }},
+    };
+
+    const size_t frames = 1024;
+
+    for (const SimdKernels *kernels : availableSimdKernels())
+    {
+        for (size_t index = 0; index < ops.size(); index++)
+        {
+            const auto &[opName, op] = ops[index];
+            bool identical = matchesScalar(*kernels, op);
+            if (!identical)
+            {
+                ctx.failures++;
+                std::cerr << "[Error] " << kernels->name << "/" << opName << " differs from scalar\n";
+            }
+
+            // Time the kernel alone on buffers that stay in cache
+            std::vector<float> a(2 * frames), b(2 * frames), c(2 * frames);
+            fillNoise(a, 0.5f, 1);
+            fillNoise(b, 0.5f, 2);
+            float *planes[] = {c.data(), c.data() + frames};
+            const float *constPlanes[] = {b.data(), b.data() + frames};
+
+            float *fivePlanes[5];
+            for (int ch = 0; ch < 5; ch++)
+                fivePlanes[ch] = c.data() + ch * (frames / 5);
+
+            // Same order as ops
+            volatile float sink = 0.0f;
+            double seconds = timePerCall([&]
+                                         {
+                switch (index)
+                {
+                case 0: kernels->multiply(a.data(), 1.0f, frames); break;
+                case 1: kernels->multiplyRamp(a.data(), b.data(), frames); break;
+                case 2: kernels->clamp(a.data(), -1.0f, 1.0f, frames); break;
+                case 3: kernels->mix(a.data(), b.data(), 0.0f, frames); break;
+                case 4: sink += kernels->dot(a.data(), b.data(), frames); break;
+                case 5: sink += kernels->peak(a.data(), frames); break;
+                case 6: kernels->matrixColumns(c.data(), b.data(), a.data(), 64, b.data(), 0, b.data() + 64, frames / 64); break;
+                case 7: kernels->deinterleave(a.data(), 2, planes, 2, frames); break;
+                case 8: kernels->interleave(constPlanes, 2, a.data(), 2, frames); break;
+                default: kernels->deinterleave(a.data(), 5, fivePlanes, 5, frames / 5); break;
+                } },
+                                         ctx.minSeconds);
+
+            ctx.reporter->report("simd", std::string(kernels->name) + "/" + opName,
+                                 {{"identical", identical ? 1.0 : 0.0},
+                                  {"frames", static_cast<double>(frames)},
+                                  {"ns_per_sample", seconds * 1e9 / frames}});
+        }
+    }
+}
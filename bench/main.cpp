@@ -0,0 +1,100 @@
+#include "bench.h"
+#include <iostream>
+#include <string>
+
+namespace
+{
+    void printUsage()
+    {
+        std::cerr << "Usage: amply_bench [options]\n"
+                  << "  --format text|csv|json   Output format (default text)\n"
+                  << "  --time S                 Minimum measured seconds per case (default 0.1)\n"
+                  << "  --rate R                 Sample rate for realtime factors (default 48000)\n"
+                  << "  --filter NAME            Only run suites whose name contains NAME\n";
+    }
+}
+
+int main(int argc, char **argv)
+{
+    BenchReporter::Format format = BenchReporter::Format::Text;
+    BenchContext ctx;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        try
+        {
+            if (arg == "--format" && hasValue)
+            {
+                std::string value = argv[++i];
+                if (value == "csv")
+                    format = BenchReporter::Format::Csv;
+                else if (value == "json")
+                    format = BenchReporter::Format::Json;
+                else if (value == "text")
+                    format = BenchReporter::Format::Text;
+                else
+                    throw std::invalid_argument(value);
+            }
+            else if (arg == "--time" && hasValue)
+                ctx.minSeconds = std::stod(argv[++i]);
+            else if (arg == "--rate" && hasValue)
+                ctx.sampleRate = std::stod(argv[++i]);
+            else if (arg == "--filter" && hasValue)
+                ctx.filter = argv[++i];
+            else
+            {
+                printUsage();
+                return 1;
+            }
+        }
+        catch (...)
+        {
+            std::cerr << "[Error] Invalid value for " << arg << "\n";
+            printUsage();
+            return 1;
+        }
+    }
+
+    BenchReporter reporter(format);
+    ctx.reporter = &reporter;
+
+    if (ctx.enabled("engine"))
+        benchEngine(ctx);
+    if (ctx.enabled("parallel"))
+        benchParallel(ctx);
+    if (ctx.enabled("effects"))
+        benchEffects(ctx);
+    if (ctx.enabled("fused"))
+        benchFused(ctx);
+    if (ctx.enabled("simd"))
+        benchSimd(ctx);
+    if (ctx.enabled("fastmath"))
+        benchFastmath(ctx);
+    if (ctx.enabled("bridge"))
+        benchBridge(ctx);
+    if (ctx.enabled("idle"))
+        benchIdle(ctx);
+    if (ctx.enabled("denormal"))
+        benchDenormal(ctx);
+    if (ctx.enabled("ampmodel"))
+        benchAmpModel(ctx);
+    if (ctx.enabled("recorder"))
+        benchRecorder(ctx);
+    if (ctx.enabled("events"))
+        benchEvents(ctx);
+    if (ctx.enabled("analysis"))
+        benchAnalysis(ctx);
+    if (ctx.enabled("conversion"))
+        benchConversion(ctx);
+
+    if (ctx.failures > 0)
+    {
+        std::cerr << "[Error] " << ctx.failures << " correctness check(s) failed.\n";
+        return 1;
+    }
+
+    return 0;
+}
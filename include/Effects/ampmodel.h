@@ -0,0 +1,78 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "arena.h"
+#include "effect.h"
+#include "simd.h"
+
+// Weights of a captured amp: a stack of recurrent layers fed one sample at
+// a time, with a linear head on the last hidden state. The flat weight list
+// follows the .nam LSTM layout, layer by layer:
+//   LSTM: W (4H x (in + H), row-major, gates i f g o), b (4H), h0 (H), c0 (H)
+//   GRU:  W (3H x (in + H), row-major, gates r z n), b_ih (3H), b_hh (3H), h0 (H)
+// then the head: w (H), b (1). in is 1 for the first layer and H after it.
+struct AmpModel
+{
+    enum class Cell { Lstm, Gru };
+
+    Cell cell = Cell::Lstm;
+    int layers = 1;
+    int hiddenSize = 16;
+    double sampleRate = 48000.0;
+    std::vector<float> weights;
+
+    // Length the weight list must have
+    static size_t weightCount(Cell cell, int layers, int hiddenSize);
+
+    // Reads a .nam file with "LSTM" (or "GRU") architecture; prints the
+    // reason and returns false on error
+    static bool load(const std::string& path, AmpModel& model);
+};
+
+// Runs an AmpModel on every channel. prepare() lays the weights out column
+// by column, each column padded to whole cache lines, so a layer's matrix-
+// vector product is one pass of the matrixColumns SIMD kernel across all
+// gates at once, whatever the hidden size.
+class AmpModelEffect : public Effect {
+public:
+    explicit AmpModelEffect(AmpModel model);
+    ~AmpModelEffect() override;
+
+    AmpModelEffect(const AmpModelEffect&) = delete;
+    AmpModelEffect& operator=(const AmpModelEffect&) = delete;
+
+    // Reads a model file; nullptr on failure
+    static std::shared_ptr<AmpModelEffect> load(const std::string& path);
+
+    const char* name() const override { return "Amp Model"; }
+
+    void prepare(const ProcessSpec& spec) override;
+    void process(float* samples, unsigned long frameCount, int channel) override;
+
+    // Silence drives a recurrent net to a resting state that need not be
+    // silent, so the chain never goes idle behind a model
+    unsigned long tailFrames() const override { return kUnboundedTail; }
+
+    const AmpModel& model() const { return model_; }
+
+private:
+    struct Layer;
+    struct Channel;
+    using Runner = void (*)(const AmpModelEffect& effect, Channel& ch, float* samples, unsigned long frameCount);
+
+    template <AmpModel::Cell C>
+    static void run(const AmpModelEffect& effect, Channel& ch, float* samples, unsigned long frameCount);
+
+    AmpModel model_;
+
+    std::vector<Layer> layers_;
+    std::vector<std::unique_ptr<Channel>> channels_;
+    ArenaArray<float> headWeights_;
+    float headBias_ = 0.0f;
+    size_t stride_ = 0; // floats per padded weight column
+    Runner runner_ = nullptr;
+    const SimdKernels& kernels_;
+    Arena arena_; // weights, then every channel's state
+};
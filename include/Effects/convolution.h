@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "arena.h"
+#include "effect.h"
+
+// Convolves each channel with a cabinet impulse response at zero added
+// latency. The response is split in three:
+//   head - the first kHeadTaps taps, as a direct FIR inside the callback
+//   body - uniform kHeadTaps-sized FFT partitions, also inside the callback
+//   tail - large kTailPartition-sized FFT partitions on a background thread
+// The tail starts far enough into the response that the background thread
+// has a whole partition of time to deliver it, so the callback's cost does
+// not depend on how long the response is. A response recorded at another
+// rate than the stream's is resampled to it in prepare().
+class ConvolutionEffect : public Effect {
+public:
+    // One response per channel; channels past the last one reuse it
+    ConvolutionEffect(std::vector<std::vector<float>> impulse, double impulseRate);
+    ~ConvolutionEffect() override;
+
+    ConvolutionEffect(const ConvolutionEffect&) = delete;
+    ConvolutionEffect& operator=(const ConvolutionEffect&) = delete;
+
+    // Reads an impulse response from a WAV file; nullptr on failure
+    static std::shared_ptr<ConvolutionEffect> load(const std::string& path);
+
+    const char* name() const override { return "Cabinet"; }
+
+    void prepare(const ProcessSpec& spec) override;
+    void process(float* samples, unsigned long frameCount, int channel) override;
+    unsigned long tailFrames() const override { return static_cast<unsigned long>(impulseLength()); }
+
+    // In frames at the rate last prepared for, or as loaded before then
+    size_t impulseLength() const;
+    double impulseRate() const { return impulseRate_; }
+
+    // Spans played without their tail because the background thread was late
+    uint64_t tailMisses() const { return tailMisses_.load(std::memory_order_relaxed); }
+
+    static constexpr size_t kHeadTaps = 64;
+    static constexpr size_t kTailPartition = 1024;
+
+private:
+    struct Channel;
+
+    void processSpan(Channel& ch, float* samples, size_t count);
+    void bodyStep(Channel& ch);
+    void tailStep(Channel& ch);
+    void resyncTail(Channel& ch, uint64_t written);
+    void tailWorker();
+    void stopWorker();
+
+    std::vector<std::vector<float>> impulse_;
+    double impulseRate_;
+    std::vector<std::vector<float>> streamImpulse_; // impulse_ at streamRate_
+    double streamRate_ = 0.0;
+
+    std::vector<std::unique_ptr<Channel>> channels_;
+    Arena arena_; // every channel's buffers and spectra
+    size_t tailPartition_ = kTailPartition;
+    size_t tailStart_ = 0; // first tap handled by the tail
+    bool realtime_ = true;
+
+    std::thread worker_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> tailMisses_{0};
+};
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <vector>
+#include "effect.h"
+#include "fastmath.h"
+#include "parameter.h"
+#include "simd.h"
+
+// Drive into a static waveshaper, then an output level. All curves use the
+// fastmath approximations, so heavy drive costs the same as light drive.
+class DistortionEffect : public Effect {
+public:
+    enum class Mode {
+        SoftClip,  // tanh: smooth, symmetric
+        Overdrive, // 2/pi * atan: softer knee, slower to saturate
+        Tube,      // biased, asymmetric exp/tanh curve: adds even harmonics
+        Foldback   // triangle fold: folds peaks back instead of flattening them
+    };
+
+    DistortionEffect(Mode mode = Mode::SoftClip, float drive = 4.0f, float level = 0.5f)
+        : mode(mode), drive(drive, SmoothedParameter::Curve::Exponential),
+          level(level, SmoothedParameter::Curve::Exponential), kernels(simd()) {}
+
+    const char* name() const override { return "Distortion"; }
+
+    void prepare(const ProcessSpec& spec) override {
+        drive.prepare(spec.sampleRate, spec.maxFrames);
+        level.prepare(spec.sampleRate, spec.maxFrames);
+
+        // One-pole DC blocker at ~10 Hz for the biased tube curve
+        dcCoefficient = static_cast<float>(1.0 - 2.0 * 3.14159265358979 * 10.0 / spec.sampleRate);
+        dcState.assign(spec.channelCount, DcState{});
+
+        // Time for the blocker's state to decay by 120 dB
+        dcTail = static_cast<unsigned long>(std::ceil(std::log(1e-6) / std::log(static_cast<double>(dcCoefficient))));
+    }
+
+    void beginBlock(unsigned long frameCount) override {
+        drive.advance(frameCount);
+        level.advance(frameCount);
+        blockMode = mode.load(std::memory_order_relaxed);
+    }
+
+    void process(float* samples, unsigned long frameCount, int channel) override {
+        if (drive.isRamping())
+            kernels.multiplyRamp(samples, drive.ramp(), frameCount);
+        else
+            kernels.multiply(samples, drive.current(), frameCount);
+
+        switch (blockMode)
+        {
+        case Mode::SoftClip:
+            fastmath::tanhBlock(samples, frameCount);
+            break;
+        case Mode::Overdrive:
+            overdrive(samples, frameCount);
+            break;
+        case Mode::Tube:
+            tube(samples, frameCount);
+            if (channel < static_cast<int>(dcState.size()))
+                blockDc(samples, frameCount, dcState[channel]);
+            break;
+        case Mode::Foldback:
+            foldback(samples, frameCount);
+            break;
+        }
+
+        if (level.isRamping())
+            kernels.multiplyRamp(samples, level.ramp(), frameCount);
+        else
+            kernels.multiply(samples, level.current(), frameCount);
+    }
+
+    // The curves are memoryless; only the tube curve's DC blocker rings on.
+    // Audio thread: follows the curve of the last block.
+    unsigned long tailFrames() const override { return blockMode == Mode::Tube ? dcTail : 0; }
+
+    // Safe to call from any thread; drive and level are ramped in on the audio thread
+    void setDrive(float d) { drive.setTarget(d); }
+    void setLevel(float l) { level.setTarget(l); }
+    void setMode(Mode m) { mode.store(m, std::memory_order_relaxed); }
+    float getDrive() const { return drive.target(); }
+    float getLevel() const { return level.target(); }
+    Mode getMode() const { return mode.load(std::memory_order_relaxed); }
+
+    // Mode takes 0-3 in the order of Mode
+    const char* parameterName(int index) const override {
+        static const char* const names[] = {"drive", "level", "mode"};
+        return index >= 0 && index < 3 ? names[index] : nullptr;
+    }
+    void setParameter(int index, float value) override {
+        if (index == 0)
+            setDrive(value);
+        else if (index == 1)
+            setLevel(value);
+        else if (index == 2 && value >= 0.0f && value < 4.0f)
+            setMode(static_cast<Mode>(static_cast<int>(value)));
+    }
+
+    // ===================== Fused Processing =====================
+    // Per-sample form of process() for StaticChain, with the curve fixed at
+    // compile time and drive and level steady for the block
+    static constexpr bool fusable = true;
+
+    template <Mode M>
+    struct Stage {
+        float drive, level;
+
+        float tick(float x) const {
+            x *= drive;
+            if constexpr (M == Mode::SoftClip)
+                x = fastmath::tanh(x);
+            else if constexpr (M == Mode::Overdrive)
+                x = overdrive(x);
+            else
+                x = foldback(x);
+            return x * level;
+        }
+    };
+
+    // The tube curve's DC blocker is a recurrence that would keep the whole
+    // fused loop scalar; it is cheaper as its own pass
+    bool canFuse() const { return blockMode != Mode::Tube && !drive.isRamping() && !level.isRamping(); }
+
+    // Calls fn with the Stage for this block's curve; only when canFuse()
+    template <typename Fn>
+    void visitStage(Fn&& fn) const {
+        const float d = drive.current(), l = level.current();
+        switch (blockMode)
+        {
+        case Mode::SoftClip:
+            fn(Stage<Mode::SoftClip>{d, l});
+            break;
+        case Mode::Overdrive:
+            fn(Stage<Mode::Overdrive>{d, l});
+            break;
+        case Mode::Foldback:
+            fn(Stage<Mode::Foldback>{d, l});
+            break;
+        case Mode::Tube:
+            break;
+        }
+    }
+
+private:
+    struct DcState {
+        float x1 = 0.0f;
+        float y1 = 0.0f;
+    };
+
+    static float overdrive(float x) {
+        return 0.63661977f * fastmath::atan(x);
+    }
+
+    static float tube(float x) {
+        // Positive half compresses like tanh, negative half more gently
+        // like e^x - 1; the bias shifts the operating point off centre
+        const float bias = 0.2f;
+        const float offset = fastmath::tanh(bias);
+        float v = x + bias;
+        float pos = fastmath::tanh(v);
+        float neg = fastmath::exp(v) - 1.0f;
+        return (v >= 0.0f ? pos : neg) - offset;
+    }
+
+    static float foldback(float x) {
+        // Triangle wave of period 4 through (0, 0): identity on [-1, 1],
+        // mirrored back at each +/-1 crossing
+        float v = fastmath::clampf(x, -1.0e6f, 1.0e6f) + 1.0f;
+        float q = v * 0.25f;
+        float fq = static_cast<float>(static_cast<int32_t>(q));
+        fq = fq > q ? fq - 1.0f : fq;
+        float m = v - 4.0f * fq; // [0, 4)
+        float t = m - 2.0f;
+        return 1.0f - (t < 0.0f ? -t : t);
+    }
+
+    static void overdrive(float* x, unsigned long n) {
+        for (unsigned long i = 0; i < n; i++)
+            x[i] = overdrive(x[i]);
+    }
+
+    static void tube(float* x, unsigned long n) {
+        for (unsigned long i = 0; i < n; i++)
+            x[i] = tube(x[i]);
+    }
+
+    static void foldback(float* x, unsigned long n) {
+        for (unsigned long i = 0; i < n; i++)
+            x[i] = foldback(x[i]);
+    }
+
+    void blockDc(float* x, unsigned long n, DcState& s) const {
+        const float r = dcCoefficient;
+        float x1 = s.x1, y1 = s.y1;
+        for (unsigned long i = 0; i < n; i++)
+        {
+            float y = x[i] - x1 + r * y1;
+            x1 = x[i];
+            x[i] = y1 = y;
+        }
+        s.x1 = x1;
+        s.y1 = y1;
+    }
+
+    std::atomic<Mode> mode;
+    Mode blockMode = Mode::SoftClip;
+    SmoothedParameter drive;
+    SmoothedParameter level;
+    const SimdKernels& kernels;
+
+    float dcCoefficient = 0.9987f;
+    unsigned long dcTail = 0;
+    std::vector<DcState> dcState;
+};
@@ -1,20 +1,63 @@
 #pragma once
 
 #include "effect.h"
+#include "fastmath.h"
+#include "parameter.h"
+#include "simd.h"
 
 class GainEffect : public Effect {
 public:
-    GainEffect(float gain = 1.0f) : gain(gain) {}
+    GainEffect(float gain = 1.0f) : gain(gain, SmoothedParameter::Curve::Exponential), kernels(simd()) {}
 
-    float process(float inputSample) override {
-        float output = inputSample * gain;
-        if (output > 1.0f) output = 1.0f;
-        if (output < -1.0f) output = -1.0f;
-        return output;
+    const char* name() const override { return "Gain"; }
+
+    void prepare(const ProcessSpec& spec) override {
+        gain.prepare(spec.sampleRate, spec.maxFrames);
+    }
+
+    void beginBlock(unsigned long frameCount) override {
+        gain.advance(frameCount);
+    }
+
+    void process(float* samples, unsigned long frameCount, int channel) override {
+        if (gain.isRamping())
+            kernels.multiplyRamp(samples, gain.ramp(), frameCount);
+        else
+            kernels.multiply(samples, gain.current(), frameCount);
+
+        kernels.clamp(samples, -1.0f, 1.0f, frameCount);
     }
 
-    void setGain(float g) { gain = g; }
+    unsigned long tailFrames() const override { return 0; }
+
+    // Safe to call from any thread; the change is ramped in on the audio thread
+    void setGain(float g) { gain.setTarget(g); }
+    float getGain() const { return gain.target(); }
+
+    const char* parameterName(int index) const override { return index == 0 ? "gain" : nullptr; }
+    void setParameter(int index, float value) override {
+        if (index == 0)
+            setGain(value);
+    }
+
+    // ===================== Fused Processing =====================
+    // Per-sample form of process() for StaticChain, while the gain is steady
+    static constexpr bool fusable = true;
+
+    struct Stage {
+        float gain;
+
+        float tick(float x) const { return fastmath::clampf(x * gain, -1.0f, 1.0f); }
+    };
+
+    bool canFuse() const { return !gain.isRamping(); }
+
+    template <typename Fn>
+    void visitStage(Fn&& fn) const {
+        fn(Stage{gain.current()});
+    }
 
 private:
-    float gain;
+    SmoothedParameter gain;
+    const SimdKernels& kernels;
 };
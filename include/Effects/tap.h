@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include "effect.h"
+#include "spscring.h"
+
+// Passes the signal through untouched and copies its first channel into a
+// ring, for analysis on a thread of its own. When the reader falls behind,
+// blocks are dropped and counted rather than waited for.
+class TapEffect : public Effect {
+public:
+    // About 0.7 s at 48 kHz; the reader drains it every few milliseconds
+    static constexpr size_t kRingFrames = 32768;
+
+    TapEffect() { ring.resize(kRingFrames); }
+
+    const char* name() const override { return "Tap"; }
+
+    void prepare(const ProcessSpec& spec) override {
+        rate.store(spec.sampleRate, std::memory_order_relaxed);
+    }
+
+    void process(float* samples, unsigned long frameCount, int channel) override {
+        if (channel == 0 && !ring.write(samples, frameCount))
+            dropped.store(dropped.load(std::memory_order_relaxed) + frameCount, std::memory_order_relaxed);
+    }
+
+    unsigned long tailFrames() const override { return 0; }
+
+    // ===================== Reader =====================
+    // One reading thread at a time
+    SpscRing& samples() { return ring; }
+    double sampleRate() const { return rate.load(std::memory_order_relaxed); }
+    uint64_t droppedFrames() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    SpscRing ring;
+    std::atomic<double> rate{0.0};
+    std::atomic<uint64_t> dropped{0};
+};
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <utility>
+
+// Zero-initialized float storage aligned for the widest vector loads. Sized
+// off the audio thread; the audio thread only uses data().
+class AlignedBuffer {
+public:
+    static constexpr size_t kAlignment = 64;
+
+    AlignedBuffer() = default;
+    explicit AlignedBuffer(size_t count) { resize(count); }
+    ~AlignedBuffer() { release(); }
+
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+    AlignedBuffer(AlignedBuffer&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+    AlignedBuffer& operator=(AlignedBuffer&& other) noexcept {
+        if (this != &other) {
+            release();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+    // Discards the contents
+    void resize(size_t count) {
+        release();
+        if (count == 0)
+            return;
+        data_ = static_cast<float*>(::operator new(count * sizeof(float), std::align_val_t(kAlignment)));
+        size_ = count;
+        std::memset(data_, 0, count * sizeof(float));
+    }
+
+    float* data() { return data_; }
+    const float* data() const { return data_; }
+    size_t size() const { return size_; }
+
+    // Floats per row so that every row starts aligned
+    static size_t alignedStride(size_t count) {
+        const size_t perLine = kAlignment / sizeof(float);
+        return (count + perLine - 1) / perLine * perLine;
+    }
+
+private:
+    void release() {
+        if (data_)
+            ::operator delete(data_, std::align_val_t(kAlignment));
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    float* data_ = nullptr;
+    size_t size_ = 0;
+};
@@ -0,0 +1,121 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "fft.h"
+#include "Effects/tap.h"
+
+// ===================== Pitch Detection =====================
+
+// YIN over a window of twice the longest period wanted (40 ms, down to
+// 50 Hz). The difference function comes from one FFT cross-correlation
+// instead of a loop per lag.
+class PitchDetector {
+public:
+    static constexpr float kMinFrequency = 50.0f;
+    static constexpr float kMaxFrequency = 1500.0f;
+
+    // Not real-time safe
+    void prepare(double sampleRate);
+    size_t windowFrames() const { return window_; }
+
+    // Looks at the windowFrames() samples ending at the newest; false when
+    // no period stands out. clarity is 1 minus YIN's normalized difference.
+    bool detect(const float* window, float& frequency, float& clarity);
+
+private:
+    double sampleRate_ = 0.0;
+    size_t window_ = 0;
+    size_t span_ = 0; // integration span and longest lag, half the window
+    std::unique_ptr<Fft> fft_;
+    std::vector<float> padded_, spanRe_, spanIm_, re_, im_, correlation_;
+    std::vector<double> energy_; // prefix sums of squares
+    std::vector<float> difference_; // cumulative mean normalized, by lag
+};
+
+// Nearest equal-tempered note to a frequency, as "E2" and the offset from
+// it in cents
+struct Note {
+    std::string name;
+    float cents = 0.0f;
+};
+Note nearestNote(float frequency, float referenceA4 = 440.0f);
+
+// ===================== Analyzer =====================
+
+// Reads a TapEffect on a low-priority thread of its own and keeps the
+// latest pitch, level and spectrum. Every 10 ms hop runs the pitch detector
+// over the newest window, and a Hann-windowed FFT with 12 Hz bins that is
+// reduced to a few bands per octave.
+class Analyzer {
+public:
+    static constexpr int kBands = 24; // 40 Hz to 16 kHz
+
+    struct Reading {
+        bool signal = false;   // window above the noise gate
+        bool pitched = false;
+        float frequency = 0.0f;
+        float clarity = 0.0f;
+        float peakDb = -120.0f; // newest hop, dBFS
+        float rmsDb = -120.0f;  // newest hop, dBFS (a full-scale sine reads -3)
+        std::array<float, kBands> bandsDb{};
+        uint64_t updates = 0;
+        std::chrono::steady_clock::time_point time; // of the newest update
+    };
+
+    Analyzer();
+    ~Analyzer();
+
+    Analyzer(const Analyzer&) = delete;
+    Analyzer& operator=(const Analyzer&) = delete;
+
+    // The tap to place in the chain; it stays the same for the analyzer's life
+    const std::shared_ptr<TapEffect>& tap() const { return tap_; }
+
+    // ===================== Control Thread =====================
+    void start();
+    void stop();
+    bool running() const { return thread_.joinable(); }
+    Reading reading() const;
+    // Lower edge of each band, then the upper edge of the last one
+    static std::array<float, kBands + 1> bandEdges();
+
+    // ===================== Analysis =====================
+    // What the thread runs: drains the tap and analyzes every complete hop,
+    // skipping ahead when far behind. Returns how many hops were analyzed.
+    // Only call directly while the thread is not running.
+    size_t poll();
+
+private:
+    void run();
+    void configure(double sampleRate);
+    void analyze();
+
+    std::shared_ptr<TapEffect> tap_;
+    PitchDetector pitch_;
+    double sampleRate_ = 0.0;
+    size_t hop_ = 0;
+    std::vector<float> history_;  // the newest samples, oldest first
+    std::vector<float> incoming_; // the hop being collected
+    size_t filled_ = 0;
+
+    // Spectrum
+    std::unique_ptr<Fft> fft_;
+    std::vector<float> hann_, windowed_, re_, im_;
+    std::array<size_t, kBands + 1> bandBins_{};
+    float spectrumScale_ = 1.0f;
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+
+    mutable std::mutex readingMutex_; // analysis thread and control thread only
+    Reading reading_;
+};
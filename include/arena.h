@@ -0,0 +1,112 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Fixed-size array carved out of an Arena; the arena owns the memory
+template <typename T>
+class ArenaArray {
+public:
+    ArenaArray() = default;
+    ArenaArray(T* data, size_t size) : data_(data), size_(size) {}
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    T* begin() { return data_; }
+    T* end() { return data_ + size_; }
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+
+    T& operator[](size_t i) { return data_[i]; }
+    const T& operator[](size_t i) const { return data_[i]; }
+
+private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Bump allocator for the state an effect sets up in prepare(). Arrays are
+// zeroed, aligned for the widest vector loads and packed next to each other
+// in a few large chunks, so preparing costs a handful of allocations and
+// the audio thread walks contiguous memory. Everything is freed together by
+// clear() or the destructor. Allocating may grow the arena and is not real-
+// time safe; the audio thread only uses the arrays.
+class Arena {
+public:
+    static constexpr size_t kAlignment = 64;
+    static constexpr size_t kChunkBytes = 64 * 1024;
+
+    Arena() = default;
+    ~Arena() { clear(); }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // Only for types that need no construction or destruction
+    template <typename T>
+    ArenaArray<T> allocate(size_t count) {
+        static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>,
+                      "Arena arrays are zero-filled, never constructed or destroyed");
+        static_assert(alignof(T) <= kAlignment, "Arena cannot align this type");
+        if (count == 0)
+            return {};
+        return ArenaArray<T>(static_cast<T*>(allocateBytes(count * sizeof(T))), count);
+    }
+
+    // Frees every chunk; arrays allocated so far dangle
+    void clear() {
+        for (Chunk& chunk : chunks_)
+            ::operator delete(chunk.data, std::align_val_t(kAlignment));
+        chunks_.clear();
+        used_ = 0;
+    }
+
+    // Bytes handed out, and reserved from the system
+    size_t bytesUsed() const {
+        size_t total = 0;
+        for (size_t i = 0; i + 1 < chunks_.size(); i++)
+            total += chunks_[i].used;
+        return total + used_;
+    }
+
+    size_t bytesReserved() const {
+        size_t total = 0;
+        for (const Chunk& chunk : chunks_)
+            total += chunk.size;
+        return total;
+    }
+
+private:
+    struct Chunk {
+        unsigned char* data;
+        size_t size;
+        size_t used; // final fill, recorded when the next chunk starts
+    };
+
+    void* allocateBytes(size_t bytes) {
+        bytes = (bytes + kAlignment - 1) / kAlignment * kAlignment;
+        if (chunks_.empty() || used_ + bytes > chunks_.back().size) {
+            if (!chunks_.empty())
+                chunks_.back().used = used_;
+
+            // Oversized arrays get a chunk of their own
+            size_t size = std::max(bytes, kChunkBytes);
+            chunks_.push_back({static_cast<unsigned char*>(::operator new(size, std::align_val_t(kAlignment))), size, 0});
+            used_ = 0;
+        }
+
+        unsigned char* ptr = chunks_.back().data + used_;
+        used_ += bytes;
+        std::memset(ptr, 0, bytes);
+        return ptr;
+    }
+
+    std::vector<Chunk> chunks_;
+    size_t used_ = 0; // in the last chunk
+};
@@ -0,0 +1,115 @@
+#pragma once
+#include <atomic>
+#include "audioengine.h"
+#include "audiofile.h"
+#include "realtime.h"
+#include "recorder.h"
+#include "streamstats.h"
+
+// ===================== Stream Configuration =====================
+
+struct StreamConfig
+{
+    double sampleRate = 48000.0;
+    int inputDevice = -1; // backend-specific index; -1 for the default device
+    int outputDevice = -1;
+    int inputChannels = 1;
+    int outputChannels = 1;
+    unsigned long framesPerBuffer = 0; // 0 lets the backend choose
+    double inputLatency = 0.0;         // suggested, in seconds; 0 for the device default
+    double outputLatency = 0.0;
+    // Sample formats on the device side; callbacks always see float
+    SampleEncoding inputEncoding = SampleEncoding::Float32;
+    SampleEncoding outputEncoding = SampleEncoding::Float32;
+};
+
+// Period and suggested device latency for a stream; 0 leaves either to the host API
+struct BufferSettings
+{
+    unsigned long framesPerBuffer = 0;
+    double suggestedLatency = 0.0; // seconds, applied to input and output
+};
+
+// What the backend knows about the block being delivered
+struct BlockInfo
+{
+    unsigned flags = 0;         // StreamStats::Flags
+    double inputLatency = 0.0;  // seconds from capture to callback, 0 if unknown
+    double outputLatency = 0.0; // seconds from callback to playback, 0 if unknown
+    double modelledSeconds = -1.0; // simulated processing time to report instead of the measured one; < 0 if none
+    double streamTime = 0.0;      // stream clock when the first frame plays (PortAudio's DAC time), 0 if unknown
+};
+
+// ===================== Callback =====================
+
+class AudioCallback {
+public:
+    virtual ~AudioCallback() = default;
+
+    // Called on the backend's audio thread once per period with interleaved
+    // float buffers; input is nullptr when the stream has no input
+    virtual void process(const float* input, float* output, unsigned long frameCount, const BlockInfo& info) = 0;
+};
+
+// Runs an AudioEngine for a backend and records each block in StreamStats.
+// The first block after setThreadSetup() prepares the thread it runs on.
+// With a recorder attached, every block's input and output go to it.
+// Blocks with a stream time anchor the engine's frame count to the
+// stream clock, for scheduling events at stream times.
+class EngineCallback : public AudioCallback {
+public:
+    EngineCallback(AudioEngine& engine, StreamStats& stats) : engine_(engine), stats_(stats) {}
+
+    void process(const float* input, float* output, unsigned long frameCount, const BlockInfo& info) override;
+
+    // Control thread, while no stream is running; also forgets the clock
+    // anchor of the previous stream
+    void setThreadSetup(const ThreadSetup& setup);
+    // How the audio thread ended up; false until a block has run
+    bool threadState(ThreadState& state) const;
+
+    // Control thread, before any stream; the recorder must outlive this object
+    void setRecorder(SessionRecorder* recorder) { recorder_ = recorder; }
+
+    // Any thread: the engine frame that plays at a time on the stream clock,
+    // from the latest block; false until a block has reported a stream time
+    bool frameAt(double streamTime, uint64_t& frame) const;
+    // Stream time of the latest block's first frame; false if unknown
+    bool latestStreamTime(double& streamTime) const;
+
+private:
+    AudioEngine& engine_;
+    StreamStats& stats_;
+    SessionRecorder* recorder_ = nullptr;
+
+    ThreadSetup setup_;
+    std::atomic<bool> setupPending_{false};
+    ThreadState state_;
+    std::atomic<bool> stateReady_{false};
+
+    // Latest clock anchor, behind a sequence lock: odd while being written
+    std::atomic<uint32_t> anchorSequence_{0};
+    std::atomic<double> anchorTime_{0.0};
+    std::atomic<uint64_t> anchorFrame_{0};
+    bool readAnchor(double& time, uint64_t& frame) const;
+};
+
+// ===================== Backend =====================
+
+// A source of audio callbacks: a real device, or a simulation of one
+class AudioBackend {
+public:
+    virtual ~AudioBackend() = default;
+
+    virtual const char* name() const = 0;
+
+    virtual bool isFormatSupported(const StreamConfig& config) = 0;
+
+    // Opens a stream delivering blocks to callback, which must outlive it.
+    // Closes any stream already open.
+    virtual bool open(const StreamConfig& config, AudioCallback* callback) = 0;
+    virtual bool start() = 0;
+    // Stops the stream if running and releases it
+    virtual void close() = 0;
+    virtual bool isOpen() const = 0;
+};
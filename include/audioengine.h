@@ -0,0 +1,138 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "alignedbuffer.h"
+#include "effect.h"
+#include "effectchain.h"
+#include "eventqueue.h"
+#include "simd.h"
+#include "workerpool.h"
+
+// Runs the effect chain over interleaved float buffers. Has no dependency on
+// an audio device, so the live stream, offline rendering and benchmarks all
+// share the same processing path.
+class AudioEngine {
+public:
+    // ===================== Constructor =====================
+    AudioEngine();
+
+    // ===================== Configuration =====================
+    // Not real-time safe: must not run concurrently with process(). Allocates
+    // planar buffers for maxFrames; offline (non-realtime) engines let effects
+    // wait on their helper threads.
+    void prepare(double sampleRate, int inputChannels, int outputChannels,
+                 unsigned long maxFrames = kDefaultMaxFrames, bool realtime = true);
+    double getSampleRate() const { return sampleRate_; }
+    int getInputChannels() const { return inputChannels_; }
+    int getOutputChannels() const { return outputChannels_; }
+    unsigned long getMaxFrames() const { return maxFrames_; }
+
+    // ===================== Effect Chain =====================
+    // Safe to call while process() runs; changes take effect at the next block
+    void addEffect(std::shared_ptr<Effect> effect);
+    bool removeEffect(size_t index);
+    bool moveEffect(size_t from, size_t to);
+    bool replaceEffect(size_t index, std::shared_ptr<Effect> effect);
+    std::vector<std::shared_ptr<Effect>> getEffects() const;
+    void collect();
+
+    // Runs standard presets (gain, drive, cab) as fused static chains, with
+    // the dynamic chain handling everything else. Off by default: see the
+    // 'fused' bench suite for whether it pays off on a given machine.
+    void setChainFusion(bool enabled) { chain_.setFusion(enabled); }
+    bool getChainFusion() const { return chain_.getFusion(); }
+
+    // ===================== Parallel Processing =====================
+    // Spreads channels over a worker pool; 0 processes them serially on the
+    // calling thread. Not real-time safe: must not run concurrently with process().
+    void setWorkerThreads(int count);
+    int getWorkerThreads() const { return pool_ ? pool_->workers() : 0; }
+    const WorkerPool* getWorkerPool() const { return pool_.get(); }
+    // Any thread. The scheduling the audio thread runs at, for the workers
+    // to follow; kept for pools created later.
+    void setAudioThreadState(int priority, bool flushDenormals);
+
+    // ===================== Idle Bypass =====================
+    // Skips the chain and writes silence once the input peak has stayed
+    // below closeDb for as long as the chain's tails last; a peak above
+    // openDb resumes processing. Off by default, so renders stay exact.
+    // Safe to call while process() runs.
+    struct IdleOptions
+    {
+        bool enabled = false;
+        float openDb = -90.0f;  // dBFS
+        float closeDb = -96.0f; // dBFS, at or below openDb
+    };
+    void setIdleOptions(const IdleOptions& options);
+    IdleOptions getIdleOptions() const;
+
+    // Whether the last block was bypassed, and how many blocks have been
+    bool isIdle() const { return idle_.load(std::memory_order_relaxed); }
+    uint64_t idleBlocks() const { return idleBlocks_.load(std::memory_order_relaxed); }
+
+    // ===================== Scheduled Events =====================
+    // Any thread. Queues a batch of events to land on their frames of the
+    // stream, counted by process() since prepare(); blocks are split so each
+    // change starts on its exact frame, and events already due land at the
+    // start of the next call. All or nothing, so a batch lands together.
+    bool schedule(const ControlEvent* events, size_t count) { return events_.push(events, count); }
+    size_t pendingEvents() const { return events_.size(); }
+    // Frames processed since prepare()
+    uint64_t streamFrame() const { return streamFrame_.load(std::memory_order_relaxed); }
+
+    // ===================== Audio Processing =====================
+    // Real-time safe. Buffers are interleaved with the prepared channel counts;
+    // calls longer than the prepared maxFrames are split.
+    void process(const float* input, float* output, unsigned long frameCount);
+
+    // Period assumed when the device does not fix one
+    static constexpr unsigned long kDefaultMaxFrames = 1024;
+
+private:
+    void prepareEffect(Effect& effect);
+
+    // One channel of one block: the unit of work handed to the pool
+    struct ChannelJob
+    {
+        const EffectChain* chain;
+        float* const* planes;
+        unsigned long frames;
+        const SimdKernels* kernels;
+    };
+    static void processChannel(void* job, size_t channel);
+    bool bypassBlock(const float* input, unsigned long frames, const EffectChain& chain, const SimdKernels& kernels);
+    void applyEvents(const EffectChain& chain);
+
+    EffectChainPublisher chain_;
+    double sampleRate_;
+    int inputChannels_;
+    int outputChannels_;
+    unsigned long maxFrames_;
+    bool realtime_;
+    bool prepared_;
+
+    // One aligned plane per processed channel, filled once per call
+    AlignedBuffer planar_;
+    std::vector<float*> planes_;
+    std::vector<float*> outputPlanes_; // extra output channels repeat plane 0
+
+    std::unique_ptr<WorkerPool> pool_;
+    std::atomic<int> audioPriority_{0};
+    std::atomic<bool> audioFlushDenormals_{false};
+
+    EventQueue events_;
+    uint64_t frame_ = 0; // audio thread
+    std::atomic<uint64_t> streamFrame_{0};
+
+    // Idle detection: options from the control thread as linear peaks,
+    // the rest owned by the audio thread
+    std::atomic<bool> idleEnabled_{false};
+    std::atomic<float> openLevel_;
+    std::atomic<float> closeLevel_;
+    bool signal_ = false;      // input last rose above openLevel_ and has not fallen below closeLevel_
+    uint64_t quietFrames_ = 0; // frames since the signal fell away
+    std::atomic<bool> idle_{false};
+    std::atomic<uint64_t> idleBlocks_{0};
+};
@@ -0,0 +1,106 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// ===================== Audio File Format =====================
+
+enum class SampleEncoding
+{
+    Int16,
+    Int24,
+    Int32,
+    Float32
+};
+
+struct AudioFormat
+{
+    double sampleRate = 0.0;
+    int channels = 0;
+    SampleEncoding encoding = SampleEncoding::Float32;
+};
+
+// Bytes used by one sample of the given encoding
+int bytesPerSample(SampleEncoding encoding);
+// Lower-case name such as "int24"; parseEncoding() takes the same names
+const char* encodingName(SampleEncoding encoding);
+bool parseEncoding(const std::string& name, SampleEncoding& encoding);
+
+// ===================== Streaming Reader =====================
+
+// Reads WAV or headerless raw files in chunks, so only one chunk of the file
+// is ever held in memory regardless of its size.
+class AudioFileReader {
+public:
+    AudioFileReader() = default;
+    ~AudioFileReader();
+
+    AudioFileReader(const AudioFileReader&) = delete;
+    AudioFileReader& operator=(const AudioFileReader&) = delete;
+
+    bool openWav(const std::string& path);
+    bool openRaw(const std::string& path, const AudioFormat& format);
+    void close();
+
+    const AudioFormat& format() const { return format_; }
+    uint64_t totalFrames() const { return totalFrames_; }
+
+    // Reads up to frameCount interleaved frames as float; returns frames read
+    unsigned long read(float* output, unsigned long frameCount);
+
+private:
+    std::FILE* file_ = nullptr;
+    AudioFormat format_;
+    uint64_t totalFrames_ = 0;
+    uint64_t framesLeft_ = 0;
+    std::vector<unsigned char> chunk_;
+};
+
+// ===================== Streaming Writer =====================
+
+// Writes WAV or headerless raw files; WAV sizes are patched in on close().
+// A WAV file that outgrows 4 GB is finalized as RF64, for which the header
+// keeps a placeholder chunk.
+class AudioFileWriter {
+public:
+    AudioFileWriter() = default;
+    ~AudioFileWriter();
+
+    AudioFileWriter(const AudioFileWriter&) = delete;
+    AudioFileWriter& operator=(const AudioFileWriter&) = delete;
+
+    // With dataAlignment (a power of two of at least 128 bytes) the header
+    // is padded so the samples start at a multiple of it, and writes skip
+    // stdio's buffer: whole chunks then go to the disk aligned
+    bool openWav(const std::string& path, const AudioFormat& format, size_t dataAlignment = 0);
+    bool openRaw(const std::string& path, const AudioFormat& format);
+    bool close();
+
+    // Reserves disk space for dataBytes of samples, so the file system does
+    // not allocate while writing; trimmed to the written size on close().
+    // False where the platform cannot.
+    bool preallocate(uint64_t dataBytes);
+
+    // Writes frameCount interleaved float frames
+    bool write(const float* input, unsigned long frameCount);
+
+    uint64_t dataBytes() const { return dataBytes_; }
+
+private:
+    // At the start of the file, with the sizes written so far
+    bool writeHeader();
+
+    std::FILE* file_ = nullptr;
+    AudioFormat format_;
+    bool isWav_ = false;
+    uint64_t headerBytes_ = 0;
+    uint64_t dataBytes_ = 0;
+    uint64_t reservedBytes_ = 0; // file size preallocate() set
+    std::vector<unsigned char> chunk_;
+};
+
+// ===================== Utility Functions =====================
+
+// True if the path ends with ".wav" (case-insensitive)
+bool isWavPath(const std::string& path);
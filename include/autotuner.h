@@ -0,0 +1,64 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+#include "audiobackend.h"
+#include "settings.h"
+#include "streamstats.h"
+
+// ===================== Autotuner =====================
+
+// Finds the smallest buffer a machine runs without xruns. Starting from a
+// safe period, each step halves framesPerBuffer (the suggested latency
+// follows it) and soaks the stream while watching callback load and xrun
+// flags. Tuning stops at the first unstable step; the result is the
+// smallest stable step, backed off by a safety margin of larger steps.
+class Autotuner {
+public:
+    struct Options {
+        unsigned long largestFrames = 1024;
+        unsigned long smallestFrames = 16;
+        double latencyPeriods = 2.0;  // suggested latency, in periods
+        double soakSeconds = 5.0;     // per step
+        double maxAverageLoad = 0.6;  // share of the period
+        double maxPeakLoad = 0.9;
+        int marginSteps = 1;          // steps to back off from the smallest stable one
+    };
+
+    struct Step {
+        BufferSettings settings;
+        StreamStats::Snapshot stats;
+        bool opened = false;
+        bool stable = false;
+    };
+
+    // Runs the stream with the given settings for soakSeconds and returns
+    // its statistics; false when the stream could not be opened
+    using Trial = std::function<bool(const BufferSettings& settings, double soakSeconds, StreamStats::Snapshot& stats)>;
+
+    Autotuner(double sampleRate, const Options& options);
+
+    // Returns false when not even the largest buffer was stable
+    bool run(const Trial& trial);
+
+    const BufferSettings& result() const { return result_; }
+    const std::vector<Step>& steps() const { return steps_; }
+
+    static bool isStable(const StreamStats::Snapshot& stats, const Options& options);
+
+private:
+    double sampleRate_;
+    Options options_;
+    BufferSettings result_;
+    std::vector<Step> steps_;
+};
+
+// One line per step, as printed by the tune command
+void printTuneSteps(std::ostream& out, const std::vector<Autotuner::Step>& steps, double sampleRate);
+
+// ===================== Persistence =====================
+
+// Tuned settings are stored per device pair and sample rate
+std::string tuneKey(const std::string& inputDevice, const std::string& outputDevice, double sampleRate);
+bool loadTunedSettings(const Settings& settings, const std::string& key, BufferSettings& result);
+void storeTunedSettings(Settings& settings, const std::string& key, const BufferSettings& result);
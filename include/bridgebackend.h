@@ -0,0 +1,67 @@
+#pragma once
+#include <portaudio.h>
+#include <atomic>
+#include <vector>
+#include "audiobackend.h"
+#include "devicebridge.h"
+#include "sampleconverter.h"
+
+// Streams through two PortAudio streams, one per device, so an input and an
+// output that cannot open as one duplex stream - different clocks, or no
+// common sample rate - can still be paired. A DeviceBridge carries the input
+// across; the engine runs at the output device's rate. Pa_Initialize() must
+// have been called. Each device keeps its own sample format; integer ones are
+// converted to and from float in its callback.
+class BridgeBackend : public AudioBackend {
+public:
+    BridgeBackend() = default;
+    ~BridgeBackend() override;
+
+    BridgeBackend(const BridgeBackend&) = delete;
+    BridgeBackend& operator=(const BridgeBackend&) = delete;
+
+    const char* name() const override { return "PortAudio bridge"; }
+
+    // The output device must support the rate; the input device any rate
+    bool isFormatSupported(const StreamConfig& config) override;
+    bool open(const StreamConfig& config, AudioCallback* callback) override;
+    bool start() override;
+    void close() override;
+    bool isOpen() const override { return outputStream_ != nullptr; }
+
+    // Any thread
+    DeviceBridge::Status status() const { return bridge_.status(); }
+
+    // Rate for the input device: the output's if it supports it, otherwise
+    // the closest standard rate it does support; 0 if there is none
+    static double inputRate(const StreamConfig& config);
+
+private:
+    static int inputCallback(const void* inputBuffer, void* outputBuffer,
+                             unsigned long framesPerBuffer,
+                             const PaStreamCallbackTimeInfo* timeInfo,
+                             PaStreamCallbackFlags statusFlags,
+                             void* userData);
+    static int outputCallback(const void* inputBuffer, void* outputBuffer,
+                              unsigned long framesPerBuffer,
+                              const PaStreamCallbackTimeInfo* timeInfo,
+                              PaStreamCallbackFlags statusFlags,
+                              void* userData);
+
+    PaStream* inputStream_ = nullptr;
+    PaStream* outputStream_ = nullptr;
+    AudioCallback* callback_ = nullptr;
+    DeviceBridge bridge_;
+    std::vector<float> input_; // bridged input for one output block
+    SampleConverter inputConverter_;
+    SampleConverter outputConverter_;
+    int inputChannels_ = 0;
+    int outputChannels_ = 0;
+    unsigned long maxFrames_ = 0;
+    unsigned long maxInputFrames_ = 0; // bound on one push into the bridge
+    double outputRate_ = 0.0;
+
+    // Written by the input callback, read by the output callback
+    std::atomic<unsigned> inputFlags_{0};
+    std::atomic<double> inputLatency_{0.0};
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "settings.h"
+#include "utils.h"
+
+// ===================== Capability Cache =====================
+
+// Remembers what probing the audio devices found - the filtered device list
+// per host API and the sample rates each device pair accepts - so later
+// runs skip the slow Pa_IsFormatSupported sweeps. Everything is tied to a
+// fingerprint of the enumerated devices: when a device is plugged in or
+// removed, the fingerprint changes and the cache starts over.
+class CapabilityCache {
+public:
+    // Settings::defaultPath() with a ".cache" suffix
+    static std::string defaultPath();
+
+    // Fingerprint of every device PortAudio currently enumerates
+    static uint64_t fingerprint();
+
+    bool load(const std::string& path);
+    // Writes only if something changed since the last load or save
+    bool save(const std::string& path);
+
+    // Drops all entries unless they were recorded for this fingerprint
+    void validate(uint64_t fingerprint);
+
+    // ===================== Devices =====================
+    bool getDevices(const std::string& hostApi, std::vector<DeviceInfo>& devices) const;
+    void setDevices(const std::string& hostApi, const std::vector<DeviceInfo>& devices);
+
+    // ===================== Sample Rates =====================
+    // Device identity is name and channel count, not index
+    static std::string rateKey(const std::string& input, int inputChannels,
+                               const std::string& output, int outputChannels);
+    bool getSampleRates(const std::string& key, std::vector<double>& rates) const;
+    void setSampleRates(const std::string& key, const std::vector<double>& rates);
+
+private:
+    Settings entries_;
+    bool dirty_ = false;
+};
@@ -3,6 +3,13 @@
 #include <functional>
 #include <string>
 #include "Effects/gain.h"
+#include "Effects/distortion.h"
+#include "Effects/convolution.h"
+#include "Effects/ampmodel.h"
+#include "eventscript.h"
+#include "streamstats.h"
+#include "settings.h"
+#include "utils.h"
 #include <memory>
 
 class DigitalAmp; // Forward Declaration
@@ -15,8 +22,22 @@ public:
     // ===================== Main Loop =====================
     void run();
 
+    // Opens and starts the stream from a saved profile without prompting;
+    // an empty name uses the startup profile, if one is set
+    bool startProfile(const std::string& name);
+
     std::shared_ptr<GainEffect> gainEffect;
+    std::shared_ptr<DistortionEffect> distortionEffect;
 private:
+    std::shared_ptr<ConvolutionEffect> cabinetEffect; // loaded by the cab command
+    std::string cabinetPath;
+    std::shared_ptr<AmpModelEffect> ampModelEffect; // loaded by the model command
+    std::string ampModelPath;
+    StatsExporter statsExporter;
+    ScriptPlayer scriptPlayer; // feeds the script command's events
+    Settings settings;        // persisted between runs, e.g. tuned buffer sizes
+    std::string settingsPath;
+
     DigitalAmp* amp;
 
     std::unordered_map<std::string, std::function<void()>> commands;
@@ -31,7 +52,29 @@ private:
     void showHelp();
     void clearConsole();
     void setGain();
+    void setDrive();
+    void loadCabinet();
+    void loadAmpModel();
+    void editChain();
+    void showStats();
+    void exportStats();
+    void setParallel();
+    void tuneLatency();
+    void editProfiles();
+    void rescanDevices();
+    void setBridging();
+    void setSampleFormat();
+    void setDspThread();
+    void setIdleBypass();
+    void setAudioThread();
+    void setRecording();
+    void playScript();
+    // The tuner and meter views of the analyzer's readings
+    void watchAnalysis(bool tuner);
 
     // ===================== Utility =====================
     void clearInputBuffer();
+    std::string currentTuneKey();
+    void saveProfile(const std::string& name);
+    bool findDevice(const std::string& name, bool isInput, DeviceInfo& device);
 };
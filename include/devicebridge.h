@@ -0,0 +1,97 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "resampler.h"
+#include "spscring.h"
+
+// Joins an input and an output device that run on separate clocks. The
+// input thread pushes frames into a lock-free ring; the output thread pulls
+// them back out through a Resampler whose ratio a PI controller trims until
+// the ring level holds steady at about one period of each side. The
+// controller's integral term is then the measured drift between the clocks.
+class DeviceBridge {
+public:
+    struct Status {
+        double inputRate = 0.0;
+        double outputRate = 0.0;
+        double driftPpm = 0.0;      // input clock relative to the output clock
+        double fillFrames = 0.0;    // smoothed ring level, in input frames
+        double targetFrames = 0.0;
+        double latencySeconds = 0.0; // ring plus resampler delay
+        uint64_t underruns = 0;     // output found too little input
+        uint64_t overruns = 0;      // input found the ring full
+        bool running = false;       // past priming
+    };
+
+    DeviceBridge() = default;
+
+    DeviceBridge(const DeviceBridge&) = delete;
+    DeviceBridge& operator=(const DeviceBridge&) = delete;
+
+    // Not real-time safe; neither side may be running. Block sizes bound a
+    // single push() and pull(); larger calls are split by the caller.
+    void prepare(int channels, double inputRate, double outputRate,
+                 size_t maxInputFrames, size_t maxOutputFrames);
+
+    // Both sides pass the time of their callback in seconds, on one clock
+    // shared by the two threads. The output side uses the time since the
+    // last push to count the input that has been captured but not handed
+    // over yet, so the level it controls does not depend on where the two
+    // devices' periods happen to fall against each other.
+
+    // ===================== Input Thread =====================
+    void push(const float* input, size_t frames, double time);
+
+    // ===================== Output Thread =====================
+    // Fills frames interleaved frames of input at the output rate, silence
+    // while priming. Returns StreamStats input flags for anything lost since
+    // the previous call.
+    unsigned pull(float* input, size_t frames, double time);
+
+    // ===================== Any Thread =====================
+    Status status() const;
+
+    // Smoothing of the ring level, and the loop's natural frequency: wide
+    // to lock on quickly, then narrowing so callback jitter barely moves
+    // the ratio. With callbacks up to 30% of a period late, the measured
+    // drift settles within 10 ppm in 4-14 s for periods of up to 256
+    // frames; longer input periods carry more jitter and take longer.
+    static constexpr double kFillSeconds = 0.1;
+    static constexpr double kLockRadians = 2.5;
+    static constexpr double kTrackRadians = 0.05;
+    static constexpr double kNarrowSeconds = 4.0;
+    // Largest drift followed, relative
+    static constexpr double kMaxDeviation = 0.005;
+
+private:
+    void restart();
+
+    int channels_ = 0;
+    double inputRate_ = 0.0;
+    double outputRate_ = 0.0;
+    SpscRing ring_;
+    Resampler resampler_;
+    std::vector<float> scratch_;
+
+    // Input thread
+    std::atomic<size_t> largestPush_{0};
+    std::atomic<double> pushTime_{0.0};
+    std::atomic<uint64_t> overruns_{0};
+
+    // Output thread
+    bool priming_ = true;
+    size_t largestPull_ = 0;
+    double fill_ = 0.0;
+    double integral_ = 0.0;
+    double lockedSeconds_ = 0.0; // since priming ended
+    uint64_t overrunsSeen_ = 0;
+
+    // Published for status()
+    std::atomic<double> driftPpm_{0.0};
+    std::atomic<double> fillFrames_{0.0};
+    std::atomic<double> targetFrames_{0.0};
+    std::atomic<uint64_t> underruns_{0};
+    std::atomic<bool> running_{false};
+};
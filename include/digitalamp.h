@@ -1,9 +1,18 @@
 #pragma once
 #include <portaudio.h>
 #include <memory>
+#include <optional>
 #include <vector>
 #include "utils.h"
 #include "effect.h"
+#include "audioengine.h"
+#include "audiobackend.h"
+#include "streamstats.h"
+#include "capabilitycache.h"
+#include "devicebridge.h"
+#include "dspthread.h"
+#include "recorder.h"
+#include "analyzer.h"
 
 class DigitalAmp {
 public:
@@ -17,10 +26,37 @@ public:
     // ===================== Stream Management =====================
     bool openStream();
     bool openStream(double sampleRate, unsigned long framesPerBuffer);
-    bool createStreamParameters(PaDeviceIndex deviceIndex, int channelCount, PaSampleFormat sampleFormat, bool isInput);
+    bool createStreamParameters(PaDeviceIndex deviceIndex, int channelCount, bool isInput);
     bool startStream();
     void stopStream();
+    bool isRunning() const { return running_; }
+
+    // Replaces the PortAudio backend, e.g. with a simulated one. Stops any stream.
+    void setBackend(std::unique_ptr<AudioBackend> backend);
+    AudioBackend& getBackend() { return *backend_; }
+
+    // Opens input and output as separate streams joined by a drift-compensating
+    // resampler, for devices that cannot share one duplex stream. Stops any stream.
+    void setBridging(bool enabled);
+    bool isBridging() const;
+    // False unless bridging
+    bool getBridgeStatus(DeviceBridge::Status& status) const;
+
+    // Period and latency used by openStream(); zeros leave them to the host API
+    void setBufferSettings(const BufferSettings& settings) { bufferSettings_ = settings; }
+    const BufferSettings& getBufferSettings() const { return bufferSettings_; }
     
+    // ===================== Sample Formats =====================
+    // Device sample format to ask for on both sides; nullopt negotiates one
+    // per device on every open, preferring integer formats on host APIs that
+    // usually run devices natively in them. A format a device refuses falls
+    // back to float. Only while no stream is running.
+    bool setSampleFormat(std::optional<SampleEncoding> encoding);
+    std::optional<SampleEncoding> getSampleFormat() const { return sampleFormat_; }
+    // What the open stream runs each device in
+    SampleEncoding getInputEncoding() const { return inputEncoding_; }
+    SampleEncoding getOutputEncoding() const { return outputEncoding_; }
+
     // ===================== Sample Rate Handling =====================
     std::vector<double> getSupportedSampleRates(const PaStreamParameters* inputParams, const PaStreamParameters* outputParams);
     std::vector<double> getSupportedSampleRates();
@@ -36,25 +72,118 @@ public:
     DeviceInfo getInputDevice();
     DeviceInfo getOutputDevice();
     std::unique_ptr<AvailableDevices> getAvailableDevices();
+    // Re-initializes PortAudio to pick up hotplugged devices. Stops any
+    // stream; returns true if the device list changed, which also clears
+    // the device selection.
+    bool rescanDevices();
+
+    // ===================== Effect Chain =====================
+    // Safe to call while the stream is running; changes take effect at the next block
+    void addEffect(std::shared_ptr<Effect> effect);
+    bool removeEffect(size_t index);
+    bool moveEffect(size_t from, size_t to);
+    bool replaceEffect(size_t index, std::shared_ptr<Effect> effect);
+    std::vector<std::shared_ptr<Effect>> getEffects() const;
+    // Matches the chain against the fused presets whenever it changes
+    void setChainFusion(bool enabled) { engine_.setChainFusion(enabled); }
+    bool getChainFusion() const { return engine_.getChainFusion(); }
+
+    // Stops processing the chain while the input is silent and its tails
+    // have played out; on by default for live streams
+    void setIdleOptions(const AudioEngine::IdleOptions& options) { engine_.setIdleOptions(options); }
+    AudioEngine::IdleOptions getIdleOptions() const { return engine_.getIdleOptions(); }
+    bool isIdle() const { return engine_.isIdle(); }
+    uint64_t idleBlocks() const { return engine_.idleBlocks(); }
+
+    // ===================== Parallel Processing =====================
+    // Only while no stream is running; 0 processes channels on the callback thread
+    bool setWorkerThreads(int count);
+    int getWorkerThreads() const { return engine_.getWorkerThreads(); }
+    const WorkerPool* getWorkerPool() const { return engine_.getWorkerPool(); }
+
+    // ===================== Audio Thread =====================
+    // Applied to the thread running the engine on the first callback of each
+    // stream. Only while no stream is running.
+    bool setThreadSetup(const ThreadSetup& setup);
+    const ThreadSetup& getThreadSetup() const { return threadSetup_; }
+    // False until the running stream has processed a block
+    bool getThreadState(ThreadState& state) const { return running_ && callback_.threadState(state); }
+
+    // ===================== DSP Thread =====================
+    // Runs the effect chain on a dedicated thread fed through rings by the
+    // driver callback. Only while no stream is running.
+    bool setDspThread(bool enabled, const DspThread::Options& options);
+    bool getDspThread() const { return dspThreadEnabled_; }
+    const DspThread::Options& getDspOptions() const { return dspOptions_; }
+    const DspThread& getDsp() const { return dsp_; }
+
+    // ===================== Recording =====================
+    // Records the dry input and processed output of the running stream to
+    // basePath-dry.wav and basePath-wet.wav. Stopping the stream stops it.
+    bool startRecording(const std::string& basePath, const SessionRecorder::Options& options);
+    bool stopRecording() { return recorder_.stop(); }
+    bool isRecording() const { return recorder_.recording(); }
+    SessionRecorder::Status getRecordingStatus() const { return recorder_.status(); }
+
+    // ===================== Scheduled Events =====================
+    // Queues a batch of events for the engine; see AudioEngine::schedule()
+    bool scheduleEvents(const ControlEvent* events, size_t count) { return engine_.schedule(events, count); }
+    size_t pendingEvents() const { return engine_.pendingEvents(); }
+    // Frames the running stream has processed
+    uint64_t streamFrame() const { return engine_.streamFrame(); }
+    // The stream frame that plays at a time on the stream clock (PortAudio's
+    // stream time); false until the running stream has reported one
+    bool frameAtStreamTime(double streamTime, uint64_t& frame) const { return running_ && callback_.frameAt(streamTime, frame); }
+    bool getStreamTime(double& streamTime) const { return running_ && callback_.latestStreamTime(streamTime); }
+
+    // ===================== Analysis =====================
+    // Puts the analyzer's tap at the front of the chain and starts its
+    // thread; the tap stays put if 'chain' has moved it. Safe while the
+    // stream is running.
+    void startAnalysis();
+    void stopAnalysis();
+    bool isAnalyzing() const { return analyzer_.running(); }
+    Analyzer::Reading getAnalysis() const { return analyzer_.reading(); }
+
+    // ===================== Statistics =====================
+    // Filled in by the audio callback; cleared whenever a stream is opened
+    StreamStats& getStats() { return stats_; }
     
     // ===================== Public Members =====================
     double sampleRate;
-    std::vector<std::shared_ptr<Effect>> effects;
 
 private:
-    // ===================== Audio Processing =====================
-    static int audioCallback(const void* inputBuffer, void* outputBuffer,
-                             unsigned long framesPerBuffer,
-                             const PaStreamCallbackTimeInfo* timeInfo,
-                             PaStreamCallbackFlags statusFlags,
-                             void* userData);
-    int processAudio(const float* input, float* output, unsigned long frameCount);
+    // Stream configuration for the selected devices
+    StreamConfig streamConfig(const PaStreamParameters* inputParams, const PaStreamParameters* outputParams,
+                              double sampleRate, unsigned long framesPerBuffer) const;
+    // Format for one device of config, as described at setSampleFormat()
+    SampleEncoding negotiateEncoding(const StreamConfig& config, bool isInput) const;
+    // Either PortAudio backend, as opposed to a simulated one
+    bool usesPortAudio() const;
+    // Capability cache applies only to PortAudio devices
+    bool usesCache() const;
 
     // ===================== Internal State =====================
     PaHostApiIndex currentApi_;
-    PaStream* stream_;
     PaStreamParameters inputParams_;
     PaStreamParameters outputParams_;
+    AudioEngine engine_;
+    StreamStats stats_;
+    SessionRecorder recorder_;
+    Analyzer analyzer_;
+    EngineCallback callback_;
+    DspThread dsp_;
+    DspThread::Options dspOptions_;
+    ThreadSetup threadSetup_;
+    bool dspThreadEnabled_ = false;
+    std::unique_ptr<AudioBackend> backend_;
+    BufferSettings bufferSettings_;
+    std::optional<SampleEncoding> sampleFormat_;
+    SampleEncoding inputEncoding_ = SampleEncoding::Float32;
+    SampleEncoding outputEncoding_ = SampleEncoding::Float32;
+    CapabilityCache cache_;
+    std::string cachePath_;
+    uint64_t deviceFingerprint_ = 0;
     bool initialized_;
     bool running_;
 };
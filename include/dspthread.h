@@ -0,0 +1,88 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "audiobackend.h"
+#include "spscring.h"
+
+// Runs the processing callback on a thread of our own instead of the
+// driver's. The driver callback only copies audio into an input ring and
+// out of an output ring; the DSP thread - optionally FIFO-scheduled, pinned
+// to a core and with memory locked - processes the blocks in between.
+// Output is queued lookahead blocks ahead of the driver, so the DSP thread
+// may fall that far behind without a dropout. Like WorkerPool, the driver
+// callback never makes a system call: the DSP thread polls.
+class DspThread : public AudioCallback {
+public:
+    struct Options {
+        int lookahead = 1;    // blocks queued beyond the one in flight
+        int core = -1;        // -1: first isolated core, else the last core
+        int priority = 80;    // FIFO priority; 0 keeps normal scheduling
+        bool lockMemory = true;
+    };
+
+    // What start() actually got, for display
+    struct Placement {
+        int core = -1;        // -1 when not pinned
+        bool realtime = false;
+        bool memoryLocked = false;
+    };
+
+    // inner runs on the DSP thread and must outlive this object
+    explicit DspThread(AudioCallback& inner) : inner_(inner) {}
+    ~DspThread() override;
+
+    DspThread(const DspThread&) = delete;
+    DspThread& operator=(const DspThread&) = delete;
+
+    // Longest driver callback assumed when the period is left to the host
+    static constexpr unsigned long kMaxHostFrames = 8192;
+
+    // Not real-time safe; the thread must be stopped. maxFrames bounds one
+    // processed block and maxCallbackFrames one driver callback, which the
+    // rings are sized for; a longer callback is dropped as an input overflow.
+    void prepare(int inputChannels, int outputChannels, unsigned long maxFrames,
+                 unsigned long maxCallbackFrames, double sampleRate, const Options& options);
+    bool start();
+    void stop();
+    bool running() const { return thread_.joinable(); }
+    const Placement& placement() const { return placement_; }
+
+    // Driver blocks that found no processed output waiting
+    uint64_t lateBlocks() const { return lateBlocks_.load(std::memory_order_relaxed); }
+
+    // ===================== Driver Thread =====================
+    void process(const float* input, float* output, unsigned long frameCount, const BlockInfo& info) override;
+
+private:
+    void loop();
+
+    AudioCallback& inner_;
+    Options options_;
+    Placement placement_;
+    int inputChannels_ = 0;
+    int outputChannels_ = 0;
+    unsigned long maxFrames_ = 0;
+    double sampleRate_ = 0.0;
+
+    SpscRing input_;  // driver -> DSP
+    SpscRing output_; // DSP -> driver
+    std::thread thread_;
+    std::atomic<bool> quit_{false};
+
+    // Driver thread
+    int primingBlocks_ = 0;
+    std::vector<float> silence_; // stands in for a missing input
+
+    // Driver -> DSP: device flags, latencies and stream time to pass on with the next block
+    std::atomic<unsigned> pendingFlags_{0};
+    std::atomic<double> inputLatency_{0.0};
+    std::atomic<double> outputLatency_{0.0};
+    std::atomic<double> streamTime_{0.0};
+    std::atomic<uint64_t> lateBlocks_{0};
+
+    // DSP thread
+    std::vector<float> inputBlock_;
+    std::vector<float> outputBlock_;
+};
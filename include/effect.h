@@ -1,11 +1,88 @@
 #pragma once
+#include <atomic>
+#include <cstdint>
 
-#pragma once
+// Stream an effect is prepared for
+struct ProcessSpec {
+    double sampleRate = 48000.0;
+    int channelCount = 1;
+    unsigned long maxFrames = 256; // largest span passed to process()
+    bool realtime = true;          // false when rendering offline: effects may wait on helper threads
+};
 
 class Effect {
 public:
     virtual ~Effect() = default;
 
+    // Short display name used when listing the chain
+    virtual const char* name() const { return "Effect"; }
+
+    // Unique for the life of the process and never reused, unlike the
+    // effect's address; scheduled events name their target by it
+    uint64_t id() const { return id_; }
+
+    // Called off the audio thread before the effect is used on a stream;
+    // allocate any state here
+    virtual void prepare(const ProcessSpec& spec) {}
+
+    // Called once per block, before any channel of that block is processed
+    virtual void beginBlock(unsigned long frameCount) {}
+
+    // Process a contiguous span of one channel's samples in place. Different
+    // channels of a block may be processed concurrently on different threads.
+    virtual void process(float* samples, unsigned long frameCount, int channel) = 0;
+
+    // Frames of output the effect can still produce after its input falls
+    // silent, at the prepared rate; asked on the audio thread between
+    // blocks. The engine stops calling an idle chain
+    // once its tails have played out; effects that cannot bound their tail
+    // keep the default, which keeps the chain running.
+    static constexpr unsigned long kUnboundedTail = ~0UL;
+    virtual unsigned long tailFrames() const { return kUnboundedTail; }
+
+    // Parameters that can be automated, by index: parameterName() returns
+    // nullptr past the last one. setParameter() is safe from any thread and
+    // is how scheduled events reach the effect on the audio thread.
+    virtual const char* parameterName(int index) const { return nullptr; }
+    virtual void setParameter(int index, float value) {}
+
+    // A bypassed effect stays in the chain but is skipped. Any thread; the
+    // engine picks the change up at the start of its next block.
+    void setBypassed(bool bypassed) { bypassed_.store(bypassed, std::memory_order_relaxed); }
+    bool isBypassed() const { return bypassed_.load(std::memory_order_relaxed); }
+
+    // Audio thread: fixes the bypass state for the block about to run
+    bool latchBypass() { return blockBypassed_ = isBypassed(); }
+    bool blockBypassed() const { return blockBypassed_; }
+
+private:
+    static uint64_t nextId() {
+        static std::atomic<uint64_t> next{1};
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const uint64_t id_ = nextId();
+    std::atomic<bool> bypassed_{false};
+    bool blockBypassed_ = false;
+};
+
+// Tail of two effects in series, saturating at kUnboundedTail
+inline unsigned long addTailFrames(unsigned long a, unsigned long b) {
+    return b > Effect::kUnboundedTail - a ? Effect::kUnboundedTail : a + b;
+}
+
+// Adapter for effects written one sample at a time. All channels share the
+// one process(float) call, so such effects must not keep signal state.
+class SampleEffect : public Effect {
+public:
     // Process a single sample
     virtual float process(float inputSample) = 0;
-};
\ No newline at end of file
+
+    void process(float* samples, unsigned long frameCount, int channel) override {
+        for (unsigned long i = 0; i < frameCount; i++)
+            samples[i] = process(samples[i]);
+    }
+
+    // Stateless, so nothing rings on
+    unsigned long tailFrames() const override { return 0; }
+};
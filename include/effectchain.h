@@ -0,0 +1,86 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "effect.h"
+
+// ===================== Chain Snapshot =====================
+
+// Immutable list of effects as seen by the audio thread. The snapshot owns
+// its effects, but the audio thread only ever walks the raw pointers, so no
+// reference counts are touched while processing. With fusion, runs matching
+// a standard preset are walked as one StaticChain instead of one by one;
+// runs already fused in previous are kept rather than built again.
+class EffectChain {
+public:
+    explicit EffectChain(std::vector<std::shared_ptr<Effect>> effects, bool fuse = false,
+                         const EffectChain* previous = nullptr);
+
+    const std::vector<std::shared_ptr<Effect>>& effects() const { return effects_; }
+
+    Effect* const* begin() const { return processors_.data(); }
+    Effect* const* end() const { return processors_.data() + processors_.size(); }
+    size_t size() const { return processors_.size(); }
+    bool empty() const { return processors_.empty(); }
+
+private:
+    std::vector<std::shared_ptr<Effect>> effects_;
+    std::vector<std::shared_ptr<Effect>> fused_; // owns the processors when fused
+    std::vector<Effect*> processors_;
+};
+
+// ===================== Chain Publisher =====================
+
+// Publishes chain snapshots from the control thread to a single audio thread,
+// RCU style. The audio thread brackets each block with acquire()/release() and
+// never blocks or allocates; replaced snapshots are freed on the control
+// thread once the audio thread can no longer be reading them.
+class EffectChainPublisher {
+public:
+    EffectChainPublisher();
+    ~EffectChainPublisher();
+
+    EffectChainPublisher(const EffectChainPublisher&) = delete;
+    EffectChainPublisher& operator=(const EffectChainPublisher&) = delete;
+
+    // ===================== Control Thread =====================
+    void publish(std::vector<std::shared_ptr<Effect>> effects);
+    std::vector<std::shared_ptr<Effect>> getEffects() const;
+
+    void addEffect(std::shared_ptr<Effect> effect);
+    bool removeEffect(size_t index);
+    bool moveEffect(size_t from, size_t to);
+    bool replaceEffect(size_t index, std::shared_ptr<Effect> effect);
+
+    // Whether new snapshots fuse preset runs into static chains; republishes
+    void setFusion(bool enabled);
+    bool getFusion() const { return fusion_; }
+
+    // Frees retired snapshots the audio thread has finished with
+    void collect();
+
+    // ===================== Audio Thread =====================
+    const EffectChain* acquire();
+    void release();
+
+private:
+    struct Retired
+    {
+        const EffectChain* chain;
+        uint64_t epoch; // blocks entered when it was replaced
+    };
+
+    void publishLocked(std::vector<std::shared_ptr<Effect>> effects);
+    void collectLocked();
+
+    std::atomic<const EffectChain*> current_;
+    std::atomic<uint64_t> blocksEntered_;
+    std::atomic<uint64_t> blocksExited_;
+
+    mutable std::mutex controlMutex_; // serializes control-thread writers only
+    bool fusion_ = false;
+    std::vector<Retired> retired_;
+};
@@ -0,0 +1,76 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "effect.h"
+
+// ===================== Control Event =====================
+
+// A change to one effect, scheduled for a frame of the stream
+struct ControlEvent
+{
+    enum class Type : uint8_t
+    {
+        Parameter, // effect->setParameter(parameter, value)
+        Bypass     // effect->setBypassed(value != 0)
+    };
+
+    uint64_t frame = 0;  // stream frame the change lands on
+    uint64_t effect = 0; // Effect::id(); dropped if no longer in the chain when due
+    Type type = Type::Parameter;
+    int parameter = 0;
+    float value = 0.0f;
+};
+
+// ===================== Event Queue =====================
+
+// Carries timestamped events from control threads to the audio thread.
+// Producers are serialized by a mutex and push whole batches, sorted by
+// frame on the way in, which become visible to the audio thread together.
+// The audio thread never blocks or allocates: it merges each batch whole
+// into a fixed pending list kept in frame order, leaving a batch in the
+// ring until the list has room for all of it, and takes events off the
+// front as their frames come up.
+class EventQueue {
+public:
+    static constexpr size_t kCapacity = 1024;
+
+    EventQueue();
+
+    EventQueue(const EventQueue&) = delete;
+    EventQueue& operator=(const EventQueue&) = delete;
+
+    // ===================== Control Thread =====================
+    // All or nothing: false if the batch does not fit
+    bool push(const ControlEvent* events, size_t count);
+    // Events the queue still holds, pending or not yet received
+    size_t size() const;
+
+    // ===================== Audio Thread =====================
+    // Takes newly pushed events into the pending list
+    void receive();
+    // Frame of the earliest pending event; false if there is none
+    bool nextFrame(uint64_t& frame) const;
+    // Removes the earliest pending event if it is due at or before frame
+    bool pop(uint64_t frame, ControlEvent& event);
+    // Discards everything, e.g. when a new stream starts counting from zero
+    void clear();
+
+private:
+    // Ring from producers to the audio thread; batches_ holds each batch's
+    // length at the slot of its first event
+    std::vector<ControlEvent> ring_;
+    std::vector<size_t> batches_;
+    alignas(64) std::atomic<size_t> write_{0};
+    alignas(64) std::atomic<size_t> read_{0};
+    std::mutex producerMutex_;
+    std::vector<ControlEvent> sorted_; // producer scratch
+
+    // Audio thread: sorted by frame, [head_, pendingCount_) in use
+    std::vector<ControlEvent> pending_;
+    size_t head_ = 0;
+    size_t pendingCount_ = 0;
+    std::atomic<size_t> held_{0}; // pending, for size()
+};
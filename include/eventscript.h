@@ -0,0 +1,105 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "eventqueue.h"
+
+// ===================== Event Script =====================
+
+// Timed control events read from text, one per line:
+//
+//   WHEN ACTION
+//
+// WHEN is an offset from the start of the script in frames (4800), seconds
+// (1.5s) or milliseconds (250ms), or a time on the stream clock (@12.5).
+// ACTION is one of
+//
+//   set EFFECT PARAMETER VALUE
+//   bypass EFFECT on|off
+//   preset NAME
+//
+// EFFECT is a position in the chain, counted from 1 as 'chain' lists it, or
+// an effect name without spaces (gain, distortion, ampmodel, cabinet).
+// A preset is a list of actions between 'define NAME' and 'end' that lands
+// as one batch. '#' starts a comment.
+class EventScript {
+public:
+    // Queues a batch of events; false if it does not fit right now
+    using Scheduler = std::function<bool(const ControlEvent*, size_t)>;
+    // Maps a stream time to a stream frame; false if the clock is unknown
+    using StreamClock = std::function<bool(double, uint64_t&)>;
+
+    // Resolves effect and parameter names against chain. Prints the first
+    // error with its line number and returns false.
+    bool parse(std::istream& in, const std::vector<std::shared_ptr<Effect>>& chain, double sampleRate);
+    size_t size() const { return timed_.size(); }
+
+    // Fixes every event to a stream frame, with offsets counted from
+    // originFrame. False if the script uses stream times and clock cannot
+    // map them.
+    bool start(uint64_t originFrame, const StreamClock& clock);
+
+    // Schedules the events due before horizonFrame, each frame's events as
+    // one batch; stops early when the queue is full. Returns how many were
+    // scheduled.
+    size_t feed(uint64_t horizonFrame, const Scheduler& schedule);
+    bool finished() const { return next_ == events_.size(); }
+    // Frame of the first event not yet scheduled; false once finished
+    bool nextFrame(uint64_t& frame) const;
+
+private:
+    struct Timed
+    {
+        ControlEvent event;
+        bool streamTime = false; // when holds stream seconds, not an offset in frames
+        double when = 0.0;
+    };
+
+    bool parseAction(const std::string& action, std::istringstream& args,
+                     const std::vector<std::shared_ptr<Effect>>& chain,
+                     std::vector<ControlEvent>& out, std::string& error) const;
+
+    std::vector<Timed> timed_;
+    std::unordered_map<std::string, std::vector<ControlEvent>> presets_;
+    std::vector<ControlEvent> events_; // after start(), in frame order
+    size_t next_ = 0;
+};
+
+// ===================== Script Player =====================
+
+// Feeds a script to a running stream from a thread of its own, keeping a
+// little over a second of events queued ahead of the audio.
+class ScriptPlayer {
+public:
+    ScriptPlayer() = default;
+    ~ScriptPlayer();
+
+    ScriptPlayer(const ScriptPlayer&) = delete;
+    ScriptPlayer& operator=(const ScriptPlayer&) = delete;
+
+    // streamFrame reports how far the stream has got
+    void start(EventScript script, std::function<uint64_t()> streamFrame,
+               EventScript::Scheduler schedule, double sampleRate);
+    void stop();
+    // True until every event is queued
+    bool playing() const { return playing_.load(std::memory_order_relaxed); }
+
+private:
+    void run(std::function<uint64_t()> streamFrame, EventScript::Scheduler schedule, double sampleRate);
+
+    EventScript script_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    std::atomic<bool> playing_{false};
+};
@@ -0,0 +1,82 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Branch-free approximations of the transcendental functions used for
+// waveshaping. Each is written so a loop over a block auto-vectorizes at the
+// baseline ISA wherever GCC's vectorizer runs: at -O3, or at -O2 with the
+// cost model the build sets. None of them calls libm. Error bounds and the
+// speed against libm are measured by the 'fastmath' suite in amply_bench.
+
+namespace fastmath
+{
+    // ===================== Bit Helpers =====================
+    inline float bitsToFloat(int32_t bits) {
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+
+    inline float clampf(float x, float lo, float hi) {
+        x = x < hi ? x : hi;
+        return x > lo ? x : lo;
+    }
+
+    // ===================== atan =====================
+    // Odd minimax polynomial on [0, 1] with the reciprocal identity for |x| > 1.
+    // Max absolute error ~2e-6 rad.
+    inline float atan(float x) {
+        const float ax = x < 0.0f ? -x : x;
+        const bool inverted = ax > 1.0f;
+        const float t = inverted ? 1.0f / ax : ax;
+        const float t2 = t * t;
+        float r = t * (0.99997726f + t2 * (-0.33262347f + t2 * (0.19354346f +
+                  t2 * (-0.11643287f + t2 * (0.05265332f + t2 * -0.01172120f)))));
+        r = inverted ? 1.57079633f - r : r;
+        return x < 0.0f ? -r : r;
+    }
+
+    // ===================== exp =====================
+    // 2^(x*log2 e): the nearest integer goes straight into the exponent bits
+    // and a degree-6 polynomial covers the remaining fraction in [-0.5, 0.5].
+    // Max relative error ~4e-6 for x in [-87, 88] (mostly from rounding x * log2 e
+    // at large |x|); inputs are clamped to that range.
+    inline float exp(float x) {
+        x = clampf(x, -87.0f, 88.0f);
+        const float t = x * 1.44269504f;
+        // Round to nearest without a libm call or a branch: adding 1.5 * 2^23
+        // leaves no fraction bits, so the sum itself is rounded
+        const float magic = 12582912.0f;
+        const float fi = (t + magic) - magic;
+        const float f = t - fi;
+        const float p = 1.0f + f * (0.69314718f + f * (0.24022651f + f * (0.05550411f +
+                        f * (0.00961813f + f * (0.00133336f + f * 0.00015404f)))));
+        return p * bitsToFloat((static_cast<int32_t>(fi) + 127) << 23);
+    }
+
+    // ===================== tanh =====================
+    // (e^2x - 1) / (e^2x + 1) on top of exp() above. Max absolute error
+    // ~1.5e-7 over all inputs, below the 24-bit quantization step.
+    inline float tanh(float x) {
+        x = clampf(x, -9.0f, 9.0f);
+        const float e = fastmath::exp(2.0f * x);
+        return (e - 1.0f) / (e + 1.0f);
+    }
+
+    // ===================== Block Versions =====================
+    inline void tanhBlock(float* data, size_t count) {
+        for (size_t i = 0; i < count; i++)
+            data[i] = fastmath::tanh(data[i]);
+    }
+
+    inline void atanBlock(float* data, size_t count) {
+        for (size_t i = 0; i < count; i++)
+            data[i] = fastmath::atan(data[i]);
+    }
+
+    inline void expBlock(float* data, size_t count) {
+        for (size_t i = 0; i < count; i++)
+            data[i] = fastmath::exp(data[i]);
+    }
+}
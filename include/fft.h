@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Real-input FFT of a fixed power-of-two size, with spectra in split
+// real/imaginary arrays so frequency-domain loops vectorize. An instance owns
+// scratch memory: use one per thread.
+class Fft {
+public:
+    // size: number of real samples (power of two, at least 4)
+    explicit Fft(size_t size);
+
+    size_t size() const { return n_; }
+    size_t bins() const { return half_ + 1; }
+
+    // size real samples -> bins() complex bins (unscaled)
+    void forward(const float* input, float* re, float* im);
+    // bins() complex bins -> size real samples, scaled by 1/size
+    void inverse(const float* re, const float* im, float* output);
+
+private:
+    // In-place complex FFT of half_ points
+    void transform(float* re, float* im, bool inverse);
+
+    size_t n_;
+    size_t half_;
+    std::vector<size_t> bitReverse_;
+    std::vector<float> twiddleRe_, twiddleIm_; // e^(-2 pi i k / half_)
+    std::vector<float> splitRe_, splitIm_;     // e^(-2 pi i k / n_)
+    std::vector<float> workRe_, workIm_;
+};
@@ -0,0 +1,134 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+// A control value that any thread may set and the audio thread reads as a
+// per-block ramp. While the value is steady, advance() is one relaxed load and
+// a compare, and effects can use current() as a plain scalar.
+class SmoothedParameter {
+public:
+    enum class Curve { Linear, Exponential };
+
+    explicit SmoothedParameter(float initial = 0.0f, Curve curve = Curve::Linear, float rampMs = 20.0f)
+        : target_(initial), current_(initial), curve_(curve), rampMs_(rampMs) {}
+
+    // ===================== Any Thread =====================
+    void setTarget(float value) { target_.store(value, std::memory_order_relaxed); }
+    float target() const { return target_.load(std::memory_order_relaxed); }
+
+    // ===================== Preparation =====================
+    // Not real-time safe: sizes the ramp buffer for the largest block
+    void prepare(double sampleRate, unsigned long maxFrames) {
+        rampSamples_ = std::max(1UL, static_cast<unsigned long>(rampMs_ * 0.001 * sampleRate));
+        buffer_.assign(maxFrames, current_);
+    }
+
+    // ===================== Audio Thread =====================
+    // Moves the ramp forward by one block. Returns true if ramp() holds
+    // per-sample values for this block, false if current() is constant.
+    bool advance(unsigned long frameCount) {
+        float target = target_.load(std::memory_order_relaxed);
+        if (target != rampTarget_)
+            startRamp(target);
+
+        ramping_ = remaining_ > 0;
+        if (!ramping_)
+            return false;
+
+        if (frameCount > buffer_.size())
+        {
+            // Block larger than prepared for: land on the target immediately
+            finishRamp();
+            ramping_ = false;
+            return false;
+        }
+
+        unsigned long n = std::min(frameCount, remaining_);
+        float *out = buffer_.data();
+        if (!multiplicative_)
+        {
+            const float start = current_, step = step_;
+            for (unsigned long i = 0; i < n; i++)
+                out[i] = start + step * static_cast<float>(i + 1);
+        }
+        else
+        {
+            // Closed form per chunk, like the linear ramp: lane k holds
+            // current * step^(k+1), and every chunk moves all lanes on by
+            // step^kLanes, so there is no recurrence from sample to sample
+            float lanes[kLanes];
+            for (unsigned long k = 0; k < kLanes; k++)
+                lanes[k] = current_ * stepPowers_[k];
+            unsigned long i = 0;
+            for (; i + kLanes <= n; i += kLanes)
+            {
+                for (unsigned long k = 0; k < kLanes; k++)
+                {
+                    out[i + k] = lanes[k];
+                    lanes[k] *= chunkStep_;
+                }
+            }
+            for (unsigned long k = 0; i < n; i++, k++)
+                out[i] = lanes[k];
+        }
+
+        remaining_ -= n;
+        if (remaining_ == 0)
+            finishRamp();
+        else
+            current_ = out[n - 1];
+
+        for (unsigned long i = n; i < frameCount; i++)
+            out[i] = current_;
+
+        return true;
+    }
+
+    bool isRamping() const { return ramping_; }
+    const float* ramp() const { return buffer_.data(); }
+    float current() const { return current_; }
+
+private:
+    void startRamp(float target) {
+        rampTarget_ = target;
+        remaining_ = rampSamples_;
+
+        // Exponential ramps only work between two values of the same sign;
+        // anything touching zero falls back to a linear ramp
+        multiplicative_ = curve_ == Curve::Exponential && current_ * target > 0.0f;
+        if (multiplicative_)
+        {
+            double step = std::pow(static_cast<double>(target) / current_, 1.0 / rampSamples_), power = 1.0;
+            for (unsigned long k = 0; k < kLanes; k++)
+                stepPowers_[k] = static_cast<float>(power *= step);
+            chunkStep_ = stepPowers_[kLanes - 1];
+        }
+        else
+            step_ = (target - current_) / static_cast<float>(rampSamples_);
+    }
+
+    void finishRamp() {
+        remaining_ = 0;
+        current_ = rampTarget_;
+    }
+
+    // Samples of an exponential ramp computed side by side
+    static constexpr unsigned long kLanes = 8;
+
+    std::atomic<float> target_;
+    float current_;
+    float rampTarget_ = current_;
+    float step_ = 0.0f;                // linear: added per sample
+    float stepPowers_[kLanes] = {};    // exponential: step^1 .. step^kLanes
+    float chunkStep_ = 1.0f;           // exponential: step^kLanes
+    unsigned long remaining_ = 0;
+    unsigned long rampSamples_ = 1;
+    bool ramping_ = false;
+    bool multiplicative_ = false;
+
+    Curve curve_;
+    float rampMs_;
+    std::vector<float> buffer_;
+};
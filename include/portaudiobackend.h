@@ -0,0 +1,41 @@
+#pragma once
+#include <portaudio.h>
+#include "audiobackend.h"
+#include "sampleconverter.h"
+
+// Streams through PortAudio. Pa_Initialize() must have been called. Devices
+// opened in an integer format are converted to and from float inside the
+// callback.
+class PortAudioBackend : public AudioBackend {
+public:
+    PortAudioBackend() = default;
+    ~PortAudioBackend() override;
+
+    PortAudioBackend(const PortAudioBackend&) = delete;
+    PortAudioBackend& operator=(const PortAudioBackend&) = delete;
+
+    const char* name() const override { return "PortAudio"; }
+
+    bool isFormatSupported(const StreamConfig& config) override;
+    bool open(const StreamConfig& config, AudioCallback* callback) override;
+    bool start() override;
+    void close() override;
+    bool isOpen() const override { return stream_ != nullptr; }
+
+    // Fills PortAudio parameters; returns false if the device does not exist
+    static bool toParameters(const StreamConfig& config, bool isInput, PaStreamParameters& params);
+    static PaSampleFormat toSampleFormat(SampleEncoding encoding);
+
+private:
+    static int paCallback(const void* inputBuffer, void* outputBuffer,
+                          unsigned long framesPerBuffer,
+                          const PaStreamCallbackTimeInfo* timeInfo,
+                          PaStreamCallbackFlags statusFlags,
+                          void* userData);
+
+    PaStream* stream_ = nullptr;
+    AudioCallback* callback_ = nullptr;
+    SampleConverter input_;
+    SampleConverter output_;
+    double sampleRate_ = 0.0;
+};
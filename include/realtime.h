@@ -0,0 +1,60 @@
+#pragma once
+#include <thread>
+#include <vector>
+
+// ===================== Real-Time Threads =====================
+
+// Placement and scheduling for threads that run audio. Each returns false
+// where the platform or the process's permissions do not allow it; callers
+// carry on at normal scheduling.
+
+// Binds thread to one core
+bool pinThread(std::thread& thread, unsigned core);
+
+// FIFO real-time scheduling at priority (1-99 on Linux); time-critical
+// priority on Windows
+bool setRealtimePriority(std::thread& thread, int priority);
+
+// Locks the process's current and future pages into RAM, so the audio
+// path never waits on a page fault. Linux only.
+bool lockMemory();
+// Whether lockMemory() has succeeded in this process
+bool memoryLocked();
+
+// Cores the kernel keeps ordinary tasks off (isolcpus), lowest first
+std::vector<unsigned> isolatedCores();
+
+// ===================== Calling Thread =====================
+
+// Flush-to-zero and denormals-are-zero for the calling thread (MXCSR on
+// x86, FPCR.FZ on ARM). A recursive filter decaying toward zero otherwise
+// spends its tail on denormal arithmetic, which costs many times more.
+bool setFlushDenormals(bool enabled);
+bool flushesDenormals();
+
+// Lowers the calling thread below normal priority, for helpers such as
+// analysis that must never compete with the audio path
+bool setBackgroundPriority();
+
+// What to do to the thread that runs the engine, on its first callback
+struct ThreadSetup {
+    bool flushDenormals = true;
+    int priority = 70;       // FIFO priority to raise to; 0 keeps the host's scheduling
+    int core = -1;           // -1 leaves placement to the host
+    bool lockMemory = false; // done from the control thread before the stream starts
+};
+
+// How a thread is running, as seen from inside it
+struct ThreadState {
+    bool flushDenormals = false;
+    bool realtime = false;
+    int priority = 0;      // real-time priority, 0 at normal scheduling
+    int core = -1;         // core it was on when asked, -1 if unknown
+    int allowedCores = 0;  // cores it may run on, 0 if unknown
+    bool memoryLocked = false;
+};
+
+// Applies setup to the calling thread, except lockMemory. Priority is only
+// ever raised: a host thread already scheduled higher keeps its priority.
+ThreadState applyThreadSetup(const ThreadSetup& setup);
+ThreadState currentThreadState();
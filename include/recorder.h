@@ -0,0 +1,95 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "audiofile.h"
+#include "spscring.h"
+
+// Records the dry input and the processed output of a stream to two WAV
+// files, for reamping later. The audio thread only copies each block into
+// a ring sized up front; a writer thread of its own drains the ring and
+// writes whole, aligned chunks. When the disk falls behind far enough to
+// fill the ring, blocks are dropped and counted instead of waiting, and
+// both files get silence in their place so they stay in sync.
+class SessionRecorder {
+public:
+    struct Options {
+        double bufferSeconds = 4.0;     // ring length: how long the disk may stall
+        double preallocateSeconds = 0.0; // disk space reserved per file up front
+    };
+
+    struct Status {
+        bool recording = false;
+        std::string dryPath;
+        std::string wetPath;
+        uint64_t framesWritten = 0;
+        uint64_t droppedBlocks = 0;
+        uint64_t droppedFrames = 0;
+        double peakFill = 0.0;   // highest share of the ring in use
+        size_t bufferBytes = 0;  // ring plus write staging
+        bool preallocated = false;
+        bool writeFailed = false;
+    };
+
+    SessionRecorder() = default;
+    ~SessionRecorder();
+
+    SessionRecorder(const SessionRecorder&) = delete;
+    SessionRecorder& operator=(const SessionRecorder&) = delete;
+
+    // ===================== Control Thread =====================
+    // Creates basePath-dry.wav and basePath-wet.wav and starts recording the
+    // next block. Either side may be running.
+    bool start(const std::string& basePath, double sampleRate, int inputChannels, int outputChannels,
+               const Options& options);
+    // Writes out what is buffered and finalizes both files
+    bool stop();
+    bool recording() const { return armed_.load(std::memory_order_relaxed); }
+    Status status() const;
+
+    // ===================== Audio Thread =====================
+    // input is nullptr when the stream has no input; it is recorded as silence
+    void push(const float* input, const float* output, unsigned long frameCount);
+
+private:
+    void writerLoop();
+    // Moves every complete block from the ring into the files; true if any
+    bool drain();
+    bool append(const float* dry, const float* wet, unsigned long frames);
+    void appendSilence(uint64_t frames);
+    bool flushBatch();
+
+    // Block header in the ring, ahead of its dry and then its wet samples
+    static constexpr size_t kHeaderValues = 4;
+
+    SpscRing ring_;
+    int inputChannels_ = 0;
+    int outputChannels_ = 0;
+
+    // Writer thread
+    AudioFileWriter dryFile_, wetFile_;
+    std::vector<float> header_;
+    std::vector<float> dryBlock_, wetBlock_;
+    std::vector<float> dryBatch_, wetBatch_; // one write chunk per file
+    unsigned long batchFrames_ = 0;
+    bool haveHeader_ = false;
+    uint64_t trailingGap_ = 0; // handed over by stop()
+    std::thread writer_;
+    std::atomic<bool> quit_{false};
+
+    // Audio thread
+    uint64_t gapFrames_ = 0; // dropped since the last block that fit
+    std::atomic<bool> armed_{false};
+    std::atomic<bool> pushing_{false};
+
+    // Any thread
+    std::string dryPath_, wetPath_;
+    bool preallocated_ = false;
+    std::atomic<uint64_t> framesWritten_{0};
+    std::atomic<uint64_t> droppedBlocks_{0};
+    std::atomic<uint64_t> droppedFrames_{0};
+    std::atomic<size_t> peakFill_{0};
+    std::atomic<bool> writeFailed_{false};
+};
@@ -0,0 +1,24 @@
+#pragma once
+#include <string>
+#include "audioengine.h"
+#include "audiofile.h"
+
+// ===================== Offline Rendering =====================
+
+struct RenderOptions
+{
+    std::string inputPath;
+    std::string outputPath;
+    unsigned long blockFrames = 8192; // frames per engine call
+    AudioFormat rawFormat;            // used when the input is not a WAV file
+    std::string modelPath;            // optional amp model (.nam)
+    std::string impulsePath;          // optional cabinet impulse response (WAV)
+    std::string eventsPath;           // optional event script, timed from the first frame
+};
+
+// Streams the input file through the engine's chain as fast as possible and
+// writes the result. Prints the achieved realtime factor. Returns false on error.
+bool renderFile(AudioEngine& engine, const RenderOptions& options);
+
+// Parses "render" command-line arguments; returns false and prints usage on error
+bool parseRenderArgs(int argc, char** argv, RenderOptions& options);
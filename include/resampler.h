@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "alignedbuffer.h"
+
+// Band-limited resampler for a slowly varying ratio, as needed to follow the
+// drift between two device clocks. A Kaiser-windowed sinc is tabulated at
+// kPhases fractional positions; each output frame interpolates between the
+// two nearest phases and takes one SIMD dot product per channel over kTaps
+// input frames. The read position is fixed point, so the input a block
+// needs is known exactly before it is processed.
+class Resampler {
+public:
+    static constexpr size_t kTaps = 64; // a multiple of kDotLanes
+    static constexpr int kPhaseBits = 8;
+    static constexpr size_t kPhases = size_t(1) << kPhaseBits;
+
+    Resampler() = default;
+
+    Resampler(const Resampler&) = delete;
+    Resampler& operator=(const Resampler&) = delete;
+
+    // Not real-time safe. ratio is the nominal number of input frames per
+    // output frame and sets the cutoff; setRatio() may then move it by up to
+    // maxDeviation (relative). One process() call makes at most maxOutputFrames.
+    void prepare(int channels, double ratio, size_t maxOutputFrames, double maxDeviation = 0.01);
+
+    // ===================== Audio Thread =====================
+    // Forgets all input and restarts at the nominal ratio
+    void reset();
+
+    // Clamped to the range allowed by prepare()
+    void setRatio(double ratio);
+    double getRatio() const { return static_cast<double>(step_) / kOne; }
+    double getNominalRatio() const { return nominal_; }
+
+    // Input frames the next process() call consumes for outputFrames frames
+    size_t inputNeeded(size_t outputFrames) const;
+
+    // Consumes inputNeeded(outputFrames) interleaved input frames and writes
+    // outputFrames interleaved output frames
+    void process(const float* input, float* output, size_t outputFrames);
+
+    // Delay through the filter, in input frames
+    static constexpr double latency() { return kTaps / 2 - 1; }
+
+private:
+    static constexpr int kFractionBits = 32;
+    static constexpr uint64_t kOne = uint64_t(1) << kFractionBits;
+
+    int channels_ = 0;
+    double nominal_ = 1.0;
+    uint64_t minStep_ = kOne;
+    uint64_t maxStep_ = kOne;
+    uint64_t step_ = kOne;     // input frames per output frame
+    uint64_t position_ = 0;    // of the next output frame within the history
+    size_t filled_ = 0;        // input frames held in the history
+    size_t historyStride_ = 0; // floats per channel
+
+    AlignedBuffer phases_;      // kPhases + 1 rows of kTaps coefficients
+    AlignedBuffer differences_; // row p + 1 minus row p
+    AlignedBuffer history_;     // one row of input per channel
+    AlignedBuffer coefficients_;
+    std::vector<float*> planes_;
+};
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+
+// Real-time safety checks for debug and CI builds (cmake -DAMPLY_RT_GUARD=ON).
+// Code inside a RealtimeScope is an audio callback: memory allocation and
+// blocking calls made there - malloc/free, operator new/delete, mutex and
+// condition variable waits, sleeps, read/write and stdio output - are
+// reported on stderr with a backtrace, or abort the program when
+// AMPLY_RT_GUARD=abort is set in the environment. Other threads are not
+// affected. Without the option a RealtimeScope compiles to nothing.
+namespace rtguard
+{
+    // Scopes nest on a thread; the outermost one decides
+    void enter();
+    void leave();
+
+    // Violations seen on any thread so far; always 0 without the guard
+    uint64_t violations();
+
+    // Whether this build checks at all
+    constexpr bool enabled() {
+#ifdef AMPLY_RT_GUARD
+        return true;
+#else
+        return false;
+#endif
+    }
+}
+
+// Marks the calling thread as running an audio callback for its lifetime
+class RealtimeScope {
+public:
+#ifdef AMPLY_RT_GUARD
+    RealtimeScope() { rtguard::enter(); }
+    ~RealtimeScope() { rtguard::leave(); }
+#else
+    RealtimeScope() {} // user-provided, so an unused scope draws no warning
+#endif
+
+    RealtimeScope(const RealtimeScope&) = delete;
+    RealtimeScope& operator=(const RealtimeScope&) = delete;
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "alignedbuffer.h"
+#include "audiofile.h"
+#include "simd.h"
+
+// Converts one direction of a device stream between its native sample
+// encoding and the interleaved float the engine works in, with the SIMD
+// conversion kernels. Float32 streams pass straight through without a copy.
+// 16- and 24-bit output is dithered with TPDF noise so quiet passages fade
+// into noise rather than distortion; 32-bit output has nothing audible left
+// to dither.
+class SampleConverter {
+public:
+    SampleConverter() = default;
+
+    SampleConverter(const SampleConverter&) = delete;
+    SampleConverter& operator=(const SampleConverter&) = delete;
+
+    // Not real-time safe. One call converts at most maxFrames frames.
+    void prepare(SampleEncoding encoding, int channels, unsigned long maxFrames, bool dither = true);
+
+    SampleEncoding encoding() const { return encoding_; }
+    bool converts() const { return encoding_ != SampleEncoding::Float32; }
+    unsigned long maxFrames() const { return maxFrames_; }
+    // Bytes between consecutive frames of the device buffer
+    size_t frameBytes() const { return frameBytes_; }
+
+    // ===================== Audio Thread =====================
+    // Device input as float; valid until the next call
+    const float* read(const void* device, unsigned long frames);
+
+    // Where the engine should render output for the device buffer: the
+    // buffer itself for Float32, otherwise scratch that write() converts
+    float* target(void* device);
+    // Converts frames rendered into target(device) into the device buffer
+    void write(void* device, unsigned long frames);
+
+private:
+    SampleEncoding encoding_ = SampleEncoding::Float32;
+    int channels_ = 0;
+    unsigned long maxFrames_ = 0;
+    size_t frameBytes_ = 0;
+    bool dither_ = true;
+    const SimdKernels& kernels_ = simd();
+    AlignedBuffer scratch_;
+    uint32_t ditherState_[kDitherLanes] = {};
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include <map>
+#include <string>
+#include <vector>
+
+// ===================== Persistent Settings =====================
+
+// Plain "key = value" lines kept between runs, e.g. the tuned buffer size.
+// Lines starting with '#' are comments; unknown keys are preserved.
+class Settings {
+public:
+    // $AMPLY_SETTINGS if set, otherwise ~/.amply (%APPDATA%\amply.conf on Windows)
+    static std::string defaultPath();
+
+    // A missing file is not an error: it leaves the settings empty
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+
+    bool has(const std::string& key) const { return values_.count(key) != 0; }
+    std::string get(const std::string& key, const std::string& fallback = "") const;
+    double getDouble(const std::string& key, double fallback) const;
+    void set(const std::string& key, const std::string& value) { values_[key] = value; }
+    void set(const std::string& key, double value);
+    void remove(const std::string& key) { values_.erase(key); }
+    // Keys starting with prefix, in order
+    std::vector<std::string> keys(const std::string& prefix) const;
+    // Removes every key starting with prefix
+    void removePrefix(const std::string& prefix);
+
+    // Makes free text (e.g. a device name) safe to embed in a key
+    static std::string keyPart(std::string text);
+
+private:
+    std::map<std::string, std::string> values_;
+};
@@ -0,0 +1,102 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ===================== Kernel Table =====================
+
+// Core block operations. Every variant produces bit-identical output to the
+// scalar one (no FMA contraction, same NaN handling), so the choice of
+// instruction set never changes the sound.
+struct SimdKernels
+{
+    const char* name;
+
+    // data[i] *= gain
+    void (*multiply)(float* data, float gain, size_t count);
+    // data[i] *= ramp[i]
+    void (*multiplyRamp)(float* data, const float* ramp, size_t count);
+    // data[i] = min(max(data[i], lo), hi); NaN becomes hi
+    void (*clamp)(float* data, float lo, float hi, size_t count);
+    // dst[i] += src[i] * gain
+    void (*mix)(float* dst, const float* src, float gain, size_t count);
+    // Sum of a[i] * b[i]. Products go into kDotLanes running sums by
+    // i % kDotLanes, which are then added pairwise, so every variant adds in
+    // the same order.
+    float (*dot)(const float* a, const float* b, size_t count);
+    // Largest |data[i]|, 0 for an empty span; NaN samples are skipped
+    float (*peak)(const float* data, size_t count);
+    // A matrix stored column by column times a vector: acc[r] = bias[r] +
+    // the sum of w[j * stride + r] * x[j] for every row r < stride, where x
+    // is a's aCount values followed by b's bCount. stride is a multiple of
+    // kColumnLanes. Each row adds its products in column order, so every
+    // variant gives the same sums.
+    void (*matrixColumns)(float* acc, const float* bias, const float* w, size_t stride,
+                          const float* a, size_t aCount, const float* b, size_t bCount);
+
+    // Split frames of an interleaved buffer with the given stride into channels planar buffers
+    void (*deinterleave)(const float* in, int stride, float* const* out, int channels, size_t frames);
+    // Write channels planar buffers into an interleaved buffer with the given stride
+    void (*interleave)(const float* const* in, int channels, float* out, int stride, size_t frames);
+
+    // Device samples to float in [-1, 1): 16-bit, packed little-endian
+    // 24-bit (three bytes per sample) and 32-bit
+    void (*int16ToFloat)(const int16_t* in, float* out, size_t count);
+    void (*int24ToFloat)(const uint8_t* in, float* out, size_t count);
+    void (*int32ToFloat)(const int32_t* in, float* out, size_t count);
+    // Float to device samples, rounded to nearest and saturated; NaN becomes
+    // full scale. A non-null dither holds kDitherLanes generator states and
+    // adds TPDF noise of up to one LSB either side.
+    void (*floatToInt16)(const float* in, int16_t* out, size_t count, uint32_t* dither);
+    void (*floatToInt24)(const float* in, uint8_t* out, size_t count, uint32_t* dither);
+    void (*floatToInt32)(const float* in, int32_t* out, size_t count);
+};
+
+// Best variant for this CPU, chosen once on first use. AMPLY_SIMD=<name>
+// in the environment forces a specific variant if the CPU supports it.
+const SimdKernels& simd();
+
+// Every variant this build and CPU can run, scalar first
+std::vector<const SimdKernels*> availableSimdKernels();
+
+// ===================== Variant Tables =====================
+
+// Each returns nullptr when the variant was not compiled into this build
+const SimdKernels* scalarKernels();
+const SimdKernels* sse2Kernels();
+const SimdKernels* avx2Kernels();
+const SimdKernels* avx512Kernels();
+const SimdKernels* neonKernels();
+
+// Strided fallbacks shared by all variants for channel layouts they do not specialize
+void scalarDeinterleave(const float* in, int stride, float* const* out, int channels, size_t frames);
+void scalarInterleave(const float* const* in, int channels, float* out, int stride, size_t frames);
+
+// Scalar conversions, shared by all variants for tails and for formats they
+// do not specialize
+void scalarInt16ToFloat(const int16_t* in, float* out, size_t count);
+void scalarInt24ToFloat(const uint8_t* in, float* out, size_t count);
+void scalarInt32ToFloat(const int32_t* in, float* out, size_t count);
+void scalarFloatToInt16(const float* in, int16_t* out, size_t count, uint32_t* dither);
+void scalarFloatToInt24(const float* in, uint8_t* out, size_t count, uint32_t* dither);
+void scalarFloatToInt32(const float* in, int32_t* out, size_t count);
+
+// Dither generators: sample i of a call draws from state i % kDitherLanes,
+// which steps a 32-bit LCG twice and sums the top 16 bits of both steps, so
+// every variant makes the same noise whatever its vector width. Variants
+// work in groups of kDitherLanes samples and leave the rest to the scalar
+// conversion.
+constexpr size_t kDitherLanes = 16;
+constexpr uint32_t kDitherMultiplier = 1664525u;
+constexpr uint32_t kDitherIncrement = 1013904223u;
+
+// Running sums used by every dot variant
+constexpr size_t kDotLanes = 16;
+// Rows of a matrixColumns stride come in groups of this many: one cache line
+constexpr size_t kColumnLanes = 16;
+// Adds the products from index `from` onwards into the running sums, then
+// reduces them; finishes every dot variant
+float finishDot(float* sums, const float* a, const float* b, size_t from, size_t count);
+// Folds lanes running maxima and the samples from index `from` onwards into
+// one peak; finishes every peak variant
+float finishPeak(const float* lanes, size_t laneCount, const float* data, size_t from, size_t count);
@@ -0,0 +1,82 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+#include "audiobackend.h"
+
+// Drives the callback from a virtual clock instead of a sound card, so
+// latency, xrun and load behaviour can be reproduced on machines without
+// audio hardware. Each period the simulated device wakes the callback late
+// by a seeded random jitter; if jitter plus processing time overruns the
+// period, the deadline is missed and handled according to the miss policy.
+class SimulatedBackend : public AudioBackend {
+public:
+    enum class MissPolicy {
+        Silence, // the late block is dropped and the device plays silence
+        Slip     // the late block is played and the clock slips by the overrun
+    };
+
+    struct Options {
+        unsigned long defaultFrames = 256; // used when the config leaves framesPerBuffer at 0
+        double jitter = 0.0;               // largest wake-up delay, as a fraction of the period
+        double wakeLatency = 0.0;          // fixed wake-up delay in seconds, e.g. scheduler latency
+        double modelLoad = -1.0;           // processing time as a fraction of the period; < 0 measures it
+        MissPolicy policy = MissPolicy::Silence;
+        bool pace = false;                 // keep the virtual clock in step with the wall clock
+        uint32_t seed = 1;
+        float toneFrequency = 110.0f;      // input test tone in Hz; 0 feeds silence
+        float toneLevel = 0.25f;
+    };
+
+    SimulatedBackend();
+    explicit SimulatedBackend(const Options& options);
+    ~SimulatedBackend() override;
+
+    SimulatedBackend(const SimulatedBackend&) = delete;
+    SimulatedBackend& operator=(const SimulatedBackend&) = delete;
+
+    const char* name() const override { return "Simulated"; }
+
+    bool isFormatSupported(const StreamConfig& config) override;
+    bool open(const StreamConfig& config, AudioCallback* callback) override;
+    // Runs blocks on a background thread until close()
+    bool start() override;
+    void close() override;
+    bool isOpen() const override { return open_; }
+
+    // Runs count blocks on the calling thread; the stream must be open and not started
+    void runBlocks(uint64_t count);
+
+    // ===================== Results =====================
+    // Valid after runBlocks(), or after close() for a started stream
+    uint64_t blocks() const { return blocks_.load(); }
+    uint64_t missedDeadlines() const { return missed_.load(); }
+    double virtualSeconds() const { return virtualTime_; }
+    float outputPeak() const { return outputPeak_; }
+    unsigned long framesPerBuffer() const { return frames_; }
+
+private:
+    void runBlock();
+
+    Options options_;
+    StreamConfig config_;
+    AudioCallback* callback_ = nullptr;
+    bool open_ = false;
+    unsigned long frames_ = 0;
+
+    std::vector<float> input_;
+    std::vector<float> output_;
+    std::mt19937 random_;
+    double phase_ = 0.0;
+
+    double virtualTime_ = 0.0;   // seconds of device time elapsed
+    unsigned pendingFlags_ = 0;  // reported with the next block, as real drivers do
+    float outputPeak_ = 0.0f;
+    std::atomic<uint64_t> blocks_{0};
+    std::atomic<uint64_t> missed_{0};
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+};
@@ -0,0 +1,26 @@
+#pragma once
+#include <string>
+#include "audioengine.h"
+#include "simulatedbackend.h"
+
+// ===================== Simulated Streaming =====================
+
+struct SimulateOptions
+{
+    StreamConfig config;               // rate, channels and frames per buffer
+    SimulatedBackend::Options backend; // jitter, load model and miss policy
+    double seconds = 10.0;             // simulated stream length
+    long maxXruns = -1;                // fail when more deadlines are missed; < 0 disables
+    std::string modelPath;             // optional amp model (.nam)
+    std::string impulsePath;           // optional cabinet impulse response (WAV)
+    int workers = 0;                   // parallel worker threads
+    bool tune = false;                 // run the autotuner, soaking each step for seconds
+};
+
+// Runs the engine's chain against the simulated driver and prints the
+// stream statistics, or the autotuner's steps when tuning. Returns false on
+// error, when maxXruns is exceeded or when tuning finds no stable buffer.
+bool runSimulation(AudioEngine& engine, const SimulateOptions& options);
+
+// Parses "simulate" command-line arguments; returns false and prints usage on error
+bool parseSimulateArgs(int argc, char** argv, SimulateOptions& options);
@@ -0,0 +1,82 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+// Single-producer, single-consumer FIFO of floats. One thread writes and one
+// reads; neither ever blocks, locks or allocates. Sized off the audio threads.
+class SpscRing {
+public:
+    SpscRing() = default;
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Not real-time safe, and neither side may be running. Rounds capacity
+    // up to a power of two and empties the ring.
+    void resize(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity)
+            size *= 2;
+        buffer_.assign(size, 0.0f);
+        mask_ = size - 1;
+        write_.store(0, std::memory_order_relaxed);
+        read_.store(0, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const { return buffer_.size(); }
+
+    // Either side; exact for the caller's own side, a lower bound for the other
+    size_t readable() const {
+        return write_.load(std::memory_order_acquire) - read_.load(std::memory_order_acquire);
+    }
+    size_t writable() const { return capacity() - readable(); }
+
+    // ===================== Producer =====================
+    // All or nothing: returns false and writes nothing if count does not fit
+    bool write(const float* data, size_t count) {
+        size_t write = write_.load(std::memory_order_relaxed);
+        if (count > capacity() - (write - read_.load(std::memory_order_acquire)))
+            return false;
+
+        size_t start = write & mask_;
+        size_t first = count < capacity() - start ? count : capacity() - start;
+        std::memcpy(buffer_.data() + start, data, first * sizeof(float));
+        std::memcpy(buffer_.data(), data + first, (count - first) * sizeof(float));
+        write_.store(write + count, std::memory_order_release);
+        return true;
+    }
+
+    // ===================== Consumer =====================
+    // All or nothing: returns false and reads nothing if count is not available
+    bool read(float* data, size_t count) {
+        size_t read = read_.load(std::memory_order_relaxed);
+        if (count > write_.load(std::memory_order_acquire) - read)
+            return false;
+
+        size_t start = read & mask_;
+        size_t first = count < capacity() - start ? count : capacity() - start;
+        std::memcpy(data, buffer_.data() + start, first * sizeof(float));
+        std::memcpy(data + first, buffer_.data(), (count - first) * sizeof(float));
+        read_.store(read + count, std::memory_order_release);
+        return true;
+    }
+
+    // Drops up to count of the oldest values; returns how many were dropped
+    size_t discard(size_t count) {
+        size_t read = read_.load(std::memory_order_relaxed);
+        size_t available = write_.load(std::memory_order_acquire) - read;
+        if (count > available)
+            count = available;
+        read_.store(read + count, std::memory_order_release);
+        return count;
+    }
+
+private:
+    std::vector<float> buffer_;
+    size_t mask_ = 0;
+    // Free-running counters on separate cache lines; only their difference matters
+    alignas(64) std::atomic<size_t> write_{0};
+    alignas(64) std::atomic<size_t> read_{0};
+};
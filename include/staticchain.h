@@ -0,0 +1,186 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "effect.h"
+
+// ===================== Fusable Effects =====================
+
+// Effects opt in to fusion with "static constexpr bool fusable = true", a
+// canFuse() that says whether this block can run fused and a
+// visitStage(fn) that calls fn with a per-sample Stage for it: a small
+// struct whose tick(x) gives what process() gives, bit for bit, so fused
+// and dynamic chains produce identical output. Stages only ever see steady
+// parameters: a member that is ramping answers canFuse() with false and
+// runs its own block process() for that block, so no ramp lookups or
+// selects end up in the fused loop.
+template <typename T, typename = void>
+struct IsFusable : std::false_type {};
+
+template <typename T>
+struct IsFusable<T, std::void_t<decltype(T::fusable)>> : std::bool_constant<T::fusable> {};
+
+// ===================== Fused Loop =====================
+
+// The loop is compiled once per x86 instruction set the SIMD kernels
+// dispatch to, so the waveshaping curves run as wide as the kernels do.
+// staticchain.cpp, where every StaticChain is instantiated, is built
+// without FP contraction like the kernels, so every width rounds the same.
+#if defined(AMPLY_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define AMPLY_FUSED_X86 1
+#define AMPLY_FUSED_INLINE inline __attribute__((always_inline))
+#else
+#define AMPLY_FUSED_INLINE inline
+#endif
+
+namespace fused
+{
+    enum class Isa {
+        Baseline,
+        Avx2,
+        Avx512
+    };
+
+    // The widest variant the selected SIMD kernels use
+    Isa selectIsa();
+
+    template <typename... Stages>
+    AMPLY_FUSED_INLINE void loop(float* samples, unsigned long frameCount, Stages... stages) {
+        for (unsigned long i = 0; i < frameCount; i++)
+        {
+            float x = samples[i];
+            ((x = stages.tick(x)), ...);
+            samples[i] = x;
+        }
+    }
+
+#ifdef AMPLY_FUSED_X86
+    template <typename... Stages>
+    __attribute__((target("avx2"))) void loopAvx2(float* samples, unsigned long frameCount, Stages... stages) {
+        loop(samples, frameCount, stages...);
+    }
+
+    template <typename... Stages>
+    __attribute__((target("avx512f"))) void loopAvx512(float* samples, unsigned long frameCount, Stages... stages) {
+        loop(samples, frameCount, stages...);
+    }
+#endif
+
+    template <typename... Stages>
+    void run(Isa isa, float* samples, unsigned long frameCount, const Stages&... stages) {
+#ifdef AMPLY_FUSED_X86
+        if (isa == Isa::Avx512)
+            return loopAvx512(samples, frameCount, stages...);
+        if (isa == Isa::Avx2)
+            return loopAvx2(samples, frameCount, stages...);
+#endif
+        (void)isa;
+        loop(samples, frameCount, stages...);
+    }
+}
+
+// ===================== Static Chain =====================
+
+// What the dynamic chain sees of a StaticChain: the effects it runs, so a
+// new chain snapshot can keep a fused run whose members have not changed
+class FusedEffect : public Effect {
+public:
+    const std::vector<Effect*>& members() const { return members_; }
+
+protected:
+    std::vector<Effect*> members_;
+};
+
+// A fixed sequence of concrete effect types run as one Effect. Consecutive
+// fusable members become a single pass over the block; other members, and
+// fusable ones that cannot fuse this block, run their own process() without
+// virtual dispatch. The members stay shared with the dynamic chain, so
+// parameters, state, bypass and preparation are exactly those of the
+// effects it wraps.
+template <typename... Effects>
+class StaticChain : public FusedEffect {
+public:
+    explicit StaticChain(std::shared_ptr<Effects>... effects)
+        : effects_(std::move(effects)...), isa_(fused::selectIsa()) {
+        std::apply([&](const auto&... effect) { members_ = {effect.get()...}; }, effects_);
+    }
+
+    const char* name() const override { return "Fused chain"; }
+
+    // Members are prepared individually when they join the engine
+    void prepare(const ProcessSpec& spec) override {}
+
+    // The engine latches bypass on the members themselves
+    void beginBlock(unsigned long frameCount) override {
+        std::apply([&](auto&... effect) { (beginMember(*effect, frameCount), ...); }, effects_);
+    }
+
+    void process(float* samples, unsigned long frameCount, int channel) override {
+        run<0>(samples, frameCount, channel);
+    }
+
+    unsigned long tailFrames() const override {
+        unsigned long tail = 0;
+        std::apply([&](const auto&... effect) { ((tail = addTailFrames(tail, effect->tailFrames())), ...); }, effects_);
+        return tail;
+    }
+
+private:
+    template <typename T>
+    static void beginMember(T& effect, unsigned long frameCount) {
+        if (!effect.blockBypassed())
+            effect.T::beginBlock(frameCount);
+    }
+
+    // Walks the members in order, collecting the stages of consecutive
+    // fusable members and flushing them as one pass before any other runs
+    template <size_t I, typename... Stages>
+    void run(float* samples, unsigned long frameCount, int channel, const Stages&... stages) {
+        if constexpr (I == sizeof...(Effects))
+            flush(samples, frameCount, stages...);
+        else
+        {
+            using T = std::tuple_element_t<I, std::tuple<Effects...>>;
+            T& effect = *std::get<I>(effects_);
+
+            if (effect.blockBypassed())
+                return run<I + 1>(samples, frameCount, channel, stages...);
+
+            if constexpr (IsFusable<T>::value)
+            {
+                if (effect.canFuse())
+                {
+                    effect.visitStage([&](const auto& stage) { run<I + 1>(samples, frameCount, channel, stages..., stage); });
+                    return;
+                }
+            }
+
+            flush(samples, frameCount, stages...);
+            effect.T::process(samples, frameCount, channel);
+            run<I + 1>(samples, frameCount, channel);
+        }
+    }
+
+    template <typename... Stages>
+    void flush(float* samples, unsigned long frameCount, const Stages&... stages) {
+        if constexpr (sizeof...(Stages) > 0)
+            fused::run(isa_, samples, frameCount, stages...);
+    }
+
+    std::tuple<std::shared_ptr<Effects>...> effects_;
+    fused::Isa isa_;
+};
+
+// ===================== Preset Matching =====================
+
+// Replaces runs of effects matching one of the standard presets (gain,
+// drive, cab and their sub-sequences) with a StaticChain specialization.
+// A run already fused in previous (the processors of the snapshot being
+// replaced) is taken over as it is, so each preset is matched and built once
+// when it enters the chain. Unmatched effects are returned as they are. Not
+// real-time safe.
+std::vector<std::shared_ptr<Effect>> fuseEffects(const std::vector<std::shared_ptr<Effect>>& effects,
+                                                 const std::vector<std::shared_ptr<Effect>>& previous);
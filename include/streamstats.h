@@ -0,0 +1,117 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// ===================== Stream Statistics =====================
+
+// Health counters for the audio callback. The audio thread is the only writer
+// and touches nothing but relaxed atomics, so recording never blocks or
+// allocates; any thread may take a snapshot.
+class StreamStats {
+public:
+    // Status reported by the audio device for a block
+    enum Flags : unsigned {
+        InputUnderflow = 1 << 0,
+        InputOverflow = 1 << 1,
+        OutputUnderflow = 1 << 2,
+        OutputOverflow = 1 << 3,
+        PrimingOutput = 1 << 4
+    };
+
+    // Load histogram buckets: 10% steps of the buffer period, the last one
+    // collecting every block that overran its deadline
+    static constexpr int kLoadBuckets = 11;
+
+    struct Block {
+        unsigned long frames = 0;
+        double sampleRate = 0.0;
+        double processSeconds = 0.0; // time spent producing the block
+        unsigned flags = 0;
+        double inputLatency = 0.0;  // seconds from capture to callback, 0 if unknown
+        double outputLatency = 0.0; // seconds from callback to playback, 0 if unknown
+    };
+
+    struct Snapshot {
+        uint64_t blocks = 0;
+        uint64_t frames = 0;
+        uint64_t inputUnderflows = 0;
+        uint64_t inputOverflows = 0;
+        uint64_t outputUnderflows = 0;
+        uint64_t outputOverflows = 0;
+        uint64_t primingBlocks = 0;
+        double averageLoad = 0.0; // processing time / buffer period
+        double peakLoad = 0.0;
+        double peakProcessMs = 0.0;
+        double inputLatencyMs = 0.0; // most recent block
+        double outputLatencyMs = 0.0;
+        std::array<uint64_t, kLoadBuckets> loadHistogram{};
+    };
+
+    StreamStats();
+
+    // ===================== Audio Thread =====================
+    void record(const Block& block);
+
+    // ===================== Any Thread =====================
+    Snapshot snapshot() const;
+
+    // Counters are cleared by the audio thread at its next block
+    void reset() { resetPending_.store(true, std::memory_order_relaxed); }
+
+private:
+    void clear();
+
+    std::atomic<bool> resetPending_;
+    std::atomic<uint64_t> blocks_;
+    std::atomic<uint64_t> frames_;
+    std::atomic<uint64_t> inputUnderflows_;
+    std::atomic<uint64_t> inputOverflows_;
+    std::atomic<uint64_t> outputUnderflows_;
+    std::atomic<uint64_t> outputOverflows_;
+    std::atomic<uint64_t> primingBlocks_;
+    std::atomic<uint64_t> processNanos_; // summed, for the average load
+    std::atomic<uint64_t> periodNanos_;
+    std::atomic<uint64_t> peakLoadPpm_;
+    std::atomic<uint64_t> peakProcessNanos_;
+    std::atomic<uint64_t> inputLatencyMicros_;
+    std::atomic<uint64_t> outputLatencyMicros_;
+    std::array<std::atomic<uint64_t>, kLoadBuckets> loadHistogram_;
+};
+
+// Human-readable summary, as shown by the stats command
+void printStats(std::ostream& out, const StreamStats::Snapshot& s);
+
+// ===================== Periodic Export =====================
+
+// Appends a snapshot to a file at a fixed interval from its own thread.
+// Files ending in .json or .jsonl get JSON Lines; anything else gets CSV.
+class StatsExporter {
+public:
+    StatsExporter() = default;
+    ~StatsExporter();
+
+    StatsExporter(const StatsExporter&) = delete;
+    StatsExporter& operator=(const StatsExporter&) = delete;
+
+    bool start(const StreamStats& stats, const std::string& path, double intervalSeconds);
+    void stop();
+    bool running() const { return thread_.joinable(); }
+
+private:
+    void run(const StreamStats* stats, double intervalSeconds);
+    void writeLine(const StreamStats::Snapshot& s, double elapsed);
+
+    std::ofstream file_;
+    bool json_ = false;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+};
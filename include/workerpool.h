@@ -0,0 +1,84 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Runs a block's independent tasks (one per channel) across a set of pinned
+// worker threads and the calling audio thread. Each participant starts on
+// its own slice of the tasks and steals from the others once it runs dry, so
+// a worker that wakes late simply has its share taken over by the caller.
+// Workers spin briefly between blocks, then yield, then poll with short
+// sleeps; the audio thread never makes a system call to wake them. They run
+// at the audio thread's priority once told it, so the caller waiting on a
+// task in flight is never waiting on a thread the scheduler put behind it.
+class WorkerPool {
+public:
+    using Task = void (*)(void* context, size_t index);
+
+    // Not real-time safe. pin: bind each worker to its own core where supported.
+    explicit WorkerPool(int workers, bool pin = true);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    int workers() const { return static_cast<int>(threads_.size()); }
+
+    // Any thread. Workers take on the calling audio thread's FIFO priority
+    // (0 leaves theirs) and denormal mode at their next poll, making the
+    // system calls themselves.
+    void followCaller(int priority, bool flushDenormals);
+
+    // ===================== Audio Thread =====================
+    // Runs task(context, i) for i in [0, count) and returns once all are
+    // done. Returns false without running anything while the pool is in its
+    // serial fallback; the caller then processes the tasks itself.
+    bool run(size_t count, Task task, void* context);
+
+    // ===================== Statistics =====================
+    // Blocks where a worker had not picked up any of its slice in time
+    uint64_t missedSlots() const { return missedSlots_.load(std::memory_order_relaxed); }
+    // Times the pool dropped to serial processing after repeated misses
+    uint64_t fallbacks() const { return fallbacks_.load(std::memory_order_relaxed); }
+    bool inFallback() const { return fallbackBlocks_.load(std::memory_order_relaxed) > 0; }
+
+    // Consecutive missed blocks before falling back, and blocks spent serial
+    static constexpr int kMissesBeforeFallback = 8;
+    static constexpr int kFallbackBlocks = 1024;
+
+private:
+    // Generation, next task and end of one participant's slice, packed so a
+    // claim is a single compare-and-swap that fails for stale generations
+    struct alignas(64) Slice {
+        std::atomic<uint64_t> state{0};
+        size_t first = 0; // start of the slice as handed out
+    };
+
+    void workerLoop(size_t self);
+    void participate(size_t self, uint64_t generation, Task task, void* context);
+    bool claim(size_t slice, uint64_t generation, bool fromBack, size_t& index);
+
+    std::vector<std::thread> threads_;
+    std::unique_ptr<Slice[]> slices_; // [0] is the caller's
+    size_t participants_;
+
+    std::atomic<uint64_t> generation_{0};
+    std::atomic<Task> task_{nullptr};
+    std::atomic<void*> context_{nullptr};
+    std::atomic<size_t> completed_{0};
+    std::atomic<bool> sliceStolen_{false}; // a whole slice was taken from its owner
+    std::atomic<bool> quit_{false};
+
+    // Scheduling to follow; a new sequence number tells workers to apply it
+    std::atomic<int> callerPriority_{0};
+    std::atomic<bool> callerFlushDenormals_{false};
+    std::atomic<uint32_t> callerSequence_{0};
+
+    int consecutiveMisses_ = 0; // audio thread only
+    std::atomic<int> fallbackBlocks_{0};
+    std::atomic<uint64_t> missedSlots_{0};
+    std::atomic<uint64_t> fallbacks_{0};
+};
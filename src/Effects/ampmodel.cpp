@@ -0,0 +1,369 @@
+#include "Effects/ampmodel.h"
+#include "fastmath.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <utility>
+
+// ===================== Layout =====================
+
+// Read-only after prepare(), shared by every channel
+struct AmpModelEffect::Layer
+{
+    size_t inputs = 0;
+    ArenaArray<float> weights;    // inputs + H columns of stride_ floats, input columns first
+    ArenaArray<float> bias;       // LSTM: b; GRU: b_ih
+    ArenaArray<float> hiddenBias; // GRU: b_hh
+    ArenaArray<float> initialHidden, initialCell;
+};
+
+// Recurrent state and scratch of one channel
+struct AmpModelEffect::Channel
+{
+    ArenaArray<float> hidden; // H per layer
+    ArenaArray<float> cell;   // LSTM only
+    ArenaArray<float> gates, hiddenGates;
+};
+
+namespace
+{
+    // A weight column's rows come a cache line at a time
+    static_assert(kColumnLanes * sizeof(float) == Arena::kAlignment, "columns are padded to cache lines");
+
+    constexpr size_t gateCount(AmpModel::Cell cell)
+    {
+        return cell == AmpModel::Cell::Lstm ? 4 : 3;
+    }
+
+    // Gate rows rounded up to whole cache lines
+    constexpr size_t columnStride(AmpModel::Cell cell, size_t hidden)
+    {
+        return (gateCount(cell) * hidden + kColumnLanes - 1) / kColumnLanes * kColumnLanes;
+    }
+
+    inline float sigmoid(float x)
+    {
+        return 1.0f / (1.0f + fastmath::exp(-x));
+    }
+
+    // One step of an LSTM layer: h and c advance in place
+    inline void lstmStep(const SimdKernels &kernels, const float *w, const float *bias, size_t stride,
+                         const float *input, size_t inputs, size_t H, float *h, float *c, float *acc)
+    {
+        kernels.matrixColumns(acc, bias, w, stride, input, inputs, h, H);
+
+        // A line of units at a time through locals: the compiler then sees
+        // that the state never overlaps the gates and vectorizes for any H
+        for (size_t k0 = 0; k0 < H; k0 += kColumnLanes)
+        {
+            const size_t n = std::min(kColumnLanes, H - k0);
+            float i[kColumnLanes], f[kColumnLanes], g[kColumnLanes], o[kColumnLanes];
+            for (size_t k = 0; k < n; k++)
+            {
+                i[k] = sigmoid(acc[k0 + k]);
+                f[k] = sigmoid(acc[H + k0 + k]);
+                g[k] = fastmath::tanh(acc[2 * H + k0 + k]);
+                o[k] = sigmoid(acc[3 * H + k0 + k]);
+            }
+            for (size_t k = 0; k < n; k++)
+            {
+                const float cell = f[k] * c[k0 + k] + i[k] * g[k];
+                c[k0 + k] = cell;
+                h[k0 + k] = o[k] * fastmath::tanh(cell);
+            }
+        }
+    }
+
+    // One step of a GRU layer; the candidate gate needs the hidden part on its own
+    inline void gruStep(const SimdKernels &kernels, const float *w, const float *bias, const float *hiddenBias,
+                        size_t stride, const float *input, size_t inputs, size_t H, float *h, float *acc,
+                        float *hiddenAcc)
+    {
+        kernels.matrixColumns(acc, bias, w, stride, input, inputs, nullptr, 0);
+        kernels.matrixColumns(hiddenAcc, hiddenBias, w + inputs * stride, stride, h, H, nullptr, 0);
+
+        for (size_t k = 0; k < H; k++)
+        {
+            const float r = sigmoid(acc[k] + hiddenAcc[k]);
+            const float z = sigmoid(acc[H + k] + hiddenAcc[H + k]);
+            const float n = fastmath::tanh(acc[2 * H + k] + r * hiddenAcc[2 * H + k]);
+            h[k] = (1.0f - z) * n + z * h[k];
+        }
+    }
+
+    // ===================== .nam Parsing =====================
+
+    // Start of the value after "key": in text, or npos
+    size_t findValue(const std::string &text, const std::string &key)
+    {
+        size_t pos = text.find("\"" + key + "\"");
+        if (pos == std::string::npos)
+            return pos;
+        pos = text.find_first_not_of(" \t\r\n", pos + key.size() + 2);
+        if (pos == std::string::npos || text[pos] != ':')
+            return std::string::npos;
+        return text.find_first_not_of(" \t\r\n", pos + 1);
+    }
+
+    bool readNumber(const std::string &text, const std::string &key, double &value)
+    {
+        size_t pos = findValue(text, key);
+        if (pos == std::string::npos)
+            return false;
+        char *end = nullptr;
+        value = std::strtod(text.c_str() + pos, &end);
+        return end != text.c_str() + pos;
+    }
+
+    bool readString(const std::string &text, const std::string &key, std::string &value)
+    {
+        size_t pos = findValue(text, key);
+        if (pos == std::string::npos || text[pos] != '"')
+            return false;
+        size_t end = text.find('"', pos + 1);
+        if (end == std::string::npos)
+            return false;
+        value = text.substr(pos + 1, end - pos - 1);
+        return true;
+    }
+
+    bool readArray(const std::string &text, const std::string &key, std::vector<float> &values)
+    {
+        size_t pos = findValue(text, key);
+        if (pos == std::string::npos || text[pos] != '[')
+            return false;
+
+        values.clear();
+        const char *p = text.c_str() + pos + 1;
+        while (true)
+        {
+            while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n' || *p == ',')
+                p++;
+            if (*p == ']')
+                return true;
+            char *end = nullptr;
+            float value = std::strtof(p, &end);
+            if (end == p)
+                return false;
+            values.push_back(value);
+            p = end;
+        }
+    }
+}
+
+// ===================== Model =====================
+size_t AmpModel::weightCount(Cell cell, int layers, int hiddenSize)
+{
+    const size_t H = static_cast<size_t>(hiddenSize);
+    const size_t rows = gateCount(cell) * H;
+    size_t count = 0;
+    for (int l = 0; l < layers; l++)
+    {
+        const size_t inputs = l == 0 ? 1 : H;
+        count += rows * (inputs + H) + rows;
+        count += cell == Cell::Lstm ? 2 * H : rows + H;
+    }
+    return count + H + 1;
+}
+
+bool AmpModel::load(const std::string &path, AmpModel &model)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cerr << "[Error] Could not open model file: " << path << "\n";
+        return false;
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+    const std::string text = contents.str();
+
+    std::string architecture;
+    double layers = 0.0, inputSize = 1.0, hiddenSize = 0.0;
+    if (!readString(text, "architecture", architecture) || !readNumber(text, "num_layers", layers) ||
+        !readNumber(text, "hidden_size", hiddenSize) || !readArray(text, "weights", model.weights))
+    {
+        std::cerr << "[Error] Not a readable .nam model: " << path << "\n";
+        return false;
+    }
+    readNumber(text, "input_size", inputSize);
+
+    if (architecture == "LSTM")
+        model.cell = Cell::Lstm;
+    else if (architecture == "GRU")
+        model.cell = Cell::Gru;
+    else
+    {
+        std::cerr << "[Error] Unsupported model architecture '" << architecture << "' (LSTM and GRU only)\n";
+        return false;
+    }
+
+    if (inputSize != 1.0 || layers < 1.0 || layers > 8.0 || hiddenSize < 1.0 || hiddenSize > 256.0)
+    {
+        std::cerr << "[Error] Unsupported model size: " << layers << " layers of " << hiddenSize
+                  << " with " << inputSize << " inputs\n";
+        return false;
+    }
+    model.layers = static_cast<int>(layers);
+    model.hiddenSize = static_cast<int>(hiddenSize);
+
+    size_t expected = weightCount(model.cell, model.layers, model.hiddenSize);
+    if (model.weights.size() != expected)
+    {
+        std::cerr << "[Error] Model has " << model.weights.size() << " weights, expected " << expected << "\n";
+        return false;
+    }
+
+    // Captures are trained at 48 kHz unless the file says otherwise
+    model.sampleRate = 48000.0;
+    readNumber(text, "sample_rate", model.sampleRate);
+    return true;
+}
+
+// ===================== Constructor / Destructor =====================
+AmpModelEffect::AmpModelEffect(AmpModel model)
+    : model_(std::move(model)), kernels_(simd())
+{
+    // A malformed model plays silence rather than reading past its weights
+    model_.weights.resize(AmpModel::weightCount(model_.cell, model_.layers, model_.hiddenSize), 0.0f);
+}
+
+AmpModelEffect::~AmpModelEffect() = default;
+
+std::shared_ptr<AmpModelEffect> AmpModelEffect::load(const std::string &path)
+{
+    AmpModel model;
+    if (!AmpModel::load(path, model))
+        return nullptr;
+    return std::make_shared<AmpModelEffect>(std::move(model));
+}
+
+// ===================== Preparation =====================
+void AmpModelEffect::prepare(const ProcessSpec &spec)
+{
+    const AmpModel::Cell cell = model_.cell;
+    const size_t H = static_cast<size_t>(model_.hiddenSize);
+    const size_t rows = gateCount(cell) * H;
+    stride_ = columnStride(cell, H);
+
+    channels_.clear();
+    layers_.clear();
+    arena_.clear();
+
+    // Row-major gate matrices become padded columns
+    const float *w = model_.weights.data();
+    for (int l = 0; l < model_.layers; l++)
+    {
+        Layer layer;
+        layer.inputs = l == 0 ? 1 : H;
+        const size_t columns = layer.inputs + H;
+
+        layer.weights = arena_.allocate<float>(columns * stride_);
+        for (size_t r = 0; r < rows; r++)
+        {
+            for (size_t j = 0; j < columns; j++)
+                layer.weights[j * stride_ + r] = *w++;
+        }
+
+        layer.bias = arena_.allocate<float>(stride_);
+        std::copy(w, w + rows, layer.bias.data());
+        w += rows;
+        if (cell == AmpModel::Cell::Gru)
+        {
+            layer.hiddenBias = arena_.allocate<float>(stride_);
+            std::copy(w, w + rows, layer.hiddenBias.data());
+            w += rows;
+        }
+
+        layer.initialHidden = arena_.allocate<float>(H);
+        std::copy(w, w + H, layer.initialHidden.data());
+        w += H;
+        if (cell == AmpModel::Cell::Lstm)
+        {
+            layer.initialCell = arena_.allocate<float>(H);
+            std::copy(w, w + H, layer.initialCell.data());
+            w += H;
+        }
+
+        layers_.push_back(layer);
+    }
+
+    headWeights_ = arena_.allocate<float>(H);
+    std::copy(w, w + H, headWeights_.data());
+    headBias_ = w[H];
+
+    for (int c = 0; c < spec.channelCount; c++)
+    {
+        auto ch = std::make_unique<Channel>();
+        ch->hidden = arena_.allocate<float>(layers_.size() * H);
+        if (cell == AmpModel::Cell::Lstm)
+            ch->cell = arena_.allocate<float>(layers_.size() * H);
+        for (size_t l = 0; l < layers_.size(); l++)
+        {
+            std::copy(layers_[l].initialHidden.begin(), layers_[l].initialHidden.end(), ch->hidden.data() + l * H);
+            if (cell == AmpModel::Cell::Lstm)
+                std::copy(layers_[l].initialCell.begin(), layers_[l].initialCell.end(), ch->cell.data() + l * H);
+        }
+
+        ch->gates = arena_.allocate<float>(stride_);
+        if (cell == AmpModel::Cell::Gru)
+            ch->hiddenGates = arena_.allocate<float>(stride_);
+        channels_.push_back(std::move(ch));
+    }
+
+    runner_ = cell == AmpModel::Cell::Lstm ? &run<AmpModel::Cell::Lstm> : &run<AmpModel::Cell::Gru>;
+}
+
+// ===================== Processing =====================
+
+template <AmpModel::Cell C>
+void AmpModelEffect::run(const AmpModelEffect &effect, Channel &ch, float *samples, unsigned long frameCount)
+{
+    const size_t H = static_cast<size_t>(effect.model_.hiddenSize);
+    const size_t stride = effect.stride_;
+    const size_t layers = effect.layers_.size();
+    const float *head = effect.headWeights_.data();
+
+    for (unsigned long i = 0; i < frameCount; i++)
+    {
+        const float x = samples[i];
+        const float *input = &x;
+        for (size_t l = 0; l < layers; l++)
+        {
+            const Layer &layer = effect.layers_[l];
+            float *h = ch.hidden.data() + l * H;
+            if constexpr (C == AmpModel::Cell::Lstm)
+            {
+                float *c = ch.cell.data() + l * H;
+                if (l == 0)
+                    lstmStep(effect.kernels_, layer.weights.data(), layer.bias.data(), stride, input, 1, H, h, c, ch.gates.data());
+                else
+                    lstmStep(effect.kernels_, layer.weights.data(), layer.bias.data(), stride, input, H, H, h, c, ch.gates.data());
+            }
+            else
+            {
+                if (l == 0)
+                    gruStep(effect.kernels_, layer.weights.data(), layer.bias.data(), layer.hiddenBias.data(), stride, input, 1, H,
+                            h, ch.gates.data(), ch.hiddenGates.data());
+                else
+                    gruStep(effect.kernels_, layer.weights.data(), layer.bias.data(), layer.hiddenBias.data(), stride, input, H, H,
+                            h, ch.gates.data(), ch.hiddenGates.data());
+            }
+            input = h;
+        }
+
+        float y = effect.headBias_;
+        for (size_t k = 0; k < H; k++)
+            y += head[k] * input[k];
+        samples[i] = y;
+    }
+}
+
+void AmpModelEffect::process(float *samples, unsigned long frameCount, int channel)
+{
+    if (channel < static_cast<int>(channels_.size()))
+        runner_(*this, *channels_[channel], samples, frameCount);
+}
@@ -0,0 +1,476 @@
+#include "Effects/convolution.h"
+#include "audiofile.h"
+#include "fft.h"
+#include "resampler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+// ===================== Per-Channel State =====================
+
+// Everything one channel needs, so channels never share scratch memory. The
+// arrays live in the effect's arena.
+struct ConvolutionEffect::Channel
+{
+    // Head: direct FIR over the newest samples
+    ArenaArray<float> headTaps; // reversed, so taps line up with history
+    ArenaArray<float> history;  // kHeadTaps - 1 old samples + the current span
+
+    // Body: uniformly partitioned overlap-save, one partition per kHeadTaps samples
+    std::unique_ptr<Fft> bodyFft;
+    size_t bodyPartitions = 0;
+    ArenaArray<float> bodyRe, bodyIm; // filter spectra, partition-major
+    ArenaArray<float> bodyFdlRe, bodyFdlIm; // input spectra, newest at bodyFdlPos
+    size_t bodyFdlPos = 0;
+    ArenaArray<float> bodyInput;  // previous block + block being filled
+    ArenaArray<float> bodyOutput; // block being played out
+    ArenaArray<float> bodyAccRe, bodyAccIm, bodyFrame;
+    size_t blockPos = 0;
+
+    // Tail: same scheme with kTailPartition blocks, fed through rings
+    std::unique_ptr<Fft> tailFft;
+    size_t tailPartitions = 0;
+    ArenaArray<float> tailRe, tailIm;
+    ArenaArray<float> tailFdlRe, tailFdlIm;
+    size_t tailFdlPos = 0;
+    ArenaArray<float> tailInput;
+    ArenaArray<float> tailAccRe, tailAccIm, tailFrame;
+    uint64_t nextTailBlock = 0; // owned by whichever thread runs tailStep()
+
+    ArenaArray<float> inRing;  // input samples by absolute index
+    ArenaArray<float> outRing; // tail output by absolute output index
+    std::atomic<uint64_t> written{0};  // input samples pushed
+    std::atomic<uint64_t> produced{0}; // tail outputs below this index are ready
+
+    uint64_t position = 0; // samples processed so far
+};
+
+namespace
+{
+    size_t nextPowerOfTwo(size_t n)
+    {
+        size_t p = 1;
+        while (p < n)
+            p <<= 1;
+        return p;
+    }
+
+    // acc += a * b over split complex spectra
+    void multiplyAccumulate(const float *aRe, const float *aIm, const float *bRe, const float *bIm,
+                            float *accRe, float *accIm, size_t bins)
+    {
+        for (size_t k = 0; k < bins; k++)
+        {
+            accRe[k] += aRe[k] * bRe[k] - aIm[k] * bIm[k];
+            accIm[k] += aRe[k] * bIm[k] + aIm[k] * bRe[k];
+        }
+    }
+
+    // Zero-padded spectra of consecutive partitionSize-long slices of ir[begin, end)
+    void partitionSpectra(const std::vector<float> &ir, size_t begin, size_t end, size_t partitionSize,
+                          size_t partitions, Arena &arena, ArenaArray<float> &re, ArenaArray<float> &im)
+    {
+        Fft fft(2 * partitionSize);
+        const size_t bins = fft.bins();
+        std::vector<float> frame(2 * partitionSize);
+
+        re = arena.allocate<float>(partitions * bins);
+        im = arena.allocate<float>(partitions * bins);
+
+        for (size_t p = 0; p < partitions; p++)
+        {
+            std::fill(frame.begin(), frame.end(), 0.0f);
+            size_t first = begin + p * partitionSize;
+            size_t last = std::min(first + partitionSize, std::min(end, ir.size()));
+            if (first < last)
+                std::copy(ir.begin() + first, ir.begin() + last, frame.begin());
+
+            fft.forward(frame.data(), re.data() + p * bins, im.data() + p * bins);
+        }
+    }
+
+    // ir as if recorded with ratio times as many samples per second of the
+    // original, i.e. at irRate / ratio. Taps are scaled by ratio so the
+    // response keeps its gain as their spacing changes.
+    std::vector<float> resampleImpulse(const std::vector<float> &ir, double ratio)
+    {
+        const size_t block = 1024;
+        Resampler resampler;
+        resampler.prepare(1, ratio, block, 0.0);
+
+        std::vector<float> out(static_cast<size_t>(std::ceil(ir.size() / ratio))), input;
+        size_t read = 0;
+        for (size_t done = 0; done < out.size(); done += block)
+        {
+            const size_t frames = std::min(block, out.size() - done);
+            const size_t needed = resampler.inputNeeded(frames);
+
+            // Zeros past the end let the filter ring out
+            input.assign(needed, 0.0f);
+            if (read < ir.size())
+                std::copy(ir.begin() + read, ir.begin() + std::min(ir.size(), read + needed), input.begin());
+            read += needed;
+
+            resampler.process(input.data(), out.data() + done, frames);
+        }
+
+        for (float &tap : out)
+            tap *= static_cast<float>(ratio);
+        return out;
+    }
+}
+
+// ===================== Constructor / Destructor =====================
+ConvolutionEffect::ConvolutionEffect(std::vector<std::vector<float>> impulse, double impulseRate)
+    : impulse_(std::move(impulse)), impulseRate_(impulseRate)
+{
+    if (impulse_.empty())
+        impulse_.push_back({1.0f});
+}
+
+ConvolutionEffect::~ConvolutionEffect()
+{
+    stopWorker();
+}
+
+std::shared_ptr<ConvolutionEffect> ConvolutionEffect::load(const std::string &path)
+{
+    AudioFileReader reader;
+    if (!reader.openWav(path))
+        return nullptr;
+
+    const AudioFormat &format = reader.format();
+    std::vector<std::vector<float>> impulse(format.channels);
+    std::vector<float> chunk(4096 * static_cast<size_t>(format.channels));
+
+    unsigned long frames;
+    while ((frames = reader.read(chunk.data(), 4096)) > 0)
+    {
+        for (unsigned long i = 0; i < frames; i++)
+        {
+            for (int c = 0; c < format.channels; c++)
+                impulse[c].push_back(chunk[i * format.channels + c]);
+        }
+    }
+
+    if (impulse.empty() || impulse[0].empty())
+    {
+        std::cerr << "[Error] Impulse response is empty: " << path << "\n";
+        return nullptr;
+    }
+
+    return std::make_shared<ConvolutionEffect>(std::move(impulse), format.sampleRate);
+}
+
+size_t ConvolutionEffect::impulseLength() const
+{
+    size_t length = 0;
+    for (const auto &ir : streamImpulse_.empty() ? impulse_ : streamImpulse_)
+        length = std::max(length, ir.size());
+    return length;
+}
+
+// ===================== Preparation =====================
+void ConvolutionEffect::prepare(const ProcessSpec &spec)
+{
+    stopWorker();
+
+    realtime_ = spec.realtime;
+
+    // Resampled once per stream rate; a response at the stream's rate is
+    // used as loaded
+    if (spec.sampleRate != streamRate_)
+    {
+        streamRate_ = spec.sampleRate;
+        streamImpulse_.clear();
+        if (spec.sampleRate > 0.0 && impulseRate_ > 0.0 && impulseRate_ != spec.sampleRate)
+        {
+            for (const auto &ir : impulse_)
+                streamImpulse_.push_back(resampleImpulse(ir, impulseRate_ / spec.sampleRate));
+        }
+    }
+    const auto &impulse = streamImpulse_.empty() ? impulse_ : streamImpulse_;
+
+    // The background thread only runs between callbacks, so the tail has to
+    // start late enough to cover one partition of work plus a callback on
+    // either side of it. Offline the tail is computed in line and needs no margin.
+    const size_t period = spec.realtime ? std::max<size_t>(spec.maxFrames, 1) : 0;
+    tailPartition_ = std::max(kTailPartition, nextPowerOfTwo(period));
+    const size_t margin = (2 * period + kHeadTaps - 1) / kHeadTaps * kHeadTaps;
+    tailStart_ = 2 * tailPartition_ + margin;
+
+    const size_t P = kHeadTaps, T = tailPartition_;
+    bool anyTail = false;
+
+    channels_.clear();
+    arena_.clear();
+    for (int c = 0; c < spec.channelCount; c++)
+    {
+        const std::vector<float> &ir = impulse[std::min<size_t>(c, impulse.size() - 1)];
+        auto ch = std::make_unique<Channel>();
+
+        ch->headTaps = arena_.allocate<float>(P);
+        for (size_t k = 0; k < P && k < ir.size(); k++)
+            ch->headTaps[P - 1 - k] = ir[k];
+        ch->history = arena_.allocate<float>(2 * P - 1);
+
+        // Body covers [P, tailStart_)
+        size_t bodyEnd = std::min(ir.size(), tailStart_);
+        ch->bodyPartitions = bodyEnd > P ? (bodyEnd - P + P - 1) / P : 0;
+        if (ch->bodyPartitions > 0)
+        {
+            ch->bodyFft = std::make_unique<Fft>(2 * P);
+            const size_t bins = ch->bodyFft->bins();
+            partitionSpectra(ir, P, bodyEnd, P, ch->bodyPartitions, arena_, ch->bodyRe, ch->bodyIm);
+            ch->bodyFdlRe = arena_.allocate<float>(ch->bodyPartitions * bins);
+            ch->bodyFdlIm = arena_.allocate<float>(ch->bodyPartitions * bins);
+            ch->bodyAccRe = arena_.allocate<float>(bins);
+            ch->bodyAccIm = arena_.allocate<float>(bins);
+            ch->bodyFrame = arena_.allocate<float>(2 * P);
+        }
+        ch->bodyInput = arena_.allocate<float>(2 * P);
+        ch->bodyOutput = arena_.allocate<float>(P);
+
+        // Tail covers [tailStart_, end)
+        ch->tailPartitions = ir.size() > tailStart_ ? (ir.size() - tailStart_ + T - 1) / T : 0;
+        if (ch->tailPartitions > 0)
+        {
+            anyTail = true;
+            ch->tailFft = std::make_unique<Fft>(2 * T);
+            const size_t bins = ch->tailFft->bins();
+            partitionSpectra(ir, tailStart_, ir.size(), T, ch->tailPartitions, arena_, ch->tailRe, ch->tailIm);
+            ch->tailFdlRe = arena_.allocate<float>(ch->tailPartitions * bins);
+            ch->tailFdlIm = arena_.allocate<float>(ch->tailPartitions * bins);
+            ch->tailAccRe = arena_.allocate<float>(bins);
+            ch->tailAccIm = arena_.allocate<float>(bins);
+            ch->tailFrame = arena_.allocate<float>(2 * T);
+            ch->tailInput = arena_.allocate<float>(2 * T);
+
+            // Outputs before tailStart_ have no tail, so they start out "produced"
+            ch->inRing = arena_.allocate<float>(nextPowerOfTwo(4 * T));
+            ch->outRing = arena_.allocate<float>(nextPowerOfTwo(tailStart_ + T));
+            ch->produced.store(tailStart_, std::memory_order_relaxed);
+        }
+
+        channels_.push_back(std::move(ch));
+    }
+
+    tailMisses_.store(0, std::memory_order_relaxed);
+
+    if (anyTail && realtime_)
+    {
+        running_.store(true);
+        worker_ = std::thread(&ConvolutionEffect::tailWorker, this);
+    }
+}
+
+void ConvolutionEffect::stopWorker()
+{
+    running_.store(false);
+    if (worker_.joinable())
+        worker_.join();
+}
+
+// ===================== Audio Processing =====================
+void ConvolutionEffect::process(float *samples, unsigned long frameCount, int channel)
+{
+    if (channel >= static_cast<int>(channels_.size()))
+        return;
+
+    Channel &ch = *channels_[channel];
+
+    // Split at body block boundaries so each span fits the head history
+    while (frameCount > 0)
+    {
+        size_t count = std::min<size_t>(frameCount, kHeadTaps - ch.blockPos);
+        processSpan(ch, samples, count);
+        samples += count;
+        frameCount -= count;
+    }
+}
+
+void ConvolutionEffect::processSpan(Channel &ch, float *samples, size_t count)
+{
+    const size_t P = kHeadTaps;
+    float *current = ch.history.data() + (P - 1);
+
+    std::copy(samples, samples + count, current);
+    std::copy(samples, samples + count, ch.bodyInput.data() + P + ch.blockPos);
+
+    if (ch.tailPartitions > 0)
+    {
+        const size_t mask = ch.inRing.size() - 1;
+        for (size_t i = 0; i < count; i++)
+            ch.inRing[(ch.position + i) & mask] = samples[i];
+        ch.written.store(ch.position + count, std::memory_order_release);
+    }
+
+    // Head, tap-major so the inner loop vectorizes
+    std::copy(ch.bodyOutput.data() + ch.blockPos, ch.bodyOutput.data() + ch.blockPos + count, samples);
+    const float *history = ch.history.data();
+    for (size_t k = 0; k < P; k++)
+    {
+        const float tap = ch.headTaps[k];
+        for (size_t i = 0; i < count; i++)
+            samples[i] += tap * history[i + k];
+    }
+    std::memmove(ch.history.data(), ch.history.data() + count, (P - 1) * sizeof(float));
+
+    // Tail, as far as the background thread has delivered it
+    if (ch.tailPartitions > 0)
+    {
+        uint64_t start = ch.position;
+        uint64_t produced = ch.produced.load(std::memory_order_acquire);
+        uint64_t ready = produced > start ? std::min<uint64_t>(produced - start, count) : 0;
+        const size_t mask = ch.outRing.size() - 1;
+
+        for (size_t i = 0; i < ready; i++)
+            samples[i] += ch.outRing[(start + i) & mask];
+
+        if (ready < count)
+            tailMisses_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ch.position += count;
+    ch.blockPos += count;
+
+    if (ch.blockPos == P)
+    {
+        bodyStep(ch);
+        ch.blockPos = 0;
+    }
+
+    // Offline there is no deadline, so the tail is computed in line
+    if (!realtime_ && ch.tailPartitions > 0 && ch.position % tailPartition_ == 0)
+        tailStep(ch);
+}
+
+void ConvolutionEffect::bodyStep(Channel &ch)
+{
+    const size_t P = kHeadTaps;
+
+    if (ch.bodyPartitions > 0)
+    {
+        const size_t bins = ch.bodyFft->bins();
+        const size_t K = ch.bodyPartitions;
+
+        ch.bodyFft->forward(ch.bodyInput.data(),
+                            ch.bodyFdlRe.data() + ch.bodyFdlPos * bins,
+                            ch.bodyFdlIm.data() + ch.bodyFdlPos * bins);
+
+        std::fill(ch.bodyAccRe.begin(), ch.bodyAccRe.end(), 0.0f);
+        std::fill(ch.bodyAccIm.begin(), ch.bodyAccIm.end(), 0.0f);
+        for (size_t k = 0; k < K; k++)
+        {
+            size_t slot = (ch.bodyFdlPos + K - k) % K;
+            multiplyAccumulate(ch.bodyFdlRe.data() + slot * bins, ch.bodyFdlIm.data() + slot * bins,
+                               ch.bodyRe.data() + k * bins, ch.bodyIm.data() + k * bins,
+                               ch.bodyAccRe.data(), ch.bodyAccIm.data(), bins);
+        }
+        ch.bodyFdlPos = (ch.bodyFdlPos + 1) % K;
+
+        // Second half of the overlap-save frame is the valid output; it is one
+        // block late, which is exactly where the body starts in the response
+        ch.bodyFft->inverse(ch.bodyAccRe.data(), ch.bodyAccIm.data(), ch.bodyFrame.data());
+        std::copy(ch.bodyFrame.begin() + P, ch.bodyFrame.end(), ch.bodyOutput.begin());
+    }
+
+    std::copy(ch.bodyInput.begin() + P, ch.bodyInput.end(), ch.bodyInput.begin());
+}
+
+// ===================== Tail =====================
+void ConvolutionEffect::tailStep(Channel &ch)
+{
+    const size_t T = tailPartition_;
+    const size_t bins = ch.tailFft->bins();
+    const size_t K = ch.tailPartitions;
+    const uint64_t first = ch.nextTailBlock * T;
+
+    const size_t inMask = ch.inRing.size() - 1;
+    for (size_t i = 0; i < T; i++)
+        ch.tailInput[T + i] = ch.inRing[(first + i) & inMask];
+
+    ch.tailFft->forward(ch.tailInput.data(),
+                        ch.tailFdlRe.data() + ch.tailFdlPos * bins,
+                        ch.tailFdlIm.data() + ch.tailFdlPos * bins);
+
+    std::fill(ch.tailAccRe.begin(), ch.tailAccRe.end(), 0.0f);
+    std::fill(ch.tailAccIm.begin(), ch.tailAccIm.end(), 0.0f);
+    for (size_t k = 0; k < K; k++)
+    {
+        size_t slot = (ch.tailFdlPos + K - k) % K;
+        multiplyAccumulate(ch.tailFdlRe.data() + slot * bins, ch.tailFdlIm.data() + slot * bins,
+                           ch.tailRe.data() + k * bins, ch.tailIm.data() + k * bins,
+                           ch.tailAccRe.data(), ch.tailAccIm.data(), bins);
+    }
+    ch.tailFdlPos = (ch.tailFdlPos + 1) % K;
+
+    ch.tailFft->inverse(ch.tailAccRe.data(), ch.tailAccIm.data(), ch.tailFrame.data());
+    std::copy(ch.tailInput.begin() + T, ch.tailInput.end(), ch.tailInput.begin());
+
+    // This block's output lands tailStart_ samples after its input
+    const uint64_t out = first + tailStart_;
+    const size_t outMask = ch.outRing.size() - 1;
+    for (size_t i = 0; i < T; i++)
+        ch.outRing[(out + i) & outMask] = ch.tailFrame[T + i];
+
+    ch.nextTailBlock++;
+    ch.produced.store(out + T, std::memory_order_release);
+}
+
+void ConvolutionEffect::resyncTail(Channel &ch, uint64_t written)
+{
+    // The input ring was overwritten before it was read: drop the tail's
+    // history and restart from the newest complete block
+    const size_t T = tailPartition_;
+    const uint64_t block = written / T - 1;
+    const uint64_t resume = block * T + tailStart_;
+
+    const size_t outMask = ch.outRing.size() - 1;
+    uint64_t produced = ch.produced.load(std::memory_order_relaxed);
+    uint64_t from = std::max<uint64_t>(produced, resume > ch.outRing.size() ? resume - ch.outRing.size() : 0);
+    for (uint64_t i = from; i < resume; i++)
+        ch.outRing[i & outMask] = 0.0f;
+
+    std::fill(ch.tailFdlRe.begin(), ch.tailFdlRe.end(), 0.0f);
+    std::fill(ch.tailFdlIm.begin(), ch.tailFdlIm.end(), 0.0f);
+    std::fill(ch.tailInput.begin(), ch.tailInput.end(), 0.0f);
+
+    ch.nextTailBlock = block;
+    ch.produced.store(std::max(produced, resume), std::memory_order_release);
+}
+
+void ConvolutionEffect::tailWorker()
+{
+    const size_t T = tailPartition_;
+
+    // Polls rather than waits on a condition variable, so the audio thread
+    // never has to make a system call to wake it
+    while (running_.load(std::memory_order_relaxed))
+    {
+        bool worked = false;
+
+        for (auto &chPtr : channels_)
+        {
+            Channel &ch = *chPtr;
+            if (ch.tailPartitions == 0)
+                continue;
+
+            uint64_t written = ch.written.load(std::memory_order_acquire);
+            if (written > ch.nextTailBlock * T + ch.inRing.size())
+                resyncTail(ch, written);
+
+            while (written >= (ch.nextTailBlock + 1) * T)
+            {
+                tailStep(ch);
+                worked = true;
+            }
+        }
+
+        if (!worked)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
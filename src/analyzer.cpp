@@ -0,0 +1,305 @@
+#include "analyzer.h"
+#include "realtime.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr double kHopSeconds = 0.01;
+    constexpr double kSpectrumResolution = 12.0; // Hz per bin, or finer
+    constexpr float kLowestBand = 40.0f;
+    constexpr float kHighestBand = 16000.0f;
+    constexpr float kFloorDb = -120.0f;
+    // Windows quieter than this are not searched for a pitch
+    constexpr float kGateDb = -60.0f;
+    // YIN's threshold on the normalized difference
+    constexpr float kThreshold = 0.15f;
+    constexpr auto kPollInterval = std::chrono::milliseconds(5);
+
+    size_t nextPowerOfTwo(double value)
+    {
+        size_t size = 4;
+        while (size < value)
+            size *= 2;
+        return size;
+    }
+
+    float powerToDb(double power)
+    {
+        return power > 0.0 ? std::max(kFloorDb, static_cast<float>(10.0 * std::log10(power))) : kFloorDb;
+    }
+}
+
+// ===================== Pitch Detection =====================
+void PitchDetector::prepare(double sampleRate)
+{
+    sampleRate_ = sampleRate;
+    span_ = static_cast<size_t>(std::ceil(sampleRate / kMinFrequency));
+    window_ = 2 * span_;
+
+    // Linear, not circular, correlation of the span against the window
+    fft_ = std::make_unique<Fft>(nextPowerOfTwo(window_ + span_));
+    padded_.assign(fft_->size(), 0.0f);
+    correlation_.assign(fft_->size(), 0.0f);
+    spanRe_.assign(fft_->bins(), 0.0f);
+    spanIm_.assign(fft_->bins(), 0.0f);
+    re_.assign(fft_->bins(), 0.0f);
+    im_.assign(fft_->bins(), 0.0f);
+    energy_.assign(window_ + 1, 0.0);
+    difference_.assign(span_ + 1, 1.0f);
+}
+
+bool PitchDetector::detect(const float *window, float &frequency, float &clarity)
+{
+    // correlation[lag] = sum over j < span of x[j] * x[j + lag]
+    std::copy(window, window + span_, padded_.begin());
+    std::fill(padded_.begin() + span_, padded_.end(), 0.0f);
+    fft_->forward(padded_.data(), spanRe_.data(), spanIm_.data());
+
+    std::copy(window, window + window_, padded_.begin());
+    fft_->forward(padded_.data(), re_.data(), im_.data());
+
+    for (size_t k = 0; k < re_.size(); k++)
+    {
+        float r = spanRe_[k] * re_[k] + spanIm_[k] * im_[k];
+        float i = spanRe_[k] * im_[k] - spanIm_[k] * re_[k];
+        re_[k] = r;
+        im_[k] = i;
+    }
+    fft_->inverse(re_.data(), im_.data(), correlation_.data());
+
+    for (size_t j = 0; j < window_; j++)
+        energy_[j + 1] = energy_[j] + static_cast<double>(window[j]) * window[j];
+
+    // d(lag) = sum of (x[j] - x[j + lag])^2, then YIN's cumulative mean
+    // normalization, which keeps short lags from winning
+    const double spanEnergy = energy_[span_];
+    double running = 0.0;
+    for (size_t lag = 1; lag <= span_; lag++)
+    {
+        double d = spanEnergy + (energy_[lag + span_] - energy_[lag]) - 2.0 * correlation_[lag];
+        d = std::max(d, 0.0);
+        running += d;
+        difference_[lag] = running > 0.0 ? static_cast<float>(d * lag / running) : 1.0f;
+    }
+
+    // The first dip under the threshold, followed down to its bottom
+    size_t lag = std::max<size_t>(2, static_cast<size_t>(sampleRate_ / kMaxFrequency));
+    while (lag < span_ && difference_[lag] >= kThreshold)
+        lag++;
+    if (lag >= span_)
+        return false;
+    while (lag + 1 < span_ && difference_[lag + 1] < difference_[lag])
+        lag++;
+
+    // A parabola through the dip places it between samples
+    float before = difference_[lag - 1], at = difference_[lag], after = difference_[lag + 1];
+    float curvature = before - 2.0f * at + after;
+    double period = lag + (curvature > 0.0f ? 0.5f * (before - after) / curvature : 0.0f);
+
+    frequency = static_cast<float>(sampleRate_ / period);
+    clarity = std::clamp(1.0f - at, 0.0f, 1.0f);
+    return true;
+}
+
+Note nearestNote(float frequency, float referenceA4)
+{
+    static const char *const kNames[] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+
+    Note note;
+    if (!(frequency > 0.0f))
+    {
+        note.name = "--";
+        return note;
+    }
+
+    double semitones = 12.0 * std::log2(frequency / referenceA4);
+    long nearest = std::lround(semitones);
+    long midi = 69 + nearest;
+    long octave = (midi >= 0 ? midi / 12 : (midi - 11) / 12) - 1;
+    note.name = std::string(kNames[((midi % 12) + 12) % 12]) + std::to_string(octave);
+    note.cents = static_cast<float>(100.0 * (semitones - nearest));
+    return note;
+}
+
+// ===================== Constructor =====================
+Analyzer::Analyzer() : tap_(std::make_shared<TapEffect>())
+{
+}
+
+Analyzer::~Analyzer()
+{
+    stop();
+}
+
+// ===================== Control Thread =====================
+void Analyzer::start()
+{
+    if (thread_.joinable())
+        return;
+
+    // Whatever the tap held from before is stale
+    tap_->samples().discard(tap_->samples().readable());
+    filled_ = 0;
+
+    stopping_ = false;
+    thread_ = std::thread(&Analyzer::run, this);
+}
+
+void Analyzer::stop()
+{
+    if (!thread_.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    thread_.join();
+}
+
+Analyzer::Reading Analyzer::reading() const
+{
+    std::lock_guard<std::mutex> lock(readingMutex_);
+    return reading_;
+}
+
+std::array<float, Analyzer::kBands + 1> Analyzer::bandEdges()
+{
+    std::array<float, kBands + 1> edges;
+    for (int b = 0; b <= kBands; b++)
+        edges[b] = kLowestBand * std::pow(kHighestBand / kLowestBand, static_cast<float>(b) / kBands);
+    return edges;
+}
+
+void Analyzer::run()
+{
+    // Falls back to normal priority where the system refuses
+    setBackgroundPriority();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    do
+    {
+        poll();
+    } while (!wake_.wait_for(lock, kPollInterval, [this] { return stopping_; }));
+}
+
+// ===================== Analysis =====================
+size_t Analyzer::poll()
+{
+    double sampleRate = tap_->sampleRate();
+    if (sampleRate <= 0.0)
+        return 0;
+    if (sampleRate != sampleRate_)
+        configure(sampleRate);
+
+    // Far behind, only the newest samples are worth analyzing
+    SpscRing &ring = tap_->samples();
+    size_t available = ring.readable();
+    if (available > history_.size() + hop_)
+    {
+        ring.discard(available - history_.size());
+        filled_ = 0;
+    }
+
+    size_t analyzed = 0;
+    while (true)
+    {
+        size_t count = std::min(hop_ - filled_, ring.readable());
+        if (count == 0 || !ring.read(incoming_.data() + filled_, count))
+            break;
+
+        filled_ += count;
+        if (filled_ < hop_)
+            break;
+
+        std::move(history_.begin() + hop_, history_.end(), history_.begin());
+        std::copy(incoming_.begin(), incoming_.end(), history_.end() - hop_);
+        filled_ = 0;
+        analyze();
+        analyzed++;
+    }
+    return analyzed;
+}
+
+void Analyzer::configure(double sampleRate)
+{
+    sampleRate_ = sampleRate;
+    pitch_.prepare(sampleRate);
+    hop_ = static_cast<size_t>(std::lround(sampleRate * kHopSeconds));
+
+    fft_ = std::make_unique<Fft>(nextPowerOfTwo(sampleRate / kSpectrumResolution));
+    const size_t size = fft_->size();
+    hann_.resize(size);
+    double windowPower = 0.0;
+    for (size_t i = 0; i < size; i++)
+    {
+        hann_[i] = 0.5f - 0.5f * std::cos(2.0f * 3.14159265358979f * i / size);
+        windowPower += static_cast<double>(hann_[i]) * hann_[i];
+    }
+    // Bins summed over a band give its mean square, so a sine of amplitude
+    // A reads A^2 / 2 whatever the window
+    spectrumScale_ = static_cast<float>(2.0 / (size * windowPower));
+
+    windowed_.assign(size, 0.0f);
+    re_.assign(fft_->bins(), 0.0f);
+    im_.assign(fft_->bins(), 0.0f);
+
+    // Every band gets at least one bin, even where bins are wider than bands
+    const auto edges = bandEdges();
+    for (int b = 0; b <= kBands; b++)
+    {
+        size_t bin = static_cast<size_t>(std::lround(edges[b] * size / sampleRate));
+        bin = std::clamp<size_t>(bin, 1, fft_->bins() - 1);
+        bandBins_[b] = b > 0 ? std::max(bin, bandBins_[b - 1] + 1) : bin;
+    }
+
+    history_.assign(std::max(pitch_.windowFrames(), size), 0.0f);
+    incoming_.assign(hop_, 0.0f);
+    filled_ = 0;
+
+    std::lock_guard<std::mutex> lock(readingMutex_);
+    reading_ = Reading();
+}
+
+void Analyzer::analyze()
+{
+    Reading reading;
+
+    float peak = 0.0f;
+    double sum = 0.0;
+    for (float x : incoming_)
+    {
+        peak = std::max(peak, std::fabs(x));
+        sum += static_cast<double>(x) * x;
+    }
+    reading.peakDb = powerToDb(static_cast<double>(peak) * peak);
+    reading.rmsDb = powerToDb(sum / hop_);
+
+    const float *window = history_.data() + history_.size() - pitch_.windowFrames();
+    sum = 0.0;
+    for (size_t i = 0; i < pitch_.windowFrames(); i++)
+        sum += static_cast<double>(window[i]) * window[i];
+    reading.signal = powerToDb(sum / pitch_.windowFrames()) > kGateDb;
+    if (reading.signal)
+        reading.pitched = pitch_.detect(window, reading.frequency, reading.clarity);
+
+    const float *newest = history_.data() + history_.size() - fft_->size();
+    for (size_t i = 0; i < fft_->size(); i++)
+        windowed_[i] = newest[i] * hann_[i];
+    fft_->forward(windowed_.data(), re_.data(), im_.data());
+    for (int b = 0; b < kBands; b++)
+    {
+        double power = 0.0;
+        for (size_t k = bandBins_[b]; k < bandBins_[b + 1]; k++)
+            power += static_cast<double>(re_[k]) * re_[k] + static_cast<double>(im_[k]) * im_[k];
+        reading.bandsDb[b] = powerToDb(power * spectrumScale_);
+    }
+
+    reading.time = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(readingMutex_);
+    reading.updates = reading_.updates + 1;
+    reading_ = reading;
+}
@@ -0,0 +1,104 @@
+#include "audiobackend.h"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+// ===================== Engine Callback =====================
+void EngineCallback::setThreadSetup(const ThreadSetup &setup)
+{
+    setup_ = setup;
+    anchorSequence_.store(0, std::memory_order_relaxed);
+    stateReady_.store(false, std::memory_order_relaxed);
+    setupPending_.store(true, std::memory_order_release);
+}
+
+bool EngineCallback::threadState(ThreadState &state) const
+{
+    if (!stateReady_.load(std::memory_order_acquire))
+        return false;
+    state = state_;
+    return true;
+}
+
+bool EngineCallback::readAnchor(double &time, uint64_t &frame) const
+{
+    while (true)
+    {
+        uint32_t sequence = anchorSequence_.load(std::memory_order_acquire);
+        if (sequence == 0)
+            return false;
+        if (sequence & 1)
+            continue;
+
+        time = anchorTime_.load(std::memory_order_relaxed);
+        frame = anchorFrame_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (anchorSequence_.load(std::memory_order_relaxed) == sequence)
+            return true;
+    }
+}
+
+bool EngineCallback::frameAt(double streamTime, uint64_t &frame) const
+{
+    double time;
+    uint64_t anchor;
+    if (!readAnchor(time, anchor))
+        return false;
+
+    // Times before the anchor clamp to it: that block has been processed
+    double offset = std::llround((streamTime - time) * engine_.getSampleRate());
+    frame = anchor + static_cast<uint64_t>(std::max(offset, 0.0));
+    return true;
+}
+
+bool EngineCallback::latestStreamTime(double &streamTime) const
+{
+    uint64_t frame;
+    return readAnchor(streamTime, frame);
+}
+
+void EngineCallback::process(const float *input, float *output, unsigned long frameCount, const BlockInfo &info)
+{
+    // Once per stream, before the first block is timed, so the system
+    // calls it makes never count against a period
+    if (setupPending_.load(std::memory_order_acquire))
+    {
+        state_ = applyThreadSetup(setup_);
+        engine_.setAudioThreadState(state_.priority, state_.flushDenormals);
+        setupPending_.store(false, std::memory_order_relaxed);
+        stateReady_.store(true, std::memory_order_release);
+    }
+
+    if (info.streamTime > 0.0)
+    {
+        uint32_t sequence = anchorSequence_.load(std::memory_order_relaxed);
+        anchorSequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        anchorTime_.store(info.streamTime, std::memory_order_relaxed);
+        anchorFrame_.store(engine_.streamFrame(), std::memory_order_relaxed);
+        anchorSequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+
+    if (input)
+        engine_.process(input, output, frameCount);
+    else
+        std::memset(output, 0, frameCount * engine_.getOutputChannels() * sizeof(float));
+
+    if (recorder_)
+        recorder_->push(input, output, frameCount);
+
+    StreamStats::Block block;
+    block.frames = frameCount;
+    block.sampleRate = engine_.getSampleRate();
+    block.processSeconds = info.modelledSeconds >= 0.0
+                               ? info.modelledSeconds
+                               : std::chrono::duration<double>(Clock::now() - start).count();
+    block.flags = info.flags;
+    block.inputLatency = info.inputLatency;
+    block.outputLatency = info.outputLatency;
+
+    stats_.record(block);
+}
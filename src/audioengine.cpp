@@ -0,0 +1,278 @@
+#include "audioengine.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+namespace
+{
+    float dbToLevel(float db)
+    {
+        return std::pow(10.0f, db / 20.0f);
+    }
+
+    float levelToDb(float level)
+    {
+        return 20.0f * std::log10(level);
+    }
+}
+
+// ===================== Constructor =====================
+AudioEngine::AudioEngine()
+    : sampleRate_(0.0), inputChannels_(0), outputChannels_(0), maxFrames_(0), realtime_(true), prepared_(false)
+{
+    setIdleOptions(IdleOptions());
+}
+
+// ===================== Configuration =====================
+void AudioEngine::prepare(double sampleRate, int inputChannels, int outputChannels,
+                          unsigned long maxFrames, bool realtime)
+{
+    sampleRate_ = sampleRate;
+    inputChannels_ = inputChannels;
+    outputChannels_ = outputChannels;
+    maxFrames_ = std::max(maxFrames, 1UL);
+    realtime_ = realtime;
+    prepared_ = true;
+
+    signal_ = false;
+    quietFrames_ = 0;
+    idle_.store(false, std::memory_order_relaxed);
+
+    // A new stream counts its frames from zero
+    events_.clear();
+    frame_ = 0;
+    streamFrame_.store(0, std::memory_order_relaxed);
+
+    int procCh = std::min(inputChannels_, outputChannels_);
+    size_t stride = AlignedBuffer::alignedStride(maxFrames_);
+    planar_.resize(stride * std::max(procCh, 1));
+
+    planes_.resize(std::max(procCh, 1));
+    for (size_t ch = 0; ch < planes_.size(); ch++)
+        planes_[ch] = planar_.data() + ch * stride;
+
+    outputPlanes_.resize(std::max(outputChannels_, 0));
+    for (int ch = 0; ch < outputChannels_; ch++)
+        outputPlanes_[ch] = planes_[ch < procCh ? ch : 0];
+
+    for (auto &effect : chain_.getEffects())
+        prepareEffect(*effect);
+}
+
+void AudioEngine::prepareEffect(Effect &effect)
+{
+    ProcessSpec spec;
+    spec.sampleRate = sampleRate_;
+    spec.channelCount = std::min(inputChannels_, outputChannels_);
+    spec.maxFrames = maxFrames_;
+    spec.realtime = realtime_;
+    effect.prepare(spec);
+}
+
+// ===================== Effect Chain =====================
+void AudioEngine::addEffect(std::shared_ptr<Effect> effect)
+{
+    // Prepare before publishing so the audio thread never sees it unprepared
+    if (prepared_)
+        prepareEffect(*effect);
+
+    chain_.addEffect(std::move(effect));
+}
+
+bool AudioEngine::removeEffect(size_t index)
+{
+    return chain_.removeEffect(index);
+}
+
+bool AudioEngine::moveEffect(size_t from, size_t to)
+{
+    return chain_.moveEffect(from, to);
+}
+
+bool AudioEngine::replaceEffect(size_t index, std::shared_ptr<Effect> effect)
+{
+    if (prepared_)
+        prepareEffect(*effect);
+
+    return chain_.replaceEffect(index, std::move(effect));
+}
+
+std::vector<std::shared_ptr<Effect>> AudioEngine::getEffects() const
+{
+    return chain_.getEffects();
+}
+
+void AudioEngine::collect()
+{
+    chain_.collect();
+}
+
+// ===================== Parallel Processing =====================
+void AudioEngine::setWorkerThreads(int count)
+{
+    pool_.reset();
+    if (count > 0)
+    {
+        pool_ = std::make_unique<WorkerPool>(count);
+        pool_->followCaller(audioPriority_.load(std::memory_order_relaxed),
+                            audioFlushDenormals_.load(std::memory_order_relaxed));
+    }
+}
+
+void AudioEngine::setAudioThreadState(int priority, bool flushDenormals)
+{
+    audioPriority_.store(priority, std::memory_order_relaxed);
+    audioFlushDenormals_.store(flushDenormals, std::memory_order_relaxed);
+    if (pool_)
+        pool_->followCaller(priority, flushDenormals);
+}
+
+// ===================== Idle Bypass =====================
+void AudioEngine::setIdleOptions(const IdleOptions &options)
+{
+    openLevel_.store(dbToLevel(options.openDb), std::memory_order_relaxed);
+    closeLevel_.store(dbToLevel(std::min(options.closeDb, options.openDb)), std::memory_order_relaxed);
+    idleEnabled_.store(options.enabled, std::memory_order_relaxed);
+}
+
+AudioEngine::IdleOptions AudioEngine::getIdleOptions() const
+{
+    IdleOptions options;
+    options.enabled = idleEnabled_.load(std::memory_order_relaxed);
+    options.openDb = levelToDb(openLevel_.load(std::memory_order_relaxed));
+    options.closeDb = levelToDb(closeLevel_.load(std::memory_order_relaxed));
+    return options;
+}
+
+bool AudioEngine::bypassBlock(const float *input, unsigned long frames, const EffectChain &chain, const SimdKernels &kernels)
+{
+    // Every input channel counts, processed or not
+    float peak = kernels.peak(input, frames * inputChannels_);
+
+    // Hysteresis: a signal has to rise above the open level, then fall
+    // below the lower close level before it counts as gone
+    float threshold = signal_ ? closeLevel_.load(std::memory_order_relaxed) : openLevel_.load(std::memory_order_relaxed);
+    if (peak > threshold)
+    {
+        signal_ = true;
+        quietFrames_ = 0;
+        return false;
+    }
+    signal_ = false;
+
+    // The chain rings on for the sum of its tails; only asked while quiet
+    unsigned long tail = 0;
+    for (Effect *effect : chain)
+        tail = addTailFrames(tail, effect->tailFrames());
+
+    bool bypass = tail != Effect::kUnboundedTail && quietFrames_ >= tail;
+    quietFrames_ += frames;
+    return bypass;
+}
+
+// ===================== Scheduled Events =====================
+void AudioEngine::applyEvents(const EffectChain &chain)
+{
+    ControlEvent event;
+    while (events_.pop(frame_, event))
+    {
+        // The effect may have left the chain, or been freed, since the
+        // event was scheduled; ids are never reused
+        const auto &effects = chain.effects();
+        auto match = [&](const std::shared_ptr<Effect> &effect)
+        { return effect->id() == event.effect; };
+        auto target = std::find_if(effects.begin(), effects.end(), match);
+        if (target == effects.end())
+            continue;
+
+        Effect &effect = **target;
+        if (event.type == ControlEvent::Type::Bypass)
+            effect.setBypassed(event.value != 0.0f);
+        else
+            effect.setParameter(event.parameter, event.value);
+    }
+}
+
+// ===================== Audio Processing =====================
+void AudioEngine::processChannel(void *job, size_t channel)
+{
+    const ChannelJob &j = *static_cast<const ChannelJob *>(job);
+    float *plane = j.planes[channel];
+
+    // Apply all effects in order; a fused run skips its bypassed members itself
+    for (Effect *effect : *j.chain)
+    {
+        if (!effect->blockBypassed())
+            effect->process(plane, j.frames, static_cast<int>(channel));
+    }
+
+    j.kernels->clamp(plane, -1.0f, 1.0f, j.frames);
+}
+
+void AudioEngine::process(const float *input, float *output, unsigned long frameCount)
+{
+    int inCh = inputChannels_;
+    int outCh = outputChannels_;
+    int procCh = std::min(inCh, outCh);
+
+    // Pick up the latest chain once per block
+    const EffectChain *chain = chain_.acquire();
+    const SimdKernels &kernels = simd();
+    bool idleEnabled = idleEnabled_.load(std::memory_order_relaxed);
+    if (!idleEnabled)
+        quietFrames_ = 0; // the chain may be ringing when detection resumes
+
+    events_.receive();
+
+    for (unsigned long start = 0, frames = 0; prepared_ && start < frameCount; start += frames, frame_ += frames)
+    {
+        // Events due by now land first; the next one ends the block early
+        applyEvents(*chain);
+        frames = std::min(maxFrames_, frameCount - start);
+        uint64_t next;
+        if (events_.nextFrame(next) && next - frame_ < frames)
+            frames = static_cast<unsigned long>(next - frame_);
+
+        // Silent input with every tail played out leaves nothing to compute
+        bool idle = idleEnabled && bypassBlock(input + start * inCh, frames, *chain, kernels);
+        idle_.store(idle, std::memory_order_relaxed);
+        if (idle)
+        {
+            std::memset(output + start * outCh, 0, frames * outCh * sizeof(float));
+            idleBlocks_.store(idleBlocks_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            continue;
+        }
+
+        // One pass into contiguous planes, so every effect sees unit-stride data
+        kernels.deinterleave(input + start * inCh, inCh, planes_.data(), procCh, frames);
+
+        // Bypass is read once per block on the effects themselves, so every
+        // channel agrees on it, fused or not
+        for (const auto &effect : chain->effects())
+        {
+            if (effect)
+                effect->latchBypass();
+        }
+        for (Effect *effect : *chain)
+        {
+            if (!effect->blockBypassed())
+                effect->beginBlock(frames);
+        }
+
+        // Channels are independent once beginBlock() has run
+        ChannelJob job{chain, planes_.data(), frames, &kernels};
+        bool parallel = pool_ && procCh > 1 && pool_->run(procCh, &AudioEngine::processChannel, &job);
+        if (!parallel)
+        {
+            for (int ch = 0; ch < procCh; ch++)
+                processChannel(&job, ch);
+        }
+
+        // One pass back out; channels past the input repeat the first one
+        kernels.interleave(outputPlanes_.data(), outCh, output + start * outCh, outCh, frames);
+    }
+
+    streamFrame_.store(frame_, std::memory_order_relaxed);
+    chain_.release();
+}
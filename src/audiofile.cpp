@@ -0,0 +1,583 @@
+#include "audiofile.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// WAV is little-endian; samples are assembled byte by byte so the code does
+// not depend on the host's byte order.
+namespace
+{
+    const uint16_t WAVE_FORMAT_PCM = 0x0001;
+    const uint16_t WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+    const uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+    // The sub-format GUID of WAVE_FORMAT_EXTENSIBLE is the format tag
+    // followed by these fixed 14 bytes
+    const unsigned char kSubFormatTail[14] = {0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80,
+                                              0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71};
+
+    // Seeks relative to the current position; fseek() takes a long, which
+    // is 32-bit on Windows
+    bool skipBytes(std::FILE *file, uint64_t bytes)
+    {
+#ifdef _WIN32
+        return _fseeki64(file, static_cast<__int64>(bytes), SEEK_CUR) == 0;
+#else
+        return fseeko(file, static_cast<off_t>(bytes), SEEK_CUR) == 0;
+#endif
+    }
+
+    uint16_t readLE16(const unsigned char *p)
+    {
+        return static_cast<uint16_t>(p[0] | (p[1] << 8));
+    }
+
+    uint32_t readLE32(const unsigned char *p)
+    {
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+               (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    void writeLE16(unsigned char *p, uint16_t v)
+    {
+        p[0] = static_cast<unsigned char>(v);
+        p[1] = static_cast<unsigned char>(v >> 8);
+    }
+
+    void writeLE32(unsigned char *p, uint32_t v)
+    {
+        for (int i = 0; i < 4; i++)
+            p[i] = static_cast<unsigned char>(v >> (8 * i));
+    }
+
+    float clampSample(float v)
+    {
+        return std::max(-1.0f, std::min(1.0f, v));
+    }
+
+    void decodeSamples(const unsigned char *in, float *out, size_t count, SampleEncoding encoding)
+    {
+        switch (encoding)
+        {
+        case SampleEncoding::Int16:
+            for (size_t i = 0; i < count; i++, in += 2)
+                out[i] = static_cast<int16_t>(readLE16(in)) * (1.0f / 32768.0f);
+            break;
+        case SampleEncoding::Int24:
+            for (size_t i = 0; i < count; i++, in += 3)
+            {
+                int32_t v = static_cast<int32_t>((in[0] << 8) | (in[1] << 16) | (static_cast<uint32_t>(in[2]) << 24)) >> 8;
+                out[i] = v * (1.0f / 8388608.0f);
+            }
+            break;
+        case SampleEncoding::Int32:
+            for (size_t i = 0; i < count; i++, in += 4)
+                out[i] = static_cast<int32_t>(readLE32(in)) * (1.0f / 2147483648.0f);
+            break;
+        case SampleEncoding::Float32:
+            for (size_t i = 0; i < count; i++, in += 4)
+            {
+                uint32_t bits = readLE32(in);
+                std::memcpy(&out[i], &bits, sizeof(float));
+            }
+            break;
+        }
+    }
+
+    void encodeSamples(const float *in, unsigned char *out, size_t count, SampleEncoding encoding)
+    {
+        switch (encoding)
+        {
+        case SampleEncoding::Int16:
+            for (size_t i = 0; i < count; i++, out += 2)
+            {
+                long v = std::lround(clampSample(in[i]) * 32767.0f);
+                writeLE16(out, static_cast<uint16_t>(static_cast<int16_t>(v)));
+            }
+            break;
+        case SampleEncoding::Int24:
+            for (size_t i = 0; i < count; i++, out += 3)
+            {
+                long v = std::lround(clampSample(in[i]) * 8388607.0f);
+                out[0] = static_cast<unsigned char>(v);
+                out[1] = static_cast<unsigned char>(v >> 8);
+                out[2] = static_cast<unsigned char>(v >> 16);
+            }
+            break;
+        case SampleEncoding::Int32:
+            for (size_t i = 0; i < count; i++, out += 4)
+            {
+                long long v = std::llround(static_cast<double>(clampSample(in[i])) * 2147483647.0);
+                writeLE32(out, static_cast<uint32_t>(static_cast<int32_t>(v)));
+            }
+            break;
+        case SampleEncoding::Float32:
+            for (size_t i = 0; i < count; i++, out += 4)
+            {
+                uint32_t bits;
+                std::memcpy(&bits, &in[i], sizeof(float));
+                writeLE32(out, bits);
+            }
+            break;
+        }
+    }
+
+    void writeLE64(unsigned char *p, uint64_t v)
+    {
+        for (int i = 0; i < 8; i++)
+            p[i] = static_cast<unsigned char>(v >> (8 * i));
+    }
+
+    uint64_t readLE64(const unsigned char *p)
+    {
+        return readLE32(p) | (static_cast<uint64_t>(readLE32(p + 4)) << 32);
+    }
+
+    // Chunk size used for streaming reads and writes. A whole chunk is a
+    // multiple of 4096 bytes in every encoding.
+    const unsigned long kChunkFrames = 16384;
+
+    // RIFF header, 28-byte JUNK chunk (ds64 once RF64), fmt chunk and the
+    // data chunk's header. The fmt chunk takes 16 bytes, or 40 for
+    // WAVE_FORMAT_EXTENSIBLE.
+    const size_t kDs64Offset = 12;
+    const size_t kFmtOffset = 48;
+
+    // WAVE_FORMAT_EXTENSIBLE is required beyond two channels and for PCM
+    // wider than 16 bits
+    bool needsExtensible(const AudioFormat &format)
+    {
+        return format.channels > 2 || (format.encoding != SampleEncoding::Float32 && bytesPerSample(format.encoding) > 2);
+    }
+
+    size_t wavHeaderBytes(const AudioFormat &format)
+    {
+        return needsExtensible(format) ? 104 : 80;
+    }
+}
+
+int bytesPerSample(SampleEncoding encoding)
+{
+    switch (encoding)
+    {
+    case SampleEncoding::Int16:
+        return 2;
+    case SampleEncoding::Int24:
+        return 3;
+    case SampleEncoding::Int32:
+    case SampleEncoding::Float32:
+        return 4;
+    }
+    return 4;
+}
+
+const char *encodingName(SampleEncoding encoding)
+{
+    switch (encoding)
+    {
+    case SampleEncoding::Int16:
+        return "int16";
+    case SampleEncoding::Int24:
+        return "int24";
+    case SampleEncoding::Int32:
+        return "int32";
+    case SampleEncoding::Float32:
+        break;
+    }
+    return "float32";
+}
+
+bool parseEncoding(const std::string &name, SampleEncoding &encoding)
+{
+    for (SampleEncoding e : {SampleEncoding::Int16, SampleEncoding::Int24, SampleEncoding::Int32, SampleEncoding::Float32})
+    {
+        if (name == encodingName(e))
+        {
+            encoding = e;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool isWavPath(const std::string &path)
+{
+    if (path.size() < 4)
+        return false;
+
+    std::string ext = path.substr(path.size() - 4);
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c)
+                   { return static_cast<char>(std::tolower(c)); });
+    return ext == ".wav";
+}
+
+// ===================== Streaming Reader =====================
+AudioFileReader::~AudioFileReader()
+{
+    close();
+}
+
+void AudioFileReader::close()
+{
+    if (file_)
+    {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+bool AudioFileReader::openWav(const std::string &path)
+{
+    close();
+    file_ = std::fopen(path.c_str(), "rb");
+    if (!file_)
+    {
+        std::cerr << "[Error] Cannot open " << path << " for reading.\n";
+        return false;
+    }
+
+    unsigned char header[12];
+    if (std::fread(header, 1, 12, file_) != 12 ||
+        (std::memcmp(header, "RIFF", 4) != 0 && std::memcmp(header, "RF64", 4) != 0) ||
+        std::memcmp(header + 8, "WAVE", 4) != 0)
+    {
+        std::cerr << "[Error] " << path << " is not a RIFF/WAVE file.\n";
+        close();
+        return false;
+    }
+
+    bool haveFormat = false;
+    uint16_t formatTag = 0, bitsPerSample = 0;
+    uint64_t dataSize64 = 0; // from an RF64 file's ds64 chunk
+
+    // Walk the chunk list until the data chunk; the file position is then at the samples
+    while (true)
+    {
+        unsigned char chunk[8];
+        if (std::fread(chunk, 1, 8, file_) != 8)
+        {
+            std::cerr << "[Error] " << path << " has no data chunk.\n";
+            close();
+            return false;
+        }
+
+        uint32_t size = readLE32(chunk + 4);
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0)
+        {
+            std::vector<unsigned char> fmt(size);
+            if (size < 16 || std::fread(fmt.data(), 1, size, file_) != size)
+                break;
+
+            formatTag = readLE16(&fmt[0]);
+            format_.channels = readLE16(&fmt[2]);
+            format_.sampleRate = readLE32(&fmt[4]);
+            bitsPerSample = readLE16(&fmt[14]);
+
+            // Anything downstream divides by both
+            if (format_.channels == 0 || format_.sampleRate <= 0.0)
+                break;
+
+            // WAVE_FORMAT_EXTENSIBLE keeps the real format tag in the sub-format GUID
+            if (formatTag == WAVE_FORMAT_EXTENSIBLE)
+            {
+                if (size < 40 || std::memcmp(&fmt[26], kSubFormatTail, sizeof(kSubFormatTail)) != 0)
+                    break;
+                formatTag = readLE16(&fmt[24]);
+            }
+
+            haveFormat = true;
+            if (size & 1)
+                skipBytes(file_, 1);
+        }
+        else if (std::memcmp(chunk, "ds64", 4) == 0 && size >= 16)
+        {
+            unsigned char ds64[16];
+            if (std::fread(ds64, 1, 16, file_) != 16)
+                break;
+            dataSize64 = readLE64(ds64 + 8);
+            skipBytes(file_, size - 16 + (size & 1));
+        }
+        else if (std::memcmp(chunk, "data", 4) == 0)
+        {
+            if (!haveFormat)
+                break;
+
+            if (formatTag == WAVE_FORMAT_PCM && bitsPerSample == 16)
+                format_.encoding = SampleEncoding::Int16;
+            else if (formatTag == WAVE_FORMAT_PCM && bitsPerSample == 24)
+                format_.encoding = SampleEncoding::Int24;
+            else if (formatTag == WAVE_FORMAT_PCM && bitsPerSample == 32)
+                format_.encoding = SampleEncoding::Int32;
+            else if (formatTag == WAVE_FORMAT_IEEE_FLOAT && bitsPerSample == 32)
+                format_.encoding = SampleEncoding::Float32;
+            else
+            {
+                std::cerr << "[Error] Unsupported WAV sample format (tag " << formatTag
+                          << ", " << bitsPerSample << " bits).\n";
+                close();
+                return false;
+            }
+
+            if (format_.channels <= 0)
+                break;
+
+            uint64_t dataSize = size == 0xFFFFFFFFu && dataSize64 > 0 ? dataSize64 : size;
+            totalFrames_ = dataSize / (static_cast<uint64_t>(bytesPerSample(format_.encoding)) * format_.channels);
+            framesLeft_ = totalFrames_;
+            return true;
+        }
+        else
+        {
+            // Skip unknown chunks (padded to an even size)
+            skipBytes(file_, static_cast<uint64_t>(size) + (size & 1));
+        }
+    }
+
+    std::cerr << "[Error] " << path << " has a malformed format chunk.\n";
+    close();
+    return false;
+}
+
+bool AudioFileReader::openRaw(const std::string &path, const AudioFormat &format)
+{
+    close();
+    if (format.channels <= 0 || format.sampleRate <= 0.0)
+    {
+        std::cerr << "[Error] Raw input needs a sample rate and channel count.\n";
+        return false;
+    }
+
+    file_ = std::fopen(path.c_str(), "rb");
+    if (!file_)
+    {
+        std::cerr << "[Error] Cannot open " << path << " for reading.\n";
+        return false;
+    }
+
+    format_ = format;
+
+    // Unknown length: read until end of file
+    totalFrames_ = 0;
+    framesLeft_ = UINT64_MAX;
+    return true;
+}
+
+unsigned long AudioFileReader::read(float *output, unsigned long frameCount)
+{
+    if (!file_)
+        return 0;
+
+    const size_t frameBytes = static_cast<size_t>(bytesPerSample(format_.encoding)) * format_.channels;
+    unsigned long done = 0;
+
+    while (done < frameCount && framesLeft_ > 0)
+    {
+        unsigned long want = static_cast<unsigned long>(
+            std::min<uint64_t>({static_cast<uint64_t>(frameCount - done), framesLeft_, kChunkFrames}));
+
+        chunk_.resize(want * frameBytes);
+        size_t got = std::fread(chunk_.data(), frameBytes, want, file_);
+        if (got == 0)
+        {
+            framesLeft_ = 0;
+            break;
+        }
+
+        decodeSamples(chunk_.data(), output + static_cast<size_t>(done) * format_.channels,
+                      got * format_.channels, format_.encoding);
+        done += static_cast<unsigned long>(got);
+        framesLeft_ -= got;
+    }
+
+    return done;
+}
+
+// ===================== Streaming Writer =====================
+AudioFileWriter::~AudioFileWriter()
+{
+    close();
+}
+
+bool AudioFileWriter::openWav(const std::string &path, const AudioFormat &format, size_t dataAlignment)
+{
+    if (dataAlignment > 0 && (dataAlignment < 128 || (dataAlignment & (dataAlignment - 1)) != 0))
+    {
+        std::cerr << "[Error] WAV data alignment must be a power of two of at least 128 bytes.\n";
+        return false;
+    }
+    if (!openRaw(path, format))
+        return false;
+
+    isWav_ = true;
+    headerBytes_ = dataAlignment > 0 ? dataAlignment : wavHeaderBytes(format);
+    if (dataAlignment > 0)
+        std::setvbuf(file_, nullptr, _IONBF, 0);
+
+    // Placeholder sizes, patched in on close()
+    if (!writeHeader())
+    {
+        std::cerr << "[Error] Cannot write WAV header.\n";
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+bool AudioFileWriter::writeHeader()
+{
+    const int bytes = bytesPerSample(format_.encoding);
+    const uint32_t rate = static_cast<uint32_t>(format_.sampleRate);
+    const uint16_t blockAlign = static_cast<uint16_t>(bytes * format_.channels);
+    const uint64_t riffSize = headerBytes_ - 8 + dataBytes_;
+    const bool rf64 = riffSize > 0xFFFFFFFFull;
+
+    std::vector<unsigned char> header(headerBytes_, 0);
+    unsigned char *h = header.data();
+    std::memcpy(h, rf64 ? "RF64" : "RIFF", 4);
+    writeLE32(h + 4, rf64 ? 0xFFFFFFFFu : static_cast<uint32_t>(riffSize));
+    std::memcpy(h + 8, "WAVE", 4);
+
+    // ds64 carries the 64-bit sizes; a plain WAV keeps the space as JUNK
+    unsigned char *ds64 = h + kDs64Offset;
+    std::memcpy(ds64, rf64 ? "ds64" : "JUNK", 4);
+    writeLE32(ds64 + 4, 28);
+    if (rf64)
+    {
+        writeLE64(ds64 + 8, riffSize);
+        writeLE64(ds64 + 16, dataBytes_);
+        writeLE64(ds64 + 24, blockAlign > 0 ? dataBytes_ / blockAlign : 0);
+    }
+
+    const uint16_t formatTag = format_.encoding == SampleEncoding::Float32 ? WAVE_FORMAT_IEEE_FLOAT : WAVE_FORMAT_PCM;
+    const bool extensible = needsExtensible(format_);
+    unsigned char *fmt = h + kFmtOffset;
+    std::memcpy(fmt, "fmt ", 4);
+    writeLE32(fmt + 4, extensible ? 40 : 16);
+    writeLE16(fmt + 8, extensible ? WAVE_FORMAT_EXTENSIBLE : formatTag);
+    writeLE16(fmt + 10, static_cast<uint16_t>(format_.channels));
+    writeLE32(fmt + 12, rate);
+    writeLE32(fmt + 16, rate * blockAlign);
+    writeLE16(fmt + 20, blockAlign);
+    writeLE16(fmt + 22, static_cast<uint16_t>(bytes * 8));
+    if (extensible)
+    {
+        // Every bit valid; the first channels of the standard speaker order
+        // (front centre alone for mono)
+        uint32_t mask = format_.channels == 1 ? 0x4u : format_.channels <= 18 ? (1u << format_.channels) - 1 : 0u;
+        writeLE16(fmt + 24, 22);
+        writeLE16(fmt + 26, static_cast<uint16_t>(bytes * 8));
+        writeLE32(fmt + 28, mask);
+        writeLE16(fmt + 32, formatTag);
+        std::memcpy(fmt + 34, kSubFormatTail, sizeof(kSubFormatTail));
+    }
+
+    // Padding up to the requested alignment
+    const size_t minimal = wavHeaderBytes(format_);
+    if (headerBytes_ > minimal)
+    {
+        std::memcpy(h + minimal - 8, "JUNK", 4);
+        writeLE32(h + minimal - 4, static_cast<uint32_t>(headerBytes_ - minimal - 8));
+    }
+
+    unsigned char *data = h + headerBytes_ - 8;
+    std::memcpy(data, "data", 4);
+    writeLE32(data + 4, rf64 ? 0xFFFFFFFFu : static_cast<uint32_t>(dataBytes_));
+
+    return std::fseek(file_, 0, SEEK_SET) == 0 && std::fwrite(h, 1, header.size(), file_) == header.size();
+}
+
+bool AudioFileWriter::preallocate(uint64_t dataBytes)
+{
+#if defined(__linux__)
+    if (!file_ || std::fflush(file_) != 0)
+        return false;
+    uint64_t size = headerBytes_ + dataBytes_ + dataBytes;
+    if (posix_fallocate(fileno(file_), 0, static_cast<off_t>(size)) != 0)
+        return false;
+    reservedBytes_ = std::max(reservedBytes_, size);
+    return true;
+#else
+    (void)dataBytes;
+    return false;
+#endif
+}
+
+bool AudioFileWriter::openRaw(const std::string &path, const AudioFormat &format)
+{
+    close();
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_)
+    {
+        std::cerr << "[Error] Cannot open " << path << " for writing.\n";
+        return false;
+    }
+
+    format_ = format;
+    isWav_ = false;
+    headerBytes_ = 0;
+    dataBytes_ = 0;
+    reservedBytes_ = 0;
+    return true;
+}
+
+bool AudioFileWriter::write(const float *input, unsigned long frameCount)
+{
+    if (!file_)
+        return false;
+
+    const size_t frameBytes = static_cast<size_t>(bytesPerSample(format_.encoding)) * format_.channels;
+
+    for (unsigned long done = 0; done < frameCount;)
+    {
+        unsigned long n = std::min(frameCount - done, kChunkFrames);
+        chunk_.resize(n * frameBytes);
+        encodeSamples(input + static_cast<size_t>(done) * format_.channels, chunk_.data(),
+                      static_cast<size_t>(n) * format_.channels, format_.encoding);
+
+        if (std::fwrite(chunk_.data(), 1, chunk_.size(), file_) != chunk_.size())
+        {
+            std::cerr << "[Error] Write failed (disk full?).\n";
+            return false;
+        }
+
+        dataBytes_ += chunk_.size();
+        done += n;
+    }
+
+    return true;
+}
+
+bool AudioFileWriter::close()
+{
+    if (!file_)
+        return true;
+
+    bool ok = true;
+    if (isWav_ && !writeHeader())
+    {
+        std::cerr << "[Error] Cannot finalize WAV header.\n";
+        ok = false;
+    }
+
+#if defined(__linux__)
+    // Give back the preallocated space that was never written
+    if (reservedBytes_ > headerBytes_ + dataBytes_ &&
+        (std::fflush(file_) != 0 || ftruncate(fileno(file_), static_cast<off_t>(headerBytes_ + dataBytes_)) != 0))
+        ok = false;
+#endif
+
+    if (std::fclose(file_) != 0)
+        ok = false;
+
+    file_ = nullptr;
+    return ok;
+}
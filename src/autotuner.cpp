@@ -0,0 +1,106 @@
+#include "autotuner.h"
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+
+// ===================== Autotuner =====================
+Autotuner::Autotuner(double sampleRate, const Options &options)
+    : sampleRate_(sampleRate), options_(options)
+{
+}
+
+bool Autotuner::isStable(const StreamStats::Snapshot &stats, const Options &options)
+{
+    uint64_t xruns = stats.inputUnderflows + stats.inputOverflows +
+                     stats.outputUnderflows + stats.outputOverflows;
+
+    return stats.blocks > 0 && xruns == 0 &&
+           stats.averageLoad <= options.maxAverageLoad &&
+           stats.peakLoad <= options.maxPeakLoad;
+}
+
+bool Autotuner::run(const Trial &trial)
+{
+    steps_.clear();
+    result_ = BufferSettings();
+
+    unsigned long smallest = std::max(options_.smallestFrames, 1UL);
+    for (unsigned long frames = std::max(options_.largestFrames, smallest); frames >= smallest; frames /= 2)
+    {
+        Step step;
+        step.settings.framesPerBuffer = frames;
+        step.settings.suggestedLatency = options_.latencyPeriods * frames / sampleRate_;
+        step.opened = trial(step.settings, options_.soakSeconds, step.stats);
+        step.stable = step.opened && isStable(step.stats, options_);
+        steps_.push_back(step);
+
+        // Smaller buffers only get harder; one failure ends the search
+        if (!step.stable)
+            break;
+    }
+
+    size_t stable = 0;
+    while (stable < steps_.size() && steps_[stable].stable)
+        stable++;
+    if (stable == 0)
+        return false;
+
+    // Back off towards larger buffers, keeping at least the largest stable step
+    size_t margin = static_cast<size_t>(std::max(options_.marginSteps, 0));
+    size_t chosen = stable - 1 >= margin ? stable - 1 - margin : 0;
+    result_ = steps_[chosen].settings;
+    return true;
+}
+
+void printTuneSteps(std::ostream &out, const std::vector<Autotuner::Step> &steps, double sampleRate)
+{
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+
+    out << std::fixed << std::setprecision(2);
+    for (const auto &step : steps)
+    {
+        out << "  " << std::setw(5) << step.settings.framesPerBuffer << " frames ("
+            << std::setw(5) << step.settings.framesPerBuffer * 1000.0 / sampleRate << " ms): ";
+
+        if (!step.opened)
+        {
+            out << "could not open stream\n";
+            continue;
+        }
+
+        const auto &s = step.stats;
+        out << "load " << s.averageLoad * 100.0 << "% avg / " << s.peakLoad * 100.0 << "% peak, "
+            << s.inputUnderflows + s.inputOverflows + s.outputUnderflows + s.outputOverflows << " xrun(s) - "
+            << (step.stable ? "stable" : "unstable") << "\n";
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+// ===================== Persistence =====================
+std::string tuneKey(const std::string &inputDevice, const std::string &outputDevice, double sampleRate)
+{
+    std::ostringstream key;
+    key << "tune." << Settings::keyPart(inputDevice) << "." << Settings::keyPart(outputDevice) << "." << static_cast<long>(sampleRate);
+    return key.str();
+}
+
+bool loadTunedSettings(const Settings &settings, const std::string &key, BufferSettings &result)
+{
+    double frames = settings.getDouble(key + ".frames", 0.0);
+    if (frames < 1.0)
+        return false;
+
+    result.framesPerBuffer = static_cast<unsigned long>(frames);
+    result.suggestedLatency = std::max(settings.getDouble(key + ".latency", 0.0), 0.0);
+    return true;
+}
+
+void storeTunedSettings(Settings &settings, const std::string &key, const BufferSettings &result)
+{
+    settings.set(key + ".frames", static_cast<double>(result.framesPerBuffer));
+    settings.set(key + ".latency", result.suggestedLatency);
+}
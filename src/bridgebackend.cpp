@@ -0,0 +1,270 @@
+#include "bridgebackend.h"
+#include "dspthread.h"
+#include "portaudiobackend.h"
+#include "rtguard.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    // One clock for both callbacks: each stream's own timestamps may run on
+    // a time base of their own. Reading it is a vDSO call, not a system call.
+    double bridgeTime()
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+// ===================== Constructor / Destructor =====================
+BridgeBackend::~BridgeBackend()
+{
+    close();
+}
+
+// ===================== Stream Management =====================
+double BridgeBackend::inputRate(const StreamConfig &config)
+{
+    static const double standardRates[] = {
+        8000.0, 11025.0, 16000.0, 22050.0, 32000.0,
+        44100.0, 48000.0, 88200.0, 96000.0, 192000.0};
+
+    PaStreamParameters input{};
+    if (!PortAudioBackend::toParameters(config, true, input))
+        return 0.0;
+
+    if (Pa_IsFormatSupported(&input, nullptr, config.sampleRate) == paFormatIsSupported)
+        return config.sampleRate;
+
+    // Nearest first; on a tie the higher rate keeps more of the band
+    std::vector<double> rates(std::begin(standardRates), std::end(standardRates));
+    std::sort(rates.begin(), rates.end(), [&](double a, double b)
+              {
+                  double da = std::abs(a - config.sampleRate), db = std::abs(b - config.sampleRate);
+                  return da != db ? da < db : a > b;
+              });
+
+    for (double rate : rates)
+    {
+        if (Pa_IsFormatSupported(&input, nullptr, rate) == paFormatIsSupported)
+            return rate;
+    }
+    return 0.0;
+}
+
+bool BridgeBackend::isFormatSupported(const StreamConfig &config)
+{
+    PaStreamParameters output{};
+    if (!PortAudioBackend::toParameters(config, false, output))
+        return false;
+
+    return Pa_IsFormatSupported(nullptr, &output, config.sampleRate) == paFormatIsSupported &&
+           inputRate(config) > 0.0;
+}
+
+bool BridgeBackend::open(const StreamConfig &config, AudioCallback *callback)
+{
+    close();
+
+    PaStreamParameters input{}, output{};
+    if (!PortAudioBackend::toParameters(config, true, input) || !PortAudioBackend::toParameters(config, false, output))
+    {
+        std::cerr << "PortAudio error: Invalid device selection" << std::endl;
+        return false;
+    }
+
+    PaError support = Pa_IsFormatSupported(nullptr, &output, config.sampleRate);
+    if (support != paFormatIsSupported)
+    {
+        std::cerr << "Format not supported: " << Pa_GetErrorText(support) << std::endl;
+        return false;
+    }
+
+    double rate = inputRate(config);
+    if (rate <= 0.0)
+    {
+        std::cerr << "Format not supported: the input device accepts none of the standard sample rates" << std::endl;
+        return false;
+    }
+
+    // Each side keeps its own period; the input's covers the same time
+    unsigned long inputFrames = paFramesPerBufferUnspecified;
+    if (config.framesPerBuffer != 0)
+        inputFrames = std::max(1ul, static_cast<unsigned long>(std::lround(config.framesPerBuffer * rate / config.sampleRate)));
+
+    // A host that picks the input period may hand over long ones; the ring
+    // is sized for the longest assumed and pushes are split to it
+    maxFrames_ = config.framesPerBuffer != 0 ? config.framesPerBuffer : AudioEngine::kDefaultMaxFrames;
+    maxInputFrames_ = inputFrames != paFramesPerBufferUnspecified ? inputFrames : DspThread::kMaxHostFrames;
+    unsigned long converterFrames = inputFrames != paFramesPerBufferUnspecified ? inputFrames : AudioEngine::kDefaultMaxFrames;
+
+    inputChannels_ = config.inputChannels;
+    outputChannels_ = config.outputChannels;
+    outputRate_ = config.sampleRate;
+    input_.assign(maxFrames_ * inputChannels_, 0.0f);
+    inputConverter_.prepare(config.inputEncoding, inputChannels_, converterFrames);
+    outputConverter_.prepare(config.outputEncoding, outputChannels_, maxFrames_);
+    bridge_.prepare(inputChannels_, rate, config.sampleRate, maxInputFrames_, maxFrames_);
+    inputFlags_.store(0, std::memory_order_relaxed);
+    inputLatency_.store(0.0, std::memory_order_relaxed);
+    callback_ = callback;
+
+    PaError err = Pa_OpenStream(&inputStream_, &input, nullptr, rate, inputFrames,
+                                paClipOff, inputCallback, this);
+    if (err != paNoError)
+    {
+        inputStream_ = nullptr;
+    }
+    else
+    {
+        err = Pa_OpenStream(&outputStream_, nullptr, &output, config.sampleRate,
+                            config.framesPerBuffer == 0 ? paFramesPerBufferUnspecified : config.framesPerBuffer,
+                            paClipOff, outputCallback, this);
+        if (err != paNoError)
+            outputStream_ = nullptr;
+    }
+
+    if (err != paNoError)
+    {
+        std::cerr << "PortAudio error: " << Pa_GetErrorText(err) << std::endl;
+        close();
+        return false;
+    }
+
+    if (rate != config.sampleRate)
+        std::cout << "[Info] Bridging input at " << rate << " Hz to output at " << config.sampleRate << " Hz\n";
+
+    return true;
+}
+
+bool BridgeBackend::start()
+{
+    if (!outputStream_)
+        return false;
+
+    // Input first, so the ring is filling by the time the output asks for it
+    PaError err = Pa_StartStream(inputStream_);
+    if (err == paNoError)
+    {
+        err = Pa_StartStream(outputStream_);
+        if (err != paNoError)
+            Pa_StopStream(inputStream_);
+    }
+
+    if (err != paNoError)
+    {
+        std::cerr << "PortAudio error: " << Pa_GetErrorText(err) << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+void BridgeBackend::close()
+{
+    // Output first: it is the only reader of what the input callback shares
+    if (outputStream_)
+    {
+        Pa_CloseStream(outputStream_);
+        outputStream_ = nullptr;
+    }
+    if (inputStream_)
+    {
+        Pa_CloseStream(inputStream_);
+        inputStream_ = nullptr;
+    }
+}
+
+// ===================== Audio Callbacks =====================
+int BridgeBackend::inputCallback(const void *inputBuffer, void *,
+                                 unsigned long framesPerBuffer,
+                                 const PaStreamCallbackTimeInfo *timeInfo,
+                                 PaStreamCallbackFlags statusFlags,
+                                 void *userData)
+{
+    RealtimeScope realtime;
+    BridgeBackend *backend = static_cast<BridgeBackend *>(userData);
+
+    unsigned flags = 0;
+    if (statusFlags & paInputUnderflow)
+        flags |= StreamStats::InputUnderflow;
+    if (statusFlags & paInputOverflow)
+        flags |= StreamStats::InputOverflow;
+    if (flags)
+        backend->inputFlags_.fetch_or(flags, std::memory_order_relaxed);
+
+    if (timeInfo && timeInfo->currentTime > 0.0 && timeInfo->inputBufferAdcTime > 0.0)
+        backend->inputLatency_.store(timeInfo->currentTime - timeInfo->inputBufferAdcTime, std::memory_order_relaxed);
+
+    if (!inputBuffer)
+        return paContinue;
+
+    // Input goes across in pieces no longer than the bridge was prepared
+    // for, and converted input in pieces that fit the converter's scratch
+    const double now = bridgeTime();
+    SampleConverter &converter = backend->inputConverter_;
+    unsigned long piece = backend->maxInputFrames_;
+    if (converter.converts())
+        piece = std::min(piece, converter.maxFrames());
+    const char *input = static_cast<const char *>(inputBuffer);
+    for (unsigned long done = 0; done < framesPerBuffer;)
+    {
+        unsigned long frames = std::min(framesPerBuffer - done, piece);
+        backend->bridge_.push(converter.read(input + done * converter.frameBytes(), frames), frames, now);
+        done += frames;
+    }
+    return paContinue;
+}
+
+int BridgeBackend::outputCallback(const void *, void *outputBuffer,
+                                  unsigned long framesPerBuffer,
+                                  const PaStreamCallbackTimeInfo *timeInfo,
+                                  PaStreamCallbackFlags statusFlags,
+                                  void *userData)
+{
+    RealtimeScope realtime;
+    BridgeBackend *backend = static_cast<BridgeBackend *>(userData);
+
+    BlockInfo info;
+    info.flags = backend->inputFlags_.exchange(0, std::memory_order_relaxed);
+    if (statusFlags & paOutputUnderflow)
+        info.flags |= StreamStats::OutputUnderflow;
+    if (statusFlags & paOutputOverflow)
+        info.flags |= StreamStats::OutputOverflow;
+    if (statusFlags & paPrimingOutput)
+        info.flags |= StreamStats::PrimingOutput;
+
+    if (timeInfo && timeInfo->currentTime > 0.0 && timeInfo->outputBufferDacTime > 0.0)
+    {
+        info.outputLatency = timeInfo->outputBufferDacTime - timeInfo->currentTime;
+        info.streamTime = timeInfo->outputBufferDacTime;
+    }
+
+    // Capture to callback now includes the time spent crossing the bridge
+    info.inputLatency = backend->inputLatency_.load(std::memory_order_relaxed) +
+                        backend->bridge_.status().latencySeconds;
+
+    const double now = bridgeTime();
+    SampleConverter &converter = backend->outputConverter_;
+    char *output = static_cast<char *>(outputBuffer);
+    for (unsigned long done = 0; done < framesPerBuffer;)
+    {
+        unsigned long frames = std::min(framesPerBuffer - done, backend->maxFrames_);
+        // The host's flags describe the period once; the bridge's go with
+        // the piece that came up short
+        BlockInfo block = info;
+        if (done > 0)
+            block.flags = 0;
+        block.flags |= backend->bridge_.pull(backend->input_.data(), frames, now);
+        if (info.streamTime > 0.0)
+            block.streamTime = info.streamTime + done / backend->outputRate_;
+
+        void *out = output + done * converter.frameBytes();
+        backend->callback_->process(backend->input_.data(), converter.target(out), frames, block);
+        converter.write(out, frames);
+        done += frames;
+    }
+    return paContinue;
+}
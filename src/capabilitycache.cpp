@@ -0,0 +1,143 @@
+#include "capabilitycache.h"
+#include <portaudio.h>
+#include <sstream>
+
+// ===================== File Location =====================
+std::string CapabilityCache::defaultPath()
+{
+    return Settings::defaultPath() + ".cache";
+}
+
+// ===================== Fingerprint =====================
+uint64_t CapabilityCache::fingerprint()
+{
+    // FNV-1a over what identifies each device; reading the enumerated list
+    // is cheap, unlike opening devices to test formats
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&](const std::string &text)
+    {
+        for (unsigned char c : text)
+        {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        hash ^= 0xff;
+        hash *= 1099511628211ULL;
+    };
+
+    int count = Pa_GetDeviceCount();
+    mix(std::to_string(count));
+    for (int i = 0; i < count; i++)
+    {
+        const PaDeviceInfo *info = Pa_GetDeviceInfo(i);
+        if (!info)
+            continue;
+
+        const PaHostApiInfo *api = Pa_GetHostApiInfo(info->hostApi);
+        mix(api ? api->name : "");
+        mix(info->name ? info->name : "");
+        mix(std::to_string(info->maxInputChannels) + "/" + std::to_string(info->maxOutputChannels));
+    }
+
+    return hash;
+}
+
+// ===================== Load / Save =====================
+bool CapabilityCache::load(const std::string &path)
+{
+    dirty_ = false;
+    return entries_.load(path);
+}
+
+bool CapabilityCache::save(const std::string &path)
+{
+    if (!dirty_)
+        return true;
+
+    dirty_ = !entries_.save(path);
+    return !dirty_;
+}
+
+void CapabilityCache::validate(uint64_t fingerprint)
+{
+    std::string expected = std::to_string(fingerprint);
+    if (entries_.get("fingerprint") == expected)
+        return;
+
+    entries_ = Settings();
+    entries_.set("fingerprint", expected);
+    dirty_ = true;
+}
+
+// ===================== Devices =====================
+bool CapabilityCache::getDevices(const std::string &hostApi, std::vector<DeviceInfo> &devices) const
+{
+    std::string prefix = "devices." + Settings::keyPart(hostApi);
+    if (!entries_.has(prefix + ".count"))
+        return false;
+
+    int count = static_cast<int>(entries_.getDouble(prefix + ".count", 0.0));
+    devices.clear();
+    for (int i = 0; i < count; i++)
+    {
+        // index|inputs|outputs|name
+        std::istringstream line(entries_.get(prefix + "." + std::to_string(i)));
+        DeviceInfo device;
+        char bar = 0;
+        if (!(line >> device.index >> bar >> device.maxInputChannels >> bar >> device.maxOutputChannels >> bar))
+            return false;
+        std::getline(line, device.name);
+        devices.push_back(device);
+    }
+
+    return true;
+}
+
+void CapabilityCache::setDevices(const std::string &hostApi, const std::vector<DeviceInfo> &devices)
+{
+    std::string prefix = "devices." + Settings::keyPart(hostApi);
+    entries_.removePrefix(prefix + ".");
+    entries_.set(prefix + ".count", static_cast<double>(devices.size()));
+
+    for (size_t i = 0; i < devices.size(); i++)
+    {
+        const DeviceInfo &d = devices[i];
+        entries_.set(prefix + "." + std::to_string(i),
+                     std::to_string(d.index) + "|" + std::to_string(d.maxInputChannels) + "|" +
+                         std::to_string(d.maxOutputChannels) + "|" + d.name);
+    }
+
+    dirty_ = true;
+}
+
+// ===================== Sample Rates =====================
+std::string CapabilityCache::rateKey(const std::string &input, int inputChannels,
+                                     const std::string &output, int outputChannels)
+{
+    return "rates." + Settings::keyPart(input) + "." + std::to_string(inputChannels) + "." +
+           Settings::keyPart(output) + "." + std::to_string(outputChannels);
+}
+
+bool CapabilityCache::getSampleRates(const std::string &key, std::vector<double> &rates) const
+{
+    if (!entries_.has(key))
+        return false;
+
+    rates.clear();
+    std::istringstream list(entries_.get(key));
+    double rate = 0.0;
+    while (list >> rate)
+        rates.push_back(rate);
+
+    return true;
+}
+
+void CapabilityCache::setSampleRates(const std::string &key, const std::vector<double> &rates)
+{
+    std::ostringstream list;
+    for (double rate : rates)
+        list << rate << " ";
+
+    entries_.set(key, list.str());
+    dirty_ = true;
+}
@@ -1,15 +1,26 @@
 #include "commandhandler.h"
 #include "digitalamp.h"
+#include "autotuner.h"
 
+#include <algorithm>
 #include <iostream>
 #include <cstdlib>
+#include <fstream>
 #include <limits>
+#include <optional>
 #include <unordered_map>
 #include <functional>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <chrono>
+#include <ctime>
 
 // ===================== Constructor =====================
-CommandHandler::CommandHandler(DigitalAmp *amp) : amp(amp)
+CommandHandler::CommandHandler(DigitalAmp *amp) : settingsPath(Settings::defaultPath()), amp(amp)
 {
+    settings.load(settingsPath);
+
     // Initialize command table
     commands = {
         {"help", [this] { showHelp(); }},
@@ -20,7 +31,26 @@ CommandHandler::CommandHandler(DigitalAmp *amp) : amp(amp)
         {"stop", [this] { closeStream(); }},
         {"exit", [this] { exitApp(); }},
         {"clear", [this] { clearConsole(); }},
-        {"gain", [this] { setGain(); }}
+        {"gain", [this] { setGain(); }},
+        {"drive", [this] { setDrive(); }},
+        {"cab", [this] { loadCabinet(); }},
+        {"model", [this] { loadAmpModel(); }},
+        {"chain", [this] { editChain(); }},
+        {"stats", [this] { showStats(); }},
+        {"statslog", [this] { exportStats(); }},
+        {"parallel", [this] { setParallel(); }},
+        {"tune", [this] { tuneLatency(); }},
+        {"profile", [this] { editProfiles(); }},
+        {"rescan", [this] { rescanDevices(); }},
+        {"bridge", [this] { setBridging(); }},
+        {"format", [this] { setSampleFormat(); }},
+        {"dsp", [this] { setDspThread(); }},
+        {"idle", [this] { setIdleBypass(); }},
+        {"thread", [this] { setAudioThread(); }},
+        {"record", [this] { setRecording(); }},
+        {"script", [this] { playScript(); }},
+        {"tuner", [this] { watchAnalysis(true); }},
+        {"meter", [this] { watchAnalysis(false); }}
     };
 }
 
@@ -62,7 +92,6 @@ void CommandHandler::chooseInput()
     amp->createStreamParameters(
         selectedDevice.index,
         selectedDevice.maxInputChannels,
-        paFloat32,
         true);
 
     std::cout << "[Info] Selected input device: "
@@ -70,6 +99,487 @@ void CommandHandler::chooseInput()
               << " (" << selectedDevice.maxInputChannels << " channels)\n";
 }
 
+void CommandHandler::rescanDevices()
+{
+    if (amp->rescanDevices())
+        std::cout << "[Info] Device list changed; select input and output again.\n";
+    else
+        std::cout << "[Info] No device changes found.\n";
+}
+
+void CommandHandler::setBridging()
+{
+    DeviceBridge::Status status;
+    if (amp->isRunning() && amp->getBridgeStatus(status))
+    {
+        std::ios::fmtflags flags = std::cout.flags();
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "[Info] Bridging " << status.inputRate << " Hz input to " << status.outputRate << " Hz output"
+                  << (status.running ? "" : " (priming)") << "\n";
+        std::cout << "   Drift: " << std::showpos << status.driftPpm << std::noshowpos << " ppm\n";
+        std::cout << "   Ring: " << status.fillFrames << " frames (target " << status.targetFrames << ")\n";
+        std::cout << "   Added latency: " << status.latencySeconds * 1000.0 << " ms\n";
+        std::cout << "   Underruns / overruns: " << status.underruns << " / " << status.overruns << "\n";
+        std::cout.flags(flags);
+    }
+
+    std::cout << "Bridge mode is " << (amp->isBridging() ? "on" : "off")
+              << ". Enter 'y' to run input and output as separate streams, 'n' for one duplex stream,\n"
+              << "or press Enter to keep: ";
+    std::string line;
+    std::getline(std::cin, line);
+    if (line.empty() || (line == "y") == amp->isBridging())
+        return;
+    if (line != "y" && line != "n")
+    {
+        std::cerr << "[Error] Invalid input. Bridge mode unchanged.\n";
+        return;
+    }
+
+    // Switching backends stops the stream
+    bool wasRunning = amp->isRunning();
+    amp->setBridging(line == "y");
+    std::cout << "[Info] Bridge mode " << (amp->isBridging() ? "on" : "off") << ".\n";
+    if (wasRunning)
+        startStream();
+}
+
+void CommandHandler::setSampleFormat()
+{
+    if (amp->isRunning())
+        std::cout << "[Info] Devices running in " << encodingName(amp->getInputEncoding()) << " (input) and "
+                  << encodingName(amp->getOutputEncoding()) << " (output)\n";
+
+    std::optional<SampleEncoding> format = amp->getSampleFormat();
+    std::cout << "Sample format is " << (format ? encodingName(*format) : "auto")
+              << ". Enter 'auto' to negotiate one per device, 'float32', 'int32', 'int24' or 'int16' to ask\n"
+              << "both devices for it, or press Enter to keep: ";
+    std::string line;
+    std::getline(std::cin, line);
+    std::istringstream in(line);
+    std::string name;
+    if (!(in >> name))
+        return;
+
+    SampleEncoding encoding;
+    if (name == "auto")
+        format.reset();
+    else if (parseEncoding(name, encoding))
+        format = encoding;
+    else
+    {
+        std::cerr << "[Error] Invalid input. Sample format unchanged.\n";
+        return;
+    }
+
+    // The format is negotiated when the stream opens
+    bool wasRunning = amp->isRunning();
+    if (wasRunning)
+        amp->stopStream();
+    amp->setSampleFormat(format);
+    std::cout << "[Info] Sample format " << (format ? encodingName(*format) : "auto") << ".\n";
+    if (wasRunning)
+        startStream();
+}
+
+void CommandHandler::setDspThread()
+{
+    DspThread::Options options = amp->getDspOptions();
+    if (amp->isRunning() && amp->getDspThread())
+    {
+        const DspThread::Placement &placement = amp->getDsp().placement();
+        std::cout << "[Info] DSP thread on ";
+        if (placement.core >= 0)
+            std::cout << "core " << placement.core;
+        else
+            std::cout << "any core";
+        std::cout << ", " << (placement.realtime ? "real-time" : "normal") << " priority, memory "
+                  << (placement.memoryLocked ? "locked" : "not locked") << "\n";
+        std::cout << "   Lookahead: " << options.lookahead << " block(s)\n";
+        std::cout << "   Late blocks: " << amp->getDsp().lateBlocks() << "\n";
+    }
+
+    std::cout << "DSP thread is " << (amp->getDspThread() ? "on" : "off")
+              << ". Enter 'on [LOOKAHEAD] [CORE]' to process on a dedicated thread (defaults "
+              << options.lookahead << ", " << (options.core < 0 ? "auto" : std::to_string(options.core)) << "),\n"
+              << "'off' to process in the driver callback, or press Enter to keep: ";
+    std::string line;
+    std::getline(std::cin, line);
+    std::istringstream in(line);
+    std::string mode;
+    if (!(in >> mode))
+        return;
+
+    bool enabled = mode == "on";
+    if (enabled)
+    {
+        // Optional numbers, in order; a core below 0 picks one automatically
+        int value = 0;
+        if (in >> value)
+        {
+            options.lookahead = value;
+            if (in >> value)
+                options.core = value;
+        }
+    }
+    if ((mode != "on" && mode != "off") || !in.eof() || options.lookahead < 0)
+    {
+        std::cerr << "[Error] Invalid input. DSP thread unchanged.\n";
+        return;
+    }
+
+    // The callbacks are wired when the stream opens
+    bool wasRunning = amp->isRunning();
+    if (wasRunning)
+        amp->stopStream();
+    amp->setDspThread(enabled, options);
+    std::cout << "[Info] DSP thread " << (enabled ? "on" : "off") << ".\n";
+    if (wasRunning)
+        startStream();
+}
+
+void CommandHandler::setIdleBypass()
+{
+    AudioEngine::IdleOptions options = amp->getIdleOptions();
+    if (amp->isRunning() && options.enabled)
+        std::cout << "[Info] Input is " << (amp->isIdle() ? "idle; the chain is bypassed" : "active")
+                  << ", " << amp->idleBlocks() << " block(s) bypassed so far\n";
+
+    std::cout << "Idle bypass is " << (options.enabled ? "on" : "off") << " (open " << options.openDb
+              << " dBFS, close " << options.closeDb << " dBFS).\n"
+              << "Enter 'on [OPEN_DB] [CLOSE_DB]' to skip the chain while the input is silent, 'off' to always\n"
+              << "process, or press Enter to keep: ";
+    std::string line;
+    std::getline(std::cin, line);
+    std::istringstream in(line);
+    std::string mode;
+    if (!(in >> mode))
+        return;
+
+    options.enabled = mode == "on";
+    if (options.enabled)
+    {
+        // Optional levels, in order; closing defaults to 6 dB below opening
+        float value = 0.0f;
+        if (in >> value)
+        {
+            options.openDb = value;
+            options.closeDb = value - 6.0f;
+            if (in >> value)
+                options.closeDb = value;
+        }
+    }
+    if ((mode != "on" && mode != "off") || !in.eof() || options.openDb > 0.0f || options.closeDb > options.openDb)
+    {
+        std::cerr << "[Error] Invalid input. Idle bypass unchanged.\n";
+        return;
+    }
+
+    amp->setIdleOptions(options);
+    std::cout << "[Info] Idle bypass " << (options.enabled ? "on" : "off") << ".\n";
+}
+
+void CommandHandler::setAudioThread()
+{
+    ThreadState state;
+    if (amp->getThreadState(state))
+    {
+        std::cout << "[Info] Audio thread " << (amp->getDspThread() ? "(DSP thread) " : "");
+        if (state.core >= 0)
+            std::cout << "on core " << state.core;
+        if (state.allowedCores > 0)
+            std::cout << (state.core >= 0 ? " of " : "allowed on ") << state.allowedCores << " allowed";
+        std::cout << "\n   Scheduling: ";
+        if (state.realtime)
+            std::cout << "real-time, priority " << state.priority << "\n";
+        else
+            std::cout << "normal\n";
+        std::cout << "   Denormals flushed to zero: " << (state.flushDenormals ? "yes" : "no") << "\n";
+        std::cout << "   Memory locked: " << (state.memoryLocked ? "yes" : "no") << "\n";
+    }
+
+    ThreadSetup setup = amp->getThreadSetup();
+    std::cout << "Audio thread setup: ftz " << (setup.flushDenormals ? "on" : "off") << ", priority " << setup.priority
+              << ", core " << setup.core << ", mlock " << (setup.lockMemory ? "on" : "off") << ".\n"
+              << "Enter any of 'ftz on|off', 'priority N' (0 keeps the host's), 'core N' (-1 for any) and\n"
+              << "'mlock on|off', or press Enter to keep: ";
+    std::string line;
+    std::getline(std::cin, line);
+    std::istringstream in(line);
+
+    std::string key, value;
+    bool changed = false;
+    while (in >> key)
+    {
+        bool ok = static_cast<bool>(in >> value);
+        if (ok && (key == "ftz" || key == "mlock"))
+        {
+            ok = value == "on" || value == "off";
+            (key == "ftz" ? setup.flushDenormals : setup.lockMemory) = value == "on";
+        }
+        else if (ok && (key == "priority" || key == "core"))
+        {
+            try
+            {
+                size_t used = 0;
+                int number = std::stoi(value, &used);
+                ok = used == value.size() && (key == "priority" ? number >= 0 && number <= 99 : number >= -1);
+                (key == "priority" ? setup.priority : setup.core) = number;
+            }
+            catch (...)
+            {
+                ok = false;
+            }
+        }
+        else
+            ok = false;
+
+        if (!ok)
+        {
+            std::cerr << "[Error] Invalid input. Audio thread setup unchanged.\n";
+            return;
+        }
+        changed = true;
+    }
+    if (!changed)
+        return;
+
+    // Applied on the first callback of a stream
+    bool wasRunning = amp->isRunning();
+    if (wasRunning)
+        amp->stopStream();
+    amp->setThreadSetup(setup);
+    std::cout << "[Info] Audio thread setup changed.\n";
+    if (wasRunning)
+        startStream();
+}
+
+void CommandHandler::setRecording()
+{
+    if (amp->isRecording())
+    {
+        SessionRecorder::Status status = amp->getRecordingStatus();
+        double seconds = amp->sampleRate > 0.0 ? status.framesWritten / amp->sampleRate : 0.0;
+        std::cout << "[Info] Recording to " << status.dryPath << " and " << status.wetPath << "\n"
+                  << "   Written: " << std::fixed << std::setprecision(1) << seconds << " s\n"
+                  << "   Dropped: " << status.droppedBlocks << " block(s), " << status.droppedFrames << " frame(s)\n"
+                  << "   Buffer: " << status.bufferBytes / (1024 * 1024) << " MB, peak use "
+                  << std::setprecision(0) << status.peakFill * 100.0 << "%\n"
+                  << std::defaultfloat << std::setprecision(6);
+        if (status.writeFailed)
+            std::cerr << "[Error] Writing failed; the rest of the session is not being saved.\n";
+    }
+
+    std::cout << "Recording is " << (amp->isRecording() ? "on" : "off") << ".\n"
+              << "Enter 'on [BASE_PATH] [PREALLOCATE_MINUTES]' to record the dry input and the processed\n"
+              << "output to BASE_PATH-dry.wav and BASE_PATH-wet.wav, 'off' to stop, or press Enter to keep: ";
+    std::string line;
+    std::getline(std::cin, line);
+    std::istringstream in(line);
+    std::string mode;
+    if (!(in >> mode))
+        return;
+
+    if (mode == "off" && in.eof())
+    {
+        if (!amp->isRecording())
+            return;
+        SessionRecorder::Status status = amp->getRecordingStatus();
+        if (amp->stopRecording())
+            std::cout << "[Info] Recording saved: " << status.dryPath << ", " << status.wetPath << "\n";
+        else
+            std::cerr << "[Error] Recording stopped, but the files may be incomplete.\n";
+        return;
+    }
+
+    // Defaults to a name from the current time in the working directory
+    std::string base;
+    double minutes = 0.0;
+    if (!(in >> base))
+    {
+        char stamp[32];
+        std::time_t now = std::time(nullptr);
+        std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", std::localtime(&now));
+        base = std::string("amply-") + stamp;
+    }
+    else if (!in.eof() && !(in >> minutes))
+        minutes = -1.0;
+
+    if (mode != "on" || !in.eof() || minutes < 0.0)
+    {
+        std::cerr << "[Error] Invalid input. Recording unchanged.\n";
+        return;
+    }
+    if (!amp->isRunning())
+    {
+        std::cerr << "[Error] Start the stream before recording.\n";
+        return;
+    }
+
+    SessionRecorder::Options options;
+    options.preallocateSeconds = minutes * 60.0;
+    if (!amp->startRecording(base, options))
+    {
+        std::cerr << "[Error] Could not start recording.\n";
+        return;
+    }
+    std::cout << "[Info] Recording to " << base << "-dry.wav and " << base << "-wet.wav\n";
+}
+
+void CommandHandler::playScript()
+{
+    double streamTime = 0.0;
+    if (amp->isRunning())
+    {
+        std::cout << "[Info] Stream at frame " << amp->streamFrame();
+        if (amp->getStreamTime(streamTime))
+            std::cout << ", stream clock " << std::fixed << std::setprecision(3) << streamTime << " s"
+                      << std::defaultfloat << std::setprecision(6);
+        std::cout << "\n";
+    }
+    if (scriptPlayer.playing() || amp->pendingEvents() > 0)
+        std::cout << "[Info] Script playing, " << amp->pendingEvents() << " event(s) queued.\n";
+
+    std::cout << "Enter a script file, '-' to type one (end it with a line '.'), 'stop' to stop\n"
+              << "feeding the current one, or press Enter to keep: ";
+    std::string line;
+    std::getline(std::cin, line);
+    if (line.empty())
+        return;
+
+    if (line == "stop")
+    {
+        scriptPlayer.stop();
+        std::cout << "[Info] Script stopped; events already queued still land.\n";
+        return;
+    }
+    if (!amp->isRunning())
+    {
+        std::cerr << "[Error] Start the stream before playing a script.\n";
+        return;
+    }
+
+    // Offsets count from now; names resolve against the chain as it is now
+    EventScript script;
+    bool parsed = false;
+    if (line == "-")
+    {
+        std::stringstream text;
+        std::string entry;
+        while (std::getline(std::cin, entry) && entry != ".")
+            text << entry << '\n';
+        parsed = script.parse(text, amp->getEffects(), amp->sampleRate);
+    }
+    else
+    {
+        std::ifstream file(line);
+        if (!file)
+        {
+            std::cerr << "[Error] Could not open " << line << "\n";
+            return;
+        }
+        parsed = script.parse(file, amp->getEffects(), amp->sampleRate);
+    }
+
+    auto clock = [this](double time, uint64_t &frame)
+    { return amp->frameAtStreamTime(time, frame); };
+    if (!parsed || !script.start(amp->streamFrame(), clock))
+        return;
+
+    size_t count = script.size();
+    scriptPlayer.start(
+        std::move(script), [this]
+        { return amp->streamFrame(); },
+        [this](const ControlEvent *events, size_t n)
+        { return amp->scheduleEvents(events, n); },
+        amp->sampleRate);
+    std::cout << "[Info] Playing " << count << " event(s).\n";
+}
+
+void CommandHandler::watchAnalysis(bool tuner)
+{
+    std::cout << "Analysis is " << (amp->isAnalyzing() ? "on" : "off") << ".\n"
+              << "Enter seconds to watch, 'off' to take the tap out of the chain, or press Enter for 5: ";
+    std::string line;
+    std::getline(std::cin, line);
+    if (line == "off")
+    {
+        if (amp->isAnalyzing())
+        {
+            amp->stopAnalysis();
+            std::cout << "[Info] Analysis stopped.\n";
+        }
+        return;
+    }
+
+    double seconds = 5.0;
+    std::istringstream in(line);
+    std::string extra;
+    if (!line.empty() && (!(in >> seconds) || in >> extra || seconds <= 0.0))
+    {
+        std::cerr << "[Error] Invalid input.\n";
+        return;
+    }
+    if (!amp->isRunning())
+    {
+        std::cerr << "[Error] Start the stream before watching it.\n";
+        return;
+    }
+    if (!amp->isAnalyzing())
+    {
+        amp->startAnalysis();
+        std::cout << "[Info] Analysis on: a tap now feeds the analyzer from the start of the chain.\n";
+    }
+    if (!tuner)
+    {
+        auto edges = Analyzer::bandEdges();
+        std::cout << "[Info] Bands from " << edges.front() << " Hz to " << edges.back() / 1000.0f
+                  << " kHz; each mark is 10 dB, from -90 dBFS.\n";
+    }
+
+    // Readings older than a few hops mean the stream has stopped feeding the tap
+    const auto stale = std::chrono::milliseconds(100);
+    const auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+    while (std::chrono::steady_clock::now() < end)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        Analyzer::Reading reading = amp->getAnalysis();
+        bool current = reading.updates > 0 && std::chrono::steady_clock::now() - reading.time < stale;
+
+        std::ostringstream out;
+        out << std::fixed;
+        if (tuner)
+        {
+            if (!current || !reading.signal)
+                out << "  --   no signal";
+            else if (!reading.pitched)
+                out << "  --   no pitch";
+            else
+            {
+                // A needle 50 cents either side of the note
+                Note note = nearestNote(reading.frequency);
+                std::string needle(21, ' ');
+                needle[10] = '|';
+                needle[std::clamp(static_cast<int>(std::lround(note.cents / 5.0f)) + 10, 0, 20)] = '*';
+                out << "  " << std::left << std::setw(4) << note.name << std::right << std::setprecision(1)
+                    << std::showpos << std::setw(6) << note.cents << std::noshowpos << " cents  [" << needle << "]  "
+                    << std::setprecision(2) << std::setw(7) << reading.frequency << " Hz";
+            }
+        }
+        else
+        {
+            static const char kLevels[] = " .:-=+*#%@";
+            std::string bars;
+            for (float db : reading.bandsDb)
+                bars += current ? kLevels[std::clamp(static_cast<int>((db + 90.0f) / 10.0f), 0, 9)] : ' ';
+            out << "  peak " << std::setprecision(1) << std::setw(6) << (current ? reading.peakDb : -120.0f)
+                << "  rms " << std::setw(6) << (current ? reading.rmsDb : -120.0f) << " dBFS  |" << bars << "|";
+        }
+        std::cout << "\r" << std::left << std::setw(64) << out.str() << std::right << std::flush;
+    }
+    std::cout << "\n";
+}
+
 void CommandHandler::chooseOutput()
 {
     auto devices = amp->getAvailableDevices();
@@ -81,7 +591,6 @@ void CommandHandler::chooseOutput()
     amp->createStreamParameters(
         selectedDevice.index,
         selectedDevice.maxOutputChannels,
-        paFloat32,
         false);
 
     std::cout << "[Info] Selected output device: "
@@ -107,9 +616,19 @@ void CommandHandler::startStream()
     if (amp->sampleRate == 0.0)
         amp->sampleRate = amp->choseBestSampleRate();
 
+    // Go straight to the buffer size found by a previous 'tune'
+    BufferSettings tuned;
+    if (amp->getBufferSettings().framesPerBuffer == 0 && loadTunedSettings(settings, currentTuneKey(), tuned))
+    {
+        amp->setBufferSettings(tuned);
+        std::cout << "[Info] Using tuned buffer: " << tuned.framesPerBuffer << " frames\n";
+    }
+
     if (!amp->openStream())
     {
         std::cerr << "[Error] Failed to open audio stream.\n";
+        if (!amp->isBridging())
+            std::cout << "[Info] Devices that cannot share one stream can still be paired with 'bridge'.\n";
         return;
     }
 
@@ -128,10 +647,15 @@ void CommandHandler::startStream()
     if (outDev.index != 0)
         std::cout << "   Output: " << outDev.name << " (" << outDev.maxOutputChannels << " channels)\n";
     std::cout << "   Sample rate: " << amp->sampleRate << " Hz\n";
+    std::cout << "   Sample format: " << encodingName(amp->getInputEncoding()) << " in, "
+              << encodingName(amp->getOutputEncoding()) << " out\n";
+    if (amp->getBufferSettings().framesPerBuffer > 0)
+        std::cout << "   Buffer: " << amp->getBufferSettings().framesPerBuffer << " frames\n";
 }
 
 void CommandHandler::closeStream()
 {
+    scriptPlayer.stop();
     amp->stopStream();
     std::cout << "[Info] Audio stream stopped.\n";
 }
@@ -139,6 +663,8 @@ void CommandHandler::closeStream()
 void CommandHandler::exitApp()
 {
     std::cout << "Exiting Amply Digital Amplifier...\n";
+    statsExporter.stop();
+    scriptPlayer.stop();
     amp->stopStream();
     std::exit(0);
 }
@@ -169,6 +695,11 @@ void CommandHandler::clearInputBuffer()
     std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
 }
 
+std::string CommandHandler::currentTuneKey()
+{
+    return tuneKey(amp->getInputDevice().name, amp->getOutputDevice().name, amp->sampleRate);
+}
+
 // ===================== Effect Functions =====================
 
 void CommandHandler::setGain() 
@@ -194,3 +725,578 @@ void CommandHandler::setGain()
     gainEffect->setGain(gain);
     std::cout << "[Info] Gain set to " << gain << "\n";
 }
+
+void CommandHandler::setDrive()
+{
+    if (!distortionEffect) {
+        std::cerr << "[Error] Distortion effect is not initialized.\n";
+        return;
+    }
+
+    std::cout << "  0 - Off\n  1 - Soft clip\n  2 - Overdrive\n  3 - Tube\n  4 - Foldback\n";
+    std::cout << "Select distortion mode: ";
+
+    int mode = 0;
+    float drive = 1.0f;
+    std::cin >> mode;
+    if (!std::cin.fail() && mode != 0) {
+        std::cout << "Enter drive multiplier: ";
+        std::cin >> drive;
+    }
+
+    if (std::cin.fail() || mode < 0 || mode > 4 || drive <= 0.0f) {
+        clearInputBuffer();
+        std::cerr << "[Error] Invalid input. Distortion unchanged.\n";
+        return;
+    }
+
+    clearInputBuffer();
+
+    // Find the effect in the live chain
+    auto effects = amp->getEffects();
+    size_t index = effects.size();
+    for (size_t i = 0; i < effects.size(); i++) {
+        if (effects[i] == distortionEffect)
+            index = i;
+    }
+
+    if (mode == 0) {
+        if (index < effects.size())
+            amp->removeEffect(index);
+        std::cout << "[Info] Distortion off.\n";
+        return;
+    }
+
+    distortionEffect->setMode(static_cast<DistortionEffect::Mode>(mode - 1));
+    distortionEffect->setDrive(drive);
+    if (index == effects.size())
+        amp->addEffect(distortionEffect);
+
+    std::cout << "[Info] Distortion drive set to " << drive << "\n";
+}
+
+void CommandHandler::loadCabinet()
+{
+    std::cout << "Enter impulse response WAV path (empty to remove): ";
+    std::string path;
+    std::getline(std::cin, path);
+
+    // Find the current cabinet in the live chain
+    auto effects = amp->getEffects();
+    size_t index = effects.size();
+    for (size_t i = 0; i < effects.size(); i++)
+    {
+        if (cabinetEffect && effects[i] == cabinetEffect)
+            index = i;
+    }
+
+    if (path.empty())
+    {
+        if (index < effects.size())
+            amp->removeEffect(index);
+        cabinetEffect.reset();
+        cabinetPath.clear();
+        std::cout << "[Info] Cabinet off.\n";
+        return;
+    }
+
+    // Only reads the response; the engine prepares it (resampling it to the
+    // stream rate and building its partitions) when it joins the chain
+    auto cabinet = ConvolutionEffect::load(path);
+    if (!cabinet)
+    {
+        std::cerr << "[Error] Could not load impulse response. Cabinet unchanged.\n";
+        return;
+    }
+
+    if (amp->sampleRate > 0.0 && cabinet->impulseRate() != amp->sampleRate)
+        std::cout << "[Info] Impulse response is " << cabinet->impulseRate()
+                  << " Hz; resampling it to the stream's " << amp->sampleRate << " Hz.\n";
+
+    if (index < effects.size())
+        amp->replaceEffect(index, cabinet);
+    else
+        amp->addEffect(cabinet);
+    cabinetEffect = cabinet;
+    cabinetPath = path;
+
+    std::cout << "[Info] Cabinet loaded: " << cabinet->impulseLength() << " samples\n";
+}
+
+void CommandHandler::loadAmpModel()
+{
+    std::cout << "Enter amp model (.nam) path (empty to remove): ";
+    std::string path;
+    std::getline(std::cin, path);
+
+    auto effects = amp->getEffects();
+    size_t index = effects.size(), cabinetIndex = effects.size();
+    for (size_t i = 0; i < effects.size(); i++)
+    {
+        if (ampModelEffect && effects[i] == ampModelEffect)
+            index = i;
+        if (cabinetEffect && effects[i] == cabinetEffect)
+            cabinetIndex = i;
+    }
+
+    if (path.empty())
+    {
+        if (index < effects.size())
+            amp->removeEffect(index);
+        ampModelEffect.reset();
+        ampModelPath.clear();
+        std::cout << "[Info] Amp model off.\n";
+        return;
+    }
+
+    auto model = AmpModelEffect::load(path);
+    if (!model)
+    {
+        std::cerr << "[Error] Could not load amp model. Model unchanged.\n";
+        return;
+    }
+
+    if (amp->sampleRate > 0.0 && model->model().sampleRate != amp->sampleRate)
+        std::cout << "[Info] Model was captured at " << model->model().sampleRate
+                  << " Hz but the stream runs at " << amp->sampleRate << " Hz; it will not sound as captured.\n";
+
+    // An amp goes in front of its cabinet
+    if (index < effects.size())
+        amp->replaceEffect(index, model);
+    else
+    {
+        amp->addEffect(model);
+        if (cabinetIndex < effects.size())
+            amp->moveEffect(effects.size(), cabinetIndex);
+    }
+    ampModelEffect = model;
+    ampModelPath = path;
+
+    const AmpModel &loaded = model->model();
+    std::cout << "[Info] Amp model loaded: " << (loaded.cell == AmpModel::Cell::Lstm ? "LSTM" : "GRU") << " "
+              << loaded.layers << "x" << loaded.hiddenSize << "\n";
+}
+
+void CommandHandler::editChain()
+{
+    auto effects = amp->getEffects();
+    if (effects.empty())
+    {
+        std::cout << "  (Effect chain is empty)\n";
+        return;
+    }
+
+    for (size_t i = 0; i < effects.size(); i++)
+        std::cout << "  " << (i + 1) << " - " << effects[i]->name() << "\n";
+    std::cout << "  Fused presets: " << (amp->getChainFusion() ? "on" : "off") << "\n";
+
+    std::cout << "Enter 'm FROM TO' to move, 'r N' to remove, 'f' to toggle fusion, or press Enter to keep: ";
+    std::string line;
+    std::getline(std::cin, line);
+    if (line.empty())
+        return;
+
+    if (line == "f")
+    {
+        amp->setChainFusion(!amp->getChainFusion());
+        std::cout << "[Info] Fused presets " << (amp->getChainFusion() ? "on" : "off") << ".\n";
+        return;
+    }
+
+    std::istringstream args(line);
+    char action = 0;
+    size_t from = 0, to = 0;
+    args >> action >> from;
+
+    bool ok = false;
+    if (action == 'm' && (args >> to) && from >= 1 && to >= 1)
+        ok = amp->moveEffect(from - 1, to - 1);
+    else if (action == 'r' && !args.fail() && from >= 1)
+        ok = amp->removeEffect(from - 1);
+
+    if (!ok)
+    {
+        std::cerr << "[Error] Invalid chain edit. Chain unchanged.\n";
+        return;
+    }
+
+    std::cout << "[Info] Effect chain updated.\n";
+}
+
+// ===================== Statistics =====================
+void CommandHandler::showStats()
+{
+    StreamStats::Snapshot s = amp->getStats().snapshot();
+
+    printStats(std::cout, s);
+
+    std::cout << "Enter 'r' to reset the counters, or press Enter to keep: ";
+    std::string line;
+    std::getline(std::cin, line);
+    if (line == "r")
+    {
+        amp->getStats().reset();
+        std::cout << "[Info] Statistics reset.\n";
+    }
+}
+
+void CommandHandler::exportStats()
+{
+    if (statsExporter.running())
+    {
+        statsExporter.stop();
+        std::cout << "[Info] Statistics export stopped.\n";
+        return;
+    }
+
+    std::cout << "Enter export file (.csv or .json, empty to cancel): ";
+    std::string path;
+    std::getline(std::cin, path);
+    if (path.empty())
+        return;
+
+    double interval = 1.0;
+    std::cout << "Enter interval in seconds: ";
+    std::cin >> interval;
+    if (std::cin.fail())
+    {
+        clearInputBuffer();
+        std::cerr << "[Error] Invalid interval.\n";
+        return;
+    }
+    clearInputBuffer();
+
+    if (statsExporter.start(amp->getStats(), path, interval))
+        std::cout << "[Info] Exporting statistics to " << path << " every " << interval
+                  << " s. Run 'statslog' again to stop.\n";
+}
+
+// ===================== Parallel Processing =====================
+void CommandHandler::setParallel()
+{
+    if (const WorkerPool *pool = amp->getWorkerPool())
+        std::cout << "[Info] " << pool->workers() << " worker thread(s), "
+                  << pool->missedSlots() << " missed slot(s), "
+                  << pool->fallbacks() << " fallback(s) to serial\n";
+    else
+        std::cout << "[Info] Channels are processed serially on the audio thread\n";
+
+    unsigned cores = std::thread::hardware_concurrency();
+    std::cout << "Enter worker thread count (0 = serial, " << cores << " cores available): ";
+
+    int count = 0;
+    std::cin >> count;
+    if (std::cin.fail() || count < 0)
+    {
+        clearInputBuffer();
+        std::cerr << "[Error] Invalid input. Workers unchanged.\n";
+        return;
+    }
+    clearInputBuffer();
+
+    if (!amp->setWorkerThreads(count))
+    {
+        std::cerr << "[Error] Stop the stream before changing worker threads.\n";
+        return;
+    }
+
+    std::cout << "[Info] Worker threads set to " << count << "\n";
+}
+
+// ===================== Latency Tuning =====================
+void CommandHandler::tuneLatency()
+{
+    if (amp->sampleRate == 0.0)
+        amp->sampleRate = amp->choseBestSampleRate();
+
+    Autotuner::Options options;
+    std::cout << "Enter soak time per step in seconds (press Enter to keep " << options.soakSeconds << "): ";
+    std::string line;
+    std::getline(std::cin, line);
+    if (!line.empty())
+    {
+        try
+        {
+            options.soakSeconds = std::stod(line);
+        }
+        catch (...)
+        {
+            options.soakSeconds = 0.0;
+        }
+
+        if (options.soakSeconds <= 0.0)
+        {
+            std::cerr << "[Error] Invalid soak time.\n";
+            return;
+        }
+    }
+
+    bool wasRunning = amp->isRunning();
+    BufferSettings previous = amp->getBufferSettings();
+    amp->stopStream();
+
+    auto trial = [this](const BufferSettings &buffer, double soakSeconds, StreamStats::Snapshot &stats)
+    {
+        std::cout << "[Info] Trying " << buffer.framesPerBuffer << " frames...\n";
+
+        amp->setBufferSettings(buffer);
+        if (!amp->openStream() || !amp->startStream())
+        {
+            amp->stopStream();
+            return false;
+        }
+
+        // Let the device settle, then count only what happens during the soak
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        amp->getStats().reset();
+        std::this_thread::sleep_for(std::chrono::duration<double>(soakSeconds));
+
+        stats = amp->getStats().snapshot();
+        amp->stopStream();
+        return true;
+    };
+
+    Autotuner tuner(amp->sampleRate, options);
+    bool found = tuner.run(trial);
+    printTuneSteps(std::cout, tuner.steps(), amp->sampleRate);
+
+    if (found)
+    {
+        amp->setBufferSettings(tuner.result());
+        storeTunedSettings(settings, currentTuneKey(), tuner.result());
+
+        std::cout << "[Info] Tuned to " << tuner.result().framesPerBuffer << " frames ("
+                  << tuner.result().suggestedLatency * 1000.0 << " ms suggested latency)\n";
+        if (settings.save(settingsPath))
+            std::cout << "[Info] Saved to " << settingsPath << "\n";
+    }
+    else
+    {
+        amp->setBufferSettings(previous);
+        std::cerr << "[Error] No stable buffer size found. Buffer settings unchanged.\n";
+    }
+
+    if (wasRunning)
+        startStream();
+}
+
+// ===================== Profiles =====================
+bool CommandHandler::findDevice(const std::string &name, bool isInput, DeviceInfo &device)
+{
+    auto devices = amp->getAvailableDevices();
+    for (const DeviceInfo &d : isInput ? devices->inputs : devices->outputs)
+    {
+        if (d.name == name)
+        {
+            device = d;
+            return true;
+        }
+    }
+    return false;
+}
+
+void CommandHandler::saveProfile(const std::string &name)
+{
+    std::string prefix = "profile." + Settings::keyPart(name) + ".";
+    settings.removePrefix(prefix);
+    settings.set(prefix + "name", name);
+
+    // Devices are stored by their listed name; indices change with hotplug
+    auto devices = amp->getAvailableDevices();
+    int inputIndex = amp->getInputDevice().index;
+    int outputIndex = amp->getOutputDevice().index;
+    for (const DeviceInfo &d : devices->inputs)
+    {
+        if (d.index == inputIndex)
+            settings.set(prefix + "input", d.name);
+    }
+    for (const DeviceInfo &d : devices->outputs)
+    {
+        if (d.index == outputIndex)
+            settings.set(prefix + "output", d.name);
+    }
+
+    settings.set(prefix + "rate", amp->sampleRate);
+    settings.set(prefix + "frames", static_cast<double>(amp->getBufferSettings().framesPerBuffer));
+    settings.set(prefix + "latency", amp->getBufferSettings().suggestedLatency);
+    settings.set(prefix + "workers", static_cast<double>(amp->getWorkerThreads()));
+    settings.set(prefix + "fusion", amp->getChainFusion() ? 1.0 : 0.0);
+    settings.set(prefix + "bridge", amp->isBridging() ? 1.0 : 0.0);
+    std::optional<SampleEncoding> format = amp->getSampleFormat();
+    settings.set(prefix + "sample_format", format ? encodingName(*format) : "auto");
+    settings.set(prefix + "dsp_thread", amp->getDspThread() ? 1.0 : 0.0);
+    settings.set(prefix + "dsp_lookahead", static_cast<double>(amp->getDspOptions().lookahead));
+    settings.set(prefix + "dsp_core", static_cast<double>(amp->getDspOptions().core));
+    settings.set(prefix + "idle", amp->getIdleOptions().enabled ? 1.0 : 0.0);
+    settings.set(prefix + "thread_ftz", amp->getThreadSetup().flushDenormals ? 1.0 : 0.0);
+    settings.set(prefix + "thread_priority", static_cast<double>(amp->getThreadSetup().priority));
+    settings.set(prefix + "thread_core", static_cast<double>(amp->getThreadSetup().core));
+    settings.set(prefix + "thread_mlock", amp->getThreadSetup().lockMemory ? 1.0 : 0.0);
+    settings.set(prefix + "idle_open_db", amp->getIdleOptions().openDb);
+    settings.set(prefix + "idle_close_db", amp->getIdleOptions().closeDb);
+
+    auto effects = amp->getEffects();
+    auto inChain = [&](const std::shared_ptr<Effect> &effect)
+    {
+        return effect && std::find(effects.begin(), effects.end(), effect) != effects.end();
+    };
+
+    if (gainEffect)
+        settings.set(prefix + "gain", gainEffect->getGain());
+    if (inChain(distortionEffect))
+    {
+        settings.set(prefix + "drive_mode", static_cast<double>(distortionEffect->getMode()) + 1.0);
+        settings.set(prefix + "drive", distortionEffect->getDrive());
+    }
+    if (inChain(ampModelEffect))
+        settings.set(prefix + "model", ampModelPath);
+    if (inChain(cabinetEffect))
+        settings.set(prefix + "cab", cabinetPath);
+}
+
+bool CommandHandler::startProfile(const std::string &requested)
+{
+    std::string name = requested.empty() ? settings.get("startup_profile") : requested;
+    if (name.empty())
+        return false;
+
+    std::string prefix = "profile." + Settings::keyPart(name) + ".";
+    DeviceInfo input, output;
+    if (!settings.has(prefix + "input") || !settings.has(prefix + "output"))
+    {
+        std::cerr << "[Error] No profile named '" << name << "'.\n";
+        return false;
+    }
+    if (!findDevice(settings.get(prefix + "input"), true, input) ||
+        !findDevice(settings.get(prefix + "output"), false, output))
+    {
+        std::cerr << "[Error] A device of profile '" << name << "' is not connected.\n";
+        return false;
+    }
+
+    amp->setBridging(settings.getDouble(prefix + "bridge", 0.0) != 0.0);
+
+    SampleEncoding encoding;
+    if (parseEncoding(settings.get(prefix + "sample_format"), encoding))
+        amp->setSampleFormat(encoding);
+    else
+        amp->setSampleFormat(std::nullopt);
+
+    DspThread::Options dsp;
+    dsp.lookahead = static_cast<int>(settings.getDouble(prefix + "dsp_lookahead", dsp.lookahead));
+    dsp.core = static_cast<int>(settings.getDouble(prefix + "dsp_core", dsp.core));
+    amp->setDspThread(settings.getDouble(prefix + "dsp_thread", 0.0) != 0.0, dsp);
+
+    AudioEngine::IdleOptions idle = amp->getIdleOptions();
+    idle.enabled = settings.getDouble(prefix + "idle", idle.enabled ? 1.0 : 0.0) != 0.0;
+    idle.openDb = static_cast<float>(settings.getDouble(prefix + "idle_open_db", idle.openDb));
+    idle.closeDb = static_cast<float>(settings.getDouble(prefix + "idle_close_db", idle.closeDb));
+    amp->setIdleOptions(idle);
+
+    ThreadSetup thread;
+    thread.flushDenormals = settings.getDouble(prefix + "thread_ftz", thread.flushDenormals ? 1.0 : 0.0) != 0.0;
+    thread.priority = static_cast<int>(settings.getDouble(prefix + "thread_priority", thread.priority));
+    thread.core = static_cast<int>(settings.getDouble(prefix + "thread_core", thread.core));
+    thread.lockMemory = settings.getDouble(prefix + "thread_mlock", thread.lockMemory ? 1.0 : 0.0) != 0.0;
+    amp->setThreadSetup(thread);
+    amp->createStreamParameters(input.index, input.maxInputChannels, true);
+    amp->createStreamParameters(output.index, output.maxOutputChannels, false);
+    amp->sampleRate = settings.getDouble(prefix + "rate", 0.0);
+
+    BufferSettings buffer;
+    buffer.framesPerBuffer = static_cast<unsigned long>(settings.getDouble(prefix + "frames", 0.0));
+    buffer.suggestedLatency = settings.getDouble(prefix + "latency", 0.0);
+    amp->setBufferSettings(buffer);
+    amp->setWorkerThreads(static_cast<int>(settings.getDouble(prefix + "workers", 0.0)));
+    amp->setChainFusion(settings.getDouble(prefix + "fusion", 0.0) != 0.0);
+
+    if (gainEffect && settings.has(prefix + "gain"))
+        gainEffect->setGain(static_cast<float>(settings.getDouble(prefix + "gain", 1.0)));
+
+    int driveMode = static_cast<int>(settings.getDouble(prefix + "drive_mode", 0.0));
+    if (distortionEffect && driveMode >= 1 && driveMode <= 4)
+    {
+        distortionEffect->setMode(static_cast<DistortionEffect::Mode>(driveMode - 1));
+        distortionEffect->setDrive(static_cast<float>(settings.getDouble(prefix + "drive", 1.0)));
+        auto effects = amp->getEffects();
+        if (std::find(effects.begin(), effects.end(), distortionEffect) == effects.end())
+            amp->addEffect(distortionEffect);
+    }
+
+    std::string model = settings.get(prefix + "model");
+    if (!model.empty() && !ampModelEffect)
+    {
+        ampModelEffect = AmpModelEffect::load(model);
+        if (ampModelEffect)
+        {
+            amp->addEffect(ampModelEffect);
+            ampModelPath = model;
+        }
+    }
+
+    std::string cab = settings.get(prefix + "cab");
+    if (!cab.empty() && !cabinetEffect)
+    {
+        cabinetEffect = ConvolutionEffect::load(cab);
+        if (cabinetEffect)
+        {
+            amp->addEffect(cabinetEffect);
+            cabinetPath = cab;
+        }
+    }
+
+    std::cout << "[Info] Profile '" << name << "'\n";
+    startStream();
+    return amp->isRunning();
+}
+
+void CommandHandler::editProfiles()
+{
+    for (const std::string &key : settings.keys("profile."))
+    {
+        // One line per profile, from its display name
+        const std::string suffix = ".name";
+        if (key.size() > suffix.size() && key.compare(key.size() - suffix.size(), suffix.size(), suffix) == 0)
+            std::cout << "  " << settings.get(key) << "\n";
+    }
+    std::cout << "  Startup profile: " << settings.get("startup_profile", "(none)") << "\n";
+
+    std::cout << "Enter 's NAME' to save the current setup, 'l NAME' to load and start one,\n"
+              << "'a NAME' to start one automatically (no name turns it off), or press Enter to keep: ";
+    std::string line;
+    std::getline(std::cin, line);
+    if (line.empty())
+        return;
+
+    std::istringstream args(line);
+    char action = 0;
+    std::string name;
+    args >> action;
+    std::getline(args >> std::ws, name);
+
+    if (action == 's' && !name.empty())
+    {
+        saveProfile(name);
+        std::cout << "[Info] Profile '" << name << "' saved.\n";
+    }
+    else if (action == 'l' && !name.empty())
+    {
+        startProfile(name);
+        return;
+    }
+    else if (action == 'a')
+    {
+        if (name.empty())
+            settings.remove("startup_profile");
+        else
+            settings.set("startup_profile", name);
+        std::cout << "[Info] Startup profile " << (name.empty() ? "off" : "set to '" + name + "'") << ".\n";
+    }
+    else
+    {
+        std::cerr << "[Error] Invalid profile command.\n";
+        return;
+    }
+
+    settings.save(settingsPath);
+}
@@ -0,0 +1,156 @@
+#include "devicebridge.h"
+#include "streamstats.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// ===================== Configuration =====================
+void DeviceBridge::prepare(int channels, double inputRate, double outputRate,
+                           size_t maxInputFrames, size_t maxOutputFrames)
+{
+    channels_ = channels;
+    inputRate_ = inputRate;
+    outputRate_ = outputRate;
+
+    double ratio = inputRate / outputRate;
+    resampler_.prepare(channels, ratio, maxOutputFrames, kMaxDeviation);
+    scratch_.assign((static_cast<size_t>(std::ceil(maxOutputFrames * ratio * (1.0 + kMaxDeviation))) + Resampler::kTaps) * channels, 0.0f);
+
+    // Room for several periods of both sides, so priming and a late
+    // callback never overrun it
+    size_t periods = maxInputFrames + static_cast<size_t>(std::ceil(maxOutputFrames * ratio));
+    ring_.resize((4 * periods + Resampler::kTaps) * channels);
+
+    restart();
+}
+
+void DeviceBridge::restart()
+{
+    resampler_.reset();
+    largestPush_.store(0, std::memory_order_relaxed);
+    pushTime_.store(0.0, std::memory_order_relaxed);
+    overruns_.store(0, std::memory_order_relaxed);
+    priming_ = true;
+    largestPull_ = 0;
+    fill_ = 0.0;
+    integral_ = 0.0;
+    lockedSeconds_ = 0.0;
+    overrunsSeen_ = 0;
+    driftPpm_.store(0.0, std::memory_order_relaxed);
+    fillFrames_.store(0.0, std::memory_order_relaxed);
+    targetFrames_.store(0.0, std::memory_order_relaxed);
+    underruns_.store(0, std::memory_order_relaxed);
+    running_.store(false, std::memory_order_relaxed);
+}
+
+// ===================== Input Thread =====================
+void DeviceBridge::push(const float *input, size_t frames, double time)
+{
+    if (frames > largestPush_.load(std::memory_order_relaxed))
+        largestPush_.store(frames, std::memory_order_relaxed);
+
+    // Single writer: plain load + store is enough
+    if (!ring_.write(input, frames * channels_))
+        overruns_.store(overruns_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    pushTime_.store(time, std::memory_order_release);
+}
+
+// ===================== Output Thread =====================
+unsigned DeviceBridge::pull(float *input, size_t frames, double time)
+{
+    unsigned flags = 0;
+    uint64_t overruns = overruns_.load(std::memory_order_relaxed);
+    if (overruns != overrunsSeen_)
+    {
+        overrunsSeen_ = overruns;
+        flags |= StreamStats::InputOverflow;
+    }
+
+    // Hold about one period of each side in the ring, measured in input frames
+    const double nominal = resampler_.getNominalRatio();
+    largestPull_ = std::max(largestPull_, static_cast<size_t>(std::ceil(frames * nominal)));
+    const size_t push = largestPush_.load(std::memory_order_relaxed);
+    const size_t target = push + largestPull_;
+    targetFrames_.store(static_cast<double>(target), std::memory_order_relaxed);
+
+    // Input arrives a period at a time, so the ring level alone jumps with
+    // the phase of the input period. Counting the frames captured since the
+    // last push, less half a period, gives the level averaged over the
+    // period wherever the pulls fall.
+    double captured = std::min(std::max(time - pushTime_.load(std::memory_order_acquire), 0.0) * inputRate_,
+                               static_cast<double>(push));
+    double pending = captured - 0.5 * static_cast<double>(push);
+
+    size_t needed = resampler_.inputNeeded(frames);
+    size_t available = ring_.readable() / channels_;
+
+    if (priming_)
+    {
+        double level = static_cast<double>(available) - static_cast<double>(needed) + pending;
+        if (level < static_cast<double>(target))
+        {
+            std::memset(input, 0, frames * channels_ * sizeof(float));
+            return flags;
+        }
+
+        // Whatever piled up before the output started would only add latency
+        size_t excess = static_cast<size_t>(level - static_cast<double>(target));
+        ring_.discard(excess * channels_);
+        available -= excess;
+        fill_ = level - static_cast<double>(excess);
+        lockedSeconds_ = 0.0;
+        priming_ = false;
+        running_.store(true, std::memory_order_relaxed);
+    }
+
+    if (available < needed)
+    {
+        // Start over from silence; the drift estimate is kept
+        std::memset(input, 0, frames * channels_ * sizeof(float));
+        underruns_.store(underruns_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        resampler_.reset();
+        priming_ = true;
+        running_.store(false, std::memory_order_relaxed);
+        return flags | StreamStats::InputUnderflow;
+    }
+
+    ring_.read(scratch_.data(), needed * channels_);
+    resampler_.process(scratch_.data(), input, frames);
+
+    // Smooth out what is left of the sawtooth the two block sizes leave
+    double dt = frames / outputRate_;
+    double level = static_cast<double>(ring_.readable() / channels_) + pending;
+    fill_ += (level - fill_) * (1.0 - std::exp(-dt / kFillSeconds));
+
+    // PI loop, critically damped at omega: a relative correction c drains
+    // the ring by c * inputRate frames per second
+    lockedSeconds_ += dt;
+    double omega = kTrackRadians + (kLockRadians - kTrackRadians) * std::exp(-lockedSeconds_ / kNarrowSeconds);
+    double error = fill_ - static_cast<double>(target);
+    integral_ += omega * omega / inputRate_ * error * dt;
+    integral_ = std::min(std::max(integral_, -kMaxDeviation), kMaxDeviation);
+    double correction = 2.0 * omega / inputRate_ * error + integral_;
+    correction = std::min(std::max(correction, -kMaxDeviation), kMaxDeviation);
+    resampler_.setRatio(nominal * (1.0 + correction));
+
+    driftPpm_.store(integral_ * 1e6, std::memory_order_relaxed);
+    fillFrames_.store(fill_, std::memory_order_relaxed);
+    return flags;
+}
+
+// ===================== Any Thread =====================
+DeviceBridge::Status DeviceBridge::status() const
+{
+    Status s;
+    s.inputRate = inputRate_;
+    s.outputRate = outputRate_;
+    s.driftPpm = driftPpm_.load(std::memory_order_relaxed);
+    s.fillFrames = fillFrames_.load(std::memory_order_relaxed);
+    s.targetFrames = targetFrames_.load(std::memory_order_relaxed);
+    s.underruns = underruns_.load(std::memory_order_relaxed);
+    s.overruns = overruns_.load(std::memory_order_relaxed);
+    s.running = running_.load(std::memory_order_relaxed);
+    if (inputRate_ > 0.0)
+        s.latencySeconds = (s.fillFrames + Resampler::latency()) / inputRate_;
+    return s;
+}
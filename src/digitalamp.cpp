@@ -1,13 +1,23 @@
 #include "digitalamp.h"
+#include "portaudiobackend.h"
+#include "bridgebackend.h"
 #include <iostream>
 #include <cmath>
 #include <algorithm>
 #include <vector>
+#include <utility>
 
 // ===================== Constructor / Destructor =====================
 DigitalAmp::DigitalAmp()
-    : stream_(nullptr), initialized_(false), running_(false), sampleRate(0.0), inputParams_({}), outputParams_({})
+    : sampleRate(0.0), inputParams_({}), outputParams_({}), callback_(engine_, stats_), dsp_(callback_),
+      backend_(std::make_unique<PortAudioBackend>()), initialized_(false), running_(false)
 {
+    // A rig left idle should cost next to nothing
+    AudioEngine::IdleOptions idle;
+    idle.enabled = true;
+    engine_.setIdleOptions(idle);
+
+    callback_.setRecorder(&recorder_);
 }
 
 DigitalAmp::~DigitalAmp()
@@ -32,61 +42,93 @@ bool DigitalAmp::initialize()
     initialized_ = true;
     currentApi_ = chooseBestApi();
 
+    // Probing results from earlier runs, unless the devices have changed since
+    cachePath_ = CapabilityCache::defaultPath();
+    deviceFingerprint_ = CapabilityCache::fingerprint();
+    cache_.load(cachePath_);
+    cache_.validate(deviceFingerprint_);
+
     return true;
 }
 
 // ===================== Stream Management =====================
 bool DigitalAmp::openStream()
 {
-    return this->openStream(sampleRate, paFramesPerBufferUnspecified);
+    return this->openStream(sampleRate, bufferSettings_.framesPerBuffer);
 }
 
 bool DigitalAmp::openStream(double sampleRate, unsigned long framesPerBuffer)
 {
-    if (!initialized_)
+    if (!initialized_ && usesPortAudio())
     {
         std::cerr << "PortAudio error: PortAudio is not initialized" << std::endl;
         return false;
     }
 
+    if (backend_->isOpen())
+        stopStream();
+
     if (!chooseCommonChannelCount())
         return false;
 
-    // Verify format support
-    PaError support = Pa_IsFormatSupported(&inputParams_, &outputParams_, sampleRate);
-    if (support != paFormatIsSupported)
+    StreamConfig config = streamConfig(&inputParams_, &outputParams_, sampleRate, framesPerBuffer);
+    if (usesPortAudio())
     {
-        std::cerr << "Format not supported: " << Pa_GetErrorText(support) << std::endl;
-        return false;
+        config.inputEncoding = negotiateEncoding(config, true);
+        config.outputEncoding = negotiateEncoding(config, false);
+    }
+    inputEncoding_ = config.inputEncoding;
+    outputEncoding_ = config.outputEncoding;
+
+    // The stream is not running yet, so the engine can be prepared in place,
+    // with planar buffers for the whole period when the period is fixed
+    unsigned long maxFrames = framesPerBuffer == paFramesPerBufferUnspecified
+                                  ? AudioEngine::kDefaultMaxFrames
+                                  : framesPerBuffer;
+    engine_.prepare(sampleRate, inputParams_.channelCount, outputParams_.channelCount, maxFrames);
+    stats_.reset();
+
+    // The driver callback either runs the engine itself or only feeds the
+    // DSP thread, which then has its own priority and core
+    ThreadSetup setup = threadSetup_;
+    AudioCallback *callback = &callback_;
+    if (dspThreadEnabled_)
+    {
+        setup.priority = 0;
+        setup.core = -1;
+        // The host may hand over longer periods than the engine's blocks
+        unsigned long maxCallbackFrames = framesPerBuffer == paFramesPerBufferUnspecified
+                                              ? DspThread::kMaxHostFrames
+                                              : framesPerBuffer;
+        dsp_.prepare(inputParams_.channelCount, outputParams_.channelCount, maxFrames, maxCallbackFrames,
+                     sampleRate, dspOptions_);
+        callback = &dsp_;
     }
 
-    PaError err = Pa_OpenStream(&stream_,
-                                &inputParams_,
-                                &outputParams_,
-                                sampleRate,
-                                framesPerBuffer,
-                                paClipOff,
-                                audioCallback,
-                                this);
+    callback_.setThreadSetup(setup);
 
-    if (err != paNoError)
-    {
-        std::cerr << "PortAudio error: " << Pa_GetErrorText(err) << std::endl;
+    if (!backend_->open(config, callback))
         return false;
-    }
 
+    this->sampleRate = sampleRate;
     return true;
 }
 
 bool DigitalAmp::startStream()
 {
-    if (!initialized_ || !stream_)
+    if (!backend_->isOpen())
         return false;
 
-    PaError err = Pa_StartStream(stream_);
-    if (err != paNoError)
+    // Process-wide, so it is done here rather than on the audio thread
+    if (threadSetup_.lockMemory && !lockMemory())
+        std::cerr << "[Warning] Could not lock memory; the audio thread may page fault\n";
+
+    if (dspThreadEnabled_ && !dsp_.start())
+        return false;
+
+    if (!backend_->start())
     {
-        std::cerr << "PortAudio error: " << Pa_GetErrorText(err) << std::endl;
+        dsp_.stop();
         return false;
     }
 
@@ -96,58 +138,218 @@ bool DigitalAmp::startStream()
 
 void DigitalAmp::stopStream()
 {
-    if (stream_)
+    backend_->close();
+    dsp_.stop();
+
+    // Nothing more to record; finish the files
+    if (recorder_.recording())
     {
-        Pa_CloseStream(stream_);
-        stream_ = nullptr;
+        SessionRecorder::Status status = recorder_.status();
+        if (recorder_.stop())
+            std::cout << "[Info] Recording stopped with the stream: " << status.dryPath << ", " << status.wetPath << "\n";
+        else
+            std::cerr << "[Error] Recording stopped with the stream, but the files may be incomplete\n";
     }
 
     running_ = false;
+    engine_.collect();
+}
+
+void DigitalAmp::setBackend(std::unique_ptr<AudioBackend> backend)
+{
+    stopStream();
+    backend_ = std::move(backend);
+}
+
+StreamConfig DigitalAmp::streamConfig(const PaStreamParameters *inputParams, const PaStreamParameters *outputParams,
+                                      double sampleRate, unsigned long framesPerBuffer) const
+{
+    StreamConfig config;
+    config.sampleRate = sampleRate;
+    config.inputDevice = inputParams->device;
+    config.outputDevice = outputParams->device;
+    config.inputChannels = inputParams->channelCount;
+    config.outputChannels = outputParams->channelCount;
+    config.framesPerBuffer = framesPerBuffer;
+    config.inputLatency = inputParams->suggestedLatency;
+    config.outputLatency = outputParams->suggestedLatency;
+
+    if (bufferSettings_.suggestedLatency > 0.0)
+        config.inputLatency = config.outputLatency = bufferSettings_.suggestedLatency;
+    return config;
+}
+
+void DigitalAmp::setBridging(bool enabled)
+{
+    if (enabled == isBridging())
+        return;
+
+    if (enabled)
+        setBackend(std::make_unique<BridgeBackend>());
+    else
+        setBackend(std::make_unique<PortAudioBackend>());
+}
+
+bool DigitalAmp::isBridging() const
+{
+    return dynamic_cast<const BridgeBackend *>(backend_.get()) != nullptr;
 }
 
-// ===================== Audio Processing =====================
-int DigitalAmp::audioCallback(const void *inputBuffer, void *outputBuffer,
-                              unsigned long framesPerBuffer,
-                              const PaStreamCallbackTimeInfo *timeInfo,
-                              PaStreamCallbackFlags statusFlags,
-                              void *userData)
+bool DigitalAmp::getBridgeStatus(DeviceBridge::Status &status) const
 {
-    DigitalAmp *amp = static_cast<DigitalAmp *>(userData);
-    const float *input = static_cast<const float *>(inputBuffer);
-    float *output = static_cast<float *>(outputBuffer);
+    const BridgeBackend *bridge = dynamic_cast<const BridgeBackend *>(backend_.get());
+    if (!bridge)
+        return false;
 
-    return amp->processAudio(input, output, framesPerBuffer);
+    status = bridge->status();
+    return true;
 }
 
-int DigitalAmp::processAudio(const float *input, float *output, unsigned long frameCount)
+SampleEncoding DigitalAmp::negotiateEncoding(const StreamConfig &config, bool isInput) const
 {
-    int inCh = inputParams_.channelCount;
-    int outCh = outputParams_.channelCount;
+    PaStreamParameters params{};
+    if (!PortAudioBackend::toParameters(config, isInput, params))
+        return SampleEncoding::Float32;
+
+    // PortAudio cannot say which format a device runs in, only which ones it
+    // accepts, and it converts anything else itself; these host APIs mostly
+    // drive hardware in integer formats, the rest mix in float
+    std::vector<SampleEncoding> candidates;
+    if (sampleFormat_)
+    {
+        candidates.push_back(*sampleFormat_);
+    }
+    else if (const PaDeviceInfo *device = Pa_GetDeviceInfo(params.device))
+    {
+        const PaHostApiInfo *api = Pa_GetHostApiInfo(device->hostApi);
+        PaHostApiTypeId type = api ? api->type : paInDevelopment;
+        if (type == paALSA || type == paOSS || type == paASIO || type == paMME || type == paDirectSound)
+            candidates = {SampleEncoding::Int32, SampleEncoding::Int24, SampleEncoding::Int16};
+    }
 
-    for (unsigned long i = 0; i < frameCount; i++)
+    // A bridged input runs at its own rate
+    double rate = isInput && isBridging() ? BridgeBackend::inputRate(config) : config.sampleRate;
+    for (SampleEncoding encoding : candidates)
     {
-        for (int ch = 0; ch < std::min(inCh, outCh); ch++)
-        {
-            float sample = input[i * inCh + ch];
+        params.sampleFormat = PortAudioBackend::toSampleFormat(encoding);
+        PaError support = isInput ? Pa_IsFormatSupported(&params, nullptr, rate)
+                                  : Pa_IsFormatSupported(nullptr, &params, rate);
+        if (support == paFormatIsSupported)
+            return encoding;
+    }
 
-            // Apply all effects in order
-            for (auto &effect : effects)
-            {
-                sample = effect->process(sample);
-            }
+    if (sampleFormat_ && *sampleFormat_ != SampleEncoding::Float32)
+        std::cerr << "[Warning] The " << (isInput ? "input" : "output") << " device does not accept "
+                  << encodingName(*sampleFormat_) << "; using float32\n";
+    return SampleEncoding::Float32;
+}
 
-            sample = std::max(-1.0f, std::min(1.0f, sample));
-            output[i * outCh + ch] = sample;
-        }
+bool DigitalAmp::usesPortAudio() const
+{
+    return dynamic_cast<const PortAudioBackend *>(backend_.get()) != nullptr || isBridging();
+}
 
-        // Duplicate first channel if output has more channels than input
-        for (int ch = inCh; ch < outCh; ch++)
-        {
-            output[i * outCh + ch] = output[i * outCh];
-        }
+bool DigitalAmp::usesCache() const
+{
+    return initialized_ && usesPortAudio();
+}
+
+// ===================== Parallel Processing =====================
+bool DigitalAmp::setWorkerThreads(int count)
+{
+    if (running_ || count < 0)
+        return false;
+
+    engine_.setWorkerThreads(count);
+    return true;
+}
+
+// ===================== Audio Thread =====================
+bool DigitalAmp::setThreadSetup(const ThreadSetup &setup)
+{
+    if (running_)
+        return false;
+
+    threadSetup_ = setup;
+    return true;
+}
+
+// ===================== DSP Thread =====================
+bool DigitalAmp::setDspThread(bool enabled, const DspThread::Options &options)
+{
+    if (running_)
+        return false;
+
+    dspThreadEnabled_ = enabled;
+    dspOptions_ = options;
+    return true;
+}
+
+// ===================== Sample Formats =====================
+bool DigitalAmp::setSampleFormat(std::optional<SampleEncoding> encoding)
+{
+    if (running_)
+        return false;
+
+    sampleFormat_ = encoding;
+    return true;
+}
+
+// ===================== Recording =====================
+bool DigitalAmp::startRecording(const std::string &basePath, const SessionRecorder::Options &options)
+{
+    if (!running_)
+        return false;
+
+    return recorder_.start(basePath, engine_.getSampleRate(), engine_.getInputChannels(),
+                           engine_.getOutputChannels(), options);
+}
+
+// ===================== Analysis =====================
+void DigitalAmp::startAnalysis()
+{
+    std::vector<std::shared_ptr<Effect>> effects = engine_.getEffects();
+    if (std::find(effects.begin(), effects.end(), analyzer_.tap()) == effects.end())
+    {
+        engine_.addEffect(analyzer_.tap());
+        engine_.moveEffect(effects.size(), 0);
     }
+    analyzer_.start();
+}
+
+void DigitalAmp::stopAnalysis()
+{
+    std::vector<std::shared_ptr<Effect>> effects = engine_.getEffects();
+    auto it = std::find(effects.begin(), effects.end(), analyzer_.tap());
+    if (it != effects.end())
+        engine_.removeEffect(it - effects.begin());
+    analyzer_.stop();
+}
+
+// ===================== Effect Chain =====================
+void DigitalAmp::addEffect(std::shared_ptr<Effect> effect)
+{
+    engine_.addEffect(std::move(effect));
+}
 
-    return paContinue;
+bool DigitalAmp::removeEffect(size_t index)
+{
+    return engine_.removeEffect(index);
+}
+
+bool DigitalAmp::moveEffect(size_t from, size_t to)
+{
+    return engine_.moveEffect(from, to);
+}
+
+bool DigitalAmp::replaceEffect(size_t index, std::shared_ptr<Effect> effect)
+{
+    return engine_.replaceEffect(index, std::move(effect));
+}
+
+std::vector<std::shared_ptr<Effect>> DigitalAmp::getEffects() const
+{
+    return engine_.getEffects();
 }
 
 // ===================== Sample Rate Handling =====================
@@ -157,13 +359,37 @@ std::vector<double> DigitalAmp::getSupportedSampleRates(const PaStreamParameters
         8000.0, 11025.0, 16000.0, 22050.0, 32000.0,
         44100.0, 48000.0, 88200.0, 96000.0, 192000.0};
 
+    // Each probe may open the device, so a pair is only ever swept once
+    std::string key;
     std::vector<double> supported;
+    if (usesCache())
+    {
+        const PaDeviceInfo *input = Pa_GetDeviceInfo(inputParams->device);
+        const PaDeviceInfo *output = Pa_GetDeviceInfo(outputParams->device);
+        if (input && output)
+        {
+            key = CapabilityCache::rateKey(input->name, inputParams->channelCount,
+                                           output->name, outputParams->channelCount);
+            // A bridge accepts whatever the output does, so it is probed separately
+            if (isBridging())
+                key = "bridge." + key;
+            if (cache_.getSampleRates(key, supported))
+                return supported;
+        }
+    }
+
     for (double rate : standardRates)
     {
-        if (Pa_IsFormatSupported(inputParams, outputParams, rate) == paFormatIsSupported)
+        if (backend_->isFormatSupported(streamConfig(inputParams, outputParams, rate, 0)))
             supported.push_back(rate);
     }
 
+    if (!key.empty())
+    {
+        cache_.setSampleRates(key, supported);
+        cache_.save(cachePath_);
+    }
+
     return supported;
 }
 
@@ -179,9 +405,10 @@ double DigitalAmp::choseBestSampleRate()
         48000.0, 44100.0, 32000.0,
         22050.0, 16000.0, 8000.0};
 
+    std::vector<double> supported = getSupportedSampleRates();
     for (double rate : COMMON_SAMPLE_RATES)
     {
-        if (Pa_IsFormatSupported(&inputParams_, &outputParams_, rate) == paFormatIsSupported)
+        if (std::find(supported.begin(), supported.end(), rate) != supported.end())
             return rate;
     }
 
@@ -228,7 +455,7 @@ int DigitalAmp::chooseCommonChannelCount(int inputCount, int outputCount)
 }
 
 // ===================== Device Handling =====================
-bool DigitalAmp::createStreamParameters(PaDeviceIndex deviceIndex, int channelCount, PaSampleFormat sampleFormat, bool isInput)
+bool DigitalAmp::createStreamParameters(PaDeviceIndex deviceIndex, int channelCount, bool isInput)
 {
     PaStreamParameters *params = isInput ? &inputParams_ : &outputParams_;
     const PaDeviceInfo *device = Pa_GetDeviceInfo(deviceIndex);
@@ -241,7 +468,7 @@ bool DigitalAmp::createStreamParameters(PaDeviceIndex deviceIndex, int channelCo
 
     params->device = deviceIndex;
     params->channelCount = channelCount;
-    params->sampleFormat = sampleFormat;
+    params->sampleFormat = paFloat32; // the format is negotiated when the stream opens
     params->suggestedLatency = isInput ? device->defaultLowInputLatency : device->defaultLowOutputLatency;
     params->hostApiSpecificStreamInfo = nullptr;
 
@@ -255,6 +482,19 @@ std::unique_ptr<AvailableDevices> DigitalAmp::getAvailableDevices()
     if (!apiInfo)
         return result;
 
+    std::vector<DeviceInfo> cached;
+    if (cache_.getDevices(apiInfo->name, cached))
+    {
+        for (const DeviceInfo &d : cached)
+        {
+            if (d.maxInputChannels > 0)
+                result->inputs.push_back(d);
+            if (d.maxOutputChannels > 0)
+                result->outputs.push_back(d);
+        }
+        return result;
+    }
+
     auto isVirtual = [](const std::string &n)
     {
         static const std::vector<std::string> blacklist = {
@@ -279,6 +519,7 @@ std::unique_ptr<AvailableDevices> DigitalAmp::getAvailableDevices()
         return s;
     };
 
+    std::vector<DeviceInfo> scanned;
     for (int i = 0; i < apiInfo->deviceCount; i++)
     {
         PaDeviceIndex deviceIndex = Pa_HostApiDeviceIndexToDeviceIndex(currentApi_, i);
@@ -300,11 +541,36 @@ std::unique_ptr<AvailableDevices> DigitalAmp::getAvailableDevices()
             result->inputs.push_back(d);
         if (d.maxOutputChannels > 0)
             result->outputs.push_back(d);
+        scanned.push_back(d);
     }
 
+    cache_.setDevices(apiInfo->name, scanned);
+    cache_.save(cachePath_);
+
     return result;
 }
 
+bool DigitalAmp::rescanDevices()
+{
+    if (!initialized_)
+        return false;
+
+    stopStream();
+    uint64_t previous = deviceFingerprint_;
+
+    // PortAudio only enumerates devices when it is initialized
+    Pa_Terminate();
+    initialized_ = false;
+    if (!initialize() || deviceFingerprint_ == previous)
+        return false;
+
+    // Indices may now point at different devices
+
+    inputParams_ = {};
+    outputParams_ = {};
+    return true;
+}
+
 DeviceInfo DigitalAmp::getDefaultDevice(bool isInput)
 {
     int defaultDeviceIndex = isInput ? Pa_GetDefaultInputDevice() : Pa_GetDefaultOutputDevice();
@@ -0,0 +1,172 @@
+#include "dspthread.h"
+#include "realtime.h"
+#include "rtguard.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    // How often an idle DSP thread looks for input, as a share of a block
+    // and within absolute bounds
+    constexpr double kPollsPerBlock = 8.0;
+    constexpr double kMinPollSeconds = 50e-6;
+    constexpr double kMaxPollSeconds = 500e-6;
+}
+
+// ===================== Constructor / Destructor =====================
+DspThread::~DspThread()
+{
+    stop();
+}
+
+// ===================== Configuration =====================
+void DspThread::prepare(int inputChannels, int outputChannels, unsigned long maxFrames,
+                        unsigned long maxCallbackFrames, double sampleRate, const Options &options)
+{
+    options_ = options;
+    options_.lookahead = std::max(0, options.lookahead);
+    inputChannels_ = inputChannels;
+    outputChannels_ = outputChannels;
+    maxFrames_ = maxFrames;
+    sampleRate_ = sampleRate;
+
+    // Room for the queued callbacks plus a few late ones; the DSP thread
+    // works through a long callback in blocks of up to maxFrames
+    size_t callbackFrames = std::max(maxCallbackFrames, maxFrames);
+    size_t blocks = static_cast<size_t>(options_.lookahead) + 4;
+    input_.resize(blocks * callbackFrames * inputChannels);
+    output_.resize(blocks * callbackFrames * outputChannels);
+    inputBlock_.assign(maxFrames * inputChannels, 0.0f);
+    silence_.assign(callbackFrames * inputChannels, 0.0f);
+    outputBlock_.assign(maxFrames * outputChannels, 0.0f);
+}
+
+bool DspThread::start()
+{
+    stop();
+
+    primingBlocks_ = options_.lookahead + 1;
+    pendingFlags_.store(0, std::memory_order_relaxed);
+    streamTime_.store(0.0, std::memory_order_relaxed);
+    lateBlocks_.store(0, std::memory_order_relaxed);
+    quit_.store(false, std::memory_order_relaxed);
+    placement_ = Placement();
+
+    if (options_.lockMemory)
+    {
+        placement_.memoryLocked = lockMemory();
+        if (!placement_.memoryLocked)
+            std::cerr << "[Warning] Could not lock memory; the DSP thread may page fault\n";
+    }
+
+    thread_ = std::thread(&DspThread::loop, this);
+
+    // An isolated core has nothing else to run; otherwise keep away from core 0
+    int core = options_.core;
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    if (core < 0)
+    {
+        std::vector<unsigned> isolated = isolatedCores();
+        if (!isolated.empty())
+            core = static_cast<int>(isolated.front());
+        else if (cores > 1)
+            core = static_cast<int>(cores - 1);
+    }
+    if (core >= 0 && pinThread(thread_, static_cast<unsigned>(core)))
+        placement_.core = core;
+
+    if (options_.priority > 0)
+    {
+        placement_.realtime = setRealtimePriority(thread_, options_.priority);
+        if (!placement_.realtime)
+            std::cerr << "[Warning] No permission for real-time scheduling; the DSP thread runs at normal priority\n";
+    }
+
+    return true;
+}
+
+void DspThread::stop()
+{
+    if (!thread_.joinable())
+        return;
+
+    quit_.store(true, std::memory_order_relaxed);
+    thread_.join();
+}
+
+// ===================== Driver Thread =====================
+void DspThread::process(const float *input, float *output, unsigned long frameCount, const BlockInfo &info)
+{
+    const size_t outputSamples = frameCount * outputChannels_;
+
+    // Output piles up after the DSP thread catches up from a late block;
+    // drop it before new input can add a block, to keep latency fixed
+    size_t queued = output_.readable();
+    size_t limit = (static_cast<size_t>(options_.lookahead) + 1) * outputSamples;
+    if (primingBlocks_ == 0 && queued > limit)
+        output_.discard(queued - limit);
+
+    // A missing input still advances the DSP thread with silence
+    unsigned flags = info.flags;
+    if (!input_.write(input ? input : silence_.data(), frameCount * inputChannels_))
+        flags |= StreamStats::InputOverflow;
+
+    if (flags)
+        pendingFlags_.fetch_or(flags, std::memory_order_relaxed);
+    inputLatency_.store(info.inputLatency, std::memory_order_relaxed);
+    outputLatency_.store(info.outputLatency, std::memory_order_relaxed);
+    streamTime_.store(info.streamTime, std::memory_order_relaxed);
+
+    if (primingBlocks_ > 0)
+    {
+        primingBlocks_--;
+        std::memset(output, 0, outputSamples * sizeof(float));
+        return;
+    }
+
+    if (!output_.read(output, outputSamples))
+    {
+        std::memset(output, 0, outputSamples * sizeof(float));
+        lateBlocks_.store(lateBlocks_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        pendingFlags_.fetch_or(StreamStats::OutputUnderflow, std::memory_order_relaxed);
+    }
+}
+
+// ===================== DSP Thread =====================
+void DspThread::loop()
+{
+    double pollSeconds = std::min(std::max(maxFrames_ / sampleRate_ / kPollsPerBlock, kMinPollSeconds), kMaxPollSeconds);
+    auto poll = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(pollSeconds));
+
+    while (!quit_.load(std::memory_order_relaxed))
+    {
+        size_t frames = std::min<size_t>(input_.readable() / inputChannels_, maxFrames_);
+        if (frames == 0)
+        {
+            std::this_thread::sleep_for(poll);
+            continue;
+        }
+
+        // Only the polling above may sleep
+        RealtimeScope realtime;
+        input_.read(inputBlock_.data(), frames * inputChannels_);
+
+        // Playback is now further away by everything still queued
+        BlockInfo info;
+        info.flags = pendingFlags_.exchange(0, std::memory_order_relaxed);
+        info.inputLatency = inputLatency_.load(std::memory_order_relaxed);
+        info.outputLatency = outputLatency_.load(std::memory_order_relaxed) +
+                             static_cast<double>(output_.readable() / outputChannels_) / sampleRate_;
+        double streamTime = streamTime_.load(std::memory_order_relaxed);
+        if (streamTime > 0.0)
+            info.streamTime = streamTime + static_cast<double>(output_.readable() / outputChannels_) / sampleRate_;
+
+        // No room means the driver stopped reading; the block is lost, so
+        // report it with the next one
+        inner_.process(inputBlock_.data(), outputBlock_.data(), frames, info);
+        if (!output_.write(outputBlock_.data(), frames * outputChannels_))
+            pendingFlags_.fetch_or(StreamStats::OutputOverflow, std::memory_order_relaxed);
+    }
+}
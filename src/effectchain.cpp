@@ -0,0 +1,145 @@
+#include "effectchain.h"
+#include "staticchain.h"
+#include <utility>
+
+// ===================== Chain Snapshot =====================
+EffectChain::EffectChain(std::vector<std::shared_ptr<Effect>> effects, bool fuse, const EffectChain *previous)
+    : effects_(std::move(effects))
+{
+    if (fuse)
+        fused_ = fuseEffects(effects_, previous ? previous->fused_ : std::vector<std::shared_ptr<Effect>>{});
+
+    const auto &processors = fuse ? fused_ : effects_;
+    processors_.reserve(processors.size());
+    for (const auto &effect : processors)
+    {
+        if (effect)
+            processors_.push_back(effect.get());
+    }
+}
+
+// ===================== Constructor / Destructor =====================
+EffectChainPublisher::EffectChainPublisher()
+    : current_(new EffectChain({})), blocksEntered_(0), blocksExited_(0)
+{
+}
+
+EffectChainPublisher::~EffectChainPublisher()
+{
+    // The audio thread must be stopped by now
+    for (const Retired &r : retired_)
+        delete r.chain;
+    delete current_.load();
+}
+
+// ===================== Control Thread =====================
+void EffectChainPublisher::publish(std::vector<std::shared_ptr<Effect>> effects)
+{
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    publishLocked(std::move(effects));
+}
+
+std::vector<std::shared_ptr<Effect>> EffectChainPublisher::getEffects() const
+{
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    return current_.load()->effects();
+}
+
+void EffectChainPublisher::addEffect(std::shared_ptr<Effect> effect)
+{
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    auto effects = current_.load()->effects();
+    effects.push_back(std::move(effect));
+    publishLocked(std::move(effects));
+}
+
+bool EffectChainPublisher::removeEffect(size_t index)
+{
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    auto effects = current_.load()->effects();
+    if (index >= effects.size())
+        return false;
+
+    effects.erase(effects.begin() + index);
+    publishLocked(std::move(effects));
+    return true;
+}
+
+bool EffectChainPublisher::moveEffect(size_t from, size_t to)
+{
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    auto effects = current_.load()->effects();
+    if (from >= effects.size() || to >= effects.size())
+        return false;
+
+    auto effect = effects[from];
+    effects.erase(effects.begin() + from);
+    effects.insert(effects.begin() + to, std::move(effect));
+    publishLocked(std::move(effects));
+    return true;
+}
+
+bool EffectChainPublisher::replaceEffect(size_t index, std::shared_ptr<Effect> effect)
+{
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    auto effects = current_.load()->effects();
+    if (index >= effects.size())
+        return false;
+
+    effects[index] = std::move(effect);
+    publishLocked(std::move(effects));
+    return true;
+}
+
+void EffectChainPublisher::setFusion(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    fusion_ = enabled;
+    publishLocked(current_.load()->effects());
+}
+
+void EffectChainPublisher::collect()
+{
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    collectLocked();
+}
+
+void EffectChainPublisher::publishLocked(std::vector<std::shared_ptr<Effect>> effects)
+{
+    // Build the snapshot completely before the audio thread can see it
+    const EffectChain *next = new EffectChain(std::move(effects), fusion_, current_.load());
+    const EffectChain *previous = current_.exchange(next);
+
+    // Any block entered after this point reads the new snapshot; the ones
+    // already counted may still hold the previous one until they exit.
+    retired_.push_back({previous, blocksEntered_.load()});
+    collectLocked();
+}
+
+void EffectChainPublisher::collectLocked()
+{
+    uint64_t exited = blocksExited_.load(std::memory_order_acquire);
+
+    size_t kept = 0;
+    for (const Retired &r : retired_)
+    {
+        if (exited >= r.epoch)
+            delete r.chain;
+        else
+            retired_[kept++] = r;
+    }
+    retired_.resize(kept);
+}
+
+// ===================== Audio Thread =====================
+const EffectChain *EffectChainPublisher::acquire()
+{
+    // Sequentially consistent so it pairs with the exchange + load in publishLocked()
+    blocksEntered_.fetch_add(1);
+    return current_.load();
+}
+
+void EffectChainPublisher::release()
+{
+    blocksExited_.fetch_add(1, std::memory_order_release);
+}
@@ -0,0 +1,121 @@
+#include "eventqueue.h"
+#include <algorithm>
+
+// ===================== Constructor =====================
+EventQueue::EventQueue() : ring_(kCapacity), batches_(kCapacity), sorted_(kCapacity), pending_(kCapacity)
+{
+}
+
+// ===================== Control Thread =====================
+bool EventQueue::push(const ControlEvent *events, size_t count)
+{
+    if (count == 0)
+        return true;
+
+    std::lock_guard<std::mutex> lock(producerMutex_);
+    size_t write = write_.load(std::memory_order_relaxed);
+    if (count > kCapacity - (write - read_.load(std::memory_order_acquire)))
+        return false;
+
+    // Stable insertion sort, so the audio thread can merge the batch in one
+    // pass; batches usually come sorted and then nothing moves
+    for (size_t n = 0; n < count; n++)
+    {
+        size_t i = n;
+        for (; i > 0 && sorted_[i - 1].frame > events[n].frame; i--)
+            sorted_[i] = sorted_[i - 1];
+        sorted_[i] = events[n];
+    }
+
+    for (size_t i = 0; i < count; i++)
+        ring_[(write + i) % kCapacity] = sorted_[i];
+    batches_[write % kCapacity] = count;
+
+    // One store publishes the whole batch
+    write_.store(write + count, std::memory_order_release);
+    return true;
+}
+
+size_t EventQueue::size() const
+{
+    return write_.load(std::memory_order_acquire) - read_.load(std::memory_order_acquire) +
+           held_.load(std::memory_order_relaxed);
+}
+
+// ===================== Audio Thread =====================
+void EventQueue::receive()
+{
+    const size_t start = read_.load(std::memory_order_relaxed);
+    const size_t write = write_.load(std::memory_order_acquire);
+    if (write == start)
+        return;
+
+    if (head_ > 0)
+    {
+        std::move(pending_.begin() + head_, pending_.begin() + pendingCount_, pending_.begin());
+        pendingCount_ -= head_;
+        head_ = 0;
+    }
+
+    // Whole batches only; one that does not fit waits for pending events
+    // to come due
+    size_t read = start;
+    while (read != write)
+    {
+        const size_t count = batches_[read % kCapacity];
+        if (count > kCapacity - pendingCount_)
+            break;
+
+        // Merge from the back: pending events stay ahead of batch events on
+        // the same frame, and a batch after everything pending moves nothing
+        size_t i = pendingCount_, j = count, k = pendingCount_ + count;
+        while (j > 0)
+        {
+            const ControlEvent &event = ring_[(read + j - 1) % kCapacity];
+            if (i > 0 && pending_[i - 1].frame > event.frame)
+                pending_[--k] = pending_[--i];
+            else
+            {
+                pending_[--k] = event;
+                j--;
+            }
+        }
+
+        pendingCount_ += count;
+        read += count;
+    }
+
+    if (read != start)
+    {
+        read_.store(read, std::memory_order_release);
+        held_.store(pendingCount_, std::memory_order_relaxed);
+    }
+}
+
+bool EventQueue::nextFrame(uint64_t &frame) const
+{
+    if (head_ == pendingCount_)
+        return false;
+    frame = pending_[head_].frame;
+    return true;
+}
+
+bool EventQueue::pop(uint64_t frame, ControlEvent &event)
+{
+    if (head_ == pendingCount_ || pending_[head_].frame > frame)
+        return false;
+
+    event = pending_[head_++];
+    if (head_ == pendingCount_)
+        head_ = pendingCount_ = 0;
+    held_.store(pendingCount_ - head_, std::memory_order_relaxed);
+    return true;
+}
+
+void EventQueue::clear()
+{
+    std::lock_guard<std::mutex> lock(producerMutex_);
+    read_.store(write_.load(std::memory_order_relaxed), std::memory_order_release);
+    head_ = pendingCount_ = 0;
+    held_.store(0, std::memory_order_relaxed);
+}
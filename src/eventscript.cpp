@@ -0,0 +1,329 @@
+#include "eventscript.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+    // How far ahead of the stream the player keeps events queued
+    constexpr double kLeadSeconds = 1.0;
+    constexpr auto kFeedInterval = std::chrono::milliseconds(50);
+
+    // Lower case without spaces, so "Amp Model" matches "ampmodel"
+    std::string normalize(const std::string &name)
+    {
+        std::string out;
+        for (char c : name)
+        {
+            if (c != ' ')
+                out += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        return out;
+    }
+
+    Effect *findEffect(const std::string &token, const std::vector<std::shared_ptr<Effect>> &chain)
+    {
+        char *end = nullptr;
+        unsigned long position = std::strtoul(token.c_str(), &end, 10);
+        if (end != token.c_str() && *end == '\0')
+            return position >= 1 && position <= chain.size() ? chain[position - 1].get() : nullptr;
+
+        for (const auto &effect : chain)
+        {
+            if (effect && normalize(effect->name()) == normalize(token))
+                return effect.get();
+        }
+        return nullptr;
+    }
+
+    int findParameter(const Effect &effect, const std::string &name)
+    {
+        for (int i = 0; effect.parameterName(i); i++)
+        {
+            if (normalize(effect.parameterName(i)) == normalize(name))
+                return i;
+        }
+        return -1;
+    }
+
+    // "4800" frames, "1.5s", "250ms" or "@12.5" on the stream clock
+    bool parseWhen(const std::string &token, double sampleRate, bool &streamTime, double &when)
+    {
+        streamTime = !token.empty() && token[0] == '@';
+        const char *start = token.c_str() + (streamTime ? 1 : 0);
+        char *end = nullptr;
+        double value = std::strtod(start, &end);
+        if (end == start || value < 0.0)
+            return false;
+
+        std::string unit = end;
+        if (streamTime)
+            when = value;
+        else if (unit == "s")
+            when = value * sampleRate;
+        else if (unit == "ms")
+            when = value * sampleRate / 1000.0;
+        else if (unit.empty() && value == std::floor(value))
+            when = value;
+        else
+            return false;
+        return unit.empty() || !streamTime;
+    }
+}
+
+// ===================== Event Script =====================
+bool EventScript::parse(std::istream &in, const std::vector<std::shared_ptr<Effect>> &chain, double sampleRate)
+{
+    timed_.clear();
+    presets_.clear();
+    events_.clear();
+    next_ = 0;
+
+    std::string line, error, defining;
+    std::vector<ControlEvent> preset;
+    int number = 0;
+    while (error.empty() && std::getline(in, line))
+    {
+        number++;
+        line.erase(std::min(line.find('#'), line.size()));
+        std::istringstream args(line);
+        std::string first;
+        if (!(args >> first))
+            continue;
+
+        if (!defining.empty())
+        {
+            if (first == "end")
+            {
+                presets_[defining] = preset;
+                defining.clear();
+            }
+            else
+                parseAction(first, args, chain, preset, error);
+            continue;
+        }
+
+        if (first == "define")
+        {
+            if (!(args >> defining))
+                error = "'define' needs a preset name";
+            preset.clear();
+            continue;
+        }
+
+        Timed timed;
+        std::string action;
+        if (!parseWhen(first, sampleRate, timed.streamTime, timed.when))
+        {
+            error = "invalid time '" + first + "'";
+            continue;
+        }
+        if (!(args >> action))
+        {
+            error = "missing action";
+            continue;
+        }
+
+        std::vector<ControlEvent> events;
+        if (!parseAction(action, args, chain, events, error))
+            continue;
+        for (const ControlEvent &event : events)
+        {
+            timed.event = event;
+            timed_.push_back(timed);
+        }
+    }
+
+    if (error.empty() && !defining.empty())
+        error = "preset '" + defining + "' has no 'end'";
+    if (!error.empty())
+    {
+        std::cerr << "[Error] Line " << number << ": " << error << "\n";
+        timed_.clear();
+        return false;
+    }
+    return true;
+}
+
+bool EventScript::parseAction(const std::string &action, std::istringstream &args,
+                              const std::vector<std::shared_ptr<Effect>> &chain,
+                              std::vector<ControlEvent> &out, std::string &error) const
+{
+    std::string target, name, extra;
+    if (action == "preset")
+    {
+        args >> name;
+        auto it = presets_.find(name);
+        if (it == presets_.end())
+        {
+            error = "no preset named '" + name + "' defined above";
+            return false;
+        }
+        out.insert(out.end(), it->second.begin(), it->second.end());
+        return true;
+    }
+
+    if (action != "set" && action != "bypass")
+    {
+        error = "unknown action '" + action + "'";
+        return false;
+    }
+
+    args >> target;
+    Effect *effect = findEffect(target, chain);
+    if (!effect)
+    {
+        error = "no effect '" + target + "' in the chain";
+        return false;
+    }
+
+    ControlEvent event;
+    event.effect = effect->id();
+    if (action == "set")
+    {
+        args >> name >> event.value;
+        event.type = ControlEvent::Type::Parameter;
+        event.parameter = findParameter(*effect, name);
+        if (event.parameter < 0)
+        {
+            error = std::string(effect->name()) + " has no parameter '" + name + "'";
+            return false;
+        }
+        if (args.fail())
+        {
+            error = "'set' needs a value";
+            return false;
+        }
+    }
+    else
+    {
+        args >> name;
+        event.type = ControlEvent::Type::Bypass;
+        event.value = name == "on" ? 1.0f : 0.0f;
+        if (name != "on" && name != "off")
+        {
+            error = "'bypass' takes on or off";
+            return false;
+        }
+    }
+
+    if (args >> extra)
+    {
+        error = "unexpected '" + extra + "'";
+        return false;
+    }
+    out.push_back(event);
+    return true;
+}
+
+bool EventScript::start(uint64_t originFrame, const StreamClock &clock)
+{
+    events_.clear();
+    next_ = 0;
+    for (const Timed &timed : timed_)
+    {
+        ControlEvent event = timed.event;
+        if (!timed.streamTime)
+            event.frame = originFrame + static_cast<uint64_t>(std::llround(timed.when));
+        else if (!clock || !clock(timed.when, event.frame))
+        {
+            std::cerr << "[Error] Stream times (@) need a running stream that reports its clock\n";
+            events_.clear();
+            return false;
+        }
+        events_.push_back(event);
+    }
+
+    // Stable, so events at one frame keep the order they were written in
+    std::stable_sort(events_.begin(), events_.end(),
+                     [](const ControlEvent &a, const ControlEvent &b)
+                     { return a.frame < b.frame; });
+
+    // A frame's events go out as one batch, which has to fit the queue
+    for (size_t i = 0, run = 0; i < events_.size(); i++)
+    {
+        run = i > 0 && events_[i].frame == events_[i - 1].frame ? run + 1 : 1;
+        if (run > EventQueue::kCapacity)
+        {
+            std::cerr << "[Error] More than " << EventQueue::kCapacity << " events land on frame "
+                      << events_[i].frame << "\n";
+            events_.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t EventScript::feed(uint64_t horizonFrame, const Scheduler &schedule)
+{
+    size_t scheduled = 0;
+    while (next_ < events_.size() && events_[next_].frame < horizonFrame)
+    {
+        size_t end = next_;
+        while (end < events_.size() && events_[end].frame == events_[next_].frame)
+            end++;
+        if (!schedule(&events_[next_], end - next_))
+            break;
+
+        scheduled += end - next_;
+        next_ = end;
+    }
+    return scheduled;
+}
+
+bool EventScript::nextFrame(uint64_t &frame) const
+{
+    if (finished())
+        return false;
+    frame = events_[next_].frame;
+    return true;
+}
+
+// ===================== Script Player =====================
+ScriptPlayer::~ScriptPlayer()
+{
+    stop();
+}
+
+void ScriptPlayer::start(EventScript script, std::function<uint64_t()> streamFrame,
+                         EventScript::Scheduler schedule, double sampleRate)
+{
+    stop();
+
+    script_ = std::move(script);
+    stopping_ = false;
+    playing_.store(true, std::memory_order_relaxed);
+    thread_ = std::thread(&ScriptPlayer::run, this, std::move(streamFrame), std::move(schedule), sampleRate);
+}
+
+void ScriptPlayer::stop()
+{
+    if (!thread_.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    thread_.join();
+    playing_.store(false, std::memory_order_relaxed);
+}
+
+void ScriptPlayer::run(std::function<uint64_t()> streamFrame, EventScript::Scheduler schedule, double sampleRate)
+{
+    const uint64_t lead = static_cast<uint64_t>(kLeadSeconds * sampleRate);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    do
+    {
+        script_.feed(streamFrame() + lead, schedule);
+        if (script_.finished())
+            break;
+    } while (!wake_.wait_for(lock, kFeedInterval, [this] { return stopping_; }));
+
+    playing_.store(false, std::memory_order_relaxed);
+}
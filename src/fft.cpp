@@ -0,0 +1,136 @@
+#include "fft.h"
+#include <cmath>
+
+// ===================== Constructor =====================
+Fft::Fft(size_t size)
+    : n_(size), half_(size / 2)
+{
+    const double pi = 3.14159265358979323846;
+
+    size_t bits = 0;
+    while ((size_t(1) << bits) < half_)
+        bits++;
+
+    bitReverse_.resize(half_);
+    for (size_t i = 0; i < half_; i++)
+    {
+        size_t r = 0;
+        for (size_t b = 0; b < bits; b++)
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        bitReverse_[i] = r;
+    }
+
+    twiddleRe_.resize(half_ / 2);
+    twiddleIm_.resize(half_ / 2);
+    for (size_t k = 0; k < half_ / 2; k++)
+    {
+        twiddleRe_[k] = static_cast<float>(std::cos(2.0 * pi * k / half_));
+        twiddleIm_[k] = static_cast<float>(-std::sin(2.0 * pi * k / half_));
+    }
+
+    splitRe_.resize(half_ + 1);
+    splitIm_.resize(half_ + 1);
+    for (size_t k = 0; k <= half_; k++)
+    {
+        splitRe_[k] = static_cast<float>(std::cos(2.0 * pi * k / n_));
+        splitIm_[k] = static_cast<float>(-std::sin(2.0 * pi * k / n_));
+    }
+
+    workRe_.resize(half_);
+    workIm_.resize(half_);
+}
+
+// ===================== Complex Transform =====================
+void Fft::transform(float *re, float *im, bool inverse)
+{
+    for (size_t i = 0; i < half_; i++)
+    {
+        size_t j = bitReverse_[i];
+        if (j > i)
+        {
+            std::swap(re[i], re[j]);
+            std::swap(im[i], im[j]);
+        }
+    }
+
+    const float sign = inverse ? -1.0f : 1.0f;
+
+    for (size_t len = 2; len <= half_; len <<= 1)
+    {
+        const size_t halfLen = len / 2;
+        const size_t step = half_ / len;
+        for (size_t start = 0; start < half_; start += len)
+        {
+            for (size_t j = 0; j < halfLen; j++)
+            {
+                const float wr = twiddleRe_[j * step];
+                const float wi = sign * twiddleIm_[j * step];
+                const size_t a = start + j, b = a + halfLen;
+
+                const float tr = re[b] * wr - im[b] * wi;
+                const float ti = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+}
+
+// ===================== Real Transforms =====================
+void Fft::forward(const float *input, float *re, float *im)
+{
+    // Pack even samples as real and odd samples as imaginary parts
+    float *zr = workRe_.data(), *zi = workIm_.data();
+    for (size_t i = 0; i < half_; i++)
+    {
+        zr[i] = input[2 * i];
+        zi[i] = input[2 * i + 1];
+    }
+
+    transform(zr, zi, false);
+
+    // Untangle the even/odd spectra: X[k] = E[k] + W^k O[k]
+    for (size_t k = 0; k <= half_; k++)
+    {
+        const size_t a = k % half_, b = (half_ - k) % half_;
+        const float er = 0.5f * (zr[a] + zr[b]);
+        const float ei = 0.5f * (zi[a] - zi[b]);
+        const float orr = 0.5f * (zi[a] + zi[b]);
+        const float oi = -0.5f * (zr[a] - zr[b]);
+
+        re[k] = er + splitRe_[k] * orr - splitIm_[k] * oi;
+        im[k] = ei + splitRe_[k] * oi + splitIm_[k] * orr;
+    }
+}
+
+void Fft::inverse(const float *re, const float *im, float *output)
+{
+    // Rebuild Z[k] = E[k] + i O[k] from the half spectrum
+    float *zr = workRe_.data(), *zi = workIm_.data();
+    for (size_t k = 0; k < half_; k++)
+    {
+        const size_t b = half_ - k;
+        const float er = 0.5f * (re[k] + re[b]);
+        const float ei = 0.5f * (im[k] - im[b]);
+        const float dr = 0.5f * (re[k] - re[b]);
+        const float di = 0.5f * (im[k] + im[b]);
+
+        // O[k] = (X[k] - conj(X[M-k])) / 2 * W^-k
+        const float orr = dr * splitRe_[k] + di * splitIm_[k];
+        const float oi = di * splitRe_[k] - dr * splitIm_[k];
+
+        zr[k] = er - oi;
+        zi[k] = ei + orr;
+    }
+
+    transform(zr, zi, true);
+
+    const float scale = 1.0f / static_cast<float>(half_);
+    for (size_t i = 0; i < half_; i++)
+    {
+        output[2 * i] = zr[i] * scale;
+        output[2 * i + 1] = zi[i] * scale;
+    }
+}
@@ -1,16 +1,85 @@
 #include "commandhandler.h"
 #include "digitalamp.h"
+#include "renderer.h"
+#include "simulator.h"
 
-int main() { 
+#include <chrono>
+#include <iostream>
+#include <string>
+
+namespace
+{
+    // The chain of the headless modes: gain, then the amp model and the
+    // cabinet when their paths are given. False if either fails to load.
+    bool buildChain(AudioEngine &engine, const std::shared_ptr<GainEffect> &gain,
+                    const std::string &modelPath, const std::string &impulsePath)
+    {
+        engine.addEffect(gain);
+        if (!modelPath.empty())
+        {
+            auto model = AmpModelEffect::load(modelPath);
+            if (!model)
+                return false;
+            engine.addEffect(model);
+        }
+        if (!impulsePath.empty())
+        {
+            auto cabinet = ConvolutionEffect::load(impulsePath);
+            if (!cabinet)
+                return false;
+            engine.addEffect(cabinet);
+        }
+        return true;
+    }
+}
+
+int main(int argc, char **argv) { 
+    auto launched = std::chrono::steady_clock::now();
     std::shared_ptr<GainEffect> gain = std::make_shared<GainEffect>(2.0f);
 
+    // Headless mode: render a file through the chain without an audio device
+    if (argc > 1 && std::string(argv[1]) == "render")
+    {
+        RenderOptions options;
+        if (!parseRenderArgs(argc - 2, argv + 2, options))
+            return 1;
+
+        AudioEngine engine;
+        if (!buildChain(engine, gain, options.modelPath, options.impulsePath))
+            return 1;
+        return renderFile(engine, options) ? 0 : 1;
+    }
+
+    // Headless mode: stream through a simulated audio device
+    if (argc > 1 && std::string(argv[1]) == "simulate")
+    {
+        SimulateOptions options;
+        if (!parseSimulateArgs(argc - 2, argv + 2, options))
+            return 1;
+
+        AudioEngine engine;
+        if (!buildChain(engine, gain, options.modelPath, options.impulsePath))
+            return 1;
+        return runSimulation(engine, options) ? 0 : 1;
+    }
+
     DigitalAmp amp;
     amp.initialize();
-    amp.effects.push_back(gain);
+    amp.addEffect(gain);
 
     CommandHandler cmd(&amp);
     cmd.gainEffect = gain;
+    cmd.distortionEffect = std::make_shared<DistortionEffect>();
+
+    // "--profile NAME", or the startup profile from the settings file
+    std::string profile = argc > 2 && std::string(argv[1]) == "--profile" ? argv[2] : "";
+    if (cmd.startProfile(profile))
+    {
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - launched).count();
+        std::cout << "[Info] Audio running " << static_cast<int>(ms) << " ms after launch\n";
+    }
+
     cmd.run();
 
     return 0;
-}
\ No newline at end of file
+}
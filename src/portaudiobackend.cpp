@@ -0,0 +1,188 @@
+#include "portaudiobackend.h"
+#include "rtguard.h"
+#include <algorithm>
+#include <iostream>
+
+// ===================== Constructor / Destructor =====================
+PortAudioBackend::~PortAudioBackend()
+{
+    close();
+}
+
+// ===================== Stream Management =====================
+bool PortAudioBackend::toParameters(const StreamConfig &config, bool isInput, PaStreamParameters &params)
+{
+    PaDeviceIndex device = isInput ? config.inputDevice : config.outputDevice;
+    if (device < 0)
+        device = isInput ? Pa_GetDefaultInputDevice() : Pa_GetDefaultOutputDevice();
+
+    const PaDeviceInfo *info = Pa_GetDeviceInfo(device);
+    if (info == nullptr)
+        return false;
+
+    double latency = isInput ? config.inputLatency : config.outputLatency;
+    if (latency <= 0.0)
+        latency = isInput ? info->defaultLowInputLatency : info->defaultLowOutputLatency;
+
+    params.device = device;
+    params.channelCount = isInput ? config.inputChannels : config.outputChannels;
+    params.sampleFormat = toSampleFormat(isInput ? config.inputEncoding : config.outputEncoding);
+    params.suggestedLatency = latency;
+    params.hostApiSpecificStreamInfo = nullptr;
+    return true;
+}
+
+PaSampleFormat PortAudioBackend::toSampleFormat(SampleEncoding encoding)
+{
+    switch (encoding)
+    {
+    case SampleEncoding::Int16:
+        return paInt16;
+    case SampleEncoding::Int24:
+        return paInt24;
+    case SampleEncoding::Int32:
+        return paInt32;
+    case SampleEncoding::Float32:
+        break;
+    }
+    return paFloat32;
+}
+
+bool PortAudioBackend::isFormatSupported(const StreamConfig &config)
+{
+    PaStreamParameters input{}, output{};
+    if (!toParameters(config, true, input) || !toParameters(config, false, output))
+        return false;
+
+    return Pa_IsFormatSupported(&input, &output, config.sampleRate) == paFormatIsSupported;
+}
+
+bool PortAudioBackend::open(const StreamConfig &config, AudioCallback *callback)
+{
+    close();
+
+    PaStreamParameters input{}, output{};
+    if (!toParameters(config, true, input) || !toParameters(config, false, output))
+    {
+        std::cerr << "PortAudio error: Invalid device selection" << std::endl;
+        return false;
+    }
+
+    // Verify format support
+    PaError support = Pa_IsFormatSupported(&input, &output, config.sampleRate);
+    if (support != paFormatIsSupported)
+    {
+        std::cerr << "Format not supported: " << Pa_GetErrorText(support) << std::endl;
+        return false;
+    }
+
+    // The host may hand over longer periods than asked for
+    unsigned long maxFrames = config.framesPerBuffer != 0 ? config.framesPerBuffer : AudioEngine::kDefaultMaxFrames;
+    input_.prepare(config.inputEncoding, config.inputChannels, maxFrames);
+    output_.prepare(config.outputEncoding, config.outputChannels, maxFrames);
+    sampleRate_ = config.sampleRate;
+
+    callback_ = callback;
+    PaError err = Pa_OpenStream(&stream_,
+                                &input,
+                                &output,
+                                config.sampleRate,
+                                config.framesPerBuffer == 0 ? paFramesPerBufferUnspecified : config.framesPerBuffer,
+                                paClipOff,
+                                paCallback,
+                                this);
+
+    if (err != paNoError)
+    {
+        std::cerr << "PortAudio error: " << Pa_GetErrorText(err) << std::endl;
+        stream_ = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+bool PortAudioBackend::start()
+{
+    if (!stream_)
+        return false;
+
+    PaError err = Pa_StartStream(stream_);
+    if (err != paNoError)
+    {
+        std::cerr << "PortAudio error: " << Pa_GetErrorText(err) << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+void PortAudioBackend::close()
+{
+    if (stream_)
+    {
+        Pa_CloseStream(stream_);
+        stream_ = nullptr;
+    }
+}
+
+// ===================== Audio Callback =====================
+int PortAudioBackend::paCallback(const void *inputBuffer, void *outputBuffer,
+                                 unsigned long framesPerBuffer,
+                                 const PaStreamCallbackTimeInfo *timeInfo,
+                                 PaStreamCallbackFlags statusFlags,
+                                 void *userData)
+{
+    RealtimeScope realtime;
+    PortAudioBackend *backend = static_cast<PortAudioBackend *>(userData);
+
+    BlockInfo info;
+    if (statusFlags & paInputUnderflow)
+        info.flags |= StreamStats::InputUnderflow;
+    if (statusFlags & paInputOverflow)
+        info.flags |= StreamStats::InputOverflow;
+    if (statusFlags & paOutputUnderflow)
+        info.flags |= StreamStats::OutputUnderflow;
+    if (statusFlags & paOutputOverflow)
+        info.flags |= StreamStats::OutputOverflow;
+    if (statusFlags & paPrimingOutput)
+        info.flags |= StreamStats::PrimingOutput;
+
+    // Some host APIs leave the timestamps at zero
+    if (timeInfo && timeInfo->currentTime > 0.0)
+    {
+        if (timeInfo->inputBufferAdcTime > 0.0)
+            info.inputLatency = timeInfo->currentTime - timeInfo->inputBufferAdcTime;
+        if (timeInfo->outputBufferDacTime > 0.0)
+        {
+            info.outputLatency = timeInfo->outputBufferDacTime - timeInfo->currentTime;
+            info.streamTime = timeInfo->outputBufferDacTime;
+        }
+    }
+
+    // Float streams go to the engine whole; converted ones in pieces that
+    // fit the converters' scratch
+    unsigned long piece = framesPerBuffer;
+    if (backend->input_.converts() || backend->output_.converts())
+        piece = backend->output_.maxFrames();
+
+    const char *input = static_cast<const char *>(inputBuffer);
+    char *output = static_cast<char *>(outputBuffer);
+    for (unsigned long done = 0; done < framesPerBuffer;)
+    {
+        unsigned long frames = std::min(framesPerBuffer - done, piece);
+        BlockInfo block = info;
+        if (info.streamTime > 0.0)
+            block.streamTime = info.streamTime + done / backend->sampleRate_;
+        // The host's xrun and priming flags describe the period once
+        if (done > 0)
+            block.flags = 0;
+
+        const float *in = input ? backend->input_.read(input + done * backend->input_.frameBytes(), frames) : nullptr;
+        void *out = output + done * backend->output_.frameBytes();
+        backend->callback_->process(in, backend->output_.target(out), frames, block);
+        backend->output_.write(out, frames);
+        done += frames;
+    }
+    return paContinue;
+}
@@ -0,0 +1,239 @@
+#include "realtime.h"
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define AMPLY_MXCSR 1
+#endif
+
+namespace
+{
+    std::atomic<bool> memoryLockedFlag{false};
+
+    // MXCSR flush-to-zero (FTZ) and denormals-are-zero (DAZ)
+    constexpr unsigned kMxcsrFlush = 0x8040;
+    // FPCR / FPSCR flush-to-zero
+    constexpr unsigned long kArmFlush = 1ul << 24;
+}
+
+// ===================== Thread Placement =====================
+bool pinThread(std::thread &thread, unsigned core)
+{
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+    return SetThreadAffinityMask(static_cast<HANDLE>(thread.native_handle()), DWORD_PTR(1) << core) != 0;
+#else
+    // macOS has no hard affinity; the scheduler places the threads
+    (void)thread;
+    (void)core;
+    return false;
+#endif
+}
+
+bool setRealtimePriority(std::thread &thread, int priority)
+{
+#if defined(__linux__) || defined(__APPLE__)
+    sched_param param{};
+    param.sched_priority = priority;
+    return pthread_setschedparam(thread.native_handle(), SCHED_FIFO, &param) == 0;
+#elif defined(_WIN32)
+    (void)priority;
+    return SetThreadPriority(static_cast<HANDLE>(thread.native_handle()), THREAD_PRIORITY_TIME_CRITICAL) != 0;
+#else
+    (void)thread;
+    (void)priority;
+    return false;
+#endif
+}
+
+bool lockMemory()
+{
+#if defined(__linux__)
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+        return false;
+    memoryLockedFlag.store(true, std::memory_order_relaxed);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool memoryLocked()
+{
+    return memoryLockedFlag.load(std::memory_order_relaxed);
+}
+
+std::vector<unsigned> isolatedCores()
+{
+    std::vector<unsigned> cores;
+#if defined(__linux__)
+    // A list such as "2-3,6"
+    std::ifstream file("/sys/devices/system/cpu/isolated");
+    std::string list;
+    std::getline(file, list);
+
+    std::istringstream ranges(list);
+    std::string range;
+    while (std::getline(ranges, range, ','))
+    {
+        try
+        {
+            size_t dash = range.find('-');
+            unsigned first = static_cast<unsigned>(std::stoul(range.substr(0, dash)));
+            unsigned last = dash == std::string::npos ? first : static_cast<unsigned>(std::stoul(range.substr(dash + 1)));
+            for (unsigned core = first; core <= last; core++)
+                cores.push_back(core);
+        }
+        catch (...)
+        {
+        }
+    }
+#endif
+    return cores;
+}
+
+// ===================== Calling Thread =====================
+bool setFlushDenormals(bool enabled)
+{
+#if defined(AMPLY_MXCSR)
+    unsigned csr = _mm_getcsr();
+    _mm_setcsr(enabled ? (csr | kMxcsrFlush) : (csr & ~kMxcsrFlush));
+    return true;
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+    unsigned long fpcr;
+    __asm__ volatile("mrs %0, fpcr" : "=r"(fpcr));
+    fpcr = enabled ? (fpcr | kArmFlush) : (fpcr & ~kArmFlush);
+    __asm__ volatile("msr fpcr, %0" : : "r"(fpcr));
+    return true;
+#elif defined(__arm__) && defined(__ARM_FP) && (defined(__GNUC__) || defined(__clang__))
+    unsigned long fpscr;
+    __asm__ volatile("vmrs %0, fpscr" : "=r"(fpscr));
+    fpscr = enabled ? (fpscr | kArmFlush) : (fpscr & ~kArmFlush);
+    __asm__ volatile("vmsr fpscr, %0" : : "r"(fpscr));
+    return true;
+#else
+    (void)enabled;
+    return false;
+#endif
+}
+
+bool flushesDenormals()
+{
+#if defined(AMPLY_MXCSR)
+    return (_mm_getcsr() & kMxcsrFlush) == kMxcsrFlush;
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+    unsigned long fpcr;
+    __asm__ volatile("mrs %0, fpcr" : "=r"(fpcr));
+    return (fpcr & kArmFlush) != 0;
+#elif defined(__arm__) && defined(__ARM_FP) && (defined(__GNUC__) || defined(__clang__))
+    unsigned long fpscr;
+    __asm__ volatile("vmrs %0, fpscr" : "=r"(fpscr));
+    return (fpscr & kArmFlush) != 0;
+#else
+    return false;
+#endif
+}
+
+bool setBackgroundPriority()
+{
+#if defined(__linux__)
+    // Nice values are per thread on Linux; raising one needs no privileges
+    return setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10) == 0;
+#elif defined(__APPLE__)
+    return pthread_set_qos_class_self_np(QOS_CLASS_UTILITY, 0) == 0;
+#elif defined(_WIN32)
+    return SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL) != 0;
+#else
+    return false;
+#endif
+}
+
+ThreadState applyThreadSetup(const ThreadSetup &setup)
+{
+    setFlushDenormals(setup.flushDenormals);
+
+#if defined(__linux__)
+    if (setup.core >= 0)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(setup.core, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+#elif defined(_WIN32)
+    if (setup.core >= 0)
+        SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << setup.core);
+#endif
+
+    if (setup.priority > 0)
+    {
+#if defined(__linux__) || defined(__APPLE__)
+        int policy = SCHED_OTHER;
+        sched_param param{};
+        pthread_getschedparam(pthread_self(), &policy, &param);
+        bool higher = (policy == SCHED_FIFO || policy == SCHED_RR) && param.sched_priority >= setup.priority;
+        if (!higher)
+        {
+            param.sched_priority = setup.priority;
+            pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        }
+#elif defined(_WIN32)
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+#endif
+    }
+
+    return currentThreadState();
+}
+
+ThreadState currentThreadState()
+{
+    ThreadState state;
+    state.flushDenormals = flushesDenormals();
+    state.memoryLocked = memoryLocked();
+
+#if defined(__linux__) || defined(__APPLE__)
+    int policy = SCHED_OTHER;
+    sched_param param{};
+    if (pthread_getschedparam(pthread_self(), &policy, &param) == 0 && (policy == SCHED_FIFO || policy == SCHED_RR))
+    {
+        state.realtime = true;
+        state.priority = param.sched_priority;
+    }
+#elif defined(_WIN32)
+    int priority = GetThreadPriority(GetCurrentThread());
+    state.realtime = priority == THREAD_PRIORITY_TIME_CRITICAL;
+    state.priority = state.realtime ? priority : 0;
+#endif
+
+#if defined(__linux__)
+    state.core = sched_getcpu();
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0)
+        state.allowedCores = CPU_COUNT(&set);
+#elif defined(_WIN32)
+    state.core = static_cast<int>(GetCurrentProcessorNumber());
+#endif
+
+    return state;
+}
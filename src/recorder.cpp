@@ -0,0 +1,279 @@
+#include "recorder.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    // Frames per write: one AudioFileWriter chunk, a multiple of 4096 bytes
+    constexpr unsigned long kBatchFrames = 16384;
+
+    // Sample data starts on a page boundary, so every chunk lands aligned
+    constexpr size_t kDataAlignment = 4096;
+
+    // How often the writer looks for new blocks
+    constexpr auto kPollInterval = std::chrono::milliseconds(10);
+
+    // How long the final drain waits for a block the audio thread is still pushing
+    constexpr int kFinalPolls = 10;
+
+    // Header flags
+    constexpr unsigned kSilentInput = 1;
+
+    // Frame counts travel as floats, exact in 24-bit pieces
+    constexpr uint64_t kPieceMask = (1u << 24) - 1;
+}
+
+// ===================== Constructor / Destructor =====================
+SessionRecorder::~SessionRecorder()
+{
+    stop();
+}
+
+// ===================== Control Thread =====================
+bool SessionRecorder::start(const std::string &basePath, double sampleRate, int inputChannels, int outputChannels,
+                            const Options &options)
+{
+    stop();
+
+    AudioFormat dry, wet;
+    dry.sampleRate = wet.sampleRate = sampleRate;
+    dry.channels = inputChannels;
+    wet.channels = outputChannels;
+    dry.encoding = wet.encoding = SampleEncoding::Float32;
+
+    dryPath_ = basePath + "-dry.wav";
+    wetPath_ = basePath + "-wet.wav";
+    if (!dryFile_.openWav(dryPath_, dry, kDataAlignment) || !wetFile_.openWav(wetPath_, wet, kDataAlignment))
+    {
+        dryFile_.close();
+        wetFile_.close();
+        return false;
+    }
+
+    preallocated_ = false;
+    if (options.preallocateSeconds > 0.0)
+    {
+        uint64_t frames = static_cast<uint64_t>(std::ceil(options.preallocateSeconds * sampleRate));
+        preallocated_ = dryFile_.preallocate(frames * inputChannels * sizeof(float)) &&
+                        wetFile_.preallocate(frames * outputChannels * sizeof(float));
+        if (!preallocated_)
+            std::cerr << "[Warning] Could not preallocate the recording files; recording without\n";
+    }
+
+    // Every allocation happens here: the ring, staging and one block per side
+    inputChannels_ = inputChannels;
+    outputChannels_ = outputChannels;
+    size_t frames = static_cast<size_t>(std::max(options.bufferSeconds, 0.1) * sampleRate);
+    ring_.resize(frames * (inputChannels + outputChannels + 1));
+    header_.assign(kHeaderValues, 0.0f);
+    dryBatch_.assign(kBatchFrames * inputChannels, 0.0f);
+    wetBatch_.assign(kBatchFrames * outputChannels, 0.0f);
+    batchFrames_ = 0;
+    haveHeader_ = false;
+
+    gapFrames_ = 0;
+    framesWritten_.store(0, std::memory_order_relaxed);
+    droppedBlocks_.store(0, std::memory_order_relaxed);
+    droppedFrames_.store(0, std::memory_order_relaxed);
+    peakFill_.store(0, std::memory_order_relaxed);
+    writeFailed_.store(false, std::memory_order_relaxed);
+
+    quit_.store(false, std::memory_order_relaxed);
+    writer_ = std::thread(&SessionRecorder::writerLoop, this);
+    armed_.store(true);
+    return true;
+}
+
+bool SessionRecorder::stop()
+{
+    if (!writer_.joinable())
+        return true;
+
+    // Paired with push(): once pushing_ reads false after disarming, the
+    // audio thread has either finished its block or will see armed_ false
+    armed_.store(false);
+    while (pushing_.load())
+        std::this_thread::yield();
+
+    // Blocks dropped at the very end still count as session time
+    trailingGap_ = gapFrames_;
+    quit_.store(true, std::memory_order_release);
+    writer_.join();
+
+    bool ok = !writeFailed_.load(std::memory_order_relaxed);
+    ok = dryFile_.close() && ok;
+    ok = wetFile_.close() && ok;
+    return ok;
+}
+
+SessionRecorder::Status SessionRecorder::status() const
+{
+    Status status;
+    status.recording = recording();
+    status.dryPath = dryPath_;
+    status.wetPath = wetPath_;
+    status.framesWritten = framesWritten_.load(std::memory_order_relaxed);
+    status.droppedBlocks = droppedBlocks_.load(std::memory_order_relaxed);
+    status.droppedFrames = droppedFrames_.load(std::memory_order_relaxed);
+    status.peakFill = ring_.capacity() > 0
+                          ? static_cast<double>(peakFill_.load(std::memory_order_relaxed)) / ring_.capacity()
+                          : 0.0;
+    status.bufferBytes = (ring_.capacity() + dryBatch_.size() + wetBatch_.size()) * sizeof(float);
+    status.preallocated = preallocated_;
+    status.writeFailed = writeFailed_.load(std::memory_order_relaxed);
+    return status;
+}
+
+// ===================== Audio Thread =====================
+void SessionRecorder::push(const float *input, const float *output, unsigned long frameCount)
+{
+    pushing_.store(true);
+    if (!armed_.load())
+    {
+        pushing_.store(false);
+        return;
+    }
+
+    const size_t drySamples = input ? frameCount * static_cast<size_t>(inputChannels_) : 0;
+    const size_t wetSamples = frameCount * static_cast<size_t>(outputChannels_);
+    const size_t needed = kHeaderValues + drySamples + wetSamples;
+
+    // Only this thread fills the ring, so the space found here stays free
+    size_t used = ring_.capacity() - ring_.writable();
+    if (needed > ring_.writable())
+    {
+        gapFrames_ += frameCount;
+        droppedBlocks_.store(droppedBlocks_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        droppedFrames_.store(droppedFrames_.load(std::memory_order_relaxed) + frameCount, std::memory_order_relaxed);
+        pushing_.store(false);
+        return;
+    }
+
+    float header[kHeaderValues] = {
+        static_cast<float>(frameCount),
+        static_cast<float>(gapFrames_ & kPieceMask),
+        static_cast<float>(gapFrames_ >> 24),
+        static_cast<float>(input ? 0u : kSilentInput)};
+    ring_.write(header, kHeaderValues);
+    if (input)
+        ring_.write(input, drySamples);
+    ring_.write(output, wetSamples);
+    gapFrames_ = 0;
+
+    if (used + needed > peakFill_.load(std::memory_order_relaxed))
+        peakFill_.store(used + needed, std::memory_order_relaxed);
+    pushing_.store(false);
+}
+
+// ===================== Writer Thread =====================
+void SessionRecorder::writerLoop()
+{
+    while (!quit_.load(std::memory_order_acquire))
+    {
+        if (!drain())
+            std::this_thread::sleep_for(kPollInterval);
+    }
+
+    // The audio thread has stopped pushing; a block it was halfway through
+    // is complete by now, but give it a moment all the same
+    for (int i = 0; i < kFinalPolls && (drain() || haveHeader_); i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    appendSilence(trailingGap_);
+    flushBatch();
+}
+
+bool SessionRecorder::drain()
+{
+    bool any = false;
+    while (true)
+    {
+        if (!haveHeader_)
+        {
+            if (!ring_.read(header_.data(), kHeaderValues))
+                return any;
+            haveHeader_ = true;
+        }
+
+        // The header may arrive ahead of its samples
+        const unsigned long frames = static_cast<unsigned long>(header_[0]);
+        const uint64_t gap = static_cast<uint64_t>(header_[1]) | (static_cast<uint64_t>(header_[2]) << 24);
+        const bool silentInput = (static_cast<unsigned>(header_[3]) & kSilentInput) != 0;
+        const size_t drySamples = silentInput ? 0 : frames * static_cast<size_t>(inputChannels_);
+        const size_t wetSamples = frames * static_cast<size_t>(outputChannels_);
+        if (ring_.readable() < drySamples + wetSamples)
+            return any;
+
+        dryBlock_.assign(frames * static_cast<size_t>(inputChannels_), 0.0f);
+        wetBlock_.resize(wetSamples);
+        if (drySamples > 0)
+            ring_.read(dryBlock_.data(), drySamples);
+        ring_.read(wetBlock_.data(), wetSamples);
+        haveHeader_ = false;
+        any = true;
+
+        // Dropped blocks become silence, so both files keep the session's timeline
+        appendSilence(gap);
+        append(dryBlock_.data(), wetBlock_.data(), frames);
+    }
+}
+
+// Copies frames into the batches (silence for nullptr), writing each full batch
+bool SessionRecorder::append(const float *dry, const float *wet, unsigned long frames)
+{
+    bool ok = true;
+    while (frames > 0)
+    {
+        unsigned long n = std::min(frames, kBatchFrames - batchFrames_);
+        float *dryOut = dryBatch_.data() + batchFrames_ * inputChannels_;
+        float *wetOut = wetBatch_.data() + batchFrames_ * outputChannels_;
+        if (dry)
+            std::memcpy(dryOut, dry, n * inputChannels_ * sizeof(float));
+        else
+            std::memset(dryOut, 0, n * inputChannels_ * sizeof(float));
+        if (wet)
+            std::memcpy(wetOut, wet, n * outputChannels_ * sizeof(float));
+        else
+            std::memset(wetOut, 0, n * outputChannels_ * sizeof(float));
+
+        batchFrames_ += n;
+        frames -= n;
+        if (dry)
+            dry += n * inputChannels_;
+        if (wet)
+            wet += n * outputChannels_;
+        if (batchFrames_ == kBatchFrames)
+            ok = flushBatch() && ok;
+    }
+    return ok;
+}
+
+void SessionRecorder::appendSilence(uint64_t frames)
+{
+    while (frames > 0)
+    {
+        unsigned long n = static_cast<unsigned long>(std::min<uint64_t>(frames, kBatchFrames));
+        append(nullptr, nullptr, n);
+        frames -= n;
+    }
+}
+
+bool SessionRecorder::flushBatch()
+{
+    if (batchFrames_ == 0)
+        return true;
+
+    // After a failed write keep draining the ring, so the audio thread
+    // does not start dropping, but stop touching the disk
+    bool ok = !writeFailed_.load(std::memory_order_relaxed) && dryFile_.write(dryBatch_.data(), batchFrames_) &&
+              wetFile_.write(wetBatch_.data(), batchFrames_);
+    if (ok)
+        framesWritten_.store(framesWritten_.load(std::memory_order_relaxed) + batchFrames_, std::memory_order_relaxed);
+    else
+        writeFailed_.store(true, std::memory_order_relaxed);
+
+    batchFrames_ = 0;
+    return ok;
+}
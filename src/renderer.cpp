@@ -0,0 +1,176 @@
+#include "renderer.h"
+#include "eventscript.h"
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    void printRenderUsage()
+    {
+        std::cerr << "Usage: amply render <input.wav|input.raw> <output.wav|output.raw> [options]\n"
+                  << "  --block N      Frames per processing block (default 8192)\n"
+                  << "  --rate R       Sample rate of raw input (default 48000)\n"
+                  << "  --channels N   Channel count of raw input (default 1)\n"
+                  << "  --model FILE   Run a captured amp model (.nam, LSTM or GRU)\n"
+                  << "  --ir FILE      Convolve with a cabinet impulse response (WAV)\n"
+                  << "  --events FILE  Apply a script of timed parameter and bypass changes\n"
+                  << "Raw files are headerless little-endian 32-bit float, interleaved.\n";
+    }
+}
+
+// ===================== Argument Parsing =====================
+bool parseRenderArgs(int argc, char **argv, RenderOptions &options)
+{
+    options.rawFormat.sampleRate = 48000.0;
+    options.rawFormat.channels = 1;
+    options.rawFormat.encoding = SampleEncoding::Float32;
+
+    std::vector<std::string> positional;
+    for (int i = 0; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        try
+        {
+            if (arg == "--block" && hasValue)
+                options.blockFrames = std::stoul(argv[++i]);
+            else if (arg == "--rate" && hasValue)
+                options.rawFormat.sampleRate = std::stod(argv[++i]);
+            else if (arg == "--channels" && hasValue)
+                options.rawFormat.channels = std::stoi(argv[++i]);
+            else if (arg == "--model" && hasValue)
+                options.modelPath = argv[++i];
+            else if (arg == "--ir" && hasValue)
+                options.impulsePath = argv[++i];
+            else if (arg == "--events" && hasValue)
+                options.eventsPath = argv[++i];
+            else if (arg.rfind("--", 0) == 0)
+            {
+                std::cerr << "[Error] Unknown option: " << arg << "\n";
+                printRenderUsage();
+                return false;
+            }
+            else
+                positional.push_back(arg);
+        }
+        catch (...)
+        {
+            std::cerr << "[Error] Invalid value for " << arg << "\n";
+            printRenderUsage();
+            return false;
+        }
+    }
+
+    if (positional.size() != 2 || options.blockFrames == 0)
+    {
+        printRenderUsage();
+        return false;
+    }
+
+    options.inputPath = positional[0];
+    options.outputPath = positional[1];
+    return true;
+}
+
+// ===================== Rendering =====================
+bool renderFile(AudioEngine &engine, const RenderOptions &options)
+{
+    AudioFileReader reader;
+    bool opened = isWavPath(options.inputPath)
+                      ? reader.openWav(options.inputPath)
+                      : reader.openRaw(options.inputPath, options.rawFormat);
+    if (!opened)
+        return false;
+
+    const AudioFormat &format = reader.format();
+
+    // WAV output keeps the input's encoding; raw output is always float
+    AudioFormat outputFormat = format;
+    if (!isWavPath(options.outputPath))
+        outputFormat.encoding = SampleEncoding::Float32;
+
+    AudioFileWriter writer;
+    opened = isWavPath(options.outputPath)
+                 ? writer.openWav(options.outputPath, outputFormat)
+                 : writer.openRaw(options.outputPath, outputFormat);
+    if (!opened)
+        return false;
+
+    // The stream clock of a render is its position in the file
+    EventScript script;
+    if (!options.eventsPath.empty())
+    {
+        std::ifstream events(options.eventsPath);
+        if (!events)
+        {
+            std::cerr << "[Error] Could not open " << options.eventsPath << "\n";
+            return false;
+        }
+        if (!script.parse(events, engine.getEffects(), format.sampleRate))
+            return false;
+    }
+
+    engine.prepare(format.sampleRate, format.channels, format.channels, options.blockFrames, false);
+    if (!script.start(0, [&](double time, uint64_t &frame)
+                      { frame = static_cast<uint64_t>(std::llround(time * format.sampleRate)); return true; }))
+        return false;
+    auto schedule = [&](const ControlEvent *events, size_t count)
+    { return engine.schedule(events, count); };
+
+    std::vector<float> input(options.blockFrames * format.channels);
+    std::vector<float> output(input.size());
+
+    using Clock = std::chrono::steady_clock;
+    Clock::duration dspTime{};
+    uint64_t frames = 0;
+    auto start = Clock::now();
+
+    while (true)
+    {
+        unsigned long n = reader.read(input.data(), options.blockFrames);
+        if (n == 0)
+            break;
+
+        auto dspStart = Clock::now();
+        for (unsigned long done = 0; done < n;)
+        {
+            // Only as far as the events that fit the queue reach
+            script.feed(frames + n, schedule);
+            unsigned long part = n - done;
+            uint64_t next;
+            if (script.nextFrame(next) && next < frames + n)
+                part = next > frames + done ? static_cast<unsigned long>(next - frames - done) : 1;
+
+            engine.process(input.data() + done * format.channels, output.data() + done * format.channels, part);
+            done += part;
+        }
+        dspTime += Clock::now() - dspStart;
+
+        if (!writer.write(output.data(), n))
+            return false;
+
+        frames += n;
+    }
+
+    if (!writer.close())
+        return false;
+
+    double wall = std::chrono::duration<double>(Clock::now() - start).count();
+    double dsp = std::chrono::duration<double>(dspTime).count();
+    double audio = frames / format.sampleRate;
+
+    std::cout << "[Info] Rendered " << frames << " frames (" << audio << " s, "
+              << format.channels << " ch @ " << format.sampleRate << " Hz)\n";
+    std::cout << "   Wall time: " << wall << " s\n";
+    if (wall > 0.0)
+        std::cout << "   Realtime factor: " << audio / wall << "x";
+    if (dsp > 0.0)
+        std::cout << " (DSP only: " << audio / dsp << "x)";
+    std::cout << "\n";
+
+    return true;
+}
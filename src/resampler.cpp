@@ -0,0 +1,158 @@
+#include "resampler.h"
+#include "simd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    constexpr double kPi = 3.14159265358979323846;
+
+    // Kaiser window shape: about 90 dB of stopband rejection
+    constexpr double kKaiserBeta = 9.0;
+
+    // Passband edge as a share of the lower Nyquist frequency; the transition
+    // band of a kTaps filter fits between it and Nyquist
+    constexpr double kCutoff = 0.91;
+
+    // Zeroth-order modified Bessel function of the first kind
+    double besselI0(double x)
+    {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 50; k++)
+        {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+            if (term < sum * 1e-12)
+                break;
+        }
+        return sum;
+    }
+}
+
+// ===================== Configuration =====================
+void Resampler::prepare(int channels, double ratio, size_t maxOutputFrames, double maxDeviation)
+{
+    channels_ = channels;
+    nominal_ = ratio;
+    minStep_ = static_cast<uint64_t>(std::llround(ratio * (1.0 - maxDeviation) * kOne));
+    maxStep_ = static_cast<uint64_t>(std::llround(ratio * (1.0 + maxDeviation) * kOne));
+
+    // Downsampling moves the cutoff below the output's Nyquist frequency
+    const double cutoff = kCutoff * std::min(1.0, 1.0 / ratio);
+    const double center = kTaps / 2 - 1;
+    const double halfWidth = kTaps / 2;
+    const double windowScale = 1.0 / besselI0(kKaiserBeta);
+
+    phases_.resize((kPhases + 1) * kTaps);
+    differences_.resize(kPhases * kTaps);
+    std::vector<double> row(kTaps);
+    for (size_t p = 0; p <= kPhases; p++)
+    {
+        // Output point sits p / kPhases of a frame past tap `center`
+        double fraction = static_cast<double>(p) / kPhases;
+        double sum = 0.0;
+        for (size_t k = 0; k < kTaps; k++)
+        {
+            double x = static_cast<double>(k) - center - fraction;
+            double t = x / halfWidth;
+            double window = std::abs(t) < 1.0 ? besselI0(kKaiserBeta * std::sqrt(1.0 - t * t)) * windowScale : 0.0;
+            double sinc = x == 0.0 ? 1.0 : std::sin(kPi * cutoff * x) / (kPi * cutoff * x);
+            row[k] = cutoff * sinc * window;
+            sum += row[k];
+        }
+
+        // Unity gain at DC for every phase, so the ratio never modulates the level
+        float *dst = phases_.data() + p * kTaps;
+        for (size_t k = 0; k < kTaps; k++)
+            dst[k] = static_cast<float>(row[k] / sum);
+    }
+
+    for (size_t p = 0; p < kPhases; p++)
+    {
+        const float *a = phases_.data() + p * kTaps;
+        float *d = differences_.data() + p * kTaps;
+        for (size_t k = 0; k < kTaps; k++)
+            d[k] = a[k + kTaps] - a[k];
+    }
+
+    // After each call at most kTaps frames remain, then a full block arrives
+    size_t maxInput = static_cast<size_t>(std::ceil(maxOutputFrames * ratio * (1.0 + maxDeviation))) + 2;
+    historyStride_ = AlignedBuffer::alignedStride(kTaps + maxInput);
+    history_.resize(historyStride_ * channels);
+    coefficients_.resize(kTaps);
+
+    planes_.resize(channels);
+    reset();
+}
+
+// ===================== Audio Thread =====================
+void Resampler::reset()
+{
+    step_ = static_cast<uint64_t>(std::llround(nominal_ * kOne));
+    position_ = 0;
+
+    // Silence ahead of the first input so that output starts at input time zero
+    filled_ = kTaps / 2 - 1;
+    if (history_.size() > 0)
+        std::memset(history_.data(), 0, history_.size() * sizeof(float));
+}
+
+void Resampler::setRatio(double ratio)
+{
+    uint64_t step = ratio > 0.0 ? static_cast<uint64_t>(std::llround(ratio * kOne)) : minStep_;
+    step_ = std::min(std::max(step, minStep_), maxStep_);
+}
+
+size_t Resampler::inputNeeded(size_t outputFrames) const
+{
+    if (outputFrames == 0)
+        return 0;
+
+    uint64_t last = position_ + (outputFrames - 1) * step_;
+    size_t needed = static_cast<size_t>(last >> kFractionBits) + kTaps;
+    return needed > filled_ ? needed - filled_ : 0;
+}
+
+void Resampler::process(const float *input, float *output, size_t outputFrames)
+{
+    const SimdKernels &kernels = simd();
+
+    size_t count = inputNeeded(outputFrames);
+    for (int ch = 0; ch < channels_; ch++)
+        planes_[ch] = history_.data() + ch * historyStride_ + filled_;
+    kernels.deinterleave(input, channels_, planes_.data(), channels_, count);
+    filled_ += count;
+
+    const uint64_t fractionMask = kOne - 1;
+    const int interpolationBits = kFractionBits - kPhaseBits;
+    const float interpolationScale = 1.0f / static_cast<float>(uint64_t(1) << interpolationBits);
+    float *coefficients = coefficients_.data();
+
+    for (size_t i = 0; i < outputFrames; i++)
+    {
+        size_t base = static_cast<size_t>(position_ >> kFractionBits);
+        uint64_t fraction = position_ & fractionMask;
+        size_t phase = static_cast<size_t>(fraction >> interpolationBits);
+        float blend = static_cast<float>(fraction & ((uint64_t(1) << interpolationBits) - 1)) * interpolationScale;
+
+        // One set of coefficients serves every channel of the frame
+        std::memcpy(coefficients, phases_.data() + phase * kTaps, kTaps * sizeof(float));
+        kernels.mix(coefficients, differences_.data() + phase * kTaps, blend, kTaps);
+
+        for (int ch = 0; ch < channels_; ch++)
+            output[i * channels_ + ch] = kernels.dot(coefficients, history_.data() + ch * historyStride_ + base, kTaps);
+
+        position_ += step_;
+    }
+
+    // Shift out the frames no later output can reach
+    size_t consumed = static_cast<size_t>(position_ >> kFractionBits);
+    for (int ch = 0; ch < channels_; ch++)
+    {
+        float *row = history_.data() + ch * historyStride_;
+        std::memmove(row, row + consumed, (filled_ - consumed) * sizeof(float));
+    }
+    filled_ -= consumed;
+    position_ -= static_cast<uint64_t>(consumed) << kFractionBits;
+}
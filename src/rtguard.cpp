@@ -0,0 +1,401 @@
+#include "rtguard.h"
+
+#ifndef AMPLY_RT_GUARD
+
+// ===================== Disabled =====================
+void rtguard::enter() {}
+void rtguard::leave() {}
+uint64_t rtguard::violations() { return 0; }
+
+#else
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(__GLIBC__)
+#define AMPLY_RT_GUARD_LIBC 1
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <execinfo.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <io.h>
+#include <malloc.h>
+#endif
+
+// ===================== Violations =====================
+namespace
+{
+    // Reports after which violations are only counted
+    constexpr uint64_t kMaxReports = 20;
+
+    // Plain thread_locals without constructors: reading them never allocates
+    thread_local int depth = 0;
+    thread_local bool reporting = false;
+
+    std::atomic<uint64_t> count{0};
+
+    bool abortOnViolation()
+    {
+        static const bool abort = [] {
+            const char *mode = std::getenv("AMPLY_RT_GUARD");
+            return mode && std::strcmp(mode, "abort") == 0;
+        }();
+        return abort;
+    }
+
+    void writeError(const char *text)
+    {
+#ifdef _WIN32
+        _write(2, text, static_cast<unsigned>(std::strlen(text)));
+#else
+        ssize_t written = ::write(2, text, std::strlen(text));
+        (void)written;
+#endif
+    }
+
+    // Straight to the file descriptor: stdio may allocate or take a lock
+    void violation(const char *what)
+    {
+        reporting = true;
+
+        uint64_t n = count.fetch_add(1, std::memory_order_relaxed) + 1;
+        bool abort = abortOnViolation();
+        if (abort || n <= kMaxReports)
+        {
+            char line[160];
+            std::snprintf(line, sizeof(line), "[RT guard] %s on the audio thread (violation %llu)\n",
+                          what, static_cast<unsigned long long>(n));
+            writeError(line);
+#if defined(__GLIBC__) || defined(__APPLE__)
+            void *frames[32];
+            int depthFound = backtrace(frames, 32);
+            backtrace_symbols_fd(frames, depthFound, 2);
+#endif
+            if (n == kMaxReports && !abort)
+                writeError("[RT guard] Further violations are counted but not reported\n");
+        }
+
+        if (abort)
+            std::abort();
+
+        reporting = false;
+    }
+
+    inline void check(const char *what)
+    {
+        if (depth > 0 && !reporting)
+            violation(what);
+    }
+
+    // backtrace() loads its unwinder on first use; do that before any callback
+    struct WarmUp
+    {
+        WarmUp()
+        {
+#if defined(__GLIBC__) || defined(__APPLE__)
+            void *frame;
+            backtrace(&frame, 1);
+#endif
+            abortOnViolation();
+        }
+    } warmUp;
+}
+
+void rtguard::enter()
+{
+    depth++;
+}
+
+void rtguard::leave()
+{
+    depth--;
+}
+
+uint64_t rtguard::violations()
+{
+    return count.load(std::memory_order_relaxed);
+}
+
+// ===================== Raw Allocation =====================
+
+// The allocator underneath the hooks, so one allocation reports once
+#ifdef AMPLY_RT_GUARD_LIBC
+extern "C"
+{
+    void *__libc_malloc(size_t size);
+    void *__libc_calloc(size_t count, size_t size);
+    void *__libc_realloc(void *ptr, size_t size);
+    void *__libc_memalign(size_t alignment, size_t size);
+    void __libc_free(void *ptr);
+}
+#endif
+
+namespace
+{
+    void *rawMalloc(size_t size)
+    {
+#ifdef AMPLY_RT_GUARD_LIBC
+        return __libc_malloc(size ? size : 1);
+#else
+        return std::malloc(size ? size : 1);
+#endif
+    }
+
+    void rawFree(void *ptr)
+    {
+#ifdef AMPLY_RT_GUARD_LIBC
+        __libc_free(ptr);
+#else
+        std::free(ptr);
+#endif
+    }
+
+    void *rawAlignedMalloc(size_t size, size_t alignment)
+    {
+#if defined(AMPLY_RT_GUARD_LIBC)
+        return __libc_memalign(alignment, size ? size : 1);
+#elif defined(_WIN32)
+        return _aligned_malloc(size ? size : 1, alignment);
+#else
+        void *ptr = nullptr;
+        return posix_memalign(&ptr, alignment, size ? size : 1) == 0 ? ptr : nullptr;
+#endif
+    }
+
+    void rawAlignedFree(void *ptr)
+    {
+#if defined(_WIN32) && !defined(AMPLY_RT_GUARD_LIBC)
+        _aligned_free(ptr);
+#else
+        rawFree(ptr);
+#endif
+    }
+
+    void *newOrThrow(size_t size)
+    {
+        check("operator new");
+        if (void *ptr = rawMalloc(size))
+            return ptr;
+        throw std::bad_alloc();
+    }
+
+    void *newAlignedOrThrow(size_t size, std::align_val_t alignment)
+    {
+        check("operator new");
+        if (void *ptr = rawAlignedMalloc(size, static_cast<size_t>(alignment)))
+            return ptr;
+        throw std::bad_alloc();
+    }
+
+    void deleteChecked(void *ptr)
+    {
+        if (!ptr)
+            return;
+        check("operator delete");
+        rawFree(ptr);
+    }
+
+    void deleteAlignedChecked(void *ptr)
+    {
+        if (!ptr)
+            return;
+        check("operator delete");
+        rawAlignedFree(ptr);
+    }
+}
+
+// ===================== operator new / delete =====================
+void *operator new(std::size_t size) { return newOrThrow(size); }
+void *operator new[](std::size_t size) { return newOrThrow(size); }
+void *operator new(std::size_t size, std::align_val_t alignment) { return newAlignedOrThrow(size, alignment); }
+void *operator new[](std::size_t size, std::align_val_t alignment) { return newAlignedOrThrow(size, alignment); }
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    check("operator new");
+    return rawMalloc(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    check("operator new");
+    return rawMalloc(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    check("operator new");
+    return rawAlignedMalloc(size, static_cast<size_t>(alignment));
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    check("operator new");
+    return rawAlignedMalloc(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void *ptr) noexcept { deleteChecked(ptr); }
+void operator delete[](void *ptr) noexcept { deleteChecked(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { deleteChecked(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { deleteChecked(ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { deleteChecked(ptr); }
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept { deleteChecked(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept { deleteAlignedChecked(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept { deleteAlignedChecked(ptr); }
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept { deleteAlignedChecked(ptr); }
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept { deleteAlignedChecked(ptr); }
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t &) noexcept { deleteAlignedChecked(ptr); }
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t &) noexcept { deleteAlignedChecked(ptr); }
+
+// ===================== C Library Hooks =====================
+
+// glibc lets the program interpose its exported functions: the allocator
+// forwards to __libc_*, everything else to the next definition found by
+// dlsym. Other platforms only get the operator new/delete checks.
+#ifdef AMPLY_RT_GUARD_LIBC
+namespace
+{
+    // Resolved on first use; racing threads store the same address
+    void *next(std::atomic<void *> &slot, const char *name)
+    {
+        void *fn = slot.load(std::memory_order_relaxed);
+        if (!fn)
+        {
+            fn = dlsym(RTLD_NEXT, name);
+            slot.store(fn, std::memory_order_relaxed);
+        }
+        return fn;
+    }
+}
+
+// Calls the real name(...) after the check
+#define AMPLY_RT_NEXT(name, ...)                               \
+    static std::atomic<void *> real_##name{nullptr};           \
+    return reinterpret_cast<decltype(&::name)>(next(real_##name, #name))(__VA_ARGS__)
+
+extern "C"
+{
+    void *malloc(size_t size) noexcept
+    {
+        check("malloc");
+        return __libc_malloc(size);
+    }
+
+    void *calloc(size_t count, size_t size) noexcept
+    {
+        check("calloc");
+        return __libc_calloc(count, size);
+    }
+
+    void *realloc(void *ptr, size_t size) noexcept
+    {
+        check("realloc");
+        return __libc_realloc(ptr, size);
+    }
+
+    // The aligned allocators, e.g. behind an AlignedBuffer or an Arena
+    int posix_memalign(void **ptr, size_t alignment, size_t size) noexcept
+    {
+        check("posix_memalign");
+        if (alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0)
+            return EINVAL;
+        void *allocated = __libc_memalign(alignment, size);
+        if (!allocated)
+            return ENOMEM;
+        *ptr = allocated;
+        return 0;
+    }
+
+    void *aligned_alloc(size_t alignment, size_t size) noexcept
+    {
+        check("aligned_alloc");
+        return __libc_memalign(alignment, size);
+    }
+
+    void *memalign(size_t alignment, size_t size) noexcept
+    {
+        check("memalign");
+        return __libc_memalign(alignment, size);
+    }
+
+    void free(void *ptr) noexcept
+    {
+        if (ptr)
+            check("free");
+        __libc_free(ptr);
+    }
+
+    int pthread_mutex_lock(pthread_mutex_t *mutex) noexcept
+    {
+        check("pthread_mutex_lock");
+        AMPLY_RT_NEXT(pthread_mutex_lock, mutex);
+    }
+
+    int pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex)
+    {
+        check("pthread_cond_wait");
+        AMPLY_RT_NEXT(pthread_cond_wait, cond, mutex);
+    }
+
+    int pthread_cond_timedwait(pthread_cond_t *cond, pthread_mutex_t *mutex, const struct timespec *abstime)
+    {
+        check("pthread_cond_timedwait");
+        AMPLY_RT_NEXT(pthread_cond_timedwait, cond, mutex, abstime);
+    }
+
+    int nanosleep(const struct timespec *duration, struct timespec *remaining)
+    {
+        check("nanosleep");
+        AMPLY_RT_NEXT(nanosleep, duration, remaining);
+    }
+
+    int clock_nanosleep(clockid_t clock, int flags, const struct timespec *duration, struct timespec *remaining)
+    {
+        check("clock_nanosleep");
+        AMPLY_RT_NEXT(clock_nanosleep, clock, flags, duration, remaining);
+    }
+
+    int usleep(useconds_t microseconds)
+    {
+        check("usleep");
+        AMPLY_RT_NEXT(usleep, microseconds);
+    }
+
+    ssize_t read(int fd, void *buffer, size_t count)
+    {
+        check("read");
+        AMPLY_RT_NEXT(read, fd, buffer, count);
+    }
+
+    ssize_t write(int fd, const void *buffer, size_t count)
+    {
+        check("write");
+        AMPLY_RT_NEXT(write, fd, buffer, count);
+    }
+
+    size_t fwrite(const void *buffer, size_t size, size_t count, FILE *stream)
+    {
+        check("fwrite");
+        AMPLY_RT_NEXT(fwrite, buffer, size, count, stream);
+    }
+
+    int fflush(FILE *stream)
+    {
+        check("fflush");
+        AMPLY_RT_NEXT(fflush, stream);
+    }
+}
+
+#undef AMPLY_RT_NEXT
+#endif
+
+#endif
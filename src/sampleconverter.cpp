@@ -0,0 +1,67 @@
+#include "sampleconverter.h"
+
+// ===================== Setup =====================
+void SampleConverter::prepare(SampleEncoding encoding, int channels, unsigned long maxFrames, bool dither)
+{
+    encoding_ = encoding;
+    channels_ = channels;
+    maxFrames_ = maxFrames;
+    frameBytes_ = static_cast<size_t>(bytesPerSample(encoding)) * channels;
+    dither_ = dither;
+    scratch_.resize(encoding == SampleEncoding::Float32 ? 0 : static_cast<size_t>(maxFrames) * channels);
+
+    // Distinct seeds, so the lanes start out of step with each other
+    uint32_t seed = 0x2545f491u;
+    for (uint32_t &state : ditherState_)
+    {
+        seed = seed * kDitherMultiplier + kDitherIncrement;
+        state = seed;
+    }
+}
+
+// ===================== Conversion =====================
+const float *SampleConverter::read(const void *device, unsigned long frames)
+{
+    size_t count = static_cast<size_t>(frames) * channels_;
+    float *out = scratch_.data();
+    switch (encoding_)
+    {
+    case SampleEncoding::Int16:
+        kernels_.int16ToFloat(static_cast<const int16_t *>(device), out, count);
+        return out;
+    case SampleEncoding::Int24:
+        kernels_.int24ToFloat(static_cast<const uint8_t *>(device), out, count);
+        return out;
+    case SampleEncoding::Int32:
+        kernels_.int32ToFloat(static_cast<const int32_t *>(device), out, count);
+        return out;
+    case SampleEncoding::Float32:
+        break;
+    }
+    return static_cast<const float *>(device);
+}
+
+float *SampleConverter::target(void *device)
+{
+    return encoding_ == SampleEncoding::Float32 ? static_cast<float *>(device) : scratch_.data();
+}
+
+void SampleConverter::write(void *device, unsigned long frames)
+{
+    size_t count = static_cast<size_t>(frames) * channels_;
+    uint32_t *dither = dither_ ? ditherState_ : nullptr;
+    switch (encoding_)
+    {
+    case SampleEncoding::Int16:
+        kernels_.floatToInt16(scratch_.data(), static_cast<int16_t *>(device), count, dither);
+        break;
+    case SampleEncoding::Int24:
+        kernels_.floatToInt24(scratch_.data(), static_cast<uint8_t *>(device), count, dither);
+        break;
+    case SampleEncoding::Int32:
+        kernels_.floatToInt32(scratch_.data(), static_cast<int32_t *>(device), count);
+        break;
+    case SampleEncoding::Float32:
+        break;
+    }
+}
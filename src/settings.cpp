@@ -0,0 +1,126 @@
+#include "settings.h"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// ===================== File Location =====================
+std::string Settings::defaultPath()
+{
+    if (const char *path = std::getenv("AMPLY_SETTINGS"))
+        return path;
+
+#ifdef _WIN32
+    if (const char *appData = std::getenv("APPDATA"))
+        return std::string(appData) + "\\amply.conf";
+#else
+    if (const char *home = std::getenv("HOME"))
+        return std::string(home) + "/.amply";
+#endif
+
+    return "amply.conf";
+}
+
+// ===================== Load / Save =====================
+bool Settings::load(const std::string &path)
+{
+    values_.clear();
+
+    std::ifstream file(path);
+    if (!file)
+        return false;
+
+    auto trim = [](const std::string &s)
+    {
+        size_t begin = s.find_first_not_of(" \t\r");
+        size_t end = s.find_last_not_of(" \t\r");
+        return begin == std::string::npos ? std::string() : s.substr(begin, end - begin + 1);
+    };
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        line = trim(line);
+        size_t equals = line.find('=');
+        if (line.empty() || line[0] == '#' || equals == std::string::npos)
+            continue;
+
+        values_[trim(line.substr(0, equals))] = trim(line.substr(equals + 1));
+    }
+
+    return true;
+}
+
+bool Settings::save(const std::string &path) const
+{
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (!file)
+    {
+        std::cerr << "[Error] Could not write settings to " << path << "\n";
+        return false;
+    }
+
+    file << "# Amply settings\n";
+    for (const auto &[key, value] : values_)
+        file << key << " = " << value << "\n";
+
+    return static_cast<bool>(file);
+}
+
+// ===================== Values =====================
+std::string Settings::get(const std::string &key, const std::string &fallback) const
+{
+    auto it = values_.find(key);
+    return it == values_.end() ? fallback : it->second;
+}
+
+double Settings::getDouble(const std::string &key, double fallback) const
+{
+    auto it = values_.find(key);
+    if (it == values_.end())
+        return fallback;
+
+    try
+    {
+        return std::stod(it->second);
+    }
+    catch (...)
+    {
+        return fallback;
+    }
+}
+
+void Settings::set(const std::string &key, double value)
+{
+    std::ostringstream text;
+    text.precision(10);
+    text << value;
+    values_[key] = text.str();
+}
+
+std::vector<std::string> Settings::keys(const std::string &prefix) const
+{
+    std::vector<std::string> result;
+    for (auto it = values_.lower_bound(prefix);
+         it != values_.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it)
+        result.push_back(it->first);
+    return result;
+}
+
+void Settings::removePrefix(const std::string &prefix)
+{
+    auto it = values_.lower_bound(prefix);
+    while (it != values_.end() && it->first.compare(0, prefix.size(), prefix) == 0)
+        it = values_.erase(it);
+}
+
+std::string Settings::keyPart(std::string text)
+{
+    // Keys end at the first '=' and are trimmed, so keep both out of the way
+    for (char &c : text)
+    {
+        if (c == '=' || c == '#' || c == ' ' || c == '\t')
+            c = '_';
+    }
+    return text;
+}
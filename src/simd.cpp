@@ -0,0 +1,315 @@
+#include "simd.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+// ===================== Scalar Kernels =====================
+namespace
+{
+    void multiplyScalar(float *data, float gain, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+            data[i] *= gain;
+    }
+
+    void multiplyRampScalar(float *data, const float *ramp, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+            data[i] *= ramp[i];
+    }
+
+    void clampScalar(float *data, float lo, float hi, size_t count)
+    {
+        // Same operand order as minps/maxps so NaN resolves identically
+        for (size_t i = 0; i < count; i++)
+        {
+            float v = data[i] < hi ? data[i] : hi;
+            data[i] = v > lo ? v : lo;
+        }
+    }
+
+    void mixScalar(float *dst, const float *src, float gain, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+            dst[i] += src[i] * gain;
+    }
+
+    float dotScalar(const float *a, const float *b, size_t count)
+    {
+        float sums[kDotLanes] = {};
+        return finishDot(sums, a, b, 0, count);
+    }
+
+    float peakScalar(const float *data, size_t count)
+    {
+        return finishPeak(nullptr, 0, data, 0, count);
+    }
+
+    void matrixColumnsScalar(float *acc, const float *bias, const float *w, size_t stride,
+                             const float *a, size_t aCount, const float *b, size_t bCount)
+    {
+        for (size_t row = 0; row < stride; row += kColumnLanes)
+        {
+            float sums[kColumnLanes];
+            for (size_t r = 0; r < kColumnLanes; r++)
+                sums[r] = bias[row + r];
+
+            const float *column = w + row;
+            for (size_t j = 0; j < aCount; j++, column += stride)
+            {
+                for (size_t r = 0; r < kColumnLanes; r++)
+                    sums[r] += column[r] * a[j];
+            }
+            for (size_t j = 0; j < bCount; j++, column += stride)
+            {
+                for (size_t r = 0; r < kColumnLanes; r++)
+                    sums[r] += column[r] * b[j];
+            }
+
+            for (size_t r = 0; r < kColumnLanes; r++)
+                acc[row + r] = sums[r];
+        }
+    }
+
+    // TPDF noise in LSBs from one generator, in (-1, 1)
+    float ditherNoise(uint32_t &state)
+    {
+        uint32_t first = state * kDitherMultiplier + kDitherIncrement;
+        state = first * kDitherMultiplier + kDitherIncrement;
+        int32_t sum = static_cast<int32_t>((first >> 16) + (state >> 16)) - 65535;
+        return static_cast<float>(sum) * (1.0f / 65536.0f);
+    }
+
+    // Scaled, dithered when asked, then saturated in the same order as the
+    // vector kernels: min before max, so NaN ends up at hi
+    float quantize(float x, float scale, float lo, float hi, uint32_t *dither, size_t i)
+    {
+        float v = x * scale;
+        if (dither)
+            v += ditherNoise(dither[i % kDitherLanes]);
+        v = v < hi ? v : hi;
+        return v > lo ? v : lo;
+    }
+}
+
+// ===================== Sample Conversion =====================
+void scalarInt16ToFloat(const int16_t *in, float *out, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        out[i] = static_cast<float>(in[i]) * (1.0f / 32768.0f);
+}
+
+void scalarInt24ToFloat(const uint8_t *in, float *out, size_t count)
+{
+    for (size_t i = 0; i < count; i++, in += 3)
+    {
+        int32_t v = static_cast<int32_t>((static_cast<uint32_t>(in[0]) << 8) | (static_cast<uint32_t>(in[1]) << 16) |
+                                         (static_cast<uint32_t>(in[2]) << 24)) >> 8;
+        out[i] = static_cast<float>(v) * (1.0f / 8388608.0f);
+    }
+}
+
+void scalarInt32ToFloat(const int32_t *in, float *out, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        out[i] = static_cast<float>(in[i]) * (1.0f / 2147483648.0f);
+}
+
+// lrint rounds to nearest even, as the vector conversions do
+void scalarFloatToInt16(const float *in, int16_t *out, size_t count, uint32_t *dither)
+{
+    for (size_t i = 0; i < count; i++)
+        out[i] = static_cast<int16_t>(std::lrint(quantize(in[i], 32768.0f, -32768.0f, 32767.0f, dither, i)));
+}
+
+void scalarFloatToInt24(const float *in, uint8_t *out, size_t count, uint32_t *dither)
+{
+    for (size_t i = 0; i < count; i++, out += 3)
+    {
+        long v = std::lrint(quantize(in[i], 8388608.0f, -8388608.0f, 8388607.0f, dither, i));
+        out[0] = static_cast<uint8_t>(v);
+        out[1] = static_cast<uint8_t>(v >> 8);
+        out[2] = static_cast<uint8_t>(v >> 16);
+    }
+}
+
+void scalarFloatToInt32(const float *in, int32_t *out, size_t count)
+{
+    // 2^31 - 128 is the largest float below 2^31
+    for (size_t i = 0; i < count; i++)
+        out[i] = static_cast<int32_t>(std::lrint(quantize(in[i], 2147483648.0f, -2147483648.0f, 2147483520.0f, nullptr, i)));
+}
+
+float finishDot(float *sums, const float *a, const float *b, size_t from, size_t count)
+{
+    for (size_t i = from; i < count; i++)
+        sums[i % kDotLanes] += a[i] * b[i];
+
+    for (size_t width = kDotLanes / 2; width > 0; width /= 2)
+    {
+        for (size_t i = 0; i < width; i++)
+            sums[i] += sums[i + width];
+    }
+    return sums[0];
+}
+
+float finishPeak(const float *lanes, size_t laneCount, const float *data, size_t from, size_t count)
+{
+    // A NaN never compares greater, so it cannot become the peak
+    float peak = 0.0f;
+    for (size_t i = 0; i < laneCount; i++)
+        peak = lanes[i] > peak ? lanes[i] : peak;
+    for (size_t i = from; i < count; i++)
+    {
+        float v = data[i] < 0.0f ? -data[i] : data[i];
+        peak = v > peak ? v : peak;
+    }
+    return peak;
+}
+
+void scalarDeinterleave(const float *in, int stride, float *const *out, int channels, size_t frames)
+{
+    for (int ch = 0; ch < channels; ch++)
+    {
+        float *dst = out[ch];
+        const float *src = in + ch;
+        for (size_t i = 0; i < frames; i++)
+            dst[i] = src[i * stride];
+    }
+}
+
+void scalarInterleave(const float *const *in, int channels, float *out, int stride, size_t frames)
+{
+    for (int ch = 0; ch < channels; ch++)
+    {
+        const float *src = in[ch];
+        float *dst = out + ch;
+        for (size_t i = 0; i < frames; i++)
+            dst[i * stride] = src[i];
+    }
+}
+
+const SimdKernels *scalarKernels()
+{
+    static const SimdKernels kernels = {
+        "scalar",
+        multiplyScalar,
+        multiplyRampScalar,
+        clampScalar,
+        mixScalar,
+        dotScalar,
+        peakScalar,
+        matrixColumnsScalar,
+        scalarDeinterleave,
+        scalarInterleave,
+        scalarInt16ToFloat,
+        scalarInt24ToFloat,
+        scalarInt32ToFloat,
+        scalarFloatToInt16,
+        scalarFloatToInt24,
+        scalarFloatToInt32};
+    return &kernels;
+}
+
+// ===================== CPU Detection =====================
+namespace
+{
+    enum class CpuFeature
+    {
+        SSE2,
+        AVX2,
+        AVX512F
+    };
+
+    bool cpuSupports(CpuFeature feature)
+    {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        int info[4];
+        __cpuid(info, 0);
+        int maxLeaf = info[0];
+
+        __cpuid(info, 1);
+        bool sse2 = (info[3] & (1 << 26)) != 0;
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        if (feature == CpuFeature::SSE2)
+            return sse2;
+        if (!osxsave || maxLeaf < 7)
+            return false;
+
+        // The OS must save the wider registers on context switch
+        unsigned long long xcr0 = _xgetbv(0);
+        __cpuidex(info, 7, 0);
+        if (feature == CpuFeature::AVX2)
+            return (xcr0 & 0x6) == 0x6 && (info[1] & (1 << 5)) != 0;
+        return (xcr0 & 0xE6) == 0xE6 && (info[1] & (1 << 16)) != 0;
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+        // Also checks that the OS has enabled the register state
+        __builtin_cpu_init();
+        switch (feature)
+        {
+        case CpuFeature::SSE2:
+            return __builtin_cpu_supports("sse2");
+        case CpuFeature::AVX2:
+            return __builtin_cpu_supports("avx2");
+        case CpuFeature::AVX512F:
+            return __builtin_cpu_supports("avx512f");
+        }
+        return false;
+#else
+        (void)feature;
+        return false;
+#endif
+    }
+
+    const SimdKernels *selectKernels()
+    {
+        auto candidates = availableSimdKernels();
+        const SimdKernels *best = candidates.back();
+
+        const char *forced = std::getenv("AMPLY_SIMD");
+        if (forced && *forced)
+        {
+            for (const SimdKernels *k : candidates)
+            {
+                if (std::strcmp(k->name, forced) == 0)
+                    return k;
+            }
+            std::cerr << "[Warning] AMPLY_SIMD=" << forced << " is not available; using " << best->name << "\n";
+        }
+
+        return best;
+    }
+}
+
+// ===================== Dispatch =====================
+std::vector<const SimdKernels *> availableSimdKernels()
+{
+    // Ordered from slowest to fastest
+    std::vector<const SimdKernels *> result = {scalarKernels()};
+
+    if (sse2Kernels() && cpuSupports(CpuFeature::SSE2))
+        result.push_back(sse2Kernels());
+    if (avx2Kernels() && cpuSupports(CpuFeature::AVX2))
+        result.push_back(avx2Kernels());
+    if (avx512Kernels() && cpuSupports(CpuFeature::AVX512F))
+        result.push_back(avx512Kernels());
+
+    // NEON is part of the baseline wherever it is compiled in
+    if (neonKernels())
+        result.push_back(neonKernels());
+
+    return result;
+}
+
+const SimdKernels &simd()
+{
+    static const SimdKernels *kernels = selectKernels();
+    return *kernels;
+}
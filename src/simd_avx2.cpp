@@ -0,0 +1,363 @@
+#include "simd.h"
+
+// Built with AVX2 enabled. Only intrinsics and plain loops are used here:
+// instantiating shared inline/template code in this file could leak AVX
+// instructions into copies used on CPUs without it.
+#if defined(AMPLY_SIMD_X86)
+#include <immintrin.h>
+
+namespace
+{
+    void multiplyAvx2(float *data, float gain, size_t count)
+    {
+        const __m256 g = _mm256_set1_ps(gain);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(data + i, _mm256_mul_ps(_mm256_loadu_ps(data + i), g));
+        for (; i < count; i++)
+            data[i] *= gain;
+    }
+
+    void multiplyRampAvx2(float *data, const float *ramp, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(data + i, _mm256_mul_ps(_mm256_loadu_ps(data + i), _mm256_loadu_ps(ramp + i)));
+        for (; i < count; i++)
+            data[i] *= ramp[i];
+    }
+
+    void clampAvx2(float *data, float lo, float hi, size_t count)
+    {
+        const __m256 l = _mm256_set1_ps(lo), h = _mm256_set1_ps(hi);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(data + i, _mm256_max_ps(_mm256_min_ps(_mm256_loadu_ps(data + i), h), l));
+        for (; i < count; i++)
+        {
+            float v = data[i] < hi ? data[i] : hi;
+            data[i] = v > lo ? v : lo;
+        }
+    }
+
+    void mixAvx2(float *dst, const float *src, float gain, size_t count)
+    {
+        // Separate multiply and add (no FMA) to match the scalar rounding
+        const __m256 g = _mm256_set1_ps(gain);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(_mm256_loadu_ps(src + i), g)));
+        for (; i < count; i++)
+            dst[i] += src[i] * gain;
+    }
+
+    float dotAvx2(const float *a, const float *b, size_t count)
+    {
+        __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps();
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            s0 = _mm256_add_ps(s0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+            s1 = _mm256_add_ps(s1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+        }
+
+        float sums[kDotLanes];
+        _mm256_storeu_ps(sums, s0);
+        _mm256_storeu_ps(sums + 8, s1);
+        return finishDot(sums, a, b, i, count);
+    }
+
+    float peakAvx2(const float *data, size_t count)
+    {
+        // maxps returns its second operand for NaN, keeping the running peak
+        const __m256 magnitude = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+        __m256 m0 = _mm256_setzero_ps(), m1 = _mm256_setzero_ps();
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            m0 = _mm256_max_ps(_mm256_and_ps(_mm256_loadu_ps(data + i), magnitude), m0);
+            m1 = _mm256_max_ps(_mm256_and_ps(_mm256_loadu_ps(data + i + 8), magnitude), m1);
+        }
+
+        float lanes[8];
+        _mm256_storeu_ps(lanes, _mm256_max_ps(m0, m1));
+        return finishPeak(lanes, 8, data, i, count);
+    }
+
+    // Two cache lines of rows per pass, each column's value broadcast once
+    void matrixColumnsAvx2(float *acc, const float *bias, const float *w, size_t stride,
+                           const float *a, size_t aCount, const float *b, size_t bCount)
+    {
+        size_t row = 0;
+        for (; row + 2 * kColumnLanes <= stride; row += 2 * kColumnLanes)
+        {
+            __m256 s0 = _mm256_loadu_ps(bias + row), s1 = _mm256_loadu_ps(bias + row + 8);
+            __m256 s2 = _mm256_loadu_ps(bias + row + 16), s3 = _mm256_loadu_ps(bias + row + 24);
+            const float *column = w + row;
+            for (int part = 0; part < 2; part++)
+            {
+                const float *x = part ? b : a;
+                const size_t count = part ? bCount : aCount;
+                for (size_t j = 0; j < count; j++, column += stride)
+                {
+                    const __m256 v = _mm256_set1_ps(x[j]);
+                    s0 = _mm256_add_ps(s0, _mm256_mul_ps(_mm256_loadu_ps(column), v));
+                    s1 = _mm256_add_ps(s1, _mm256_mul_ps(_mm256_loadu_ps(column + 8), v));
+                    s2 = _mm256_add_ps(s2, _mm256_mul_ps(_mm256_loadu_ps(column + 16), v));
+                    s3 = _mm256_add_ps(s3, _mm256_mul_ps(_mm256_loadu_ps(column + 24), v));
+                }
+            }
+            _mm256_storeu_ps(acc + row, s0);
+            _mm256_storeu_ps(acc + row + 8, s1);
+            _mm256_storeu_ps(acc + row + 16, s2);
+            _mm256_storeu_ps(acc + row + 24, s3);
+        }
+        if (row < stride)
+        {
+            __m256 s0 = _mm256_loadu_ps(bias + row), s1 = _mm256_loadu_ps(bias + row + 8);
+            const float *column = w + row;
+            for (int part = 0; part < 2; part++)
+            {
+                const float *x = part ? b : a;
+                const size_t count = part ? bCount : aCount;
+                for (size_t j = 0; j < count; j++, column += stride)
+                {
+                    const __m256 v = _mm256_set1_ps(x[j]);
+                    s0 = _mm256_add_ps(s0, _mm256_mul_ps(_mm256_loadu_ps(column), v));
+                    s1 = _mm256_add_ps(s1, _mm256_mul_ps(_mm256_loadu_ps(column + 8), v));
+                }
+            }
+            _mm256_storeu_ps(acc + row, s0);
+            _mm256_storeu_ps(acc + row + 8, s1);
+        }
+    }
+
+    void deinterleaveAvx2(const float *in, int stride, float *const *out, int channels, size_t frames)
+    {
+        if (stride != 2 || channels != 2)
+            return scalarDeinterleave(in, stride, out, channels, frames);
+
+        float *left = out[0], *right = out[1];
+        size_t i = 0;
+        for (; i + 8 <= frames; i += 8)
+        {
+            __m256 a = _mm256_loadu_ps(in + 2 * i);
+            __m256 b = _mm256_loadu_ps(in + 2 * i + 8);
+
+            // Shuffles work within 128-bit lanes; fix the lane order afterwards
+            __m256 l = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            __m256 r = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            l = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(l), _MM_SHUFFLE(3, 1, 2, 0)));
+            r = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(r), _MM_SHUFFLE(3, 1, 2, 0)));
+
+            _mm256_storeu_ps(left + i, l);
+            _mm256_storeu_ps(right + i, r);
+        }
+        for (; i < frames; i++)
+        {
+            left[i] = in[2 * i];
+            right[i] = in[2 * i + 1];
+        }
+    }
+
+    void interleaveAvx2(const float *const *in, int channels, float *out, int stride, size_t frames)
+    {
+        if (stride != 2 || channels != 2)
+            return scalarInterleave(in, channels, out, stride, frames);
+
+        const float *left = in[0], *right = in[1];
+        size_t i = 0;
+        for (; i + 8 <= frames; i += 8)
+        {
+            __m256 l = _mm256_loadu_ps(left + i);
+            __m256 r = _mm256_loadu_ps(right + i);
+            __m256 lo = _mm256_unpacklo_ps(l, r);
+            __m256 hi = _mm256_unpackhi_ps(l, r);
+            _mm256_storeu_ps(out + 2 * i, _mm256_permute2f128_ps(lo, hi, 0x20));
+            _mm256_storeu_ps(out + 2 * i + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+        }
+        for (; i < frames; i++)
+        {
+            out[2 * i] = left[i];
+            out[2 * i + 1] = right[i];
+        }
+    }
+
+    void int16ToFloatAvx2(const int16_t *in, float *out, size_t count)
+    {
+        const __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i)));
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+        }
+        scalarInt16ToFloat(in + i, out + i, count - i);
+    }
+
+    void int24ToFloatAvx2(const uint8_t *in, float *out, size_t count)
+    {
+        // Four samples from each 16-byte load, their three bytes moved to the
+        // top of a 32-bit lane and shifted back down with their sign
+        const __m256i spread = _mm256_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11,
+                                                -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+        const __m256 scale = _mm256_set1_ps(1.0f / 8388608.0f);
+        size_t i = 0;
+        // The second load reads four bytes past the eight samples
+        for (; i + 10 <= count; i += 8)
+        {
+            const uint8_t *p = in + 3 * i;
+            __m256i bytes = _mm256_inserti128_si256(
+                _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))),
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 12)), 1);
+            __m256i v = _mm256_srai_epi32(_mm256_shuffle_epi8(bytes, spread), 8);
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+        }
+        scalarInt24ToFloat(in + 3 * i, out + i, count - i);
+    }
+
+    void int32ToFloatAvx2(const int32_t *in, float *out, size_t count)
+    {
+        const __m256 scale = _mm256_set1_ps(1.0f / 2147483648.0f);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+        }
+        scalarInt32ToFloat(in + i, out + i, count - i);
+    }
+
+    // Eight generators stepped twice, as in the scalar ditherNoise()
+    __m256 ditherAvx2(__m256i &state)
+    {
+        const __m256i multiplier = _mm256_set1_epi32(static_cast<int>(kDitherMultiplier));
+        const __m256i increment = _mm256_set1_epi32(static_cast<int>(kDitherIncrement));
+        __m256i first = _mm256_add_epi32(_mm256_mullo_epi32(state, multiplier), increment);
+        state = _mm256_add_epi32(_mm256_mullo_epi32(first, multiplier), increment);
+        __m256i sum = _mm256_sub_epi32(_mm256_add_epi32(_mm256_srli_epi32(first, 16), _mm256_srli_epi32(state, 16)),
+                                       _mm256_set1_epi32(65535));
+        return _mm256_mul_ps(_mm256_cvtepi32_ps(sum), _mm256_set1_ps(1.0f / 65536.0f));
+    }
+
+    __m256i quantizeAvx2(__m256 x, __m256 scale, __m256 lo, __m256 hi, __m256 noise)
+    {
+        return _mm256_cvtps_epi32(_mm256_max_ps(_mm256_min_ps(_mm256_add_ps(_mm256_mul_ps(x, scale), noise), hi), lo));
+    }
+
+    // Quantizes kDitherLanes samples from in into two vectors of eight
+    void quantizeGroupAvx2(const float *in, float scale, float lo, float hi, __m256i *state, uint32_t *dither,
+                           __m256i &first, __m256i &second)
+    {
+        const __m256 s = _mm256_set1_ps(scale), l = _mm256_set1_ps(lo), h = _mm256_set1_ps(hi);
+        first = quantizeAvx2(_mm256_loadu_ps(in), s, l, h, dither ? ditherAvx2(state[0]) : _mm256_setzero_ps());
+        second = quantizeAvx2(_mm256_loadu_ps(in + 8), s, l, h, dither ? ditherAvx2(state[1]) : _mm256_setzero_ps());
+    }
+
+    void loadDitherAvx2(__m256i *state, const uint32_t *dither)
+    {
+        if (!dither)
+            return;
+        state[0] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dither));
+        state[1] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dither + 8));
+    }
+
+    void storeDitherAvx2(const __m256i *state, uint32_t *dither)
+    {
+        if (!dither)
+            return;
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dither), state[0]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dither + 8), state[1]);
+    }
+
+    void floatToInt16Avx2(const float *in, int16_t *out, size_t count, uint32_t *dither)
+    {
+        __m256i state[2] = {};
+        loadDitherAvx2(state, dither);
+
+        size_t i = 0;
+        for (; i + kDitherLanes <= count; i += kDitherLanes)
+        {
+            __m256i first, second;
+            quantizeGroupAvx2(in + i, 32768.0f, -32768.0f, 32767.0f, state, dither, first, second);
+            // packs works within 128-bit lanes, leaving the quarters as 0, 2, 1, 3
+            __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(first, second), _MM_SHUFFLE(3, 1, 2, 0));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), packed);
+        }
+
+        storeDitherAvx2(state, dither);
+        scalarFloatToInt16(in + i, out + i, count - i, dither);
+    }
+
+    void floatToInt24Avx2(const float *in, uint8_t *out, size_t count, uint32_t *dither)
+    {
+        // The low three bytes of each 32-bit lane, packed into the bottom 12
+        // bytes of each 128-bit half
+        const __m256i pack = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+                                              0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+        __m256i state[2] = {};
+        loadDitherAvx2(state, dither);
+
+        size_t i = 0;
+        // Each 16-byte store writes four bytes past its 12; the next one
+        // overwrites them, and the last needs them to be inside the buffer
+        for (; i + kDitherLanes + 2 <= count; i += kDitherLanes)
+        {
+            __m256i first, second;
+            quantizeGroupAvx2(in + i, 8388608.0f, -8388608.0f, 8388607.0f, state, dither, first, second);
+            first = _mm256_shuffle_epi8(first, pack);
+            second = _mm256_shuffle_epi8(second, pack);
+
+            uint8_t *p = out + 3 * i;
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(p), _mm256_castsi256_si128(first));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(p + 12), _mm256_extracti128_si256(first, 1));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(p + 24), _mm256_castsi256_si128(second));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(p + 36), _mm256_extracti128_si256(second, 1));
+        }
+
+        storeDitherAvx2(state, dither);
+        scalarFloatToInt24(in + i, out + 3 * i, count - i, dither);
+    }
+
+    void floatToInt32Avx2(const float *in, int32_t *out, size_t count)
+    {
+        const __m256 scale = _mm256_set1_ps(2147483648.0f);
+        const __m256 lo = _mm256_set1_ps(-2147483648.0f), hi = _mm256_set1_ps(2147483520.0f);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i),
+                                quantizeAvx2(_mm256_loadu_ps(in + i), scale, lo, hi, _mm256_setzero_ps()));
+        scalarFloatToInt32(in + i, out + i, count - i);
+    }
+}
+
+const SimdKernels *avx2Kernels()
+{
+    static const SimdKernels kernels = {
+        "avx2",
+        multiplyAvx2,
+        multiplyRampAvx2,
+        clampAvx2,
+        mixAvx2,
+        dotAvx2,
+        peakAvx2,
+        matrixColumnsAvx2,
+        deinterleaveAvx2,
+        interleaveAvx2,
+        int16ToFloatAvx2,
+        int24ToFloatAvx2,
+        int32ToFloatAvx2,
+        floatToInt16Avx2,
+        floatToInt24Avx2,
+        floatToInt32Avx2};
+    return &kernels;
+}
+
+#else
+
+const SimdKernels *avx2Kernels()
+{
+    return nullptr;
+}
+
+#endif
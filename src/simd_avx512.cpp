@@ -0,0 +1,275 @@
+#include "simd.h"
+
+// Built with AVX-512F enabled. Only intrinsics and plain loops are used here:
+// instantiating shared inline/template code in this file could leak AVX-512
+// instructions into copies used on CPUs without it.
+#if defined(AMPLY_SIMD_X86)
+// GCC 12's AVX-512 intrinsics build their unused lanes from a vector
+// initialized with itself, which -Wmaybe-uninitialized reports wherever they
+// inline (GCC PR 105593); nothing here reads an undefined lane
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ == 12
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#include <immintrin.h>
+
+namespace
+{
+    void multiplyAvx512(float *data, float gain, size_t count)
+    {
+        const __m512 g = _mm512_set1_ps(gain);
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+            _mm512_storeu_ps(data + i, _mm512_mul_ps(_mm512_loadu_ps(data + i), g));
+        for (; i < count; i++)
+            data[i] *= gain;
+    }
+
+    void multiplyRampAvx512(float *data, const float *ramp, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+            _mm512_storeu_ps(data + i, _mm512_mul_ps(_mm512_loadu_ps(data + i), _mm512_loadu_ps(ramp + i)));
+        for (; i < count; i++)
+            data[i] *= ramp[i];
+    }
+
+    void clampAvx512(float *data, float lo, float hi, size_t count)
+    {
+        const __m512 l = _mm512_set1_ps(lo), h = _mm512_set1_ps(hi);
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+            _mm512_storeu_ps(data + i, _mm512_max_ps(_mm512_min_ps(_mm512_loadu_ps(data + i), h), l));
+        for (; i < count; i++)
+        {
+            float v = data[i] < hi ? data[i] : hi;
+            data[i] = v > lo ? v : lo;
+        }
+    }
+
+    void mixAvx512(float *dst, const float *src, float gain, size_t count)
+    {
+        // Separate multiply and add (no FMA) to match the scalar rounding
+        const __m512 g = _mm512_set1_ps(gain);
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+            _mm512_storeu_ps(dst + i, _mm512_add_ps(_mm512_loadu_ps(dst + i), _mm512_mul_ps(_mm512_loadu_ps(src + i), g)));
+        for (; i < count; i++)
+            dst[i] += src[i] * gain;
+    }
+
+    float dotAvx512(const float *a, const float *b, size_t count)
+    {
+        __m512 s = _mm512_setzero_ps();
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+            s = _mm512_add_ps(s, _mm512_mul_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i)));
+
+        float sums[kDotLanes];
+        _mm512_storeu_ps(sums, s);
+        return finishDot(sums, a, b, i, count);
+    }
+
+    float peakAvx512(const float *data, size_t count)
+    {
+        // maxps returns its second operand for NaN, keeping the running peak
+        __m512 m = _mm512_setzero_ps();
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+            m = _mm512_max_ps(_mm512_abs_ps(_mm512_loadu_ps(data + i)), m);
+
+        float lanes[16];
+        _mm512_storeu_ps(lanes, m);
+        return finishPeak(lanes, 16, data, i, count);
+    }
+
+    // Four cache lines of rows per pass, one register per line
+    void matrixColumnsAvx512(float *acc, const float *bias, const float *w, size_t stride,
+                             const float *a, size_t aCount, const float *b, size_t bCount)
+    {
+        size_t row = 0;
+        for (; row + 4 * kColumnLanes <= stride; row += 4 * kColumnLanes)
+        {
+            __m512 s0 = _mm512_loadu_ps(bias + row), s1 = _mm512_loadu_ps(bias + row + 16);
+            __m512 s2 = _mm512_loadu_ps(bias + row + 32), s3 = _mm512_loadu_ps(bias + row + 48);
+            const float *column = w + row;
+            for (int part = 0; part < 2; part++)
+            {
+                const float *x = part ? b : a;
+                const size_t count = part ? bCount : aCount;
+                for (size_t j = 0; j < count; j++, column += stride)
+                {
+                    const __m512 v = _mm512_set1_ps(x[j]);
+                    s0 = _mm512_add_ps(s0, _mm512_mul_ps(_mm512_loadu_ps(column), v));
+                    s1 = _mm512_add_ps(s1, _mm512_mul_ps(_mm512_loadu_ps(column + 16), v));
+                    s2 = _mm512_add_ps(s2, _mm512_mul_ps(_mm512_loadu_ps(column + 32), v));
+                    s3 = _mm512_add_ps(s3, _mm512_mul_ps(_mm512_loadu_ps(column + 48), v));
+                }
+            }
+            _mm512_storeu_ps(acc + row, s0);
+            _mm512_storeu_ps(acc + row + 16, s1);
+            _mm512_storeu_ps(acc + row + 32, s2);
+            _mm512_storeu_ps(acc + row + 48, s3);
+        }
+        for (; row < stride; row += kColumnLanes)
+        {
+            __m512 s0 = _mm512_loadu_ps(bias + row);
+            const float *column = w + row;
+            for (int part = 0; part < 2; part++)
+            {
+                const float *x = part ? b : a;
+                const size_t count = part ? bCount : aCount;
+                for (size_t j = 0; j < count; j++, column += stride)
+                    s0 = _mm512_add_ps(s0, _mm512_mul_ps(_mm512_loadu_ps(column), _mm512_set1_ps(x[j])));
+            }
+            _mm512_storeu_ps(acc + row, s0);
+        }
+    }
+
+    void deinterleaveAvx512(const float *in, int stride, float *const *out, int channels, size_t frames)
+    {
+        if (stride != 2 || channels != 2)
+            return scalarDeinterleave(in, stride, out, channels, frames);
+
+        const __m512i evens = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+        const __m512i odds = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+
+        float *left = out[0], *right = out[1];
+        size_t i = 0;
+        for (; i + 16 <= frames; i += 16)
+        {
+            __m512 a = _mm512_loadu_ps(in + 2 * i);
+            __m512 b = _mm512_loadu_ps(in + 2 * i + 16);
+            _mm512_storeu_ps(left + i, _mm512_permutex2var_ps(a, evens, b));
+            _mm512_storeu_ps(right + i, _mm512_permutex2var_ps(a, odds, b));
+        }
+        for (; i < frames; i++)
+        {
+            left[i] = in[2 * i];
+            right[i] = in[2 * i + 1];
+        }
+    }
+
+    void interleaveAvx512(const float *const *in, int channels, float *out, int stride, size_t frames)
+    {
+        if (stride != 2 || channels != 2)
+            return scalarInterleave(in, channels, out, stride, frames);
+
+        const __m512i first = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+        const __m512i second = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+
+        const float *left = in[0], *right = in[1];
+        size_t i = 0;
+        for (; i + 16 <= frames; i += 16)
+        {
+            __m512 l = _mm512_loadu_ps(left + i);
+            __m512 r = _mm512_loadu_ps(right + i);
+            _mm512_storeu_ps(out + 2 * i, _mm512_permutex2var_ps(l, first, r));
+            _mm512_storeu_ps(out + 2 * i + 16, _mm512_permutex2var_ps(l, second, r));
+        }
+        for (; i < frames; i++)
+        {
+            out[2 * i] = left[i];
+            out[2 * i + 1] = right[i];
+        }
+    }
+
+    void int16ToFloatAvx512(const int16_t *in, float *out, size_t count)
+    {
+        const __m512 scale = _mm512_set1_ps(1.0f / 32768.0f);
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m512i v = _mm512_cvtepi16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i)));
+            _mm512_storeu_ps(out + i, _mm512_mul_ps(_mm512_cvtepi32_ps(v), scale));
+        }
+        scalarInt16ToFloat(in + i, out + i, count - i);
+    }
+
+    void int32ToFloatAvx512(const int32_t *in, float *out, size_t count)
+    {
+        const __m512 scale = _mm512_set1_ps(1.0f / 2147483648.0f);
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+            _mm512_storeu_ps(out + i, _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_loadu_si512(in + i)), scale));
+        scalarInt32ToFloat(in + i, out + i, count - i);
+    }
+
+    // All sixteen generators stepped twice, as in the scalar ditherNoise()
+    __m512 ditherAvx512(__m512i &state)
+    {
+        const __m512i multiplier = _mm512_set1_epi32(static_cast<int>(kDitherMultiplier));
+        const __m512i increment = _mm512_set1_epi32(static_cast<int>(kDitherIncrement));
+        __m512i first = _mm512_add_epi32(_mm512_mullo_epi32(state, multiplier), increment);
+        state = _mm512_add_epi32(_mm512_mullo_epi32(first, multiplier), increment);
+        __m512i sum = _mm512_sub_epi32(_mm512_add_epi32(_mm512_srli_epi32(first, 16), _mm512_srli_epi32(state, 16)),
+                                       _mm512_set1_epi32(65535));
+        return _mm512_mul_ps(_mm512_cvtepi32_ps(sum), _mm512_set1_ps(1.0f / 65536.0f));
+    }
+
+    __m512i quantizeAvx512(__m512 x, __m512 scale, __m512 lo, __m512 hi, __m512 noise)
+    {
+        return _mm512_cvtps_epi32(_mm512_max_ps(_mm512_min_ps(_mm512_add_ps(_mm512_mul_ps(x, scale), noise), hi), lo));
+    }
+
+    void floatToInt16Avx512(const float *in, int16_t *out, size_t count, uint32_t *dither)
+    {
+        const __m512 scale = _mm512_set1_ps(32768.0f), lo = _mm512_set1_ps(-32768.0f), hi = _mm512_set1_ps(32767.0f);
+        __m512i state = dither ? _mm512_loadu_si512(dither) : _mm512_setzero_si512();
+
+        size_t i = 0;
+        for (; i + kDitherLanes <= count; i += kDitherLanes)
+        {
+            __m512i v = quantizeAvx512(_mm512_loadu_ps(in + i), scale, lo, hi,
+                                       dither ? ditherAvx512(state) : _mm512_setzero_ps());
+            // Already in range, so narrowing needs no saturation
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm512_cvtepi32_epi16(v));
+        }
+
+        if (dither)
+            _mm512_storeu_si512(dither, state);
+        scalarFloatToInt16(in + i, out + i, count - i, dither);
+    }
+
+    void floatToInt32Avx512(const float *in, int32_t *out, size_t count)
+    {
+        const __m512 scale = _mm512_set1_ps(2147483648.0f);
+        const __m512 lo = _mm512_set1_ps(-2147483648.0f), hi = _mm512_set1_ps(2147483520.0f);
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+            _mm512_storeu_si512(out + i, quantizeAvx512(_mm512_loadu_ps(in + i), scale, lo, hi, _mm512_setzero_ps()));
+        scalarFloatToInt32(in + i, out + i, count - i);
+    }
+}
+
+const SimdKernels *avx512Kernels()
+{
+    // AVX-512F has no byte shuffle of its own; every CPU with it runs the
+    // AVX2 kernels for packed 24-bit samples
+    static const SimdKernels kernels = {
+        "avx512",
+        multiplyAvx512,
+        multiplyRampAvx512,
+        clampAvx512,
+        mixAvx512,
+        dotAvx512,
+        peakAvx512,
+        matrixColumnsAvx512,
+        deinterleaveAvx512,
+        interleaveAvx512,
+        int16ToFloatAvx512,
+        avx2Kernels()->int24ToFloat,
+        int32ToFloatAvx512,
+        floatToInt16Avx512,
+        avx2Kernels()->floatToInt24,
+        floatToInt32Avx512};
+    return &kernels;
+}
+
+#else
+
+const SimdKernels *avx512Kernels()
+{
+    return nullptr;
+}
+
+#endif
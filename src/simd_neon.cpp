@@ -0,0 +1,312 @@
+#include "simd.h"
+
+// NEON kernels for ARM. Only intrinsics and plain loops are used here, to
+// match the other instruction-set files.
+#if defined(AMPLY_SIMD_NEON) && defined(__ARM_NEON)
+#include <arm_neon.h>
+
+namespace
+{
+    void multiplyNeon(float *data, float gain, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+            vst1q_f32(data + i, vmulq_n_f32(vld1q_f32(data + i), gain));
+        for (; i < count; i++)
+            data[i] *= gain;
+    }
+
+    void multiplyRampNeon(float *data, const float *ramp, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+            vst1q_f32(data + i, vmulq_f32(vld1q_f32(data + i), vld1q_f32(ramp + i)));
+        for (; i < count; i++)
+            data[i] *= ramp[i];
+    }
+
+    void clampNeon(float *data, float lo, float hi, size_t count)
+    {
+        // vminq/vmaxq propagate NaN, so select explicitly to match the scalar result
+        const float32x4_t l = vdupq_n_f32(lo), h = vdupq_n_f32(hi);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            float32x4_t x = vld1q_f32(data + i);
+            float32x4_t v = vbslq_f32(vcltq_f32(x, h), x, h);
+            vst1q_f32(data + i, vbslq_f32(vcgtq_f32(v, l), v, l));
+        }
+        for (; i < count; i++)
+        {
+            float v = data[i] < hi ? data[i] : hi;
+            data[i] = v > lo ? v : lo;
+        }
+    }
+
+    void mixNeon(float *dst, const float *src, float gain, size_t count)
+    {
+        // Separate multiply and add (no fused vfmaq) to match the scalar rounding
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+            vst1q_f32(dst + i, vaddq_f32(vld1q_f32(dst + i), vmulq_n_f32(vld1q_f32(src + i), gain)));
+        for (; i < count; i++)
+            dst[i] += src[i] * gain;
+    }
+
+    float dotNeon(const float *a, const float *b, size_t count)
+    {
+        // Separate multiply and add: vmlaq may be fused on AArch64
+        float32x4_t s0 = vdupq_n_f32(0.0f), s1 = s0, s2 = s0, s3 = s0;
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            s0 = vaddq_f32(s0, vmulq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+            s1 = vaddq_f32(s1, vmulq_f32(vld1q_f32(a + i + 4), vld1q_f32(b + i + 4)));
+            s2 = vaddq_f32(s2, vmulq_f32(vld1q_f32(a + i + 8), vld1q_f32(b + i + 8)));
+            s3 = vaddq_f32(s3, vmulq_f32(vld1q_f32(a + i + 12), vld1q_f32(b + i + 12)));
+        }
+
+        float sums[kDotLanes];
+        vst1q_f32(sums, s0);
+        vst1q_f32(sums + 4, s1);
+        vst1q_f32(sums + 8, s2);
+        vst1q_f32(sums + 12, s3);
+        return finishDot(sums, a, b, i, count);
+    }
+
+    float peakNeon(const float *data, size_t count)
+    {
+        // vmaxq propagates NaN, so select explicitly to skip it like the scalar loop
+        float32x4_t m0 = vdupq_n_f32(0.0f), m1 = m0;
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            float32x4_t a0 = vabsq_f32(vld1q_f32(data + i));
+            float32x4_t a1 = vabsq_f32(vld1q_f32(data + i + 4));
+            m0 = vbslq_f32(vcgtq_f32(a0, m0), a0, m0);
+            m1 = vbslq_f32(vcgtq_f32(a1, m1), a1, m1);
+        }
+
+        float lanes[8];
+        vst1q_f32(lanes, m0);
+        vst1q_f32(lanes + 4, m1);
+        return finishPeak(lanes, 8, data, i, count);
+    }
+
+    // A cache line of rows per pass, one register per four rows
+    void matrixColumnsNeon(float *acc, const float *bias, const float *w, size_t stride,
+                           const float *a, size_t aCount, const float *b, size_t bCount)
+    {
+        for (size_t row = 0; row < stride; row += kColumnLanes)
+        {
+            float32x4_t s0 = vld1q_f32(bias + row), s1 = vld1q_f32(bias + row + 4);
+            float32x4_t s2 = vld1q_f32(bias + row + 8), s3 = vld1q_f32(bias + row + 12);
+            const float *column = w + row;
+            for (int part = 0; part < 2; part++)
+            {
+                const float *x = part ? b : a;
+                const size_t count = part ? bCount : aCount;
+                for (size_t j = 0; j < count; j++, column += stride)
+                {
+                    const float32x4_t v = vdupq_n_f32(x[j]);
+                    s0 = vaddq_f32(s0, vmulq_f32(vld1q_f32(column), v));
+                    s1 = vaddq_f32(s1, vmulq_f32(vld1q_f32(column + 4), v));
+                    s2 = vaddq_f32(s2, vmulq_f32(vld1q_f32(column + 8), v));
+                    s3 = vaddq_f32(s3, vmulq_f32(vld1q_f32(column + 12), v));
+                }
+            }
+            vst1q_f32(acc + row, s0);
+            vst1q_f32(acc + row + 4, s1);
+            vst1q_f32(acc + row + 8, s2);
+            vst1q_f32(acc + row + 12, s3);
+        }
+    }
+
+    void deinterleaveNeon(const float *in, int stride, float *const *out, int channels, size_t frames)
+    {
+        if (stride != 2 || channels != 2)
+            return scalarDeinterleave(in, stride, out, channels, frames);
+
+        float *left = out[0], *right = out[1];
+        size_t i = 0;
+        for (; i + 4 <= frames; i += 4)
+        {
+            float32x4x2_t v = vld2q_f32(in + 2 * i);
+            vst1q_f32(left + i, v.val[0]);
+            vst1q_f32(right + i, v.val[1]);
+        }
+        for (; i < frames; i++)
+        {
+            left[i] = in[2 * i];
+            right[i] = in[2 * i + 1];
+        }
+    }
+
+    void interleaveNeon(const float *const *in, int channels, float *out, int stride, size_t frames)
+    {
+        if (stride != 2 || channels != 2)
+            return scalarInterleave(in, channels, out, stride, frames);
+
+        const float *left = in[0], *right = in[1];
+        size_t i = 0;
+        for (; i + 4 <= frames; i += 4)
+        {
+            float32x4x2_t v;
+            v.val[0] = vld1q_f32(left + i);
+            v.val[1] = vld1q_f32(right + i);
+            vst2q_f32(out + 2 * i, v);
+        }
+        for (; i < frames; i++)
+        {
+            out[2 * i] = left[i];
+            out[2 * i + 1] = right[i];
+        }
+    }
+
+    void int16ToFloatNeon(const int16_t *in, float *out, size_t count)
+    {
+        const float scale = 1.0f / 32768.0f;
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            int16x8_t v = vld1q_s16(in + i);
+            vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));
+            vst1q_f32(out + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale));
+        }
+        scalarInt16ToFloat(in + i, out + i, count - i);
+    }
+
+    void int24ToFloatNeon(const uint8_t *in, float *out, size_t count)
+    {
+        const float scale = 1.0f / 8388608.0f;
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            // De-interleaved into low, middle and high bytes; the high byte
+            // carries the sign
+            uint8x16x3_t b = vld3q_u8(in + 3 * i);
+            uint16x8_t low[2] = {vorrq_u16(vmovl_u8(vget_low_u8(b.val[0])), vshll_n_u8(vget_low_u8(b.val[1]), 8)),
+                                 vorrq_u16(vmovl_u8(vget_high_u8(b.val[0])), vshll_n_u8(vget_high_u8(b.val[1]), 8))};
+            int16x8_t high[2] = {vmovl_s8(vreinterpret_s8_u8(vget_low_u8(b.val[2]))),
+                                 vmovl_s8(vreinterpret_s8_u8(vget_high_u8(b.val[2])))};
+            for (int k = 0; k < 2; k++)
+            {
+                int32x4_t lo = vorrq_s32(vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(low[k]))),
+                                         vshlq_n_s32(vmovl_s16(vget_low_s16(high[k])), 16));
+                int32x4_t hi = vorrq_s32(vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(low[k]))),
+                                         vshlq_n_s32(vmovl_s16(vget_high_s16(high[k])), 16));
+                vst1q_f32(out + i + 8 * k, vmulq_n_f32(vcvtq_f32_s32(lo), scale));
+                vst1q_f32(out + i + 8 * k + 4, vmulq_n_f32(vcvtq_f32_s32(hi), scale));
+            }
+        }
+        scalarInt24ToFloat(in + 3 * i, out + i, count - i);
+    }
+
+    void int32ToFloatNeon(const int32_t *in, float *out, size_t count)
+    {
+        const float scale = 1.0f / 2147483648.0f;
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+            vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(in + i)), scale));
+        scalarInt32ToFloat(in + i, out + i, count - i);
+    }
+
+#if defined(__aarch64__)
+    // Four generators stepped twice, as in the scalar ditherNoise()
+    float32x4_t ditherNeon(uint32x4_t &state)
+    {
+        const uint32x4_t multiplier = vdupq_n_u32(kDitherMultiplier);
+        const uint32x4_t increment = vdupq_n_u32(kDitherIncrement);
+        uint32x4_t first = vmlaq_u32(increment, state, multiplier);
+        state = vmlaq_u32(increment, first, multiplier);
+        int32x4_t sum = vsubq_s32(vreinterpretq_s32_u32(vaddq_u32(vshrq_n_u32(first, 16), vshrq_n_u32(state, 16))),
+                                  vdupq_n_s32(65535));
+        return vmulq_n_f32(vcvtq_f32_s32(sum), 1.0f / 65536.0f);
+    }
+
+    // Selects rather than vminq/vmaxq so NaN saturates to hi like the scalar
+    // code; vcvtnq rounds to nearest even like lrint()
+    int32x4_t quantizeNeon(float32x4_t x, float scale, float32x4_t lo, float32x4_t hi, float32x4_t noise)
+    {
+        float32x4_t v = vaddq_f32(vmulq_n_f32(x, scale), noise);
+        v = vbslq_f32(vcltq_f32(v, hi), v, hi);
+        v = vbslq_f32(vcgtq_f32(v, lo), v, lo);
+        return vcvtnq_s32_f32(v);
+    }
+
+    void floatToInt16Neon(const float *in, int16_t *out, size_t count, uint32_t *dither)
+    {
+        const float32x4_t lo = vdupq_n_f32(-32768.0f), hi = vdupq_n_f32(32767.0f);
+        uint32x4_t state[4] = {};
+        if (dither)
+        {
+            for (int k = 0; k < 4; k++)
+                state[k] = vld1q_u32(dither + 4 * k);
+        }
+
+        size_t i = 0;
+        for (; i + kDitherLanes <= count; i += kDitherLanes)
+        {
+            int32x4_t v[4];
+            for (int k = 0; k < 4; k++)
+                v[k] = quantizeNeon(vld1q_f32(in + i + 4 * k), 32768.0f, lo, hi,
+                                    dither ? ditherNeon(state[k]) : vdupq_n_f32(0.0f));
+            // Already in range, so narrowing needs no saturation
+            vst1q_s16(out + i, vcombine_s16(vmovn_s32(v[0]), vmovn_s32(v[1])));
+            vst1q_s16(out + i + 8, vcombine_s16(vmovn_s32(v[2]), vmovn_s32(v[3])));
+        }
+
+        if (dither)
+        {
+            for (int k = 0; k < 4; k++)
+                vst1q_u32(dither + 4 * k, state[k]);
+        }
+        scalarFloatToInt16(in + i, out + i, count - i, dither);
+    }
+
+    void floatToInt32Neon(const float *in, int32_t *out, size_t count)
+    {
+        const float32x4_t lo = vdupq_n_f32(-2147483648.0f), hi = vdupq_n_f32(2147483520.0f);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+            vst1q_s32(out + i, quantizeNeon(vld1q_f32(in + i), 2147483648.0f, lo, hi, vdupq_n_f32(0.0f)));
+        scalarFloatToInt32(in + i, out + i, count - i);
+    }
+#else
+    // 32-bit ARM only converts toward zero; rounding like lrint() needs AArch64
+    const auto floatToInt16Neon = scalarFloatToInt16;
+    const auto floatToInt32Neon = scalarFloatToInt32;
+#endif
+}
+
+const SimdKernels *neonKernels()
+{
+    static const SimdKernels kernels = {
+        "neon",
+        multiplyNeon,
+        multiplyRampNeon,
+        clampNeon,
+        mixNeon,
+        dotNeon,
+        peakNeon,
+        matrixColumnsNeon,
+        deinterleaveNeon,
+        interleaveNeon,
+        int16ToFloatNeon,
+        int24ToFloatNeon,
+        int32ToFloatNeon,
+        floatToInt16Neon,
+        // Packing back into three-byte samples gains little over the scalar loop
+        scalarFloatToInt24,
+        floatToInt32Neon};
+    return &kernels;
+}
+
+#else
+
+const SimdKernels *neonKernels()
+{
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,282 @@
+#include "simd.h"
+
+// Built with SSE2 enabled. Only intrinsics and plain loops are used here:
+// instantiating shared inline/template code in this file could leak wider
+// instructions into copies used by the rest of the program.
+#if defined(AMPLY_SIMD_X86)
+#include <emmintrin.h>
+
+namespace
+{
+    void multiplySse2(float *data, float gain, size_t count)
+    {
+        const __m128 g = _mm_set1_ps(gain);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+            _mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), g));
+        for (; i < count; i++)
+            data[i] *= gain;
+    }
+
+    void multiplyRampSse2(float *data, const float *ramp, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+            _mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), _mm_loadu_ps(ramp + i)));
+        for (; i < count; i++)
+            data[i] *= ramp[i];
+    }
+
+    void clampSse2(float *data, float lo, float hi, size_t count)
+    {
+        const __m128 l = _mm_set1_ps(lo), h = _mm_set1_ps(hi);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+            _mm_storeu_ps(data + i, _mm_max_ps(_mm_min_ps(_mm_loadu_ps(data + i), h), l));
+        for (; i < count; i++)
+        {
+            float v = data[i] < hi ? data[i] : hi;
+            data[i] = v > lo ? v : lo;
+        }
+    }
+
+    void mixSse2(float *dst, const float *src, float gain, size_t count)
+    {
+        const __m128 g = _mm_set1_ps(gain);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+            _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), g)));
+        for (; i < count; i++)
+            dst[i] += src[i] * gain;
+    }
+
+    float dotSse2(const float *a, const float *b, size_t count)
+    {
+        __m128 s0 = _mm_setzero_ps(), s1 = _mm_setzero_ps(), s2 = _mm_setzero_ps(), s3 = _mm_setzero_ps();
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+            s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+            s2 = _mm_add_ps(s2, _mm_mul_ps(_mm_loadu_ps(a + i + 8), _mm_loadu_ps(b + i + 8)));
+            s3 = _mm_add_ps(s3, _mm_mul_ps(_mm_loadu_ps(a + i + 12), _mm_loadu_ps(b + i + 12)));
+        }
+
+        float sums[kDotLanes];
+        _mm_storeu_ps(sums, s0);
+        _mm_storeu_ps(sums + 4, s1);
+        _mm_storeu_ps(sums + 8, s2);
+        _mm_storeu_ps(sums + 12, s3);
+        return finishDot(sums, a, b, i, count);
+    }
+
+    float peakSse2(const float *data, size_t count)
+    {
+        // maxps returns its second operand for NaN, keeping the running peak
+        const __m128 magnitude = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+        __m128 m0 = _mm_setzero_ps(), m1 = _mm_setzero_ps();
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            m0 = _mm_max_ps(_mm_and_ps(_mm_loadu_ps(data + i), magnitude), m0);
+            m1 = _mm_max_ps(_mm_and_ps(_mm_loadu_ps(data + i + 4), magnitude), m1);
+        }
+
+        float lanes[4];
+        _mm_storeu_ps(lanes, _mm_max_ps(m0, m1));
+        return finishPeak(lanes, 4, data, i, count);
+    }
+
+    // A cache line of rows per pass, one register per four rows
+    void matrixColumnsSse2(float *acc, const float *bias, const float *w, size_t stride,
+                           const float *a, size_t aCount, const float *b, size_t bCount)
+    {
+        for (size_t row = 0; row < stride; row += kColumnLanes)
+        {
+            __m128 s0 = _mm_loadu_ps(bias + row), s1 = _mm_loadu_ps(bias + row + 4);
+            __m128 s2 = _mm_loadu_ps(bias + row + 8), s3 = _mm_loadu_ps(bias + row + 12);
+            const float *column = w + row;
+            for (int part = 0; part < 2; part++)
+            {
+                const float *x = part ? b : a;
+                const size_t count = part ? bCount : aCount;
+                for (size_t j = 0; j < count; j++, column += stride)
+                {
+                    const __m128 v = _mm_set1_ps(x[j]);
+                    s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(column), v));
+                    s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(column + 4), v));
+                    s2 = _mm_add_ps(s2, _mm_mul_ps(_mm_loadu_ps(column + 8), v));
+                    s3 = _mm_add_ps(s3, _mm_mul_ps(_mm_loadu_ps(column + 12), v));
+                }
+            }
+            _mm_storeu_ps(acc + row, s0);
+            _mm_storeu_ps(acc + row + 4, s1);
+            _mm_storeu_ps(acc + row + 8, s2);
+            _mm_storeu_ps(acc + row + 12, s3);
+        }
+    }
+
+    void deinterleaveSse2(const float *in, int stride, float *const *out, int channels, size_t frames)
+    {
+        if (stride != 2 || channels != 2)
+            return scalarDeinterleave(in, stride, out, channels, frames);
+
+        float *left = out[0], *right = out[1];
+        size_t i = 0;
+        for (; i + 4 <= frames; i += 4)
+        {
+            __m128 a = _mm_loadu_ps(in + 2 * i);
+            __m128 b = _mm_loadu_ps(in + 2 * i + 4);
+            _mm_storeu_ps(left + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+        }
+        for (; i < frames; i++)
+        {
+            left[i] = in[2 * i];
+            right[i] = in[2 * i + 1];
+        }
+    }
+
+    void interleaveSse2(const float *const *in, int channels, float *out, int stride, size_t frames)
+    {
+        if (stride != 2 || channels != 2)
+            return scalarInterleave(in, channels, out, stride, frames);
+
+        const float *left = in[0], *right = in[1];
+        size_t i = 0;
+        for (; i + 4 <= frames; i += 4)
+        {
+            __m128 l = _mm_loadu_ps(left + i);
+            __m128 r = _mm_loadu_ps(right + i);
+            _mm_storeu_ps(out + 2 * i, _mm_unpacklo_ps(l, r));
+            _mm_storeu_ps(out + 2 * i + 4, _mm_unpackhi_ps(l, r));
+        }
+        for (; i < frames; i++)
+        {
+            out[2 * i] = left[i];
+            out[2 * i + 1] = right[i];
+        }
+    }
+
+    void int16ToFloatSse2(const int16_t *in, float *out, size_t count)
+    {
+        const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            // Each sample doubled into a 32-bit lane, then shifted back down with its sign
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+            __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+            __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+            _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+            _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+        }
+        scalarInt16ToFloat(in + i, out + i, count - i);
+    }
+
+    void int32ToFloatSse2(const int32_t *in, float *out, size_t count)
+    {
+        const __m128 scale = _mm_set1_ps(1.0f / 2147483648.0f);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+            _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i))), scale));
+        scalarInt32ToFloat(in + i, out + i, count - i);
+    }
+
+    // SSE2 has no 32-bit multiply; the low halves of two 64-bit products do
+    __m128i multiplyLow(__m128i a, __m128i b)
+    {
+        __m128i even = _mm_mul_epu32(a, b);
+        __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                  _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+
+    // Four generators stepped twice, as in the scalar ditherNoise()
+    __m128 ditherSse2(__m128i &state)
+    {
+        const __m128i multiplier = _mm_set1_epi32(static_cast<int>(kDitherMultiplier));
+        const __m128i increment = _mm_set1_epi32(static_cast<int>(kDitherIncrement));
+        __m128i first = _mm_add_epi32(multiplyLow(state, multiplier), increment);
+        state = _mm_add_epi32(multiplyLow(first, multiplier), increment);
+        __m128i sum = _mm_sub_epi32(_mm_add_epi32(_mm_srli_epi32(first, 16), _mm_srli_epi32(state, 16)),
+                                    _mm_set1_epi32(65535));
+        return _mm_mul_ps(_mm_cvtepi32_ps(sum), _mm_set1_ps(1.0f / 65536.0f));
+    }
+
+    __m128i quantizeSse2(__m128 x, __m128 scale, __m128 lo, __m128 hi, __m128 noise)
+    {
+        return _mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(_mm_add_ps(_mm_mul_ps(x, scale), noise), hi), lo));
+    }
+
+    void floatToInt16Sse2(const float *in, int16_t *out, size_t count, uint32_t *dither)
+    {
+        const __m128 scale = _mm_set1_ps(32768.0f), lo = _mm_set1_ps(-32768.0f), hi = _mm_set1_ps(32767.0f);
+        __m128i state[4] = {};
+        if (dither)
+        {
+            for (int k = 0; k < 4; k++)
+                state[k] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dither + 4 * k));
+        }
+
+        size_t i = 0;
+        for (; i + kDitherLanes <= count; i += kDitherLanes)
+        {
+            __m128i v[4];
+            for (int k = 0; k < 4; k++)
+                v[k] = quantizeSse2(_mm_loadu_ps(in + i + 4 * k), scale, lo, hi,
+                                    dither ? ditherSse2(state[k]) : _mm_setzero_ps());
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_packs_epi32(v[0], v[1]));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + 8), _mm_packs_epi32(v[2], v[3]));
+        }
+
+        if (dither)
+        {
+            for (int k = 0; k < 4; k++)
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dither + 4 * k), state[k]);
+        }
+        scalarFloatToInt16(in + i, out + i, count - i, dither);
+    }
+
+    void floatToInt32Sse2(const float *in, int32_t *out, size_t count)
+    {
+        const __m128 scale = _mm_set1_ps(2147483648.0f), lo = _mm_set1_ps(-2147483648.0f), hi = _mm_set1_ps(2147483520.0f);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+                             quantizeSse2(_mm_loadu_ps(in + i), scale, lo, hi, _mm_setzero_ps()));
+        scalarFloatToInt32(in + i, out + i, count - i);
+    }
+}
+
+const SimdKernels *sse2Kernels()
+{
+    static const SimdKernels kernels = {
+        "sse2",
+        multiplySse2,
+        multiplyRampSse2,
+        clampSse2,
+        mixSse2,
+        dotSse2,
+        peakSse2,
+        matrixColumnsSse2,
+        deinterleaveSse2,
+        interleaveSse2,
+        int16ToFloatSse2,
+        // Packed 24-bit samples need a byte shuffle, which arrives with SSSE3
+        scalarInt24ToFloat,
+        int32ToFloatSse2,
+        floatToInt16Sse2,
+        scalarFloatToInt24,
+        floatToInt32Sse2};
+    return &kernels;
+}
+
+#else
+
+const SimdKernels *sse2Kernels()
+{
+    return nullptr;
+}
+
+#endif
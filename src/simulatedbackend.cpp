@@ -0,0 +1,163 @@
+#include "simulatedbackend.h"
+#include "rtguard.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// ===================== Constructor / Destructor =====================
+SimulatedBackend::SimulatedBackend()
+    : SimulatedBackend(Options())
+{
+}
+
+SimulatedBackend::SimulatedBackend(const Options &options)
+    : options_(options), random_(options.seed)
+{
+}
+
+SimulatedBackend::~SimulatedBackend()
+{
+    close();
+}
+
+// ===================== Stream Management =====================
+bool SimulatedBackend::isFormatSupported(const StreamConfig &config)
+{
+    return config.sampleRate > 0.0 && config.inputChannels > 0 && config.outputChannels > 0;
+}
+
+bool SimulatedBackend::open(const StreamConfig &config, AudioCallback *callback)
+{
+    close();
+
+    if (!isFormatSupported(config) || callback == nullptr)
+        return false;
+
+    config_ = config;
+    callback_ = callback;
+    frames_ = config.framesPerBuffer ? config.framesPerBuffer : std::max(options_.defaultFrames, 1UL);
+
+    input_.assign(frames_ * config.inputChannels, 0.0f);
+    output_.assign(frames_ * config.outputChannels, 0.0f);
+    random_.seed(options_.seed);
+    phase_ = 0.0;
+    virtualTime_ = 0.0;
+    pendingFlags_ = StreamStats::PrimingOutput;
+    outputPeak_ = 0.0f;
+    blocks_.store(0);
+    missed_.store(0);
+
+    open_ = true;
+    return true;
+}
+
+bool SimulatedBackend::start()
+{
+    if (!open_ || thread_.joinable())
+        return false;
+
+    running_.store(true);
+    thread_ = std::thread([this]
+                          {
+                              using Clock = std::chrono::steady_clock;
+                              auto origin = Clock::now();
+                              double startTime = virtualTime_;
+                              while (running_.load(std::memory_order_relaxed))
+                              {
+                                  runBlock();
+                                  if (options_.pace)
+                                      std::this_thread::sleep_until(
+                                          origin + std::chrono::duration_cast<Clock::duration>(
+                                                       std::chrono::duration<double>(virtualTime_ - startTime)));
+                              } });
+    return true;
+}
+
+void SimulatedBackend::close()
+{
+    running_.store(false);
+    if (thread_.joinable())
+        thread_.join();
+    open_ = false;
+}
+
+void SimulatedBackend::runBlocks(uint64_t count)
+{
+    if (!open_ || thread_.joinable())
+        return;
+
+    using Clock = std::chrono::steady_clock;
+    auto origin = Clock::now();
+    double startTime = virtualTime_;
+
+    for (uint64_t i = 0; i < count; i++)
+    {
+        runBlock();
+        if (options_.pace)
+            std::this_thread::sleep_until(origin + std::chrono::duration_cast<Clock::duration>(
+                                                       std::chrono::duration<double>(virtualTime_ - startTime)));
+    }
+}
+
+// ===================== Simulated Period =====================
+void SimulatedBackend::runBlock()
+{
+    const double period = frames_ / config_.sampleRate;
+    const int inCh = config_.inputChannels;
+    const int outCh = config_.outputChannels;
+
+    // Test tone on every input channel
+    const double step = 2.0 * 3.14159265358979323846 * options_.toneFrequency / config_.sampleRate;
+    for (unsigned long i = 0; i < frames_; i++)
+    {
+        float sample = options_.toneFrequency > 0.0f ? options_.toneLevel * static_cast<float>(std::sin(phase_)) : 0.0f;
+        phase_ = std::fmod(phase_ + step, 2.0 * 3.14159265358979323846);
+        for (int ch = 0; ch < inCh; ch++)
+            input_[i * inCh + ch] = sample;
+    }
+
+    // The device wakes the callback late by up to jitter periods
+    std::uniform_real_distribution<double> jitter(0.0, std::max(options_.jitter, 0.0) * period);
+    double wakeDelay = std::max(options_.wakeLatency, 0.0) + (options_.jitter > 0.0 ? jitter(random_) : 0.0);
+
+    BlockInfo info;
+    info.flags = pendingFlags_;
+    info.inputLatency = period + wakeDelay;
+    info.outputLatency = 2.0 * period - wakeDelay;
+    // A modelled load replaces the measured time both here and in the stats
+    bool modelled = options_.modelLoad >= 0.0;
+    info.modelledSeconds = modelled ? options_.modelLoad * period : -1.0;
+    info.streamTime = virtualTime_ + 2.0 * period;
+    pendingFlags_ = 0;
+
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    {
+        RealtimeScope realtime;
+        callback_->process(input_.data(), output_.data(), frames_, info);
+    }
+    double processTime = modelled ? info.modelledSeconds
+                                  : std::chrono::duration<double>(Clock::now() - start).count();
+
+    double overrun = wakeDelay + processTime - period;
+    if (overrun > 0.0)
+    {
+        missed_.fetch_add(1, std::memory_order_relaxed);
+        pendingFlags_ |= StreamStats::OutputUnderflow;
+
+        if (options_.policy == MissPolicy::Silence)
+            std::fill(output_.begin(), output_.end(), 0.0f);
+        else
+        {
+            // Capture kept running while the clock slipped
+            virtualTime_ += overrun;
+            pendingFlags_ |= StreamStats::InputOverflow;
+        }
+    }
+
+    for (unsigned long i = 0; i < frames_ * static_cast<unsigned long>(outCh); i++)
+        outputPeak_ = std::max(outputPeak_, std::fabs(output_[i]));
+
+    virtualTime_ += period;
+    blocks_.fetch_add(1, std::memory_order_relaxed);
+}
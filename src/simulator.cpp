@@ -0,0 +1,194 @@
+#include "simulator.h"
+#include "autotuner.h"
+#include <iostream>
+#include <stdexcept>
+
+namespace
+{
+    void printSimulateUsage()
+    {
+        std::cerr << "Usage: amply simulate [options]\n"
+                  << "  --seconds S      Simulated stream length (default 10)\n"
+                  << "  --rate R         Sample rate (default 48000)\n"
+                  << "  --frames N       Frames per buffer (default 256)\n"
+                  << "  --channels N     Input and output channels (default 2)\n"
+                  << "  --jitter F       Largest callback wake-up delay, as a fraction of the period\n"
+                  << "  --wake-latency US  Fixed callback wake-up delay in microseconds\n"
+                  << "  --load F         Model processing time as a fraction of the period\n"
+                  << "                   instead of measuring it (deterministic)\n"
+                  << "  --policy P       Deadline miss policy: silence or slip (default silence)\n"
+                  << "  --seed N         Jitter random seed (default 1)\n"
+                  << "  --realtime       Pace the virtual clock to the wall clock\n"
+                  << "  --workers N      Parallel worker threads (default 0)\n"
+                  << "  --model FILE     Run a captured amp model (.nam, LSTM or GRU)\n"
+                  << "  --ir FILE        Convolve with a cabinet impulse response (WAV)\n"
+                  << "  --max-xruns N    Exit with an error when more deadlines are missed\n"
+                  << "  --tune           Find the smallest stable buffer, soaking each step for --seconds\n";
+    }
+}
+
+// ===================== Argument Parsing =====================
+bool parseSimulateArgs(int argc, char **argv, SimulateOptions &options)
+{
+    options.config.sampleRate = 48000.0;
+    options.config.inputChannels = 2;
+    options.config.outputChannels = 2;
+    options.config.framesPerBuffer = 256;
+
+    for (int i = 0; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        try
+        {
+            if (arg == "--seconds" && hasValue)
+                options.seconds = std::stod(argv[++i]);
+            else if (arg == "--rate" && hasValue)
+                options.config.sampleRate = std::stod(argv[++i]);
+            else if (arg == "--frames" && hasValue)
+                options.config.framesPerBuffer = std::stoul(argv[++i]);
+            else if (arg == "--channels" && hasValue)
+                options.config.inputChannels = options.config.outputChannels = std::stoi(argv[++i]);
+            else if (arg == "--jitter" && hasValue)
+                options.backend.jitter = std::stod(argv[++i]);
+            else if (arg == "--wake-latency" && hasValue)
+                options.backend.wakeLatency = std::stod(argv[++i]) * 1e-6;
+            else if (arg == "--load" && hasValue)
+                options.backend.modelLoad = std::stod(argv[++i]);
+            else if (arg == "--policy" && hasValue)
+            {
+                std::string policy = argv[++i];
+                if (policy == "silence")
+                    options.backend.policy = SimulatedBackend::MissPolicy::Silence;
+                else if (policy == "slip")
+                    options.backend.policy = SimulatedBackend::MissPolicy::Slip;
+                else
+                    throw std::invalid_argument(policy);
+            }
+            else if (arg == "--seed" && hasValue)
+                options.backend.seed = static_cast<uint32_t>(std::stoul(argv[++i]));
+            else if (arg == "--realtime")
+                options.backend.pace = true;
+            else if (arg == "--workers" && hasValue)
+                options.workers = std::stoi(argv[++i]);
+            else if (arg == "--model" && hasValue)
+                options.modelPath = argv[++i];
+            else if (arg == "--ir" && hasValue)
+                options.impulsePath = argv[++i];
+            else if (arg == "--max-xruns" && hasValue)
+                options.maxXruns = std::stol(argv[++i]);
+            else if (arg == "--tune")
+                options.tune = true;
+            else
+            {
+                std::cerr << "[Error] Unknown option: " << arg << "\n";
+                printSimulateUsage();
+                return false;
+            }
+        }
+        catch (...)
+        {
+            std::cerr << "[Error] Invalid value for " << arg << "\n";
+            printSimulateUsage();
+            return false;
+        }
+    }
+
+    if (options.seconds <= 0.0 || options.config.framesPerBuffer == 0 ||
+        options.config.sampleRate <= 0.0 || options.config.inputChannels <= 0)
+    {
+        printSimulateUsage();
+        return false;
+    }
+
+    return true;
+}
+
+// ===================== Simulation =====================
+namespace
+{
+    // Streams the chain through a fresh simulated device for the given time
+    void simulate(AudioEngine &engine, const SimulateOptions &options, const StreamConfig &config,
+                  double seconds, SimulatedBackend &backend, StreamStats &stats)
+    {
+        // Unpaced runs go faster than realtime, so helper threads are waited on
+        // as in offline rendering and the output stays deterministic
+        engine.prepare(config.sampleRate, config.inputChannels, config.outputChannels,
+                       config.framesPerBuffer, options.backend.pace);
+
+        EngineCallback callback(engine, stats);
+        if (!backend.open(config, &callback))
+            return;
+
+        backend.runBlocks(static_cast<uint64_t>(seconds * config.sampleRate / config.framesPerBuffer + 0.5));
+        backend.close();
+    }
+
+    bool runTuner(AudioEngine &engine, const SimulateOptions &options)
+    {
+        Autotuner::Options tuneOptions;
+        tuneOptions.soakSeconds = options.seconds;
+
+        auto trial = [&](const BufferSettings &buffer, double soakSeconds, StreamStats::Snapshot &result)
+        {
+            StreamConfig config = options.config;
+            config.framesPerBuffer = buffer.framesPerBuffer;
+            config.inputLatency = config.outputLatency = buffer.suggestedLatency;
+
+            StreamStats stats;
+            SimulatedBackend backend(options.backend);
+            simulate(engine, options, config, soakSeconds, backend, stats);
+            result = stats.snapshot();
+            return result.blocks > 0;
+        };
+
+        Autotuner tuner(options.config.sampleRate, tuneOptions);
+        bool found = tuner.run(trial);
+        printTuneSteps(std::cout, tuner.steps(), options.config.sampleRate);
+
+        if (!found)
+        {
+            std::cerr << "[Error] No stable buffer size found\n";
+            return false;
+        }
+
+        std::cout << "[Info] Tuned to " << tuner.result().framesPerBuffer << " frames ("
+                  << tuner.result().suggestedLatency * 1000.0 << " ms suggested latency)\n";
+        return true;
+    }
+}
+
+bool runSimulation(AudioEngine &engine, const SimulateOptions &options)
+{
+    const StreamConfig &config = options.config;
+    engine.setWorkerThreads(options.workers);
+
+    if (options.tune)
+        return runTuner(engine, options);
+
+    StreamStats stats;
+    SimulatedBackend backend(options.backend);
+    simulate(engine, options, config, options.seconds, backend, stats);
+    if (backend.blocks() == 0)
+    {
+        std::cerr << "[Error] Invalid simulated stream configuration\n";
+        return false;
+    }
+
+    std::cout << "[Info] Simulated " << backend.virtualSeconds() << " s: "
+              << config.inputChannels << " ch @ " << config.sampleRate << " Hz, "
+              << config.framesPerBuffer << " frames per buffer\n";
+    std::cout << "   Missed deadlines: " << backend.missedDeadlines() << "\n";
+    std::cout << "   Output peak: " << backend.outputPeak() << "\n";
+    printStats(std::cout, stats.snapshot());
+
+    if (options.maxXruns >= 0 && backend.missedDeadlines() > static_cast<uint64_t>(options.maxXruns))
+    {
+        std::cerr << "[Error] " << backend.missedDeadlines() << " missed deadlines exceed the limit of "
+                  << options.maxXruns << "\n";
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,111 @@
+#include "staticchain.h"
+#include "Effects/convolution.h"
+#include "Effects/distortion.h"
+#include "Effects/gain.h"
+#include "simd.h"
+#include <typeinfo>
+
+namespace
+{
+    using EffectList = std::vector<std::shared_ptr<Effect>>;
+
+    // The fused run in previous made of exactly effects[position, position + length)
+    std::shared_ptr<Effect> findFused(const EffectList &previous, const EffectList &effects, size_t position, size_t length)
+    {
+        for (const auto &candidate : previous)
+        {
+            const auto *run = dynamic_cast<const FusedEffect *>(candidate.get());
+            if (!run || run->members().size() != length)
+                continue;
+
+            bool same = true;
+            for (size_t i = 0; i < length && same; i++)
+                same = effects[position + i].get() == run->members()[i];
+            if (same)
+                return candidate;
+        }
+        return nullptr;
+    }
+
+    // StaticChain<Members...> if the effects at position match the types
+    // exactly, taken over from previous when it was fused already; nullptr
+    // otherwise
+    template <typename... Members, size_t... I>
+    std::shared_ptr<Effect> tryFuseAt(const EffectList &effects, const EffectList &previous, size_t position,
+                                      std::index_sequence<I...>)
+    {
+        // Exact types only: a subclass may override process()
+        bool matches = ((effects[position + I] && typeid(*effects[position + I]) == typeid(Members)) && ...);
+        if (!matches)
+            return nullptr;
+
+        if (std::shared_ptr<Effect> existing = findFused(previous, effects, position, sizeof...(Members)))
+            return existing;
+
+        return std::make_shared<StaticChain<Members...>>(
+            std::static_pointer_cast<Members>(effects[position + I])...);
+    }
+
+    template <typename... Members>
+    std::shared_ptr<Effect> tryFuse(const EffectList &effects, const EffectList &previous, size_t position)
+    {
+        if (position + sizeof...(Members) > effects.size())
+            return nullptr;
+
+        return tryFuseAt<Members...>(effects, previous, position, std::index_sequence_for<Members...>{});
+    }
+
+    struct Preset
+    {
+        size_t length;
+        std::shared_ptr<Effect> (*fuse)(const EffectList &, const EffectList &, size_t);
+    };
+
+    // Longest first, so a full preset wins over its sub-sequences
+    const Preset kPresets[] = {
+        {3, &tryFuse<GainEffect, DistortionEffect, ConvolutionEffect>},
+        {2, &tryFuse<GainEffect, DistortionEffect>},
+        {2, &tryFuse<DistortionEffect, ConvolutionEffect>},
+        {2, &tryFuse<GainEffect, ConvolutionEffect>},
+        {2, &tryFuse<DistortionEffect, GainEffect>},
+    };
+}
+
+// ===================== Fused Loop =====================
+fused::Isa fused::selectIsa()
+{
+    // Follows the kernels, so AMPLY_SIMD narrows the fused loop as well
+    const SimdKernels *kernels = &simd();
+    if (kernels == avx512Kernels())
+        return Isa::Avx512;
+    if (kernels == avx2Kernels())
+        return Isa::Avx2;
+    return Isa::Baseline;
+}
+
+// ===================== Preset Matching =====================
+std::vector<std::shared_ptr<Effect>> fuseEffects(const std::vector<std::shared_ptr<Effect>> &effects,
+                                                 const std::vector<std::shared_ptr<Effect>> &previous)
+{
+    std::vector<std::shared_ptr<Effect>> result;
+    result.reserve(effects.size());
+
+    for (size_t position = 0; position < effects.size();)
+    {
+        std::shared_ptr<Effect> fused;
+        size_t length = 1;
+        for (const Preset &preset : kPresets)
+        {
+            if ((fused = preset.fuse(effects, previous, position)))
+            {
+                length = preset.length;
+                break;
+            }
+        }
+
+        result.push_back(fused ? fused : effects[position]);
+        position += length;
+    }
+
+    return result;
+}
@@ -0,0 +1,250 @@
+#include "streamstats.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+// ===================== Stream Statistics =====================
+StreamStats::StreamStats()
+    : resetPending_(false)
+{
+    clear();
+}
+
+void StreamStats::clear()
+{
+    blocks_.store(0, std::memory_order_relaxed);
+    frames_.store(0, std::memory_order_relaxed);
+    inputUnderflows_.store(0, std::memory_order_relaxed);
+    inputOverflows_.store(0, std::memory_order_relaxed);
+    outputUnderflows_.store(0, std::memory_order_relaxed);
+    outputOverflows_.store(0, std::memory_order_relaxed);
+    primingBlocks_.store(0, std::memory_order_relaxed);
+    processNanos_.store(0, std::memory_order_relaxed);
+    periodNanos_.store(0, std::memory_order_relaxed);
+    peakLoadPpm_.store(0, std::memory_order_relaxed);
+    peakProcessNanos_.store(0, std::memory_order_relaxed);
+    inputLatencyMicros_.store(0, std::memory_order_relaxed);
+    outputLatencyMicros_.store(0, std::memory_order_relaxed);
+    for (auto &bucket : loadHistogram_)
+        bucket.store(0, std::memory_order_relaxed);
+}
+
+void StreamStats::record(const Block &block)
+{
+    if (resetPending_.exchange(false, std::memory_order_relaxed))
+        clear();
+
+    // Single writer: plain load + store is enough, no read-modify-write loops
+    auto add = [](std::atomic<uint64_t> &counter, uint64_t value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    };
+    auto raise = [](std::atomic<uint64_t> &peak, uint64_t value)
+    {
+        if (value > peak.load(std::memory_order_relaxed))
+            peak.store(value, std::memory_order_relaxed);
+    };
+
+    add(blocks_, 1);
+    add(frames_, block.frames);
+
+    if (block.flags & InputUnderflow)
+        add(inputUnderflows_, 1);
+    if (block.flags & InputOverflow)
+        add(inputOverflows_, 1);
+    if (block.flags & OutputUnderflow)
+        add(outputUnderflows_, 1);
+    if (block.flags & OutputOverflow)
+        add(outputOverflows_, 1);
+    if (block.flags & PrimingOutput)
+        add(primingBlocks_, 1);
+
+    uint64_t processNanos = static_cast<uint64_t>(block.processSeconds * 1e9);
+    add(processNanos_, processNanos);
+    raise(peakProcessNanos_, processNanos);
+
+    if (block.sampleRate > 0.0 && block.frames > 0)
+    {
+        double period = block.frames / block.sampleRate;
+        double load = block.processSeconds / period;
+        add(periodNanos_, static_cast<uint64_t>(period * 1e9));
+        raise(peakLoadPpm_, static_cast<uint64_t>(load * 1e6));
+
+        int bucket = std::min(static_cast<int>(load * 10.0), kLoadBuckets - 1);
+        add(loadHistogram_[bucket], 1);
+    }
+
+    if (block.inputLatency > 0.0)
+        inputLatencyMicros_.store(static_cast<uint64_t>(block.inputLatency * 1e6), std::memory_order_relaxed);
+    if (block.outputLatency > 0.0)
+        outputLatencyMicros_.store(static_cast<uint64_t>(block.outputLatency * 1e6), std::memory_order_relaxed);
+}
+
+StreamStats::Snapshot StreamStats::snapshot() const
+{
+    Snapshot s;
+    if (resetPending_.load(std::memory_order_relaxed))
+        return s;
+
+    s.blocks = blocks_.load(std::memory_order_relaxed);
+    s.frames = frames_.load(std::memory_order_relaxed);
+    s.inputUnderflows = inputUnderflows_.load(std::memory_order_relaxed);
+    s.inputOverflows = inputOverflows_.load(std::memory_order_relaxed);
+    s.outputUnderflows = outputUnderflows_.load(std::memory_order_relaxed);
+    s.outputOverflows = outputOverflows_.load(std::memory_order_relaxed);
+    s.primingBlocks = primingBlocks_.load(std::memory_order_relaxed);
+
+    uint64_t period = periodNanos_.load(std::memory_order_relaxed);
+    if (period > 0)
+        s.averageLoad = static_cast<double>(processNanos_.load(std::memory_order_relaxed)) / period;
+    s.peakLoad = peakLoadPpm_.load(std::memory_order_relaxed) / 1e6;
+    s.peakProcessMs = peakProcessNanos_.load(std::memory_order_relaxed) / 1e6;
+    s.inputLatencyMs = inputLatencyMicros_.load(std::memory_order_relaxed) / 1e3;
+    s.outputLatencyMs = outputLatencyMicros_.load(std::memory_order_relaxed) / 1e3;
+
+    for (int i = 0; i < kLoadBuckets; i++)
+        s.loadHistogram[i] = loadHistogram_[i].load(std::memory_order_relaxed);
+
+    return s;
+}
+
+void printStats(std::ostream &out, const StreamStats::Snapshot &s)
+{
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+
+    out << std::fixed << std::setprecision(2);
+    out << "  Blocks:            " << s.blocks << " (" << s.frames << " frames)\n";
+    out << "  Input  under/over: " << s.inputUnderflows << " / " << s.inputOverflows << "\n";
+    out << "  Output under/over: " << s.outputUnderflows << " / " << s.outputOverflows << "\n";
+    out << "  Priming blocks:    " << s.primingBlocks << "\n";
+    out << "  Load avg / peak:   " << s.averageLoad * 100.0 << "% / " << s.peakLoad * 100.0 << "%\n";
+    out << "  Peak process time: " << s.peakProcessMs << " ms\n";
+    out << "  Latency in / out:  " << s.inputLatencyMs << " ms / " << s.outputLatencyMs << " ms\n";
+
+    out << "  Load histogram (share of buffer period):\n";
+    for (int i = 0; i < StreamStats::kLoadBuckets; i++)
+    {
+        if (i == StreamStats::kLoadBuckets - 1)
+            out << "    >=100%   ";
+        else
+            out << "    " << std::setw(3) << i * 10 << "-" << std::setw(3) << (i + 1) * 10 << "% ";
+        out << s.loadHistogram[i] << "\n";
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+// ===================== Periodic Export =====================
+StatsExporter::~StatsExporter()
+{
+    stop();
+}
+
+bool StatsExporter::start(const StreamStats &stats, const std::string &path, double intervalSeconds)
+{
+    stop();
+
+    if (intervalSeconds <= 0.0)
+    {
+        std::cerr << "[Error] Export interval must be positive\n";
+        return false;
+    }
+
+    file_.open(path, std::ios::out | std::ios::trunc);
+    if (!file_)
+    {
+        std::cerr << "[Error] Could not open " << path << " for writing\n";
+        return false;
+    }
+
+    auto endsWith = [&](const std::string &suffix)
+    {
+        return path.size() >= suffix.size() &&
+               path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0;
+    };
+    json_ = endsWith(".json") || endsWith(".jsonl");
+
+    if (!json_)
+    {
+        file_ << "elapsed_s,blocks,frames,input_underflows,input_overflows,output_underflows,"
+                 "output_overflows,priming_blocks,average_load,peak_load,peak_process_ms,"
+                 "input_latency_ms,output_latency_ms";
+        for (int i = 0; i < StreamStats::kLoadBuckets; i++)
+            file_ << ",load_" << i * 10 << (i == StreamStats::kLoadBuckets - 1 ? "_plus" : "");
+        file_ << "\n";
+    }
+
+    stopping_ = false;
+    thread_ = std::thread(&StatsExporter::run, this, &stats, intervalSeconds);
+    return true;
+}
+
+void StatsExporter::stop()
+{
+    if (!thread_.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    thread_.join();
+    file_.close();
+}
+
+void StatsExporter::run(const StreamStats *stats, double intervalSeconds)
+{
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(intervalSeconds));
+    auto next = start + interval;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!wake_.wait_until(lock, next, [this] { return stopping_; }))
+    {
+        double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        writeLine(stats->snapshot(), elapsed);
+        next += interval;
+    }
+}
+
+void StatsExporter::writeLine(const StreamStats::Snapshot &s, double elapsed)
+{
+    if (json_)
+    {
+        file_ << "{\"elapsed_s\":" << elapsed
+              << ",\"blocks\":" << s.blocks
+              << ",\"frames\":" << s.frames
+              << ",\"input_underflows\":" << s.inputUnderflows
+              << ",\"input_overflows\":" << s.inputOverflows
+              << ",\"output_underflows\":" << s.outputUnderflows
+              << ",\"output_overflows\":" << s.outputOverflows
+              << ",\"priming_blocks\":" << s.primingBlocks
+              << ",\"average_load\":" << s.averageLoad
+              << ",\"peak_load\":" << s.peakLoad
+              << ",\"peak_process_ms\":" << s.peakProcessMs
+              << ",\"input_latency_ms\":" << s.inputLatencyMs
+              << ",\"output_latency_ms\":" << s.outputLatencyMs
+              << ",\"load_histogram\":[";
+        for (int i = 0; i < StreamStats::kLoadBuckets; i++)
+            file_ << (i ? "," : "") << s.loadHistogram[i];
+        file_ << "]}\n";
+    }
+    else
+    {
+        file_ << elapsed << "," << s.blocks << "," << s.frames << ","
+              << s.inputUnderflows << "," << s.inputOverflows << ","
+              << s.outputUnderflows << "," << s.outputOverflows << ","
+              << s.primingBlocks << "," << s.averageLoad << "," << s.peakLoad << ","
+              << s.peakProcessMs << "," << s.inputLatencyMs << "," << s.outputLatencyMs;
+        for (int i = 0; i < StreamStats::kLoadBuckets; i++)
+            file_ << "," << s.loadHistogram[i];
+        file_ << "\n";
+    }
+
+    file_.flush();
+}
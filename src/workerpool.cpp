@@ -0,0 +1,217 @@
+#include "workerpool.h"
+#include "realtime.h"
+#include <algorithm>
+#include <chrono>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    // Packed slice state: 16-bit generation, 24-bit next task, 24-bit end
+    constexpr uint64_t kIndexMask = (1u << 24) - 1;
+
+    uint64_t pack(uint64_t generation, size_t begin, size_t end)
+    {
+        return ((generation & 0xFFFF) << 48) | (static_cast<uint64_t>(begin) << 24) | end;
+    }
+
+    // Spins without starving a hyperthread sibling
+    inline void cpuRelax()
+    {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+        _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        __asm__ __volatile__("yield");
+#else
+        std::this_thread::yield();
+#endif
+    }
+
+    constexpr int kSpinIterations = 4000;
+    constexpr auto kYieldPeriod = std::chrono::milliseconds(50);
+    constexpr auto kIdlePoll = std::chrono::microseconds(500);
+}
+
+// ===================== Constructor / Destructor =====================
+WorkerPool::WorkerPool(int workers, bool pin)
+    : participants_(static_cast<size_t>(workers) + 1)
+{
+    slices_ = std::make_unique<Slice[]>(participants_);
+
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 0; i < workers; i++)
+    {
+        threads_.emplace_back(&WorkerPool::workerLoop, this, static_cast<size_t>(i) + 1);
+
+        // Leave core 0 to the audio callback where there is room
+        if (pin)
+            pinThread(threads_.back(), (static_cast<unsigned>(i) + 1) % cores);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    quit_.store(true);
+    for (auto &thread : threads_)
+        thread.join();
+}
+
+void WorkerPool::followCaller(int priority, bool flushDenormals)
+{
+    callerPriority_.store(priority, std::memory_order_relaxed);
+    callerFlushDenormals_.store(flushDenormals, std::memory_order_relaxed);
+    callerSequence_.fetch_add(1, std::memory_order_release);
+}
+
+// ===================== Audio Thread =====================
+bool WorkerPool::run(size_t count, Task task, void *context)
+{
+    int fallback = fallbackBlocks_.load(std::memory_order_relaxed);
+    if (fallback > 0)
+    {
+        fallbackBlocks_.store(fallback - 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    if (count == 0)
+        return true;
+
+    const uint64_t generation = generation_.load(std::memory_order_relaxed) + 1;
+
+    // Even slices, the caller's first
+    size_t begin = 0;
+    for (size_t s = 0; s < participants_; s++)
+    {
+        size_t size = count / participants_ + (s < count % participants_ ? 1 : 0);
+        slices_[s].first = begin;
+        slices_[s].state.store(pack(generation, begin, begin + size), std::memory_order_relaxed);
+        begin += size;
+    }
+
+    task_.store(task, std::memory_order_relaxed);
+    context_.store(context, std::memory_order_relaxed);
+    completed_.store(0, std::memory_order_relaxed);
+    sliceStolen_.store(false, std::memory_order_relaxed);
+    generation_.store(generation, std::memory_order_release);
+
+    participate(0, generation, task, context);
+
+    // Everything unclaimed is done by now; wait out tasks still in flight
+    while (completed_.load(std::memory_order_acquire) < count)
+        cpuRelax();
+
+    if (sliceStolen_.load(std::memory_order_relaxed))
+    {
+        missedSlots_.fetch_add(1, std::memory_order_relaxed);
+        if (++consecutiveMisses_ >= kMissesBeforeFallback)
+        {
+            consecutiveMisses_ = 0;
+            fallbacks_.fetch_add(1, std::memory_order_relaxed);
+            fallbackBlocks_.store(kFallbackBlocks, std::memory_order_relaxed);
+        }
+    }
+    else
+    {
+        consecutiveMisses_ = 0;
+    }
+
+    return true;
+}
+
+// ===================== Task Distribution =====================
+bool WorkerPool::claim(size_t slice, uint64_t generation, bool fromBack, size_t &index)
+{
+    std::atomic<uint64_t> &state = slices_[slice].state;
+    uint64_t current = state.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        if ((current >> 48) != (generation & 0xFFFF))
+            return false;
+
+        size_t begin = static_cast<size_t>((current >> 24) & kIndexMask);
+        size_t end = static_cast<size_t>(current & kIndexMask);
+        if (begin >= end)
+            return false;
+
+        // Owners take from the front, thieves from the back
+        uint64_t next = fromBack ? pack(generation, begin, end - 1) : pack(generation, begin + 1, end);
+        if (state.compare_exchange_weak(current, next, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            index = fromBack ? end - 1 : begin;
+            return true;
+        }
+    }
+}
+
+void WorkerPool::participate(size_t self, uint64_t generation, Task task, void *context)
+{
+    size_t index;
+
+    for (size_t k = 0; k < participants_; k++)
+    {
+        size_t slice = (self + k) % participants_;
+        bool stealing = slice != self;
+
+        while (claim(slice, generation, stealing, index))
+        {
+            // The owner always starts at the front, so a thief reaching the
+            // front means the owner never showed up
+            if (stealing && index == slices_[slice].first)
+                sliceStolen_.store(true, std::memory_order_relaxed);
+
+            task(context, index);
+            completed_.fetch_add(1, std::memory_order_release);
+        }
+    }
+}
+
+void WorkerPool::workerLoop(size_t self)
+{
+    using Clock = std::chrono::steady_clock;
+
+    uint64_t seen = generation_.load(std::memory_order_acquire);
+    uint32_t followed = 0;
+    auto idleSince = Clock::now();
+    int spins = 0;
+
+    while (!quit_.load(std::memory_order_relaxed))
+    {
+        // At a FIFO priority below the caller's, a worker preempted mid-task
+        // on the caller's core would never get back to finish it
+        uint32_t sequence = callerSequence_.load(std::memory_order_acquire);
+        if (sequence != followed)
+        {
+            followed = sequence;
+            ThreadSetup setup;
+            setup.flushDenormals = callerFlushDenormals_.load(std::memory_order_relaxed);
+            setup.priority = callerPriority_.load(std::memory_order_relaxed);
+            applyThreadSetup(setup);
+        }
+
+        uint64_t generation = generation_.load(std::memory_order_acquire);
+        if (generation != seen)
+        {
+            seen = generation;
+            participate(self, generation, task_.load(std::memory_order_relaxed),
+                        context_.load(std::memory_order_relaxed));
+            idleSince = Clock::now();
+            spins = 0;
+            continue;
+        }
+
+        // Spin right after a block, when the next one is most likely due,
+        // then back off so an idle pool costs next to nothing
+        if (spins < kSpinIterations)
+        {
+            cpuRelax();
+            spins++;
+        }
+        else if (Clock::now() - idleSince < kYieldPeriod)
+            std::this_thread::yield();
+        else
+            std::this_thread::sleep_for(kIdlePoll);
+    }
+}